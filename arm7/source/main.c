@@ -0,0 +1,54 @@
+#include <nds.h>
+
+#include "worker.h"
+
+// 両方のアプリが使うARM7のプログラム
+// libndsの標準のARM7 (タッチ・キー・RTC・電源・サウンドのFIFO) に
+// common/worker.c のジョブの実行を足したもの。無線LANとmaxmodは使わない。
+
+static void vcountHandler(void) {
+    inputGetAndSend(); // タッチとキーをARM9に送る
+}
+
+static volatile bool exitflag = false;
+
+static void powerButtonCB(void) {
+    exitflag = true;
+}
+
+int main(void) {
+    // サウンドのレジスタを消してから有効にする
+    dmaFillWords(0, (void*)0x04000400, 0x100);
+    REG_SOUNDCNT |= SOUND_ENABLE;
+    writePowerManagement(PM_CONTROL_REG, (readPowerManagement(PM_CONTROL_REG) & ~PM_SOUND_MUTE) | PM_SOUND_AMP);
+    powerOn(POWER_SOUND);
+
+    readUserSettings();
+    ledBlink(0);
+
+    irqInit();
+    initClockIRQ(); // RTC
+    fifoInit();
+    touchInit();
+
+    SetYtrigger(80);
+
+    installSoundFIFO();
+    installSystemFIFO();
+    worker_start();
+
+    irqSet(IRQ_VCOUNT, vcountHandler);
+    irqEnable(IRQ_VBLANK | IRQ_VCOUNT);
+
+    setPowerButtonCB(powerButtonCB);
+
+    while (!exitflag) {
+        if (0 == (REG_KEYINPUT & (KEY_SELECT | KEY_START | KEY_L | KEY_R))) {
+            exitflag = true;
+        }
+        // ジョブが無ければ次のVBlankまで休む。
+        // タッチとキーは割り込みで送るので、長いジョブの間も止まらない
+        if (!worker_runNext()) swiWaitForVBlank();
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "platform.h"
+
+// 簡易ベンチマーク用タイマー
+// ARM9ではlibndsのcpuStartTiming()(タイマー0/1をカスケード)を、
+// ホストではclock_gettime()を使う。make BENCHMARK=1 でENABLE_BENCHMARKが定義される。
+
+// ARM9のCPUクロック (BUS_CLOCKの2倍, 約67MHz)
+#define BENCH_CPU_HZ 67027964ULL
+
+#ifdef ARM9
+static inline void bench_start(void) { cpuStartTiming(0); }
+
+// bench_start()からの経過時間 (ナノ秒)
+static inline u64 bench_elapsedNsec(void) {
+    return (u64)cpuGetTiming() * 1000000000ULL / BUS_CLOCK;
+}
+
+static inline void bench_stop(void) { cpuEndTiming(); }
+#else
+#include <time.h>
+
+static struct timespec bench_start_time;
+
+static inline void bench_start(void) { clock_gettime(CLOCK_MONOTONIC, &bench_start_time); }
+
+static inline u64 bench_elapsedNsec(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)(now.tv_sec - bench_start_time.tv_sec) * 1000000000ULL
+         + (u64)(now.tv_nsec - bench_start_time.tv_nsec);
+}
+
+static inline void bench_stop(void) { }
+#endif
+
+// 経過ナノ秒をARM9のCPUサイクル数に換算する (1回あたり)
+static inline u32 bench_cyclesPerOp(u64 nsec, u32 ops) {
+    if (ops == 0) return 0;
+    return (u32)(nsec * BENCH_CPU_HZ / 1000000000ULL / ops);
+}
+
+#endif // BENCH_H
@@ -0,0 +1,661 @@
+#include <string.h>
+
+#include "bignum.h"
+#include "hw_math.h"
+#include "tcm.h"
+
+// n! を計算できる上限 (途中の積が64bitに収まり、時間も数秒以内の範囲)
+#define BIGNUM_FACTORIAL_MAX 10000
+
+// ARM7のワーカーが結果を書き込むので、キャッシュラインの境界にそろえる
+static u32 bignum_arena[BIGNUM_ARENA_LIMBS] __attribute__((aligned(32)));
+static u32 bignum_arena_top = 0;
+
+// 確保はキャッシュライン (32バイト = 8 limb) 単位。ジョブの完了時にARM9が結果の
+// limbの範囲のキャッシュを捨てても、同じラインに載った他の値を巻き込まない
+#define ARENA_LINE_LIMBS 8
+
+#if BIGNUM_ARENA_LIMBS % ARENA_LINE_LIMBS != 0
+#error "BIGNUM_ARENA_LIMBS must be a multiple of 8"
+#endif
+
+static const u32 pow10_table[BIGNUM_BASE_DIGITS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+u32 bignum_arenaMark(void) {
+    return bignum_arena_top;
+}
+
+void bignum_arenaRelease(u32 mark) {
+    if (mark <= bignum_arena_top) bignum_arena_top = mark;
+}
+
+static u32* arenaAlloc(s32 limbs) {
+    if (limbs < 0 || (u32)limbs > BIGNUM_ARENA_LIMBS - bignum_arena_top) return NULL;
+    u32 rounded = ((u32)limbs + ARENA_LINE_LIMBS - 1) & ~(u32)(ARENA_LINE_LIMBS - 1);
+    u32* p = &bignum_arena[bignum_arena_top];
+    bignum_arena_top += rounded;
+    return p;
+}
+
+bool bignum_alloc(BigNum* n, s32 cap) {
+    n->limb = arenaAlloc(cap);
+    n->cap = n->limb != NULL ? cap : 0;
+    bignum_setZero(n);
+    return n->limb != NULL;
+}
+
+void bignum_setZero(BigNum* n) {
+    n->len = 0;
+    n->exp = 0;
+    n->negative = false;
+}
+
+bool bignum_isZero(const BigNum* n) {
+    return n->len == 0;
+}
+
+// t = 上位 * 10^9 + *lo に分ける (上位は32bitに収まること)
+static inline u32 splitBase(u64 t, u32* lo) {
+#ifdef ARM9
+    hwmath_divStart64_32((s64)t, BIGNUM_BASE);
+    u32 hi = (u32)hwmath_divResult();
+    *lo = (u32)hwmath_divRemainder32();
+    return hi;
+#else
+    // 除算器が無い (ARM7とホスト) ので、商から余りを求めて除算を1回にする
+    u64 q = t / BIGNUM_BASE;
+    *lo = (u32)(t - q * BIGNUM_BASE);
+    return (u32)q;
+#endif
+}
+
+// 上下の0 limbを除いてrに入れる。capを超える分は下位を捨てる
+static bool store(BigNum* r, const u32* limbs, s32 len, s32 exp, bool negative) {
+    while (len > 0 && limbs[len - 1] == 0) len--;
+    if (len > r->cap) {
+        exp += len - r->cap;
+        limbs += len - r->cap;
+        len = r->cap;
+    }
+    while (len > 0 && limbs[0] == 0) {
+        limbs++;
+        len--;
+        exp++;
+    }
+    if (len == 0) {
+        bignum_setZero(r);
+        return true;
+    }
+    if (exp > BIGNUM_MAX_EXP || exp < -BIGNUM_MAX_EXP) return false;
+
+    memmove(r->limb, limbs, len * sizeof(u32));
+    r->len = len;
+    r->exp = exp;
+    r->negative = negative;
+    return true;
+}
+
+bool bignum_copy(BigNum* dst, const BigNum* src) {
+    if (dst == src) return true;
+    return store(dst, src->limb, src->len, src->exp, src->negative);
+}
+
+bool bignum_fromString(BigNum* n, const char* s) {
+    bool negative = false;
+    if (*s == '-') {
+        negative = true;
+        s++;
+    }
+
+    s32 digits = 0;
+    s32 frac_digits = 0;
+    bool dot = false;
+    const char* end = s;
+    for (; *end != '\0'; end++) {
+        if (*end >= '0' && *end <= '9') {
+            digits++;
+            if (dot) frac_digits++;
+        } else if (*end == '.' && !dot) {
+            dot = true;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0) return false;
+
+    // 小数部の桁数を9の倍数にそろえる
+    s32 pad = (BIGNUM_BASE_DIGITS - frac_digits % BIGNUM_BASE_DIGITS) % BIGNUM_BASE_DIGITS;
+    s32 len = (digits + pad + BIGNUM_BASE_DIGITS - 1) / BIGNUM_BASE_DIGITS;
+
+    u32 mark = bignum_arenaMark();
+    u32* t = arenaAlloc(len);
+    if (t == NULL) return false;
+    memset(t, 0, len * sizeof(u32));
+
+    s32 k = pad;
+    for (const char* p = end - 1; p >= s; p--) {
+        if (*p == '.') continue;
+        t[k / BIGNUM_BASE_DIGITS] += (u32)(*p - '0') * pow10_table[k % BIGNUM_BASE_DIGITS];
+        k++;
+    }
+
+    bool ok = store(n, t, len, -(frac_digits + pad) / BIGNUM_BASE_DIGITS, negative);
+    bignum_arenaRelease(mark);
+    return ok;
+}
+
+bool bignum_toU32(const BigNum* n, u32* out) {
+    if (n->len == 0) {
+        *out = 0;
+        return true;
+    }
+    // 正規化済みなので exp < 0 なら小数部がある
+    if (n->negative || n->exp < 0 || n->len + n->exp > 2) return false;
+
+    u64 v = 0;
+    for (s32 i = n->len - 1; i >= 0; i--) v = v * BIGNUM_BASE + n->limb[i];
+    for (s32 i = 0; i < n->exp; i++) v *= BIGNUM_BASE;
+    if (v > 0xFFFFFFFFULL) return false;
+    *out = (u32)v;
+    return true;
+}
+
+// 仮数の下からk桁目 (0始まり) の数字
+static inline int mantDigit(const BigNum* n, s32 k) {
+    return (int)(n->limb[k / BIGNUM_BASE_DIGITS] / pow10_table[k % BIGNUM_BASE_DIGITS] % 10);
+}
+
+static u32 writeInt(char* buf, s32 v) {
+    char tmp[12];
+    u32 len = 0;
+    u32 out = 0;
+    if (v < 0) {
+        buf[out++] = '-';
+        v = -v;
+    }
+    do {
+        tmp[len++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (len > 0) buf[out++] = tmp[--len];
+    return out;
+}
+
+u32 bignum_toString(const BigNum* n, char* buf, u32 size) {
+    u32 out = 0;
+
+    if (size == 0) return 0;
+    if (n->len == 0 || size < 2) {
+        if (size >= 2) buf[out++] = '0';
+        buf[out] = '\0';
+        return out;
+    }
+
+    // 仮数の桁数と、下位の0の数
+    s32 top_digits = 1;
+    while (top_digits < BIGNUM_BASE_DIGITS && n->limb[n->len - 1] >= pow10_table[top_digits]) top_digits++;
+    s32 mant_digits = top_digits + BIGNUM_BASE_DIGITS * (n->len - 1);
+    s32 low_zeros = 0;
+    while (mantDigit(n, low_zeros) == 0) low_zeros++;
+
+    s32 shift = BIGNUM_BASE_DIGITS * n->exp;  // 仮数の0桁目の位 (10^shift)
+    s32 int_digits = mant_digits + shift;      // 整数部の桁数 (0以下なら0.xxx)
+    s32 frac_digits = shift < 0 ? -shift - low_zeros : 0;
+
+    u32 plain_len = (n->negative ? 1 : 0) + (int_digits > 0 ? int_digits : 1) + (frac_digits > 0 ? 1 + frac_digits : 0);
+    if (n->negative) buf[out++] = '-';
+
+    if (plain_len < size) {
+        // 位ごとに書く (pは10の何乗の位か)
+        if (int_digits <= 0) buf[out++] = '0';
+        for (s32 p = int_digits > 0 ? int_digits - 1 : -1; p >= -frac_digits; p--) {
+            if (p == -1) buf[out++] = '.';
+            s32 k = p - shift;
+            buf[out++] = (k >= 0 && k < mant_digits) ? (char)('0' + mantDigit(n, k)) : '0';
+        }
+        buf[out] = '\0';
+        return out;
+    }
+
+    // 指数表記: d.ddd...e+N
+    char suffix[14];
+    u32 suffix_len = 1;
+    suffix[0] = 'e';
+    if (int_digits - 1 >= 0) suffix[suffix_len++] = '+';
+    suffix_len += writeInt(suffix + suffix_len, int_digits - 1);
+
+    s32 room = (s32)size - 1 - (s32)out - (s32)suffix_len - 2; // 先頭の数字と小数点の分
+    s32 more = mant_digits - 1 - low_zeros;
+    if (more > room) more = room;
+    if (more < 0) more = 0;
+
+    buf[out++] = (char)('0' + mantDigit(n, mant_digits - 1));
+    if (more > 0) {
+        buf[out++] = '.';
+        for (s32 i = 1; i <= more; i++) buf[out++] = (char)('0' + mantDigit(n, mant_digits - 1 - i));
+    }
+    if (out + suffix_len < size) {
+        memcpy(buf + out, suffix, suffix_len);
+        out += suffix_len;
+    }
+    buf[out] = '\0';
+    return out;
+}
+
+static inline s32 topPos(const BigNum* n) {
+    return n->exp + n->len;
+}
+
+static inline u32 limbAt(const BigNum* n, s32 pos) {
+    s32 i = pos - n->exp;
+    return (i >= 0 && i < n->len) ? n->limb[i] : 0;
+}
+
+// |a| と |b| の比較
+static int compareMag(const BigNum* a, const BigNum* b) {
+    if (a->len == 0 || b->len == 0) return (a->len != 0) - (b->len != 0);
+    if (topPos(a) != topPos(b)) return topPos(a) > topPos(b) ? 1 : -1;
+
+    s32 lo = a->exp < b->exp ? a->exp : b->exp;
+    for (s32 pos = topPos(a) - 1; pos >= lo; pos--) {
+        u32 x = limbAt(a, pos);
+        u32 y = limbAt(b, pos);
+        if (x != y) return x > y ? 1 : -1;
+    }
+    return 0;
+}
+
+// r = a + (b_negative ? -|b| : |b|)
+static bool addSigned(BigNum* r, const BigNum* a, const BigNum* b, bool b_negative) {
+    if (b->len == 0) return bignum_copy(r, a);
+    if (a->len == 0) return store(r, b->limb, b->len, b->exp, b_negative);
+
+    s32 lo = a->exp < b->exp ? a->exp : b->exp;
+    s32 hi = topPos(a) > topPos(b) ? topPos(a) : topPos(b);
+    s32 n = hi - lo + 1;
+
+    u32 mark = bignum_arenaMark();
+    u32* t = arenaAlloc(n);
+    if (t == NULL) return false;
+
+    bool negative;
+    if (a->negative == b_negative) {
+        u32 carry = 0;
+        for (s32 i = 0; i < n; i++) {
+            u32 s = limbAt(a, lo + i) + limbAt(b, lo + i) + carry;
+            carry = s >= BIGNUM_BASE;
+            t[i] = carry ? s - BIGNUM_BASE : s;
+        }
+        negative = a->negative;
+    } else {
+        // 絶対値の大きい方から小さい方を引く
+        const BigNum* big = a;
+        const BigNum* small = b;
+        negative = a->negative;
+        if (compareMag(a, b) < 0) {
+            big = b;
+            small = a;
+            negative = b_negative;
+        }
+        s32 borrow = 0;
+        for (s32 i = 0; i < n; i++) {
+            s32 d = (s32)limbAt(big, lo + i) - (s32)limbAt(small, lo + i) - borrow;
+            borrow = d < 0;
+            t[i] = (u32)(borrow ? d + (s32)BIGNUM_BASE : d);
+        }
+    }
+
+    bool ok = store(r, t, n, lo, negative);
+    bignum_arenaRelease(mark);
+    return ok;
+}
+
+bool bignum_add(BigNum* r, const BigNum* a, const BigNum* b) {
+    return addSigned(r, a, b, b->negative);
+}
+
+bool bignum_sub(BigNum* r, const BigNum* a, const BigNum* b) {
+    return addSigned(r, a, b, !b->negative);
+}
+
+// r[0..na] = a + b (na >= nb)。rはna+1 limb
+static void addLimbs(u32* r, const u32* a, s32 na, const u32* b, s32 nb) {
+    u32 carry = 0;
+    for (s32 i = 0; i < na; i++) {
+        u32 s = a[i] + (i < nb ? b[i] : 0) + carry;
+        carry = s >= BIGNUM_BASE;
+        r[i] = carry ? s - BIGNUM_BASE : s;
+    }
+    r[na] = carry;
+}
+
+// a += b (na >= nb、桁あふれしないこと)
+static void addInPlace(u32* a, s32 na, const u32* b, s32 nb) {
+    u32 carry = 0;
+    for (s32 i = 0; i < na && (i < nb || carry); i++) {
+        u32 s = a[i] + (i < nb ? b[i] : 0) + carry;
+        carry = s >= BIGNUM_BASE;
+        a[i] = carry ? s - BIGNUM_BASE : s;
+    }
+}
+
+// a -= b (na >= nb、a >= b)
+static void subInPlace(u32* a, s32 na, const u32* b, s32 nb) {
+    s32 borrow = 0;
+    for (s32 i = 0; i < na && (i < nb || borrow); i++) {
+        s32 d = (s32)a[i] - (s32)(i < nb ? b[i] : 0) - borrow;
+        borrow = d < 0;
+        a[i] = (u32)(borrow ? d + (s32)BIGNUM_BASE : d);
+    }
+}
+
+// 筆算。rは na + nb limb (Karatsubaの末端もここ。make TCM=1 ではITCMに置く)
+static TCM_CODE void mulSchool(u32* r, const u32* a, s32 na, const u32* b, s32 nb) {
+    memset(r, 0, (na + nb) * sizeof(u32));
+    for (s32 i = 0; i < na; i++) {
+        u32 ai = a[i];
+        u32 carry = 0;
+        if (ai == 0) continue;
+        for (s32 j = 0; j < nb; j++) {
+            carry = splitBase((u64)ai * b[j] + r[i + j] + carry, &r[i + j]);
+        }
+        r[i + nb] = carry;
+    }
+}
+
+// karatsuba(n) が使う作業領域のlimb数
+static s32 karatsubaScratch(s32 n) {
+    if (n < BIGNUM_KARATSUBA_THRESHOLD) return 0;
+    s32 h = n - n / 2;
+    return 4 * (h + 1) + karatsubaScratch(h + 1);
+}
+
+// a, b は n limbずつ、rは 2n limb
+static void karatsuba(u32* r, const u32* a, const u32* b, s32 n, u32* scratch) {
+    if (n < BIGNUM_KARATSUBA_THRESHOLD) {
+        mulSchool(r, a, n, b, n);
+        return;
+    }
+
+    s32 m = n / 2;
+    s32 h = n - m;
+
+    // z0 = a0 b0, z2 = a1 b1 はrに直接置く
+    karatsuba(r, a, b, m, scratch);
+    karatsuba(r + 2 * m, a + m, b + m, h, scratch);
+
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+    u32* sa = scratch;
+    u32* sb = sa + h + 1;
+    u32* z1 = sb + h + 1;
+    addLimbs(sa, a + m, h, a, m);
+    addLimbs(sb, b + m, h, b, m);
+    karatsuba(z1, sa, sb, h + 1, z1 + 2 * (h + 1));
+    subInPlace(z1, 2 * (h + 1), r, 2 * m);
+    subInPlace(z1, 2 * (h + 1), r + 2 * m, 2 * h);
+
+    addInPlace(r + m, 2 * n - m, z1, 2 * (h + 1));
+}
+
+// rは na + nb limb
+static void mulLimbs(u32* r, const u32* a, s32 na, const u32* b, s32 nb) {
+    if (na < nb) {
+        const u32* t = a;
+        a = b;
+        b = t;
+        s32 tn = na;
+        na = nb;
+        nb = tn;
+    }
+    if (nb < BIGNUM_KARATSUBA_THRESHOLD) {
+        mulSchool(r, a, na, b, nb);
+        return;
+    }
+
+    u32 mark = bignum_arenaMark();
+    u32* part = arenaAlloc(2 * nb);
+    u32* scratch = arenaAlloc(karatsubaScratch(nb));
+    if (part == NULL || scratch == NULL) {
+        bignum_arenaRelease(mark);
+        mulSchool(r, a, na, b, nb);
+        return;
+    }
+
+    // 長い方をnb limbずつに切って掛ける
+    memset(r, 0, (na + nb) * sizeof(u32));
+    for (s32 off = 0; off < na; off += nb) {
+        s32 len = na - off < nb ? na - off : nb;
+        if (len == nb) {
+            karatsuba(part, a + off, b, nb, scratch);
+        } else {
+            mulLimbs(part, b, nb, a + off, len);
+        }
+        addInPlace(r + off, na + nb - off, part, len + nb);
+    }
+    bignum_arenaRelease(mark);
+}
+
+bool bignum_mul(BigNum* r, const BigNum* a, const BigNum* b) {
+    if (a->len == 0 || b->len == 0) {
+        bignum_setZero(r);
+        return true;
+    }
+
+    u32 mark = bignum_arenaMark();
+    u32* t = arenaAlloc(a->len + b->len);
+    if (t == NULL) return false;
+
+    mulLimbs(t, a->limb, a->len, b->limb, b->len);
+    bool ok = store(r, t, a->len + b->len, a->exp + b->exp, a->negative != b->negative);
+    bignum_arenaRelease(mark);
+    return ok;
+}
+
+// a *= m (aはn limb、最上位にあふれないこと)
+static void mulSmallInPlace(u32* a, s32 n, u32 m) {
+    u32 carry = 0;
+    for (s32 i = 0; i < n; i++) {
+        carry = splitBase((u64)a[i] * m + carry, &a[i]);
+    }
+}
+
+// Knuth Algorithm D。q = u / v (商は ulen - n + 1 limb、余りは捨てる)。
+// uは ulen + 1 limb (最上位は0)、vは n >= 2 limb。u, v は書き換える
+static void divLimbs(u32* q, u32* u, s32 ulen, u32* v, s32 n) {
+    // vの最上位limbが基数の半分以上になるように正規化する
+    u32 d = BIGNUM_BASE / (v[n - 1] + 1);
+    mulSmallInPlace(u, ulen + 1, d);
+    mulSmallInPlace(v, n, d);
+
+    u32 vtop = v[n - 1];
+    u32 vnext = v[n - 2];
+
+    for (s32 j = ulen - n; j >= 0; j--) {
+        // 上位2 limbから商の1 limbを見積もる (多くても2大きいだけ)
+        hwmath_divStart64_32((s64)((u64)u[j + n] * BIGNUM_BASE + u[j + n - 1]), (s32)vtop);
+        u64 qhat = (u64)hwmath_divResult();
+        u64 rhat = (u32)hwmath_divRemainder32();
+        while (qhat >= BIGNUM_BASE || qhat * vnext > rhat * BIGNUM_BASE + u[j + n - 2]) {
+            qhat--;
+            rhat += vtop;
+            if (rhat >= BIGNUM_BASE) break;
+        }
+
+        // u[j..j+n] -= qhat * v
+        u32 carry = 0;
+        s32 borrow = 0;
+        for (s32 i = 0; i < n; i++) {
+            u32 lo;
+            carry = splitBase(qhat * v[i] + carry, &lo);
+            s32 t = (s32)u[i + j] - (s32)lo - borrow;
+            borrow = t < 0;
+            u[i + j] = (u32)(borrow ? t + (s32)BIGNUM_BASE : t);
+        }
+        s64 top = (s64)u[j + n] - carry - borrow;
+
+        // 引きすぎたら1回足し戻す
+        if (top < 0) {
+            qhat--;
+            u32 c = 0;
+            for (s32 i = 0; i < n; i++) {
+                u32 s = u[i + j] + v[i] + c;
+                c = s >= BIGNUM_BASE;
+                u[i + j] = c ? s - BIGNUM_BASE : s;
+            }
+            top += c;
+        }
+        u[j + n] = (u32)top;
+        q[j] = (u32)qhat;
+    }
+}
+
+bool bignum_div(BigNum* r, const BigNum* a, const BigNum* b, u32 digits) {
+    if (b->len == 0) return false;
+    if (a->len == 0) {
+        bignum_setZero(r);
+        return true;
+    }
+
+    // 商が want limb以上になるように被除数の下に0 limbを足す
+    // (商の最上位limbは0のことがあり、次のlimbも1桁しかないことがあるので2つ余分に)
+    s32 want = (s32)((digits + BIGNUM_BASE_DIGITS - 1) / BIGNUM_BASE_DIGITS) + 2;
+    s32 n = b->len;
+    s32 pad = want + n - 1 - a->len;
+    if (pad < 0) pad = 0;
+    s32 ulen = a->len + pad;
+    s32 qlen = ulen - n + 1;
+
+    u32 mark = bignum_arenaMark();
+    u32* u = arenaAlloc(ulen + 1);
+    u32* v = arenaAlloc(n);
+    u32* q = arenaAlloc(qlen);
+    if (u == NULL || v == NULL || q == NULL) {
+        bignum_arenaRelease(mark);
+        return false;
+    }
+    memset(u, 0, pad * sizeof(u32));
+    memcpy(u + pad, a->limb, a->len * sizeof(u32));
+    u[ulen] = 0;
+    memcpy(v, b->limb, n * sizeof(u32));
+
+    if (n == 1) {
+        // 1 limbで割る
+        u32 rem = 0;
+        for (s32 i = ulen - 1; i >= 0; i--) {
+            hwmath_divStart64_32((s64)((u64)rem * BIGNUM_BASE + u[i]), (s32)v[0]);
+            q[i] = (u32)hwmath_divResult();
+            rem = (u32)hwmath_divRemainder32();
+        }
+    } else {
+        divLimbs(q, u, ulen, v, n);
+    }
+
+    bool ok = store(r, q, qlen, a->exp - pad - b->exp, a->negative != b->negative);
+    bignum_arenaRelease(mark);
+    return ok;
+}
+
+bool bignum_factorial(BigNum* r, u32 n) {
+    if (n > BIGNUM_FACTORIAL_MAX) return false;
+
+    u32 mark = bignum_arenaMark();
+    u32* t = arenaAlloc(r->cap + 1);
+    if (t == NULL) return false;
+
+    // t[lo..len) が仮数。下位の0 limbとcapを超えた分は lo を進めて捨てる
+    s32 lo = 0;
+    s32 len = 1;
+    s32 exp = 0;
+    t[0] = 1;
+
+    for (u32 k = 2; k <= n; k++) {
+        u32 carry = 0;
+        for (s32 i = lo; i < len; i++) {
+            carry = splitBase((u64)t[i] * k + carry, &t[i]);
+        }
+        while (t[lo] == 0) {
+            lo++;
+            exp++;
+        }
+        if (carry != 0) {
+            if (len - lo >= r->cap) {
+                lo++;
+                exp++;
+            }
+            if (len == r->cap + 1) {
+                memmove(t, t + lo, (len - lo) * sizeof(u32));
+                len -= lo;
+                lo = 0;
+            }
+            t[len++] = carry;
+        }
+    }
+
+    bool ok = store(r, t + lo, len - lo, exp, false);
+    bignum_arenaRelease(mark);
+    return ok;
+}
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+
+// 1000桁 = 112 limb
+#define BENCH_LIMBS 112
+#define BENCH_REPEAT 20
+
+static void benchFill(u32* limbs, s32 n, u32 seed) {
+    for (s32 i = 0; i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        limbs[i] = (seed >> 2) % BIGNUM_BASE;
+    }
+    limbs[n - 1] |= 1; // 最上位を0にしない
+}
+
+void bignum_benchmark(void) {
+    static u32 a[BENCH_LIMBS], b[BENCH_LIMBS];
+    static u32 r1[2 * BENCH_LIMBS], r2[2 * BENCH_LIMBS];
+    u64 ns;
+
+    benchFill(a, BENCH_LIMBS, 1);
+    benchFill(b, BENCH_LIMBS, 2);
+
+    iprintf("Bignum (1000 digits):\n");
+
+    bench_start();
+    for (int i = 0; i < BENCH_REPEAT; i++) mulSchool(r1, a, BENCH_LIMBS, b, BENCH_LIMBS);
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" mul school:    %6lu us\n", (unsigned long)(ns / 1000 / BENCH_REPEAT));
+
+    bench_start();
+    for (int i = 0; i < BENCH_REPEAT; i++) mulLimbs(r2, a, BENCH_LIMBS, b, BENCH_LIMBS);
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" mul karatsuba: %6lu us%s\n", (unsigned long)(ns / 1000 / BENCH_REPEAT),
+            memcmp(r1, r2, sizeof(r1)) == 0 ? "" : " NG");
+
+    // 1000桁 / 500桁 を有効数字1000桁で
+    u32 mark = bignum_arenaMark();
+    BigNum x, y, q;
+    if (bignum_alloc(&x, BENCH_LIMBS) && bignum_alloc(&y, BENCH_LIMBS) &&
+        bignum_alloc(&q, BENCH_LIMBS + 2)) {
+        store(&x, a, BENCH_LIMBS, 0, false);
+        store(&y, b, BENCH_LIMBS / 2, 0, false);
+
+        bench_start();
+        for (int i = 0; i < BENCH_REPEAT; i++) bignum_div(&q, &x, &y, 1000);
+        ns = bench_elapsedNsec();
+        bench_stop();
+        iprintf(" div:           %6lu us\n", (unsigned long)(ns / 1000 / BENCH_REPEAT));
+
+        bench_start();
+        bignum_factorial(&q, 449); // 449! は996桁
+        ns = bench_elapsedNsec();
+        bench_stop();
+        iprintf(" 449!:          %6lu us\n", (unsigned long)(ns / 1000));
+    }
+    bignum_arenaRelease(mark);
+}
+#endif
@@ -0,0 +1,78 @@
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 多倍長の10進数
+// 仮数は基数10^9のlimb列 (下位から)、値 = 仮数 × 10^(9 × exp)。
+// limbはすべて固定サイズのアリーナから取り、mallocは使わない。
+// 加減乗算は結果がcapに収まる限り正確。収まらない分は下位を切り捨てる。
+
+#define BIGNUM_BASE        1000000000u
+#define BIGNUM_BASE_DIGITS 9
+
+// アリーナのlimb数 (4バイト単位)。ARM7ビルドはIWRAMに収まるよう小さくする
+#ifndef BIGNUM_ARENA_LIMBS
+#define BIGNUM_ARENA_LIMBS (16 * 1024)
+#endif
+
+// これ以上のlimb数同士の乗算はKaratsuba法にする
+#define BIGNUM_KARATSUBA_THRESHOLD 24
+
+// 指数(limb単位)の上限。超えたら演算は失敗する
+#define BIGNUM_MAX_EXP 100000
+
+typedef struct {
+    u32* limb;     // 下位から
+    s32 len;       // 使っているlimb数 (0なら値は0)
+    s32 cap;
+    s32 exp;       // 10^(9 × exp) の位から始まる
+    bool negative;
+} BigNum;
+
+// アリーナ: bignum_alloc()で確保した領域はmark/releaseで積み戻す
+u32 bignum_arenaMark(void);
+void bignum_arenaRelease(u32 mark);
+
+// cap limb分の領域を確保して0にする (アリーナが足りなければfalse)
+bool bignum_alloc(BigNum* n, s32 cap);
+
+void bignum_setZero(BigNum* n);
+bool bignum_isZero(const BigNum* n);
+bool bignum_copy(BigNum* dst, const BigNum* src);
+
+// "-123.456" 形式を読む (指数表記は無し)
+bool bignum_fromString(BigNum* n, const char* s);
+
+// 整数部が0 <= n <= 0xFFFFFFFF の整数ならtrue
+bool bignum_toU32(const BigNum* n, u32* out);
+
+// 10進表記で書き出す。sizeに収まらないときは "1.2345e+678" 形式にする。
+// 返り値は文字数
+u32 bignum_toString(const BigNum* n, char* buf, u32 size);
+
+// r は a, b と同じでもよい。失敗するのは指数のあふれとアリーナ不足
+bool bignum_add(BigNum* r, const BigNum* a, const BigNum* b);
+bool bignum_sub(BigNum* r, const BigNum* a, const BigNum* b);
+bool bignum_mul(BigNum* r, const BigNum* a, const BigNum* b);
+
+// 有効数字 digits 桁以上で切り捨てた商 (b == 0ならfalse)
+bool bignum_div(BigNum* r, const BigNum* a, const BigNum* b, u32 digits);
+
+// n!
+bool bignum_factorial(BigNum* r, u32 n);
+
+#ifdef ENABLE_BENCHMARK
+// 1000桁の乗算(筆算/Karatsuba)・除算・1000!の時間を表示する
+void bignum_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIGNUM_H
@@ -0,0 +1,115 @@
+#include <stdio.h>
+
+#include "complex.h"
+#include "hw_math.h"
+#include "sci_math.h"
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+#endif
+
+static double absOf(double x) { return x < 0 ? -x : x; }
+
+// Smith の方法: |b.re| >= |b.im| なら t = b.im/b.re として
+// a/b = ((a.re + a.im t) + (a.im - a.re t) i) / (b.re + b.im t)
+bool complex_div(Complex* r, Complex a, Complex b) {
+    if (b.re == 0.0 && b.im == 0.0) return false;
+
+    if (absOf(b.re) >= absOf(b.im)) {
+        double t = hwmath_divDouble(b.im, b.re);
+        double d = hwmath_divDouble(1.0, b.re + b.im * t);
+        *r = complex_make((a.re + a.im * t) * d, (a.im - a.re * t) * d);
+    } else {
+        double t = hwmath_divDouble(b.re, b.im);
+        double d = hwmath_divDouble(1.0, b.re * t + b.im);
+        *r = complex_make((a.re * t + a.im) * d, (a.im * t - a.re) * d);
+    }
+    return true;
+}
+
+double complex_abs(Complex z) {
+    double x = absOf(z.re);
+    double y = absOf(z.im);
+    if (x < y) {
+        double t = x;
+        x = y;
+        y = t;
+    }
+    if (y == 0.0) return x;
+
+    // x √(1 + (y/x)^2)
+    double t = hwmath_divDouble(y, x);
+    return x * sci_sqrt(1.0 + t * t);
+}
+
+double complex_arg(Complex z) {
+    if (z.re == 0.0) {
+        if (z.im == 0.0) return 0.0;
+        return z.im > 0.0 ? SCI_PI / 2 : -SCI_PI / 2;
+    }
+
+    // 傾きが大きいときは atan(re/im) から求める (商があふれないように)
+    if (absOf(z.im) > absOf(z.re)) {
+        double a = sci_atan(hwmath_divDouble(z.re, z.im));
+        return (z.im > 0.0 ? SCI_PI / 2 : -SCI_PI / 2) - a;
+    }
+    double a = sci_atan(hwmath_divDouble(z.im, z.re));
+    if (z.re > 0.0) return a;
+    return z.im >= 0.0 ? a + SCI_PI : a - SCI_PI;
+}
+
+Complex complex_fromPolar(double r, double theta) {
+    return complex_make(r * sci_cos(theta), r * sci_sin(theta));
+}
+
+int complex_formatRect(Complex z, int digits, char* buf, u32 size) {
+    int n;
+    if (z.im == 0.0) {
+        n = snprintf(buf, size, "%.*g", digits, z.re);
+    } else if (z.re == 0.0) {
+        n = snprintf(buf, size, "%.*gi", digits, z.im);
+    } else {
+        // 虚部の符号は %g が付ける ("+" だけこちらで書く)
+        n = snprintf(buf, size, "%.*g%s%.*gi", digits, z.re, z.im > 0.0 ? "+" : "", digits, z.im);
+    }
+    return n < (int)size ? n : (int)size - 1;
+}
+
+int complex_formatPolar(double r, double theta, int digits, char* buf, u32 size) {
+    int n = snprintf(buf, size, "%.*g<%.*g", digits, r, digits, theta);
+    return n < (int)size ? n : (int)size - 1;
+}
+
+#ifdef ENABLE_BENCHMARK
+#define BENCH_OPS 10000
+
+void complex_benchmark(void) {
+    Complex z = complex_make(0.6, 0.8);
+    Complex w = complex_make(1.0, 0.0);
+    Complex q;
+    u64 ns;
+
+    iprintf("Complex:\n");
+
+    bench_start();
+    for (u32 i = 0; i < BENCH_OPS; i++) w = complex_mul(w, z); // |z| = 1 なので値は回るだけ
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" mul: %5lu cyc\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_OPS));
+
+    bench_start();
+    for (u32 i = 0; i < BENCH_OPS; i++) complex_div(&w, w, z);
+    ns = bench_elapsedNsec();
+    bench_stop();
+    bool ok = complex_div(&q, w, complex_make(1.0, 0.0)) && absOf(q.re - 1.0) < 1e-9 && absOf(q.im) < 1e-9;
+    iprintf(" div: %5lu cyc%s\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_OPS), ok ? "" : " NG");
+
+    double sum = 0.0;
+    bench_start();
+    for (u32 i = 0; i < BENCH_OPS; i++) sum += complex_abs(complex_make(3.0 * i, 4.0 * i));
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" abs: %5lu cyc%s\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_OPS),
+            absOf(sum - 2.5 * BENCH_OPS * (BENCH_OPS - 1)) < 1e-3 ? "" : " NG");
+}
+#endif
@@ -0,0 +1,68 @@
+#ifndef COMPLEX_H
+#define COMPLEX_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 複素数 (実部と虚部の double 2つ)
+// 足し算・引き算・掛け算はインラインで展開する。実数だけの計算は今まで通り
+// double で行い、この型は使わない。
+
+typedef struct {
+    double re;
+    double im;
+} Complex;
+
+static inline Complex complex_make(double re, double im) {
+    Complex z = {re, im};
+    return z;
+}
+
+static inline Complex complex_add(Complex a, Complex b) {
+    return complex_make(a.re + b.re, a.im + b.im);
+}
+
+static inline Complex complex_sub(Complex a, Complex b) {
+    return complex_make(a.re - b.re, a.im - b.im);
+}
+
+static inline Complex complex_mul(Complex a, Complex b) {
+    return complex_make(a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re);
+}
+
+static inline Complex complex_conj(Complex z) {
+    return complex_make(z.re, -z.im);
+}
+
+// *r = a / b (b が0ならfalse)。途中であふれないように大きい方の成分で割る
+bool complex_div(Complex* r, Complex a, Complex b);
+
+// 絶対値 |z| (途中の2乗であふれない)
+double complex_abs(Complex z);
+
+// 偏角 (-pi < arg <= pi、ラジアン)。0 の偏角は0
+double complex_arg(Complex z);
+
+// 極形式 r∠theta (ラジアン) から
+Complex complex_fromPolar(double r, double theta);
+
+// "a+bi" / "a-bi" / "a" / "bi" の形で、各成分は有効数字 digits 桁。
+// 書いた文字数を返す (size に収まらなければ切り詰める)
+int complex_formatRect(Complex z, int digits, char* buf, u32 size);
+
+// "r<theta" の形 (theta の単位は呼び出し側で決める)
+int complex_formatPolar(double r, double theta, int digits, char* buf, u32 size);
+
+#ifdef ENABLE_BENCHMARK
+// 掛け算・割り算・絶対値の1回あたりのサイクル数を表示する
+void complex_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMPLEX_H
@@ -0,0 +1,282 @@
+#include <math.h> // NAN
+#include <stdlib.h>
+#include <string.h>
+
+#include "expr.h"
+#include "hw_math.h"
+#include "registers.h"
+#include "sci_math.h"
+#include "tcm.h"
+
+enum {
+    OP_CONST,   // 次のバイトが定数番号
+    OP_X,
+    OP_REG,     // 次のバイトがレジスタ番号
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_POW,
+    OP_NEG,
+    OP_FUNC     // 次のバイトが関数番号
+};
+
+static double absOf(double x) { return x < 0 ? -x : x; }
+
+typedef struct {
+    const char* name;
+    double (*fn)(double);
+} ExprFunction;
+
+// 先頭一致で長いものから探すので、長い名前を先に並べる
+static const ExprFunction expr_functions[] = {
+    { "asin", sci_asin },
+    { "acos", sci_acos },
+    { "atan", sci_atan },
+    { "sqrt", sci_sqrt },
+    { "sin",  sci_sin },
+    { "cos",  sci_cos },
+    { "tan",  sci_tan },
+    { "log",  sci_log10 },
+    { "exp",  sci_exp },
+    { "abs",  absOf },
+    { "ln",   sci_ln },
+};
+#define EXPR_FUNCTION_COUNT (int)(sizeof(expr_functions) / sizeof(expr_functions[0]))
+
+typedef struct {
+    ExprProgram* prog;
+    const char* src;
+    const char* p;
+    int depth;      // 評価時のスタックの深さ
+    bool failed;
+    const char* error_at;
+} ExprParser;
+
+static void fail(ExprParser* ps) {
+    if (!ps->failed) {
+        ps->failed = true;
+        ps->error_at = ps->p;
+    }
+}
+
+static void skipSpaces(ExprParser* ps) {
+    while (*ps->p == ' ') ps->p++;
+}
+
+static void emit(ExprParser* ps, u8 op, int stack_change) {
+    if (ps->prog->length >= EXPR_MAX_CODE) {
+        fail(ps);
+        return;
+    }
+    ps->prog->code[ps->prog->length++] = op;
+    ps->depth += stack_change;
+    if (ps->depth > EXPR_MAX_STACK) fail(ps);
+}
+
+static void emitConst(ExprParser* ps, double value) {
+    if (ps->prog->const_count >= EXPR_MAX_CONSTS) {
+        fail(ps);
+        return;
+    }
+    emit(ps, OP_CONST, 1);
+    emit(ps, ps->prog->const_count, 0);
+    ps->prog->consts[ps->prog->const_count++] = value;
+}
+
+static bool startsWith(const char* p, const char* name) {
+    return strncmp(p, name, strlen(name)) == 0;
+}
+
+// 値を始められる文字か (掛け算の省略の判定に使う)
+static bool startsPrimary(const char* p) {
+    return (*p >= '0' && *p <= '9') || *p == '.' || *p == '(' ||
+           (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z');
+}
+
+static void parseExpr(ExprParser* ps);
+static void parseUnary(ExprParser* ps);
+
+static void parsePrimary(ExprParser* ps) {
+    skipSpaces(ps);
+    const char* p = ps->p;
+
+    if ((*p >= '0' && *p <= '9') || *p == '.') {
+        // 数字と小数点だけを読む ("2e" は2×e、"0x" は0×x なので strtod に任せない)
+        char number[24];
+        int n = 0;
+        while (((*p >= '0' && *p <= '9') || *p == '.') && n < (int)sizeof(number) - 1) {
+            number[n++] = *p++;
+        }
+        number[n] = '\0';
+        if ((*p >= '0' && *p <= '9') || *p == '.') {
+            fail(ps); // 長すぎる (残りを別の数として掛けてしまわないように)
+            return;
+        }
+
+        char* end;
+        double value = strtod(number, &end);
+        if (*end != '\0') {
+            fail(ps); // "1.2.3" や "."
+            return;
+        }
+        ps->p = p;
+        emitConst(ps, value);
+        return;
+    }
+
+    if (*p == '(') {
+        ps->p++;
+        parseExpr(ps);
+        skipSpaces(ps);
+        if (*ps->p != ')') {
+            fail(ps);
+            return;
+        }
+        ps->p++;
+        return;
+    }
+
+    for (int i = 0; i < EXPR_FUNCTION_COUNT; i++) {
+        if (startsWith(p, expr_functions[i].name)) {
+            ps->p += strlen(expr_functions[i].name);
+            skipSpaces(ps);
+            if (*ps->p != '(') {
+                fail(ps);
+                return;
+            }
+            parsePrimary(ps); // 括弧の中身
+            emit(ps, OP_FUNC, 0);
+            emit(ps, (u8)i, 0);
+            return;
+        }
+    }
+
+    if (startsWith(p, "pi")) {
+        ps->p += 2;
+        emitConst(ps, SCI_PI);
+    } else if (*p == 'e') {
+        ps->p++;
+        emitConst(ps, SCI_E);
+    } else if (*p == 'x') {
+        ps->p++;
+        emit(ps, OP_X, 1);
+    } else if (*p >= 'A' && *p <= 'Z') {
+        // "Ans" を先に見る ("A" のあとに "ns" ではない)
+        int reg = startsWith(p, "Ans") ? REG_ANS : *p - 'A';
+        ps->p += reg == REG_ANS ? 3 : 1;
+        emit(ps, OP_REG, 1);
+        emit(ps, (u8)reg, 0);
+        ps->prog->uses_registers = true;
+    } else {
+        fail(ps);
+    }
+}
+
+// べき乗は右結合で、指数には単項マイナスを書ける (2^-x)
+static void parsePower(ExprParser* ps) {
+    parsePrimary(ps);
+    skipSpaces(ps);
+    if (*ps->p == '^') {
+        ps->p++;
+        parseUnary(ps);
+        emit(ps, OP_POW, -1);
+    }
+}
+
+// -x^2 は -(x^2)
+static void parseUnary(ExprParser* ps) {
+    skipSpaces(ps);
+    if (*ps->p == '-') {
+        ps->p++;
+        parseUnary(ps);
+        emit(ps, OP_NEG, 0);
+    } else if (*ps->p == '+') {
+        ps->p++;
+        parseUnary(ps);
+    } else {
+        parsePower(ps);
+    }
+}
+
+static void parseTerm(ExprParser* ps) {
+    parseUnary(ps);
+    while (!ps->failed) {
+        skipSpaces(ps);
+        char c = *ps->p;
+        if (c == '*' || c == '/') {
+            ps->p++;
+            parseUnary(ps);
+            emit(ps, c == '*' ? OP_MUL : OP_DIV, -1);
+        } else if (startsPrimary(ps->p)) {
+            parsePower(ps); // 掛け算の省略
+            emit(ps, OP_MUL, -1);
+        } else {
+            break;
+        }
+    }
+}
+
+static void parseExpr(ExprParser* ps) {
+    parseTerm(ps);
+    while (!ps->failed) {
+        skipSpaces(ps);
+        char c = *ps->p;
+        if (c != '+' && c != '-') break;
+        ps->p++;
+        parseTerm(ps);
+        emit(ps, c == '+' ? OP_ADD : OP_SUB, -1);
+    }
+}
+
+bool expr_compile(ExprProgram* prog, const char* src, int* error_pos) {
+    ExprParser ps;
+
+    prog->length = 0;
+    prog->const_count = 0;
+    prog->uses_registers = false;
+    ps.prog = prog;
+    ps.src = src;
+    ps.p = src;
+    ps.depth = 0;
+    ps.failed = false;
+    ps.error_at = src;
+
+    parseExpr(&ps);
+    skipSpaces(&ps);
+    if (*ps.p != '\0') fail(&ps);
+
+    if (ps.failed) {
+        prog->length = 0;
+        if (error_pos != NULL) *error_pos = (int)(ps.error_at - src);
+        return false;
+    }
+    return true;
+}
+
+// グラフは1フレームに32列ずつ呼ぶ (make TCM=1 ではITCMに置く)
+TCM_CODE double expr_eval(const ExprProgram* prog, double x) {
+    double stack[EXPR_MAX_STACK];
+    int sp = 0;
+
+    if (prog->length == 0) return NAN;
+
+    for (int pc = 0; pc < prog->length; pc++) {
+        switch (prog->code[pc]) {
+        case OP_CONST: stack[sp++] = prog->consts[prog->code[++pc]]; break;
+        case OP_X:     stack[sp++] = x; break;
+        case OP_REG:   stack[sp++] = registers_get(prog->code[++pc]); break;
+        case OP_ADD:   sp--; stack[sp - 1] += stack[sp]; break;
+        case OP_SUB:   sp--; stack[sp - 1] -= stack[sp]; break;
+        case OP_MUL:   sp--; stack[sp - 1] *= stack[sp]; break;
+        case OP_DIV:
+            sp--;
+            stack[sp - 1] = stack[sp] != 0.0 ? hwmath_divDouble(stack[sp - 1], stack[sp]) : NAN;
+            break;
+        case OP_POW:   sp--; stack[sp - 1] = sci_pow(stack[sp - 1], stack[sp]); break;
+        case OP_NEG:   stack[sp - 1] = -stack[sp - 1]; break;
+        case OP_FUNC:  stack[sp - 1] = expr_functions[prog->code[++pc]].fn(stack[sp - 1]); break;
+        }
+    }
+    return stack[0];
+}
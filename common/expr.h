@@ -0,0 +1,38 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 数式 (変数x) をスタックマシンのバイトコードにコンパイルして評価する
+// 書ける式: 数値, x, pi, e, + - * / ^, 単項マイナス, 括弧,
+//   sin cos tan asin acos atan ln log exp sqrt abs (引数は括弧付き、角度はラジアン)
+// 掛け算の省略 ("2x", "3sin(x)", "x(x+1)") もできる。
+// 大文字の A～Z と Ans はレジスタ (registers.h) で、評価するときの値を読む。
+
+#define EXPR_MAX_CODE   128
+#define EXPR_MAX_CONSTS 32
+#define EXPR_MAX_STACK  16
+
+typedef struct {
+    u8 code[EXPR_MAX_CODE];
+    u8 length;
+    u8 const_count;
+    bool uses_registers;  // レジスタが変わったら評価し直す必要がある
+    double consts[EXPR_MAX_CONSTS];
+} ExprProgram;
+
+// 成功したらtrue。失敗したら *error_pos に問題のある文字位置を入れる
+bool expr_compile(ExprProgram* prog, const char* src, int* error_pos);
+
+// 定義域外などではNaNを返す
+double expr_eval(const ExprProgram* prog, double x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPR_H
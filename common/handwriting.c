@@ -0,0 +1,359 @@
+#include <string.h>
+
+#include "handwriting.h"
+#include "hw_math.h"
+
+#ifdef ENABLE_BENCHMARK
+#include <stdio.h>
+#include "bench.h"
+#endif
+
+#define HW_SIZE       1024 // そろえた後の長い方の辺
+#define HW_GRID_SCALE 32   // テンプレートの格子1つ分 (ピクセル)
+#define HW_MIN_STEP   2    // 前の点からこれより近い点は取らない (ペンの揺れ)
+#define HW_DOT_SIZE   6    // これより小さい1画は '.'
+
+// テンプレート: 10x10の格子 (xyの2桁) の折れ線。画は '/' で区切る。
+// 書き順と画の向きは標準のものに合わせてある。同じ文字に複数あってもよい
+typedef struct {
+    u16 code;
+    u8 set;
+    const char* strokes;
+} HwTemplateDef;
+
+static const HwTemplateDef hw_defs[] = {
+    {'0', HW_SET_DIGITS, "50 21 14 17 39 69 87 84 71 50"},
+    {'1', HW_SET_DIGITS, "50 59"},
+    {'1', HW_SET_DIGITS, "31 50 59"},
+    {'2', HW_SET_DIGITS, "22 40 60 82 84 19 99"},
+    {'3', HW_SET_DIGITS, "21 50 81 83 54 85 88 59 28"},
+    {'4', HW_SET_DIGITS, "60 16 96 / 73 79"},
+    {'4', HW_SET_DIGITS, "10 16 86 / 60 69"},
+    {'5', HW_SET_DIGITS, "20 24 54 75 87 79 49 18 / 20 80"},
+    {'5', HW_SET_DIGITS, "80 20 24 54 86 88 59 18"},
+    {'6', HW_SET_DIGITS, "70 32 16 39 69 87 65 35 17"},
+    {'7', HW_SET_DIGITS, "10 80 49"},
+    {'8', HW_SET_DIGITS, "71 50 21 34 76 78 59 28 26 73 71"},
+    {'9', HW_SET_DIGITS, "82 60 30 12 34 64 82 89"},
+    {'+', HW_SET_OPERATORS, "15 95 / 51 59"},
+    {'+', HW_SET_OPERATORS, "51 59 / 15 95"},
+    {'-', HW_SET_OPERATORS, "15 95"},
+    {'*', HW_SET_OPERATORS, "22 88 / 82 28"},
+    {'/', HW_SET_OPERATORS, "80 19"},
+    {'=', HW_SET_OPERATORS, "13 93 / 17 97"},
+    {'C', HW_SET_OPERATORS, "81 50 21 14 16 28 59 88"},
+    {0x82A0, HW_SET_HIRAGANA, "12 81 / 40 45 59 / 63 56 38 17 25 54 85 97 69"}, // あ
+    {0x82A2, HW_SET_HIRAGANA, "21 26 38 47 / 72 86"}, // い
+    {0x82A4, HW_SET_HIRAGANA, "30 61 / 23 52 73 76 49"}, // う
+    {0x82A6, HW_SET_HIRAGANA, "30 61 / 23 73 29 47 58 69 99"}, // え
+    {0x82A8, HW_SET_HIRAGANA, "12 72 / 40 49 28 16 45 75 87 69 / 71 93"}, // お
+    {0x82A9, HW_SET_HIRAGANA, "13 63 66 48 / 40 19 / 82 95"}, // か
+    {0x82AB, HW_SET_HIRAGANA, "22 71 / 24 83 / 40 76 / 37 38 59 89"}, // き
+    {0x82AD, HW_SET_HIRAGANA, "70 24 79"}, // く
+    {0x82AF, HW_SET_HIRAGANA, "11 17 28 / 43 93 / 70 76 59"}, // け
+    {0x82B1, HW_SET_HIRAGANA, "22 72 63 / 27 48 88"}, // こ
+    {0x82B3, HW_SET_HIRAGANA, "23 82 / 40 76 / 37 49 89"}, // さ
+    {0x82B5, HW_SET_HIRAGANA, "30 37 59 86"}, // し
+    {0x82B7, HW_SET_HIRAGANA, "12 92 / 50 55 46 35 44 55 57 39"}, // す
+    {0x82B9, HW_SET_HIRAGANA, "13 93 / 70 76 67 / 30 37 49 89"}, // せ
+    {0x82BB, HW_SET_HIRAGANA, "21 61 24 84 56 58 79 89"}, // そ
+    {0x82BD, HW_SET_HIRAGANA, "12 52 / 30 19 / 54 84 / 57 69 99"}, // た
+    {0x82BF, HW_SET_HIRAGANA, "12 82 / 40 36 64 85 88 49"}, // ち
+    {0x82C2, HW_SET_HIRAGANA, "04 42 72 94 87 49"}, // つ
+    {0x82C4, HW_SET_HIRAGANA, "02 91 53 36 59 89"}, // て
+    {0x82C6, HW_SET_HIRAGANA, "30 44 / 83 36 38 59 99"}, // と
+    {0x82C8, HW_SET_HIRAGANA, "12 52 / 30 16 / 73 85 / 65 69 49 38 57 99"}, // な
+    {0x82C9, HW_SET_HIRAGANA, "11 17 29 / 42 82 73 / 47 58 98"}, // に
+    {0x82CA, HW_SET_HIRAGANA, "22 48 / 60 47 29 16 43 73 95 98 79 68 87 99"}, // ぬ
+    {0x82CB, HW_SET_HIRAGANA, "30 39 / 13 43 18 54 84 97 89 68 87 99"}, // ね
+    {0x82CC, HW_SET_HIRAGANA, "52 46 29 06 22 61 94 88 59"}, // の
+    {0x82CD, HW_SET_HIRAGANA, "11 17 29 / 43 93 / 70 78 59 47 66 99"}, // は
+    {0x82D0, HW_SET_HIRAGANA, "12 42 26 39 69 86 71 94"}, // ひ
+    {0x82D3, HW_SET_HIRAGANA, "40 62 / 53 37 59 / 18 09 / 86 98"}, // ふ
+    {0x82D6, HW_SET_HIRAGANA | HW_SET_KATAKANA, "06 32 99"}, // へ (ヘも同じ形)
+    {0x82D9, HW_SET_HIRAGANA, "11 17 29 / 41 91 / 44 94 / 71 78 59 47 66 99"}, // ほ
+    {0x82DC, HW_SET_HIRAGANA, "12 82 / 15 85 / 50 58 39 28 47 89"}, // ま
+    {0x82DD, HW_SET_HIRAGANA, "11 41 18 29 57 86 97 / 73 69"}, // み
+    {0x82DE, HW_SET_HIRAGANA, "12 62 / 30 36 25 34 38 59 88 86 / 71 93"}, // む
+    {0x82DF, HW_SET_HIRAGANA, "22 48 / 60 47 29 16 43 73 95 98 69"}, // め
+    {0x82E0, HW_SET_HIRAGANA, "40 37 59 88 95 / 13 63 / 15 65"}, // も
+    {0x82E2, HW_SET_HIRAGANA, "14 62 93 85 65 / 41 52 / 30 69"}, // や
+    {0x82E4, HW_SET_HIRAGANA, "22 16 28 36 53 83 96 68 / 50 55 39"}, // ゆ
+    {0x82E6, HW_SET_HIRAGANA, "53 83 / 50 58 39 18 36 99"}, // よ
+    {0x82E7, HW_SET_HIRAGANA, "30 51 / 22 26 45 75 87 69 39"}, // ら
+    {0x82E8, HW_SET_HIRAGANA, "21 25 36 / 70 75 49"}, // り
+    {0x82E9, HW_SET_HIRAGANA, "21 71 27 55 86 88 59 38 47"}, // る
+    {0x82EA, HW_SET_HIRAGANA, "30 39 / 13 43 18 54 74 78 99"}, // れ
+    {0x82EB, HW_SET_HIRAGANA, "21 71 27 55 86 88 59 29"}, // ろ
+    {0x82ED, HW_SET_HIRAGANA, "30 39 / 13 43 18 54 84 96 88 59"}, // わ
+    {0x82F0, HW_SET_HIRAGANA, "12 72 / 40 16 54 / 84 37 39 89"}, // を
+    {0x82F1, HW_SET_HIRAGANA, "50 19 45 56 69 96"}, // ん
+    {0x8341, HW_SET_KATAKANA, "11 91 73 54 / 53 56 29"}, // ア
+    {0x8343, HW_SET_KATAKANA, "70 15 / 53 59"}, // イ
+    {0x8345, HW_SET_KATAKANA, "50 52 / 12 14 / 12 92 86 49"}, // ウ
+    {0x8347, HW_SET_KATAKANA, "21 81 / 51 58 / 18 98"}, // エ
+    {0x8349, HW_SET_KATAKANA, "13 93 / 60 69 58 / 63 18"}, // オ
+    {0x834A, HW_SET_KATAKANA, "12 82 88 69 / 40 19"}, // カ
+    {0x834C, HW_SET_KATAKANA, "12 82 / 15 95 / 40 69"}, // キ
+    {0x834E, HW_SET_KATAKANA, "40 14 / 41 81 66 29"}, // ク
+    {0x8350, HW_SET_KATAKANA, "30 05 / 22 92 / 62 56 29"}, // ケ
+    {0x8352, HW_SET_KATAKANA, "11 81 88 / 18 88"}, // コ
+    {0x8354, HW_SET_KATAKANA, "03 93 / 30 36 / 70 75 49"}, // サ
+    {0x8356, HW_SET_KATAKANA, "11 32 / 14 35 / 19 66 91"}, // シ
+    {0x8358, HW_SET_KATAKANA, "11 81 56 19 / 55 99"}, // ス
+    {0x835A, HW_SET_KATAKANA, "04 92 75 / 30 38 59 99"}, // セ
+    {0x835C, HW_SET_KATAKANA, "11 34 / 81 66 29"}, // ソ
+    {0x835E, HW_SET_KATAKANA, "40 14 / 41 81 66 29 / 34 76"}, // タ
+    {0x8360, HW_SET_KATAKANA, "80 22 / 04 94 / 51 57 39"}, // チ
+    {0x8363, HW_SET_KATAKANA, "12 24 / 41 53 / 91 66 29"}, // ツ
+    {0x8365, HW_SET_KATAKANA, "21 81 / 04 94 / 54 56 39"}, // テ
+    {0x8367, HW_SET_KATAKANA, "30 39 / 34 86"}, // ト
+    {0x8369, HW_SET_KATAKANA, "03 93 / 50 56 29"}, // ナ
+    {0x836A, HW_SET_KATAKANA, "22 82 / 08 98"}, // ニ
+    {0x836B, HW_SET_KATAKANA, "11 81 56 19 / 34 88"}, // ヌ
+    {0x836C, HW_SET_KATAKANA, "40 51 / 12 82 18 / 54 59 / 65 97"}, // ネ
+    {0x836D, HW_SET_KATAKANA, "80 55 19"}, // ノ
+    {0x836E, HW_SET_KATAKANA, "32 17 / 62 98"}, // ハ
+    {0x8371, HW_SET_KATAKANA, "24 83 / 20 28 49 99"}, // ヒ
+    {0x8374, HW_SET_KATAKANA, "11 81 66 29"}, // フ
+    {0x837A, HW_SET_KATAKANA, "13 93 / 50 59 48 / 35 18 / 75 98"}, // ホ
+    {0x837D, HW_SET_KATAKANA, "11 91 56 / 34 78"}, // マ
+    {0x837E, HW_SET_KATAKANA, "21 72 / 24 74 / 17 88"}, // ミ
+    {0x8380, HW_SET_KATAKANA, "40 18 87 / 75 99"}, // ム
+    {0x8381, HW_SET_KATAKANA, "80 19 / 23 88"}, // メ
+    {0x8382, HW_SET_KATAKANA, "11 81 / 04 94 / 41 48 69 99"}, // モ
+    {0x8384, HW_SET_KATAKANA, "03 92 75 / 30 59"}, // ヤ
+    {0x8386, HW_SET_KATAKANA, "22 72 78 / 08 98"}, // ユ
+    {0x8388, HW_SET_KATAKANA, "11 81 88 / 25 85 / 18 88"}, // ヨ
+    {0x8389, HW_SET_KATAKANA, "20 70 / 13 83 67 29"}, // ラ
+    {0x838A, HW_SET_KATAKANA, "21 26 / 70 75 39"}, // リ
+    {0x838B, HW_SET_KATAKANA, "31 35 19 / 60 69 96"}, // ル
+    {0x838C, HW_SET_KATAKANA, "20 29 95"}, // レ
+    {0x838D, HW_SET_KATAKANA, "11 19 / 11 81 89 / 19 89"}, // ロ
+    {0x838F, HW_SET_KATAKANA, "11 14 / 11 91 76 39"}, // ワ
+    {0x8392, HW_SET_KATAKANA, "11 81 / 14 74 / 81 66 29"}, // ヲ
+    {0x8393, HW_SET_KATAKANA, "11 33 / 19 66 91"}, // ン
+};
+
+#define HW_TEMPLATES (sizeof(hw_defs) / sizeof(hw_defs[0]))
+
+typedef struct {
+    s16 x[HW_RESAMPLE];
+    s16 y[HW_RESAMPLE];
+    u16 code;
+    u8 set;
+    u8 strokes;
+} HwTemplate;
+
+static HwTemplate hw_templates[HW_TEMPLATES];
+
+// resample() の作業領域
+static s32 norm_x[HW_MAX_POINTS];
+static s32 norm_y[HW_MAX_POINTS];
+static u32 seg_len[HW_MAX_POINTS];
+
+// 画をつないだ点列を長い方の辺がHW_SIZEになるようにそろえて中央に置き、
+// 道のりで等間隔にHW_RESAMPLE点取り直す
+static void resample(const s16* px, const s16* py, int n, s16* ox, s16* oy) {
+    s32 min_x = px[0], max_x = px[0], min_y = py[0], max_y = py[0];
+    for (int i = 1; i < n; i++) {
+        if (px[i] < min_x) min_x = px[i];
+        if (px[i] > max_x) max_x = px[i];
+        if (py[i] < min_y) min_y = py[i];
+        if (py[i] > max_y) max_y = py[i];
+    }
+    s32 w = max_x - min_x;
+    s32 h = max_y - min_y;
+    s32 size = w > h ? w : h;
+    if (size == 0) size = 1;
+
+    s32 scale = hwmath_div64_32((s64)HW_SIZE << 16, size); // Q16
+    s32 off_x = (HW_SIZE - ((w * scale) >> 16)) >> 1;
+    s32 off_y = (HW_SIZE - ((h * scale) >> 16)) >> 1;
+
+    u32 total = 0;
+    for (int i = 0; i < n; i++) {
+        norm_x[i] = (((px[i] - min_x) * scale) >> 16) + off_x;
+        norm_y[i] = (((py[i] - min_y) * scale) >> 16) + off_y;
+        if (i > 0) {
+            s32 dx = norm_x[i] - norm_x[i - 1];
+            s32 dy = norm_y[i] - norm_y[i - 1];
+            seg_len[i - 1] = hwmath_sqrt64((u64)(dx * dx + dy * dy));
+            total += seg_len[i - 1];
+        }
+    }
+
+    int seg = 0;
+    u32 walked = 0; // seg の始点までの道のり
+    for (int k = 0; k < HW_RESAMPLE; k++) {
+        u32 target = (u32)hwmath_div64_32((s64)total * k, HW_RESAMPLE - 1);
+        while (seg < n - 2 && walked + seg_len[seg] < target) {
+            walked += seg_len[seg];
+            seg++;
+        }
+        if (n == 1 || seg_len[seg] == 0) {
+            ox[k] = (s16)norm_x[seg];
+            oy[k] = (s16)norm_y[seg];
+            continue;
+        }
+        s32 t = (s32)(target - walked);
+        if (t > (s32)seg_len[seg]) t = (s32)seg_len[seg];
+        ox[k] = (s16)(norm_x[seg] + hwmath_div64_32((s64)(norm_x[seg + 1] - norm_x[seg]) * t, (s32)seg_len[seg]));
+        oy[k] = (s16)(norm_y[seg] + hwmath_div64_32((s64)(norm_y[seg + 1] - norm_y[seg]) * t, (s32)seg_len[seg]));
+    }
+}
+
+// テンプレートの文字列を点列にする。画の数を返す
+static int parseTemplate(const char* s, HwInk* ink) {
+    handwriting_clear(ink);
+    bool new_stroke = true;
+    while (*s) {
+        if (*s == '/') {
+            new_stroke = true;
+            s++;
+        } else if (*s >= '0' && *s <= '9' && s[1] >= '0' && s[1] <= '9') {
+            int x = (s[0] - '0') * HW_GRID_SCALE;
+            int y = (s[1] - '0') * HW_GRID_SCALE;
+            if (new_stroke) handwriting_penDown(ink, x, y);
+            else handwriting_penMove(ink, x, y);
+            new_stroke = false;
+            s += 2;
+        } else {
+            s++;
+        }
+    }
+    handwriting_penUp(ink);
+    return ink->stroke_count;
+}
+
+static HwInk template_ink;
+
+void handwriting_init(void) {
+    for (u32 i = 0; i < HW_TEMPLATES; i++) {
+        HwTemplate* t = &hw_templates[i];
+        t->code = hw_defs[i].code;
+        t->set = hw_defs[i].set;
+        t->strokes = (u8)parseTemplate(hw_defs[i].strokes, &template_ink);
+        resample(template_ink.x, template_ink.y, template_ink.point_count, t->x, t->y);
+    }
+}
+
+void handwriting_clear(HwInk* ink) {
+    ink->point_count = 0;
+    ink->stroke_count = 0;
+    ink->pen_down = false;
+}
+
+static void addPoint(HwInk* ink, int x, int y) {
+    if (ink->point_count >= HW_MAX_POINTS) return;
+    ink->x[ink->point_count] = (s16)x;
+    ink->y[ink->point_count] = (s16)y;
+    ink->point_count++;
+    ink->stroke_end[ink->stroke_count - 1] = (u16)ink->point_count;
+}
+
+void handwriting_penDown(HwInk* ink, int x, int y) {
+    if (ink->stroke_count >= HW_MAX_STROKES || ink->point_count >= HW_MAX_POINTS) return;
+    ink->stroke_count++;
+    ink->pen_down = true;
+    addPoint(ink, x, y);
+}
+
+void handwriting_penMove(HwInk* ink, int x, int y) {
+    if (!ink->pen_down) return;
+    int dx = x - ink->x[ink->point_count - 1];
+    int dy = y - ink->y[ink->point_count - 1];
+    if (dx * dx + dy * dy < HW_MIN_STEP * HW_MIN_STEP) return;
+    addPoint(ink, x, y);
+}
+
+void handwriting_penUp(HwInk* ink) {
+    ink->pen_down = false;
+}
+
+// 距離の二乗和。limit以上になった時点で打ち切ってlimitを返す
+static u32 distance(const s16* x, const s16* y, const HwTemplate* t, u32 limit) {
+    u32 sum = 0;
+    for (int i = 0; i < HW_RESAMPLE; i++) {
+        s32 dx = x[i] - t->x[i];
+        s32 dy = y[i] - t->y[i];
+        sum += (u32)(dx * dx + dy * dy);
+        if (sum >= limit) return limit;
+    }
+    return sum;
+}
+
+// ひらがなのSJISコードを同じ音のカタカナに (0x837F は欠番)
+static u16 toKatakana(u16 code) {
+    u16 i = code - 0x829F;
+    return 0x8340 + i + (i >= 0x3F ? 1 : 0);
+}
+
+u16 handwriting_recognize(const HwInk* ink, u32 sets) {
+    if (ink->stroke_count == 0 || ink->point_count == 0) return 0;
+
+    if (ink->stroke_count == 1 && (sets & HW_SET_OPERATORS)) {
+        s32 min_x = ink->x[0], max_x = ink->x[0], min_y = ink->y[0], max_y = ink->y[0];
+        for (int i = 1; i < ink->point_count; i++) {
+            if (ink->x[i] < min_x) min_x = ink->x[i];
+            if (ink->x[i] > max_x) max_x = ink->x[i];
+            if (ink->y[i] < min_y) min_y = ink->y[i];
+            if (ink->y[i] > max_y) max_y = ink->y[i];
+        }
+        if (max_x - min_x < HW_DOT_SIZE && max_y - min_y < HW_DOT_SIZE) return '.';
+    }
+
+    s16 x[HW_RESAMPLE], y[HW_RESAMPLE];
+    resample(ink->x, ink->y, ink->point_count, x, y);
+
+    // 1回目は画数が同じもの、無ければ2回目に1画違いまで広げる
+    u32 best = 0xFFFFFFFF;
+    u16 code = 0;
+    for (int pass = 0; pass < 2 && code == 0; pass++) {
+        for (u32 i = 0; i < HW_TEMPLATES; i++) {
+            const HwTemplate* t = &hw_templates[i];
+            int diff = t->strokes - ink->stroke_count;
+            if (!(t->set & sets) || (diff < 0 ? -diff : diff) != pass) continue;
+
+            u32 d = distance(x, y, t, best);
+            if (d < best) {
+                best = d;
+                code = t->code;
+            }
+        }
+    }
+
+    // ひらがなとカタカナで共通のテンプレートは、ひらがなを探していなければカタカナ
+    if (code >= 0x829F && code <= 0x82F1 && !(sets & HW_SET_HIRAGANA)) code = toKatakana(code);
+    return code;
+}
+
+#ifdef ENABLE_BENCHMARK
+static HwInk bench_ink;
+
+void handwriting_benchmark(void) {
+    const u32 sets = HW_SET_DIGITS | HW_SET_OPERATORS | HW_SET_HIRAGANA | HW_SET_KATAKANA;
+    u32 correct = 0;
+    u64 ns = 0;
+
+    handwriting_init(); // ベンチマークはアプリの初期化より前に動く
+
+    // テンプレートを画面上の大きさ (格子1つ6ピクセル) で書いたものとして認識させる。
+    // 形が同じ文字 (へ/ヘ など) は先にある方になる
+    for (u32 i = 0; i < HW_TEMPLATES; i++) {
+        parseTemplate(hw_defs[i].strokes, &bench_ink);
+        for (int k = 0; k < bench_ink.point_count; k++) {
+            bench_ink.x[k] = (s16)(bench_ink.x[k] * 6 / HW_GRID_SCALE + 100);
+            bench_ink.y[k] = (s16)(bench_ink.y[k] * 6 / HW_GRID_SCALE + 60);
+        }
+        bench_start();
+        u16 code = handwriting_recognize(&bench_ink, sets);
+        ns += bench_elapsedNsec();
+        bench_stop();
+        if (code == hw_defs[i].code) correct++;
+    }
+    iprintf("Handwriting (%u templates):\n", (unsigned)HW_TEMPLATES);
+    iprintf(" %6lu cyc/char, %lu correct\n", (unsigned long)bench_cyclesPerOp(ns, HW_TEMPLATES),
+            (unsigned long)correct);
+}
+#endif
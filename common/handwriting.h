@@ -0,0 +1,67 @@
+#ifndef HANDWRITING_H
+#define HANDWRITING_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// タッチペンの手書き文字認識 (ひらがな、カタカナ、数字、演算子)
+//
+// ペンの軌跡を画の順につないだ1本の折れ線として扱い、大きさと位置をそろえてから
+// 道のりで等間隔にHW_RESAMPLE点取り直す。テンプレートも同じ手順で作った点列で、
+// 点ごとの距離の二乗和が最小のものを答えにする (書き順と画の向きも見ている)。
+// 画数の違うテンプレートは比べずに捨て、比べている途中でもそれまでの最小を
+// 超えたら打ち切るので、1文字の認識は1フレームよりずっと短い。
+// テンプレートは10x10の格子に書いた折れ線で、起動時に一度だけ点列に直す。
+// へとヘのように同じ形の文字はテンプレートを1つにして、sets にひらがなが
+// 含まれていなければカタカナを返す。
+// 座標はピクセルで、入力は input.c のタッチのイベントをそのまま渡せばよい。
+
+#define HW_MAX_POINTS  256 // 1文字の点の数 (これを超えた分は捨てる)
+#define HW_MAX_STROKES 8
+#define HW_RESAMPLE    32
+
+// 認識する文字の組 (handwriting_recognize() の sets にORで渡す)
+#define HW_SET_DIGITS    0x01 // '0'..'9'
+#define HW_SET_OPERATORS 0x02 // '+' '-' '*' '/' '=' '.' 'C'
+#define HW_SET_HIRAGANA  0x04 // あ..ん (SJIS)
+#define HW_SET_KATAKANA  0x08 // ア..ン (SJIS)
+
+typedef struct {
+    s16 x[HW_MAX_POINTS];
+    s16 y[HW_MAX_POINTS];
+    u16 stroke_end[HW_MAX_STROKES]; // 各画の最後の点の次の位置
+    int point_count;
+    int stroke_count;
+    bool pen_down;
+} HwInk;
+
+// テンプレートを点列に直す (最初に一度だけ呼ぶ)
+void handwriting_init(void);
+
+void handwriting_clear(HwInk* ink);
+
+// ペンを下ろす / 動かす / 上げる。画の数や点の数があふれた分は無視する
+void handwriting_penDown(HwInk* ink, int x, int y);
+void handwriting_penMove(HwInk* ink, int x, int y);
+void handwriting_penUp(HwInk* ink);
+
+static inline bool handwriting_empty(const HwInk* ink) {
+    return ink->stroke_count == 0;
+}
+
+// 書かれた文字に最も近い文字のコード (ASCIIかSJIS) を返す。何も無ければ0
+u16 handwriting_recognize(const HwInk* ink, u32 sets);
+
+#ifdef ENABLE_BENCHMARK
+// テンプレートそのものを入力にして認識の時間と正解数を表示する
+void handwriting_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HANDWRITING_H
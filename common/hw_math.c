@@ -0,0 +1,163 @@
+#include "hw_math.h"
+
+#define FRAC_MASK ((1ULL << 52) - 1)
+
+typedef union {
+    double d;
+    u64 u;
+} DoubleBits;
+
+double hwmath_divDouble(double a, double b) {
+    DoubleBits da, db, result;
+    da.d = a;
+    db.d = b;
+
+    int ea = (int)((da.u >> 52) & 0x7FF);
+    int eb = (int)((db.u >> 52) & 0x7FF);
+    // 0, 非正規化数, 無限大, NaN はソフトウェアに任せる
+    if (ea == 0 || ea == 0x7FF || eb == 0 || eb == 0x7FF) return a / b;
+
+    u64 mb = (db.u & FRAC_MASK) | (1ULL << 52);
+    int tz = __builtin_ctzll(mb);
+    if (tz < 22) return a / b; // 除数の仮数が31bitを超える
+
+    // a / b = (ma / d) * 2^(ea - eb - tz)。1段目で整数部、2段目で32bit分の小数部を求める
+    u64 ma = (da.u & FRAC_MASK) | (1ULL << 52);
+    s32 d = (s32)(mb >> tz);
+    hwmath_divStart64_32((s64)ma, d);
+
+    u64 sign = (da.u ^ db.u) & (1ULL << 63);
+    int exp2 = ea - eb - tz;
+
+    u64 q1 = (u64)hwmath_divResult(); // >= 2^21 (ma >= 2^52, d < 2^31)
+    u32 r1 = (u32)hwmath_divRemainder32();
+    hwmath_divStart64_32((s64)r1 << 32, d);
+
+    // 商の最上位bitをbit62に揃える
+    int k = __builtin_clzll(q1) - 1;
+
+    u32 q2 = (u32)hwmath_divResult();
+    bool sticky = hwmath_divRemainder32() != 0;
+
+    u64 q;
+    if (k >= 32) {
+        q = ((q1 << 32) | q2) << (k - 32);
+    } else {
+        q = (q1 << k) | (q2 >> (32 - k));
+        sticky |= (q2 & ((1U << (32 - k)) - 1)) != 0;
+    }
+
+    // 53bitに偶数丸め
+    u64 m = q >> 10;
+    u32 guard = (u32)(q & 0x3FF);
+    if (guard > 0x200 || (guard == 0x200 && (sticky || (m & 1)))) m++;
+    exp2 += 10 - k;
+    if (m >> 53) {
+        m >>= 1;
+        exp2++;
+    }
+
+    // m * 2^exp2 (m は [2^52, 2^53)) の指数が正規化数の範囲外ならソフトウェアで
+    int e = exp2 + 52 + 1023;
+    if (e <= 0 || e >= 0x7FF) return a / b;
+
+    result.u = sign | ((u64)e << 52) | (m & FRAC_MASK);
+    return result.d;
+}
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+
+#define HWMATH_BENCH_OPS 1000
+
+// 1フレーム (約1/60秒) のナノ秒
+#define FRAME_NSEC (1000000000ULL / 60)
+
+static s64 hw_bench_num[HWMATH_BENCH_OPS];
+static s32 hw_bench_den[HWMATH_BENCH_OPS];
+static double hw_bench_a[HWMATH_BENCH_OPS];
+static double hw_bench_b[HWMATH_BENCH_OPS];
+
+static unsigned long opsPerFrame(u64 ns) {
+    return (unsigned long)((u64)HWMATH_BENCH_OPS * FRAME_NSEC / (ns + 1));
+}
+
+static void printRow(const char* name, u64 soft_ns, u64 hw_ns) {
+    iprintf("%-11s %8lu %8lu\n", name, opsPerFrame(soft_ns), opsPerFrame(hw_ns));
+}
+
+void hwmath_benchmark(void) {
+    u32 seed = 12345;
+    volatile s64 isink = 0;
+    volatile double dsink = 0;
+    u64 soft_ns, hw_ns;
+
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        hw_bench_num[i] = ((s64)seed << 20) + i;
+        hw_bench_den[i] = (s32)(seed >> 12) + 1;
+        hw_bench_a[i] = (double)(seed >> 8) * 0.001;
+        hw_bench_b[i] = (double)((seed >> 20) + 1); // 電卓で多い整数の除数
+    }
+
+    iprintf("ops/frame        soft       hw\n");
+
+    // 64bit / 32bit 整数除算
+    bench_start();
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) isink += hw_bench_num[i] / hw_bench_den[i];
+    soft_ns = bench_elapsedNsec();
+    bench_stop();
+    bench_start();
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) isink += hwmath_div64(hw_bench_num[i], hw_bench_den[i]);
+    hw_ns = bench_elapsedNsec();
+    bench_stop();
+    printRow("s64/s32", soft_ns, hw_ns);
+
+    // 64bit 平方根
+    bench_start();
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) isink += hwmath_softSqrt64((u64)hw_bench_num[i]);
+    soft_ns = bench_elapsedNsec();
+    bench_stop();
+    bench_start();
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) isink += hwmath_sqrt64((u64)hw_bench_num[i]);
+    hw_ns = bench_elapsedNsec();
+    bench_stop();
+    printRow("sqrt64", soft_ns, hw_ns);
+
+    // 除算と平方根を順に待つ場合と、両方を同時に動かす場合
+    bench_start();
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) {
+        isink += hwmath_div64(hw_bench_num[i], hw_bench_den[i]) + hwmath_sqrt64((u64)hw_bench_num[i]);
+    }
+    soft_ns = bench_elapsedNsec();
+    bench_stop();
+    bench_start();
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) {
+        hwmath_divStart64(hw_bench_num[i], hw_bench_den[i]);
+        hwmath_sqrtStart64((u64)hw_bench_num[i]);
+        isink += hwmath_divResult() + hwmath_sqrtResult();
+    }
+    hw_ns = bench_elapsedNsec();
+    bench_stop();
+    printRow("div+sqrt", soft_ns, hw_ns);
+    iprintf(" (soft column: hw in sequence)\n");
+
+    // doubleの除算
+    bench_start();
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) dsink += hw_bench_a[i] / hw_bench_b[i];
+    soft_ns = bench_elapsedNsec();
+    bench_stop();
+    bench_start();
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) dsink += hwmath_divDouble(hw_bench_a[i], hw_bench_b[i]);
+    hw_ns = bench_elapsedNsec();
+    bench_stop();
+    printRow("double /", soft_ns, hw_ns);
+
+    // 結果がソフトウェアと一致するか
+    int mismatch = 0;
+    for (int i = 0; i < HWMATH_BENCH_OPS; i++) {
+        if (hwmath_divDouble(hw_bench_a[i], hw_bench_b[i]) != hw_bench_a[i] / hw_bench_b[i]) mismatch++;
+    }
+    iprintf(" double / mismatches: %d\n", mismatch);
+}
+#endif
@@ -0,0 +1,123 @@
+#ifndef HW_MATH_H
+#define HW_MATH_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ARM9の除算器(REG_DIV*)と平方根ユニット(REG_SQRT*)を使う整数演算
+// ホストビルドでは同じ結果をCで計算する。
+// 除算器は割り込みハンドラから使わないこと (途中の計算を壊すため)。
+//
+// 除算は約34サイクル、平方根は約13サイクルかかる。xxxStart()で計算を始めて
+// 別の処理をしてからxxxResult()で受け取ると、その間CPUを止めずに済む。
+// 除算器と平方根ユニットは独立しているので同時に動かせる。
+
+// ソフトウェアの平方根 (ホストビルドとベンチマークの比較用)
+static inline u32 hwmath_softSqrt64(u64 x) {
+    // 1bitずつ決める開平法
+    u64 root = 0;
+    u64 bit = 1ULL << 62;
+    while (bit > x) bit >>= 2;
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (u32)root;
+}
+
+#ifdef ARM9
+// 64bit / 64bit (den != 0)
+static inline void hwmath_divStart64(s64 num, s64 den) {
+    REG_DIVCNT = DIV_64_64;
+    REG_DIV_NUMER = num;
+    REG_DIV_DENOM = den;
+}
+
+// 64bit / 32bit (den != 0)。商は64bit、余りは32bit
+static inline void hwmath_divStart64_32(s64 num, s32 den) {
+    REG_DIVCNT = DIV_64_32;
+    REG_DIV_NUMER = num;
+    REG_DIV_DENOM_L = den;
+}
+
+static inline s64 hwmath_divResult(void) {
+    while (REG_DIVCNT & DIV_BUSY);
+    return REG_DIV_RESULT;
+}
+
+static inline s32 hwmath_divRemainder32(void) {
+    while (REG_DIVCNT & DIV_BUSY);
+    return REG_DIVREM_RESULT_L;
+}
+
+static inline void hwmath_sqrtStart64(u64 x) {
+    REG_SQRTCNT = SQRT_64;
+    REG_SQRT_PARAM = x;
+}
+
+static inline u32 hwmath_sqrtResult(void) {
+    while (REG_SQRTCNT & SQRT_BUSY);
+    return REG_SQRT_RESULT;
+}
+#else
+static s64 hwmath_div_numer;
+static s64 hwmath_div_denom = 1;
+static u64 hwmath_sqrt_param;
+
+static inline void hwmath_divStart64(s64 num, s64 den) {
+    hwmath_div_numer = num;
+    hwmath_div_denom = den;
+}
+
+static inline void hwmath_divStart64_32(s64 num, s32 den) {
+    hwmath_div_numer = num;
+    hwmath_div_denom = den;
+}
+
+static inline s64 hwmath_divResult(void) { return hwmath_div_numer / hwmath_div_denom; }
+static inline s32 hwmath_divRemainder32(void) { return (s32)(hwmath_div_numer % hwmath_div_denom); }
+
+static inline void hwmath_sqrtStart64(u64 x) { hwmath_sqrt_param = x; }
+static inline u32 hwmath_sqrtResult(void) { return hwmath_softSqrt64(hwmath_sqrt_param); }
+#endif
+
+// 同期版
+static inline s64 hwmath_div64(s64 num, s64 den) {
+    hwmath_divStart64(num, den);
+    return hwmath_divResult();
+}
+
+// 商が32bitに収まるとき
+static inline s32 hwmath_div64_32(s64 num, s32 den) {
+    hwmath_divStart64_32(num, den);
+    return (s32)hwmath_divResult();
+}
+
+// 64bit符号なし整数の平方根 (切り捨て)
+static inline u32 hwmath_sqrt64(u64 x) {
+    hwmath_sqrtStart64(x);
+    return hwmath_sqrtResult();
+}
+
+// a / b を正しく丸めて求める。除数の仮数が31bitに収まる (整数や短い小数) ときは
+// 除算器で仮数を割り、それ以外はソフトウェアの浮動小数点除算を使う。
+double hwmath_divDouble(double a, double b);
+
+#ifdef ENABLE_BENCHMARK
+// ソフトウェアとハードウェアの1フレームあたりの演算回数を表示する
+void hwmath_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HW_MATH_H
@@ -0,0 +1,85 @@
+#include <string.h>
+
+#include "input.h"
+
+// 書いた内容が head の更新より後にならないように (割り込みとの間)
+#define INPUT_BARRIER() __asm__ volatile("" ::: "memory")
+
+void input_reset(InputQueue* q) {
+    memset(q, 0, sizeof(*q));
+}
+
+bool input_push(InputQueue* q, const InputEvent* e) {
+    u32 head = q->head;
+    if (head - q->tail >= INPUT_QUEUE_SIZE) {
+        q->dropped++;
+        return false;
+    }
+    q->events[head & (INPUT_QUEUE_SIZE - 1)] = *e;
+    INPUT_BARRIER();
+    q->head = head + 1;
+    return true;
+}
+
+bool input_pop(InputQueue* q, InputEvent* e) {
+    u32 tail = q->tail;
+    if (tail == q->head) return false;
+    INPUT_BARRIER();
+    *e = q->events[tail & (INPUT_QUEUE_SIZE - 1)];
+    INPUT_BARRIER();
+    q->tail = tail + 1;
+    return true;
+}
+
+static void pushEvent(InputQueue* q, u8 type, u32 keys, u16 x, u16 y, u32 time) {
+    InputEvent e;
+    e.type = type;
+    e.x = x;
+    e.y = y;
+    e.keys = keys;
+    e.time = time;
+    input_push(q, &e);
+}
+
+void input_sample(InputQueue* q, u32 keys, u32 touch_bit, u16 x, u16 y, u32 time) {
+    bool touch = (keys & touch_bit) != 0;
+    keys &= ~touch_bit;
+
+    u32 changed = keys ^ q->prev_keys;
+    if (changed & keys) pushEvent(q, INPUT_KEY_DOWN, changed & keys, 0, 0, time);
+    if (changed & q->prev_keys) pushEvent(q, INPUT_KEY_UP, changed & q->prev_keys, 0, 0, time);
+    q->prev_keys = keys;
+
+    if (touch && !q->prev_touch) {
+        pushEvent(q, INPUT_TOUCH_DOWN, 0, x, y, time);
+    } else if (!touch && q->prev_touch) {
+        pushEvent(q, INPUT_TOUCH_UP, 0, q->last_x, q->last_y, time);
+    } else if (touch && (x != q->last_x || y != q->last_y)) {
+        pushEvent(q, INPUT_TOUCH_MOVE, 0, x, y, time);
+    }
+    if (touch) {
+        q->last_x = x;
+        q->last_y = y;
+    }
+    q->prev_touch = touch;
+}
+
+#ifdef ARM9
+static InputQueue* input_queue = NULL;
+static u32 input_time = 0;
+
+// タッチの座標はARM7が1フレームに1回送ってくる。キーはここで直接読む
+static void sampleIrq(void) {
+    touchPosition touch;
+    u32 keys = keysCurrent();
+    if (keys & KEY_TOUCH) touchRead(&touch);
+    else touch.px = touch.py = 0;
+    input_sample(input_queue, keys, KEY_TOUCH, touch.px, touch.py, input_time++);
+}
+
+void input_start(InputQueue* q, int timer) {
+    input_queue = q;
+    input_time = 0;
+    timerStart(timer, ClockDivider_1024, TIMER_FREQ_1024(INPUT_SAMPLE_HZ), sampleIrq);
+}
+#endif
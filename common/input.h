@@ -0,0 +1,71 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 入力イベントのキュー
+// 割り込み (生産者) がキーとタッチを取り込んでイベントにし、メインループ
+// (消費者) が毎フレーム取り出す。生産者と消費者が1つずつなのでロックは
+// 要らない: head は生産者だけが、tail は消費者だけが書く。
+// フレームの途中で押して離したキーや、描画に時間がかかっている間の
+// タッチも失われない。
+
+#define INPUT_QUEUE_SIZE 64      // 2のべき乗
+#define INPUT_SAMPLE_HZ  240     // ARM9で取り込む回数 (1フレームに4回)
+
+typedef enum {
+    INPUT_KEY_DOWN,     // keys: 押されたキー
+    INPUT_KEY_UP,       // keys: 離されたキー
+    INPUT_TOUCH_DOWN,   // x, y: タッチした位置
+    INPUT_TOUCH_UP,     // x, y: 最後の位置
+    INPUT_TOUCH_MOVE    // x, y: タッチしたまま動いた先 (手書きの軌跡用)
+} InputEventType;
+
+typedef struct {
+    u8 type;
+    u16 x;
+    u16 y;
+    u32 keys;   // KEY_TOUCH は含めない (タッチは別のイベント)
+    u32 time;   // 取り込んだ回数 (INPUT_SAMPLE_HZ 単位)
+} InputEvent;
+
+typedef struct {
+    volatile u32 head;      // 次に書く位置 (生産者)
+    volatile u32 tail;      // 次に読む位置 (消費者)
+    InputEvent events[INPUT_QUEUE_SIZE];
+    u32 dropped;            // いっぱいで捨てたイベントの数
+
+    // 前回の取り込み (生産者だけが使う)
+    u32 prev_keys;
+    bool prev_touch;
+    u16 last_x;
+    u16 last_y;
+} InputQueue;
+
+void input_reset(InputQueue* q);
+
+// 生産者: いっぱいならfalse
+bool input_push(InputQueue* q, const InputEvent* e);
+
+// 消費者: 空ならfalse
+bool input_pop(InputQueue* q, InputEvent* e);
+
+// 生産者: 今押されているキーとタッチの状態を前回と比べてイベントを積む。
+// touch_bit は keys の中のタッチのビット (KEY_TOUCH)
+void input_sample(InputQueue* q, u32 keys, u32 touch_bit, u16 x, u16 y, u32 time);
+
+#ifdef ARM9
+// タイマー timer の割り込みで INPUT_SAMPLE_HZ 回/秒取り込みを始める
+// (タイマー0/1はベンチマークが使う)
+void input_start(InputQueue* q, int timer);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INPUT_H
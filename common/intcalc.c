@@ -0,0 +1,193 @@
+#include <string.h>
+
+#include "intcalc.h"
+#include "hw_math.h"
+
+#ifdef ENABLE_BENCHMARK
+#include <stdio.h>
+#include "bench.h"
+#endif
+
+static const char intcalc_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+// 10^19 から 10^0 まで (u64 の最大は20桁)
+static const u64 intcalc_pow10[20] = {
+    10000000000000000000ULL, 1000000000000000000ULL, 100000000000000000ULL,
+    10000000000000000ULL, 1000000000000000ULL, 100000000000000ULL,
+    10000000000000ULL, 1000000000000ULL, 100000000000ULL, 10000000000ULL,
+    1000000000ULL, 100000000ULL, 10000000ULL, 1000000ULL, 100000ULL,
+    10000ULL, 1000ULL, 100ULL, 10ULL, 1ULL
+};
+
+// 2/8/16進の1桁のビット数 (それ以外は0)
+static int bitsPerDigit(u32 base) {
+    switch (base) {
+    case 2:  return 1;
+    case 8:  return 3;
+    case 16: return 4;
+    }
+    return 0;
+}
+
+// 符号なし64bitの商。2^63 未満なら除算器を使う
+static u64 divideUnsigned(u64 a, u64 b) {
+    if ((s64)a >= 0 && (s64)b > 0) return (u64)hwmath_div64((s64)a, (s64)b);
+    return a / b;
+}
+
+// 符号付きの商 (0に向かって切り捨て)。最小値 / -1 はあふれて最小値のまま
+static s64 divideSigned(s64 a, s64 b) {
+    if (b == -1) return (s64)(0 - (u64)a);
+    return hwmath_div64(a, b);
+}
+
+bool intcalc_apply(u64* r, char op, u64 a, u64 b, u8 bits, bool is_signed) {
+    u64 result;
+
+    switch (op) {
+    case '+': result = a + b; break;
+    case '-': result = a - b; break;
+    case '*': result = a * b; break;
+    case '&': result = a & b; break;
+    case '|': result = a | b; break;
+    case '^': result = a ^ b; break;
+    case '/':
+    case '%':
+        if (b == 0) return false;
+        if (is_signed) {
+            s64 sa = intcalc_toSigned(a, bits);
+            s64 sb = intcalc_toSigned(b, bits);
+            s64 q = divideSigned(sa, sb);
+            result = op == '/' ? (u64)q : (u64)sa - (u64)q * (u64)sb;
+        } else {
+            u64 q = divideUnsigned(a, b);
+            result = op == '/' ? q : a - q * b;
+        }
+        break;
+    case INTCALC_SHL:
+        result = b >= bits ? 0 : a << b;
+        break;
+    case INTCALC_SHR:
+        if (is_signed) {
+            s64 sa = intcalc_toSigned(a, bits);
+            u32 shift = b >= bits ? bits - 1u : (u32)b;
+            result = (u64)(sa >> shift);
+        } else {
+            result = b >= bits ? 0 : a >> b;
+        }
+        break;
+    default:
+        result = b;
+        break;
+    }
+    *r = result & intcalc_mask(bits);
+    return true;
+}
+
+bool intcalc_appendDigit(u64* v, u32 digit, u32 base, u8 bits) {
+    if (digit >= base) return false;
+
+    u64 mask = intcalc_mask(bits);
+    int shift = bitsPerDigit(base);
+    if (shift > 0) {
+        if (*v > (mask >> shift)) return false;
+        *v = (*v << shift) | digit;
+        return true;
+    }
+
+    // 10進: v*10 + digit <= mask (mask/10 は定数の割り算)
+    u64 limit = bits >= 64 ? ~0ULL / 10 : intcalc_mask(32) / 10;
+    if (*v > limit || (*v == limit && digit > (u32)(mask - limit * 10))) return false;
+    *v = *v * 10 + digit;
+    return true;
+}
+
+u64 intcalc_removeDigit(u64 v, u32 base) {
+    int shift = bitsPerDigit(base);
+    if (shift > 0) return v >> shift;
+    return divideUnsigned(v, 10);
+}
+
+int intcalc_format(char* buf, u64 v, u32 base, u8 bits, bool is_signed, bool pad) {
+    int n = 0;
+    int shift = bitsPerDigit(base);
+
+    if (shift > 0) {
+        // 上の桁から表を引く。bits が桁の倍数でなければ先頭の桁は短い (8進)
+        int count = (bits + shift - 1) / shift;
+        u32 digit_mask = (1u << shift) - 1;
+        bool leading = !pad;
+        for (int i = count - 1; i >= 0; i--) {
+            u32 d = (u32)(v >> (i * shift)) & digit_mask;
+            if (leading && d == 0 && i > 0) continue;
+            leading = false;
+            buf[n++] = intcalc_digits[d];
+        }
+        buf[n] = '\0';
+        return n;
+    }
+
+    // 10進: 大きい10のべき乗から、引ける回数がその桁
+    if (is_signed && intcalc_toSigned(v, bits) < 0) {
+        buf[n++] = '-';
+        v = intcalc_neg(v, bits); // 最小値はそのまま (符号なしで読めば絶対値になる)
+    }
+    bool leading = true;
+    for (int i = 0; i < 20; i++) {
+        u64 p = intcalc_pow10[i];
+        u32 d = 0;
+        while (v >= p) {
+            v -= p;
+            d++;
+        }
+        if (leading && d == 0 && i < 19) continue;
+        leading = false;
+        buf[n++] = intcalc_digits[d];
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+#ifdef ENABLE_BENCHMARK
+#define BENCH_VALUES 1000
+
+void intcalc_benchmark(void) {
+    static const u32 bases[4] = {16, 10, 8, 2};
+    char buf[INTCALC_MAX_DIGITS + 2];
+    char ref[32];
+    u64 ns;
+    bool ok = true;
+
+    iprintf("Integer formatting (4 bases):\n");
+
+    u64 v = 0x0123456789ABCDEFULL;
+    bench_start();
+    for (u32 i = 0; i < BENCH_VALUES; i++) {
+        for (int b = 0; b < 4; b++) intcalc_format(buf, v + i, bases[b], 64, false, true);
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" table:    %6lu cyc\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_VALUES));
+
+    // snprintf には2進が無いので16/10/8進だけ
+    bench_start();
+    for (u32 i = 0; i < BENCH_VALUES; i++) {
+        snprintf(ref, sizeof(ref), "%016llX", (unsigned long long)(v + i));
+        snprintf(ref, sizeof(ref), "%llu", (unsigned long long)(v + i));
+        snprintf(ref, sizeof(ref), "%llo", (unsigned long long)(v + i));
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+
+    intcalc_format(buf, v, 10, 64, false, false);
+    snprintf(ref, sizeof(ref), "%llu", (unsigned long long)v);
+    ok = strcmp(buf, ref) == 0;
+    intcalc_format(buf, v, 8, 64, false, false);
+    snprintf(ref, sizeof(ref), "%llo", (unsigned long long)v);
+    ok = ok && strcmp(buf, ref) == 0;
+    iprintf(" snprintf: %6lu cyc (3 bases)%s\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_VALUES),
+            ok ? "" : " NG");
+}
+#endif
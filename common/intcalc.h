@@ -0,0 +1,66 @@
+#ifndef INTCALC_H
+#define INTCALC_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// プログラマ向けの整数演算 (32/64bit、符号付き/なし)
+// 値は u64 の下位 bits ビットに入れ、上位は常に0にしておく。浮動小数点は
+// 使わない。2/8/16進は表とシフトで、10進は10のべき乗の表を引き算して
+// 文字列にするので、1回の表示で除算を繰り返さない。
+
+#define INTCALC_MAX_DIGITS 64   // 2進64桁
+
+// 演算子: + - * / % & | ^ と、< (左シフト) > (右シフト、符号付きなら算術)
+enum {
+    INTCALC_SHL = '<',
+    INTCALC_SHR = '>'
+};
+
+static inline u64 intcalc_mask(u8 bits) {
+    return bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+}
+
+// 下位 bits ビットを符号付きとして読む
+static inline s64 intcalc_toSigned(u64 v, u8 bits) {
+    if (bits >= 64) return (s64)v;
+    u64 sign = 1ULL << (bits - 1);
+    return (s64)((v ^ sign) - sign);
+}
+
+static inline u64 intcalc_not(u64 v, u8 bits) {
+    return ~v & intcalc_mask(bits);
+}
+
+static inline u64 intcalc_neg(u64 v, u8 bits) {
+    return (0 - v) & intcalc_mask(bits);
+}
+
+// *r = a op b (0で割ったらfalse)。結果は bits ビットで切り捨てる
+bool intcalc_apply(u64* r, char op, u64 a, u64 b, u8 bits, bool is_signed);
+
+// 入力中の値の末尾に base 進の1桁を足す。base の桁でないか、bits ビットに
+// 収まらなくなるならfalse
+bool intcalc_appendDigit(u64* v, u32 digit, u32 base, u8 bits);
+
+// 末尾の1桁を消す
+u64 intcalc_removeDigit(u64 v, u32 base);
+
+// base 進 (2, 8, 10, 16) の文字列にする。10進は is_signed なら符号付き。
+// pad なら2/8/16進を bits ビット分の桁まで0で埋める。
+// buf は INTCALC_MAX_DIGITS + 2 バイト以上。文字数を返す
+int intcalc_format(char* buf, u64 v, u32 base, u8 bits, bool is_signed, bool pad);
+
+#ifdef ENABLE_BENCHMARK
+// 4つの基数の表示にかかるサイクル数を snprintf と比べる
+void intcalc_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INTCALC_H
@@ -0,0 +1,28 @@
+#include "lz77.h"
+
+void lz77_decompress(const u8* src, u8* dst) {
+#ifdef ARM9
+    swiDecompressLZSSWram((void*)src, dst);
+#else
+    u32 size = lz77_size(src);
+    u32 n = 0;
+
+    src += 4;
+    while (n < size) {
+        u8 flags = *src++;
+        for (int bit = 0; bit < 8 && n < size; bit++, flags <<= 1) {
+            if (flags & 0x80) {
+                u32 len = (src[0] >> 4) + 3;
+                u32 disp = (((src[0] & 0x0F) << 8) | src[1]) + 1;
+                src += 2;
+                while (len-- > 0 && n < size) {
+                    dst[n] = dst[n - disp];
+                    n++;
+                }
+            } else {
+                dst[n++] = *src++;
+            }
+        }
+    }
+#endif
+}
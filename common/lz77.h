@@ -0,0 +1,30 @@
+#ifndef LZ77_H
+#define LZ77_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// BIOSのLZ77形式(ヘッダ0x10)の展開
+// ARM9ではswiDecompressLZSSWram()、ホストでは同じ形式のソフトウェア実装を使う。
+// 圧縮側はpack_text.pyのlz77_compress()。
+
+// ヘッダから展開後のサイズを読む
+static inline u32 lz77_size(const u8* src) {
+    return src[1] | (src[2] << 8) | (src[3] << 16);
+}
+
+static inline bool lz77_isCompressed(const u8* src) {
+    return (src[0] & 0xF0) == 0x10;
+}
+
+// srcは4バイト境界に置かれていること
+void lz77_decompress(const u8* src, u8* dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LZ77_H
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "macro.h"
+#include "storage.h"
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+#endif
+
+// ファイルの先頭: "NCMC" + 版数
+static const char macro_magic[4] = {'N', 'C', 'M', 'C'};
+#define MACRO_FILE_VERSION 1
+
+void macro_clear(MacroProgram* p) {
+    p->length = 0;
+    p->label_count = 0;
+}
+
+static bool emit(MacroProgram* p, u8 byte) {
+    if (p->length >= MACRO_MAX_CODE) return false;
+    p->code[p->length++] = byte;
+    return true;
+}
+
+// ラベルの番号 (無ければ登録する。表がいっぱいなら-1)
+static int labelIndex(MacroProgram* p, const char* label) {
+    for (int i = 0; i < p->label_count; i++) {
+        if (strcmp(p->labels[i], label) == 0) return i;
+    }
+    if (p->label_count >= MACRO_MAX_LABELS || strlen(label) >= MACRO_LABEL_SIZE) return -1;
+
+    strcpy(p->labels[p->label_count], label);
+    return p->label_count++;
+}
+
+bool macro_recordKey(MacroProgram* p, const char* label) {
+    if (p->length >= MACRO_MAX_CODE) return false;
+    int index = labelIndex(p, label);
+    return index >= 0 && emit(p, (u8)index);
+}
+
+bool macro_recordMode(MacroProgram* p, u8 mode) {
+    if (p->length + 2 > MACRO_MAX_CODE) return false;
+    return emit(p, MACRO_OP_MODE) && emit(p, mode);
+}
+
+u32 macro_stepCount(const MacroProgram* p) {
+    u32 steps = 0;
+    for (u32 pc = 0; pc < p->length; pc++) {
+        if (p->code[pc] == MACRO_OP_MODE) pc++;
+        steps++;
+    }
+    return steps;
+}
+
+void macro_startPlayback(MacroPlayer* player, const MacroProgram* p) {
+    player->program = p;
+    player->pc = 0;
+}
+
+bool macro_step(MacroPlayer* player, u32 budget, MacroKeyFunc key, MacroModeFunc mode) {
+    const MacroProgram* p = player->program;
+
+    while (budget-- > 0 && player->pc < p->length) {
+        u8 op = p->code[player->pc++];
+        if (op == MACRO_OP_MODE) {
+            if (player->pc >= p->length) break;
+            mode(p->code[player->pc++]);
+        } else if (op < p->label_count) {
+            key(p->labels[op]);
+        }
+    }
+    return player->pc < p->length;
+}
+
+bool macro_save(const MacroProgram* p, const char* path) {
+    if (!storage_mount()) return false;
+
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) return false;
+
+    bool ok = fwrite(macro_magic, 1, sizeof(macro_magic), f) == sizeof(macro_magic) &&
+              fputc(MACRO_FILE_VERSION, f) != EOF &&
+              fputc(p->label_count, f) != EOF;
+    for (int i = 0; ok && i < p->label_count; i++) {
+        size_t len = strlen(p->labels[i]) + 1;
+        ok = fwrite(p->labels[i], 1, len, f) == len;
+    }
+    u8 length[2] = {(u8)(p->length & 0xFF), (u8)(p->length >> 8)};
+    ok = ok && fwrite(length, 1, 2, f) == 2 &&
+         fwrite(p->code, 1, p->length, f) == p->length;
+
+    return fclose(f) == 0 && ok;
+}
+
+bool macro_load(MacroProgram* p, const char* path) {
+    if (!storage_mount()) return false;
+
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return false;
+
+    char magic[4];
+    bool ok = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+              memcmp(magic, macro_magic, sizeof(magic)) == 0 &&
+              fgetc(f) == MACRO_FILE_VERSION;
+
+    int count = ok ? fgetc(f) : EOF;
+    ok = ok && count != EOF && count <= MACRO_MAX_LABELS;
+    for (int i = 0; ok && i < count; i++) {
+        // NUL終端のラベル
+        int len = 0;
+        int c;
+        while ((c = fgetc(f)) > 0 && len < MACRO_LABEL_SIZE - 1) p->labels[i][len++] = (char)c;
+        p->labels[i][len] = '\0';
+        ok = c == 0;
+    }
+
+    u8 length[2];
+    ok = ok && fread(length, 1, 2, f) == 2;
+    u32 n = length[0] | (length[1] << 8);
+    ok = ok && n <= MACRO_MAX_CODE && fread(p->code, 1, n, f) == n;
+    fclose(f);
+
+    if (!ok) {
+        macro_clear(p);
+        return false;
+    }
+    p->label_count = (u8)count;
+    p->length = (u16)n;
+    return true;
+}
+
+#ifdef ENABLE_BENCHMARK
+static u32 bench_keys;
+static MacroKeyFunc bench_key;
+
+static void countKey(const char* label) {
+    bench_keys++;
+    bench_key(label);
+}
+
+void macro_benchmark(const MacroProgram* p, MacroKeyFunc key, MacroModeFunc mode) {
+    MacroPlayer player;
+
+    bench_keys = 0;
+    bench_key = key;
+    macro_startPlayback(&player, p);
+
+    bench_start();
+    while (macro_step(&player, 0xFFFFFFFF, countKey, mode));
+    u64 ns = bench_elapsedNsec();
+    bench_stop();
+
+    iprintf("Macro:\n %lu keys (%u bytes): %lu us\n", (unsigned long)bench_keys,
+            p->length, (unsigned long)(ns / 1000));
+}
+#endif
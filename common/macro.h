@@ -0,0 +1,65 @@
+#ifndef MACRO_H
+#define MACRO_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// キー操作のマクロ (記録・再生・SDへの保存)
+// 押されたボタンのラベルはプログラムごとの表に登録し、コードには表の番号を
+// 1バイトで積む。モードの切り替えは MACRO_OP_MODE + モード番号の2バイト。
+// ラベルをそのまま保存するので、ボタンの配置が変わっても読み込める。
+
+#define MACRO_MAX_CODE   4096
+#define MACRO_MAX_LABELS 128
+#define MACRO_LABEL_SIZE 8    // ラベルは7文字まで
+
+#define MACRO_OP_MODE 0xFF    // 次のバイトがモード番号
+
+typedef struct {
+    u16 length;       // code のバイト数
+    u8 label_count;
+    char labels[MACRO_MAX_LABELS][MACRO_LABEL_SIZE];
+    u8 code[MACRO_MAX_CODE];
+} MacroProgram;
+
+// 再生の途中状態。macro_step() を毎フレーム呼んで少しずつ進める
+typedef struct {
+    const MacroProgram* program;
+    u16 pc;
+} MacroPlayer;
+
+typedef void (*MacroKeyFunc)(const char* label);
+typedef void (*MacroModeFunc)(u8 mode);
+
+void macro_clear(MacroProgram* p);
+
+// 1手を追加する (いっぱいならfalse)
+bool macro_recordKey(MacroProgram* p, const char* label);
+bool macro_recordMode(MacroProgram* p, u8 mode);
+
+// 手数 (モード切り替えも1手)
+u32 macro_stepCount(const MacroProgram* p);
+
+void macro_startPlayback(MacroPlayer* player, const MacroProgram* p);
+
+// 最大 budget 手を実行する。まだ残っていればtrue
+bool macro_step(MacroPlayer* player, u32 budget, MacroKeyFunc key, MacroModeFunc mode);
+
+// SD (libfat) またはホストのファイルに保存/から読み込み。
+// 読み込みに失敗したら p は空になる
+bool macro_save(const MacroProgram* p, const char* path);
+bool macro_load(MacroProgram* p, const char* path);
+
+#ifdef ENABLE_BENCHMARK
+// program を最後まで再生する時間を表示する
+void macro_benchmark(const MacroProgram* p, MacroKeyFunc key, MacroModeFunc mode);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MACRO_H
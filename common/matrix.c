@@ -0,0 +1,375 @@
+#include <string.h>
+
+#include "matrix.h"
+#include "hw_math.h"
+#include "tcm.h"
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+#endif
+
+#define HALF (1 << (MATRIX_FRAC_BITS - 1))
+
+// 乗算・転置・サイズ変更の作業領域 (乗算では転置したB)。
+// make TCM=1 では内積と行の消去をITCMに、この4KBをDTCMに置く
+static s32 matrix_bt[MATRIX_MAX * MATRIX_MAX] TCM_BSS;
+
+// 消去の作業領域: 係数 n 列と右辺 (逆行列なら単位行列) n 列を並べる
+static s32 matrix_work[MATRIX_MAX * MATRIX_MAX * 2];
+
+static bool fits(s64 v) {
+    return v == (s32)v;
+}
+
+static bool validSize(s32 rows, s32 cols) {
+    return rows >= 1 && rows <= MATRIX_MAX && cols >= 1 && cols <= MATRIX_MAX;
+}
+
+static u32 absOf(s32 v) {
+    return v < 0 ? -(u32)v : (u32)v;
+}
+
+static u32 maxAbs(const s32* v, s32 count) {
+    u32 m = 0;
+    for (s32 i = 0; i < count; i++) {
+        if (absOf(v[i]) > m) m = absOf(v[i]);
+    }
+    return m;
+}
+
+bool matrix_setZero(Matrix* m, s32 rows, s32 cols) {
+    if (!validSize(rows, cols)) return false;
+    m->rows = rows;
+    m->cols = cols;
+    memset(m->data, 0, rows * cols * sizeof(m->data[0]));
+    return true;
+}
+
+bool matrix_resize(Matrix* m, s32 rows, s32 cols) {
+    if (!validSize(rows, cols)) return false;
+
+    // 行の幅が変わるので作業領域に詰め直してから戻す
+    s32 copy_rows = rows < m->rows ? rows : m->rows;
+    s32 copy_cols = cols < m->cols ? cols : m->cols;
+    s32* tmp = matrix_bt;
+    for (s32 i = 0; i < copy_rows; i++) {
+        memcpy(tmp + i * cols, m->data + i * m->cols, copy_cols * sizeof(tmp[0]));
+        memset(tmp + i * cols + copy_cols, 0, (cols - copy_cols) * sizeof(tmp[0]));
+    }
+    memset(tmp + copy_rows * cols, 0, (rows - copy_rows) * cols * sizeof(tmp[0]));
+    memcpy(m->data, tmp, rows * cols * sizeof(tmp[0]));
+    m->rows = rows;
+    m->cols = cols;
+    return true;
+}
+
+static bool addSub(Matrix* r, const Matrix* a, const Matrix* b, bool subtract) {
+    if (a->rows != b->rows || a->cols != b->cols) return false;
+
+    s32 count = a->rows * a->cols;
+    for (s32 i = 0; i < count; i++) {
+        s64 v = subtract ? (s64)a->data[i] - b->data[i] : (s64)a->data[i] + b->data[i];
+        if (!fits(v)) return false;
+        r->data[i] = (s32)v;
+    }
+    r->rows = a->rows;
+    r->cols = a->cols;
+    return true;
+}
+
+bool matrix_add(Matrix* r, const Matrix* a, const Matrix* b) {
+    return addSub(r, a, b, false);
+}
+
+bool matrix_sub(Matrix* r, const Matrix* a, const Matrix* b) {
+    return addSub(r, a, b, true);
+}
+
+// dst (cols × rows) = src (rows × cols) の転置
+static void transposeTo(s32* dst, const s32* src, s32 rows, s32 cols) {
+    for (s32 i = 0; i < rows; i++) {
+        const s32* row = src + i * cols;
+        for (s32 j = 0; j < cols; j++) dst[j * rows + i] = row[j];
+    }
+}
+
+bool matrix_transpose(Matrix* r, const Matrix* a) {
+    s32 rows = a->rows;
+    s32 cols = a->cols;
+    transposeTo(matrix_bt, a->data, rows, cols);
+    memcpy(r->data, matrix_bt, rows * cols * sizeof(r->data[0]));
+    r->rows = cols;
+    r->cols = rows;
+    return true;
+}
+
+// 内積 (Q32)。乗算の一番内側
+static TCM_CODE s64 dot(const s32* a, const s32* b, s32 n) {
+    s64 acc = 0;
+    for (s32 k = 0; k < n; k++) acc += (s64)a[k] * b[k];
+    return acc;
+}
+
+bool matrix_mul(Matrix* r, const Matrix* a, const Matrix* b) {
+    s32 n = a->rows;
+    s32 len = a->cols;
+    s32 m = b->cols;
+    if (len != b->rows || r == a || r == b) return false;
+
+    // 内積の途中で64bitがあふれないこと (要素が大きすぎる行列は失敗にする)
+    u64 max_product = (u64)maxAbs(a->data, n * len) * maxAbs(b->data, len * m);
+    if (max_product > (u64)(0x7FFFFFFFFFFFFFFFLL - HALF) / (u64)len) return false;
+
+    // Bを転置して、Bの列もAの行と同じく連続したメモリで読めるようにする
+    transposeTo(matrix_bt, b->data, len, m);
+
+    // Bの列をMATRIX_BLOCK本ずつキャッシュに載せ、その間にAの全行と掛ける
+    for (s32 jj = 0; jj < m; jj += MATRIX_BLOCK) {
+        s32 j_end = jj + MATRIX_BLOCK < m ? jj + MATRIX_BLOCK : m;
+        for (s32 i = 0; i < n; i++) {
+            const s32* a_row = a->data + i * len;
+            s32* r_row = r->data + i * m;
+            for (s32 j = jj; j < j_end; j++) {
+                s64 v = (dot(a_row, matrix_bt + j * len, len) + HALF) >> MATRIX_FRAC_BITS;
+                if (!fits(v)) return false;
+                r_row[j] = (s32)v;
+            }
+        }
+    }
+    r->rows = n;
+    r->cols = m;
+    return true;
+}
+
+// dst -= f × src (f はQ16.16)。消去の一番内側。結果が収まらなければfalse
+static TCM_CODE bool subtractRow(s32* dst, const s32* src, s32 f, s32 n) {
+    bool ok = true;
+    for (s32 k = 0; k < n; k++) {
+        s64 v = dst[k] - (((s64)f * src[k] + HALF) >> MATRIX_FRAC_BITS);
+        dst[k] = (s32)v;
+        ok &= fits(v);
+    }
+    return ok;
+}
+
+enum {
+    ELIMINATE_OK,
+    ELIMINATE_SINGULAR,
+    ELIMINATE_OVERFLOW
+};
+
+// 部分ピボット選択付きの前進消去 (work は n 行 × w 列)。
+// 終わると左のn列は上三角になる。det が NULL でなければピボットの積を入れる
+static int eliminate(s32* work, s32 n, s32 w, double* det) {
+    double d = 1.0;
+
+    for (s32 p = 0; p < n; p++) {
+        s32 best = p;
+        u32 best_abs = absOf(work[p * w + p]);
+        for (s32 i = p + 1; i < n; i++) {
+            u32 a = absOf(work[i * w + p]);
+            if (a > best_abs) {
+                best = i;
+                best_abs = a;
+            }
+        }
+        if (best_abs < MATRIX_PIVOT_MIN) return ELIMINATE_SINGULAR;
+
+        s32* prow = work + p * w;
+        if (best != p) {
+            s32* brow = work + best * w;
+            for (s32 k = p; k < w; k++) {
+                s32 t = prow[k];
+                prow[k] = brow[k];
+                brow[k] = t;
+            }
+            d = -d;
+        }
+        s32 pivot = prow[p];
+        d *= matrix_toDouble(pivot);
+
+        // 行ごとの係数 work[i][p] / pivot (|係数| <= 1) は除算器で求める。
+        // 次の行の除算を始めてから今の行を消去して、除算の待ち時間を隠す
+        if (p + 1 < n) hwmath_divStart64_32((s64)work[(p + 1) * w + p] << MATRIX_FRAC_BITS, pivot);
+        for (s32 i = p + 1; i < n; i++) {
+            s32 f = (s32)hwmath_divResult();
+            if (i + 1 < n) hwmath_divStart64_32((s64)work[(i + 1) * w + p] << MATRIX_FRAC_BITS, pivot);
+
+            s32* row = work + i * w;
+            row[p] = 0;
+            if (f != 0 && !subtractRow(row + p + 1, prow + p + 1, f, w - p - 1)) {
+                return ELIMINATE_OVERFLOW;
+            }
+        }
+    }
+    if (det != NULL) *det = d;
+    return ELIMINATE_OK;
+}
+
+// 上三角にした work の右辺 (n 列目以降) から解を x に求める
+static bool backSubstitute(const s32* work, s32 n, s32 w, Matrix* x) {
+    static s64 acc[MATRIX_MAX];
+    s32 m = w - n;
+
+    for (s32 i = n - 1; i >= 0; i--) {
+        const s32* row = work + i * w;
+        for (s32 c = 0; c < m; c++) acc[c] = (s64)row[n + c] << MATRIX_FRAC_BITS;
+
+        // 解いた行の分を行単位で引く (x の行は連続している)
+        for (s32 k = i + 1; k < n; k++) {
+            s32 f = row[k];
+            if (f == 0) continue;
+            const s32* x_row = x->data + k * m;
+            for (s32 c = 0; c < m; c++) acc[c] -= (s64)f * x_row[c];
+        }
+
+        // 商は四捨五入 (acc と pivot の符号をそろえて半分を足す)
+        s32 pivot = row[i];
+        s64 half = (pivot < 0 ? -(s64)pivot : pivot) / 2;
+        s32* x_row = x->data + i * m;
+        for (s32 c = 0; c < m; c++) {
+            hwmath_divStart64_32(acc[c] < 0 ? acc[c] - half : acc[c] + half, pivot);
+            s64 q = hwmath_divResult();
+            if (!fits(q)) return false;
+            x_row[c] = (s32)q;
+        }
+    }
+    x->rows = n;
+    x->cols = m;
+    return true;
+}
+
+// work = [a | b] (b が NULL なら単位行列)
+static void loadAugmented(const Matrix* a, const Matrix* b, s32 w) {
+    s32 n = a->rows;
+    for (s32 i = 0; i < n; i++) {
+        s32* row = matrix_work + i * w;
+        memcpy(row, a->data + i * n, n * sizeof(row[0]));
+        if (b != NULL) {
+            memcpy(row + n, b->data + i * b->cols, b->cols * sizeof(row[0]));
+        } else {
+            memset(row + n, 0, n * sizeof(row[0]));
+            row[n + i] = MATRIX_ONE;
+        }
+    }
+}
+
+bool matrix_det(const Matrix* a, double* det) {
+    if (a->rows != a->cols) return false;
+
+    s32 n = a->rows;
+    memcpy(matrix_work, a->data, n * n * sizeof(matrix_work[0]));
+    switch (eliminate(matrix_work, n, n, det)) {
+    case ELIMINATE_SINGULAR: *det = 0.0; return true;
+    case ELIMINATE_OVERFLOW: return false;
+    }
+    return true;
+}
+
+bool matrix_inverse(Matrix* r, const Matrix* a) {
+    if (a->rows != a->cols) return false;
+
+    s32 n = a->rows;
+    loadAugmented(a, NULL, 2 * n);
+    if (eliminate(matrix_work, n, 2 * n, NULL) != ELIMINATE_OK) return false;
+    return backSubstitute(matrix_work, n, 2 * n, r);
+}
+
+bool matrix_solve(Matrix* x, const Matrix* a, const Matrix* b) {
+    if (a->rows != a->cols || b->rows != a->rows) return false;
+
+    s32 n = a->rows;
+    s32 w = n + b->cols;
+    loadAugmented(a, b, w);
+    if (eliminate(matrix_work, n, w, NULL) != ELIMINATE_OK) return false;
+    return backSubstitute(matrix_work, n, w, x);
+}
+
+#ifdef ENABLE_BENCHMARK
+#define BENCH_REPEAT 20
+
+// 1フレーム (59.83Hz) のマイクロ秒
+#define BENCH_FRAME_US 16715
+
+// ブロック化も転置もしない乗算 (比較用)。Bは列方向に飛び飛びに読む
+static void mulNaive(Matrix* r, const Matrix* a, const Matrix* b) {
+    s32 n = a->rows, len = a->cols, m = b->cols;
+    for (s32 i = 0; i < n; i++) {
+        for (s32 j = 0; j < m; j++) {
+            s64 acc = 0;
+            for (s32 k = 0; k < len; k++) acc += (s64)a->data[i * len + k] * b->data[k * m + j];
+            r->data[i * m + j] = (s32)((acc + HALF) >> MATRIX_FRAC_BITS);
+        }
+    }
+    r->rows = n;
+    r->cols = m;
+}
+
+// [-1, 1) の値に対角 n を足した正則な行列
+static void benchFill(Matrix* m, s32 n, u32 seed) {
+    matrix_setZero(m, n, n);
+    for (s32 i = 0; i < n * n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        m->data[i] = (s32)(seed >> 15) - MATRIX_ONE;
+    }
+    for (s32 i = 0; i < n; i++) m->data[i * n + i] += n * MATRIX_ONE;
+}
+
+static void benchPrint(const char* name, u64 ns) {
+    u32 us = (u32)(ns / 1000 / BENCH_REPEAT);
+    iprintf(" %-7s%6lu us %3lu%%\n", name, (unsigned long)us,
+            (unsigned long)(us * 100 / BENCH_FRAME_US));
+}
+
+void matrix_benchmark(void) {
+    static Matrix a, b, r, r2;
+    static const s32 sizes[] = {8, 16, 32};
+    u64 ns;
+
+    iprintf("Matrix (Q16.16, %% of frame):\n");
+    for (u32 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        s32 n = sizes[s];
+        benchFill(&a, n, 1);
+        benchFill(&b, n, 2);
+        iprintf("%ldx%ld\n", (long)n, (long)n);
+
+        bench_start();
+        for (int i = 0; i < BENCH_REPEAT; i++) mulNaive(&r2, &a, &b);
+        ns = bench_elapsedNsec();
+        bench_stop();
+        benchPrint("mul", ns);
+
+        bench_start();
+        for (int i = 0; i < BENCH_REPEAT; i++) matrix_mul(&r, &a, &b);
+        ns = bench_elapsedNsec();
+        bench_stop();
+        benchPrint(memcmp(r.data, r2.data, n * n * sizeof(r.data[0])) == 0 ? "blocked" : "NG", ns);
+
+        double det = 0.0;
+        bench_start();
+        for (int i = 0; i < BENCH_REPEAT; i++) matrix_det(&a, &det);
+        ns = bench_elapsedNsec();
+        bench_stop();
+        benchPrint("det", ns);
+
+        bench_start();
+        for (int i = 0; i < BENCH_REPEAT; i++) matrix_inverse(&r, &a);
+        ns = bench_elapsedNsec();
+        bench_stop();
+        benchPrint("inv", ns);
+
+        // A × A^-1 と単位行列の差の最大 (LSB = 2^-16)
+        matrix_mul(&r2, &a, &r);
+        for (s32 i = 0; i < n; i++) r2.data[i * n + i] -= MATRIX_ONE;
+        iprintf("  |A*inv-I| %lu lsb\n", (unsigned long)maxAbs(r2.data, n * n));
+
+        b.cols = 1; // 最初の列を右辺に
+        for (s32 i = 0; i < n; i++) b.data[i] = b.data[i * n];
+        bench_start();
+        for (int i = 0; i < BENCH_REPEAT; i++) matrix_solve(&r, &a, &b);
+        ns = bench_elapsedNsec();
+        bench_stop();
+        benchPrint("solve", ns);
+    }
+}
+#endif
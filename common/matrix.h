@@ -0,0 +1,74 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 固定小数点 (Q16.16) の行列
+// 要素は行優先で詰めて格納する (i行j列は data[i * cols + j])。
+// 演算はサイズが合わないとき、結果がQ16.16に収まらないとき、
+// 正則でないとき (inverse/solve) にfalseを返す。
+
+#define MATRIX_MAX       32
+#define MATRIX_FRAC_BITS 16
+#define MATRIX_ONE       (1 << MATRIX_FRAC_BITS)
+
+// 乗算で一度にキャッシュに載せる転置済みBの行数。
+// 32x32ならBの16行 (2KB) とA全体 (4KB) が8KBのデータキャッシュに同時に収まる
+#define MATRIX_BLOCK 16
+
+// 消去でこれより小さいピボット (約2.4e-4) は0とみなす
+#define MATRIX_PIVOT_MIN 16
+
+typedef struct {
+    s32 rows;
+    s32 cols;
+    s32 data[MATRIX_MAX * MATRIX_MAX];
+} Matrix;
+
+static inline s32 matrix_fromDouble(double v) {
+    return (s32)(v * MATRIX_ONE + (v < 0 ? -0.5 : 0.5));
+}
+
+static inline double matrix_toDouble(s32 v) {
+    return v / (double)MATRIX_ONE;
+}
+
+// rows × cols の零行列 (サイズが範囲外ならfalse)
+bool matrix_setZero(Matrix* m, s32 rows, s32 cols);
+
+// 左上の要素を残して rows × cols にする (増えた要素は0)
+bool matrix_resize(Matrix* m, s32 rows, s32 cols);
+
+// r = a + b, r = a - b (r は a, b と同じでもよい)
+bool matrix_add(Matrix* r, const Matrix* a, const Matrix* b);
+bool matrix_sub(Matrix* r, const Matrix* a, const Matrix* b);
+
+// r = a × b (r は a, b と別の行列)
+bool matrix_mul(Matrix* r, const Matrix* a, const Matrix* b);
+
+// r = a^T (r は a と同じでもよい)
+bool matrix_transpose(Matrix* r, const Matrix* a);
+
+// 正方行列の行列式。Q16.16に収まらない大きさになるのでdoubleで返す
+bool matrix_det(const Matrix* a, double* det);
+
+// r = a^-1 (r は a と同じでもよい)
+bool matrix_inverse(Matrix* r, const Matrix* a);
+
+// a x = b を解く (b は複数列でもよい。x は a, b と同じでもよい)
+bool matrix_solve(Matrix* x, const Matrix* a, const Matrix* b);
+
+#ifdef ENABLE_BENCHMARK
+// 8/16/32次の乗算 (素朴/ブロック)・逆行列・連立方程式・行列式の時間を表示する
+void matrix_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MATRIX_H
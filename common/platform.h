@@ -0,0 +1,27 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// ARM9ビルドではlibndsをそのまま使い、ホストビルド(-DARM9なし)では
+// 同じ型名を標準ヘッダから用意する。ハードウェアに依存しない
+// モジュール(デコーダや数値演算カーネル)をPC上でも計測できるようにするため。
+// ARM7ビルド(arm7/、-DARM7)もlibndsを使うが、ARM9専用のハードウェアは無い。
+#if defined(ARM9) || defined(ARM7)
+#include <nds.h>
+#else
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t   s8;
+typedef int16_t  s16;
+typedef int32_t  s32;
+typedef int64_t  s64;
+
+#define iprintf printf
+#endif
+
+#endif // PLATFORM_H
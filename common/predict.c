@@ -0,0 +1,66 @@
+#include "predict.h"
+
+#define HIRA_FIRST 0x829F // ぁ
+#define HIRA_LAST  0x82F1 // ん
+#define KATA_FIRST 0x8340 // ァ
+#define KATA_LAST  0x8393 // ン (0x837Fは空き)
+#define LONG_MARK  0x815B // ー
+
+// トライのラベル (generate_predict_index.pyのlabel()と同じ)。かな以外は0
+static inline u32 predictLabel(u16 code) {
+    if (code >= HIRA_FIRST && code <= HIRA_LAST) return code - HIRA_FIRST + 1;
+    if (code >= KATA_FIRST && code <= KATA_LAST && code != 0x837F) {
+        return code - KATA_FIRST + 1 - (code > 0x837F ? 1 : 0);
+    }
+    if (code == LONG_MARK) return HIRA_LAST - HIRA_FIRST + 2;
+    return 0;
+}
+
+bool predict_open(PredictDict* dict, const u8* data, u32 size) {
+    const u32* header = (const u32*)data;
+
+    if (size < 16 || ((uintptr_t)data & 3)) return false;
+    if (header[0] != PREDICT_MAGIC || header[3] != PREDICT_TOP_K) return false;
+
+    u32 node_count = header[1];
+    u32 word_count = header[2];
+    u32 fixed = 16 + (word_count + 1) * 4 + node_count * (2 + 2 + PREDICT_TOP_K * 2);
+    if (node_count == 0 || node_count >= PREDICT_NONE || fixed > size) return false;
+
+    dict->node_count = node_count;
+    dict->word_count = word_count;
+    dict->word_starts = header + 4;
+    dict->base = (const u16*)(dict->word_starts + word_count + 1);
+    dict->check = dict->base + node_count;
+    dict->top = dict->check + node_count;
+    dict->words = dict->top + node_count * PREDICT_TOP_K;
+    return fixed + dict->word_starts[word_count] * 2 <= size;
+}
+
+u16 predict_step(const PredictDict* dict, u16 node, u16 code) {
+    u32 label = predictLabel(code);
+    if (label == 0) return PREDICT_ROOT;
+    if (node == PREDICT_NONE) return PREDICT_NONE;
+
+    u32 t = dict->base[node] + label;
+    if (t >= dict->node_count || dict->check[t] != node) return PREDICT_NONE;
+    return (u16)t;
+}
+
+int predict_candidates(const PredictDict* dict, u16 node, u16* ids) {
+    if (node == PREDICT_NONE) return 0;
+
+    const u16* top = dict->top + node * PREDICT_TOP_K;
+    int n = 0;
+    while (n < PREDICT_TOP_K && top[n] != 0xFFFF) {
+        ids[n] = top[n];
+        n++;
+    }
+    return n;
+}
+
+const u16* predict_word(const PredictDict* dict, u16 id, int* len) {
+    u32 start = dict->word_starts[id];
+    *len = (int)(dict->word_starts[id + 1] - start);
+    return dict->words + start;
+}
@@ -0,0 +1,51 @@
+#ifndef PREDICT_H
+#define PREDICT_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// かな入力の予測変換 (入力中の読みから始まる語を頻度順に出す)
+//
+// 辞書はビルド時にgenerate_predict_index.pyで本文のひらがな・カタカナの語から作り、
+// data/にbin2oで埋め込む (4バイト境界に置かれていること)。
+// 読みのダブル配列トライの各ノードに、その下の語の上位PREDICT_TOP_K個を
+// 持たせてあるので、1文字打つごとの処理は配列を1回引くだけで、候補も探さずに読める。
+// カタカナはひらがなと同じ読みとして扱う。
+
+#define PREDICT_MAGIC 0x31445250 // 'PRD1'
+#define PREDICT_TOP_K 4
+
+#define PREDICT_ROOT 0
+#define PREDICT_NONE 0xFFFF // 辞書に無い読み (この先も候補は無い)
+
+typedef struct {
+    u32 node_count;
+    u32 word_count;
+    const u32* word_starts; // word_count + 1 個 (wordsの中の位置)
+    const u16* base;
+    const u16* check;
+    const u16* top;         // node_count * PREDICT_TOP_K 個の語の番号
+    const u16* words;       // 表記 (SJIS)
+} PredictDict;
+
+// 辞書を開く。形式が合わなければfalse。
+bool predict_open(PredictDict* dict, const u8* data, u32 size);
+
+// 読みnodeの後にcodeを1文字足したノード。辞書に無い読みならPREDICT_NONE。
+// かな以外は語の区切りとしてPREDICT_ROOTを返す (次の文字から新しい語になる)
+u16 predict_step(const PredictDict* dict, u16 node, u16 code);
+
+// nodeの候補 (語の番号) を頻度の高い順にidsに書き、個数を返す (最大PREDICT_TOP_K)
+int predict_candidates(const PredictDict* dict, u16 node, u16* ids);
+
+// 語の表記 (SJISの文字コード列) と文字数
+const u16* predict_word(const PredictDict* dict, u16 id, int* len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PREDICT_H
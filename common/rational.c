@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "rational.h"
+#include "hw_math.h"
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+#endif
+
+// |x| (x は INT64_MIN ではない)
+static inline u64 absU(s64 x) {
+    return x < 0 ? (u64)-x : (u64)x;
+}
+
+// 割り算は1回ごとにARM9の除算器を待つので、約分しなくてよいとき (g == 1) は飛ばす
+static inline s64 divExact(s64 x, s64 g) {
+    return g == 1 ? x : hwmath_div64(x, g);
+}
+
+u64 rational_gcd(u64 a, u64 b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+
+    // 共通の2の累乗をくくり出し、あとは奇数どうしの引き算を繰り返す
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            u64 t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+bool rational_make(Rational* r, s64 num, s64 den) {
+    if (den == 0 || num == INT64_MIN || den == INT64_MIN) return false;
+    if (den < 0) {
+        num = -num;
+        den = -den;
+    }
+    s64 g = (s64)rational_gcd(absU(num), (u64)den);
+    r->num = divExact(num, g);
+    r->den = divExact(den, g);
+    return true;
+}
+
+// Knuthの方法: g = gcd(b, d) として
+// a/b + c/d = (a (d/g) + c (b/g)) / (b (d/g))、分子と b (d/g) の公約数は g の約数だけ
+bool rational_add(Rational* r, Rational a, Rational b) {
+    s64 g = (s64)rational_gcd((u64)a.den, (u64)b.den);
+    s64 da = divExact(a.den, g);
+    s64 db = divExact(b.den, g);
+
+    s64 left, right, num;
+    if (__builtin_mul_overflow(a.num, db, &left) || __builtin_mul_overflow(b.num, da, &right) ||
+        __builtin_add_overflow(left, right, &num) || num == INT64_MIN) {
+        return false;
+    }
+
+    s64 g2 = (s64)rational_gcd(absU(num), (u64)g);
+    s64 den;
+    if (__builtin_mul_overflow(da, divExact(b.den, g2), &den)) return false;
+
+    r->num = num == 0 ? 0 : divExact(num, g2);
+    r->den = num == 0 ? 1 : den;
+    return true;
+}
+
+bool rational_sub(Rational* r, Rational a, Rational b) {
+    b.num = -b.num;
+    return rational_add(r, a, b);
+}
+
+// 先に互いの分母と分子で約分しておくので、掛けた結果はもう既約
+bool rational_mul(Rational* r, Rational a, Rational b) {
+    if (a.num == 0 || b.num == 0) {
+        *r = rational_fromInt(0);
+        return true;
+    }
+
+    s64 g1 = (s64)rational_gcd(absU(a.num), (u64)b.den);
+    s64 g2 = (s64)rational_gcd(absU(b.num), (u64)a.den);
+    s64 num, den;
+    if (__builtin_mul_overflow(divExact(a.num, g1), divExact(b.num, g2), &num) || num == INT64_MIN ||
+        __builtin_mul_overflow(divExact(a.den, g2), divExact(b.den, g1), &den)) {
+        return false;
+    }
+    r->num = num;
+    r->den = den;
+    return true;
+}
+
+bool rational_div(Rational* r, Rational a, Rational b) {
+    if (b.num == 0) return false;
+
+    // 逆数 (分母を正に保つ)
+    Rational inv = {b.den, b.num};
+    if (inv.den < 0) {
+        inv.num = -inv.num;
+        inv.den = -inv.den;
+    }
+    return rational_mul(r, a, inv);
+}
+
+bool rational_parse(Rational* r, const char* text) {
+    bool negative = false;
+    if (*text == '-') {
+        negative = true;
+        text++;
+    }
+
+    // 末尾の0は分子と分母の両方を10倍するだけなので数えない
+    const char* end = text + strlen(text);
+    const char* dot = strchr(text, '.');
+    if (dot != NULL) {
+        while (end > dot + 1 && end[-1] == '0') end--;
+        if (end == dot + 1) end = dot;
+    }
+
+    u64 num = 0;
+    s64 den = 1;
+    bool digits = false;
+    for (const char* p = text; p < end; p++) {
+        if (p == dot) continue;
+        if (*p < '0' || *p > '9') return false;
+        if (num > ((u64)INT64_MAX - 9) / 10) return false;
+        num = num * 10 + (u64)(*p - '0');
+        if (dot != NULL && p > dot) {
+            if (den > INT64_MAX / 10) return false;
+            den *= 10;
+        }
+        digits = true;
+    }
+    if (!digits) return false; // "" や "."
+
+    return rational_make(r, negative ? -(s64)num : (s64)num, den);
+}
+
+double rational_toDouble(Rational r) {
+    if (r.den == 1) return (double)r.num;
+    return hwmath_divDouble((double)r.num, (double)r.den);
+}
+
+// 10^9 ずつ除算器で割って、9桁ずつ下から作る
+static int formatU64(char* buf, u64 value) {
+    char tmp[24];
+    int n = 0;
+    while (value >= 1000000000ULL) {
+        s64 q = hwmath_div64((s64)value, 1000000000LL);
+        u32 chunk = (u32)(value - (u64)q * 1000000000ULL);
+        for (int i = 0; i < 9; i++, chunk /= 10) tmp[n++] = (char)('0' + chunk % 10);
+        value = (u64)q;
+    }
+    u32 low = (u32)value;
+    do {
+        tmp[n++] = (char)('0' + low % 10);
+        low /= 10;
+    } while (low != 0);
+
+    for (int i = 0; i < n; i++) buf[i] = tmp[n - 1 - i];
+    buf[n] = '\0';
+    return n;
+}
+
+int rational_format(Rational r, bool mixed, char* buf, u32 size) {
+    char text[64];
+    char* p = text;
+    u64 num = absU(r.num);
+
+    if (r.num < 0) *p++ = '-';
+    if (r.den == 1) {
+        p += formatU64(p, num);
+    } else {
+        if (mixed && num > (u64)r.den) {
+            s64 whole = hwmath_div64((s64)num, r.den);
+            p += formatU64(p, (u64)whole);
+            *p++ = ' ';
+            num -= (u64)whole * (u64)r.den;
+        }
+        p += formatU64(p, num);
+        *p++ = '/';
+        p += formatU64(p, (u64)r.den);
+    }
+    *p = '\0';
+
+    int n = p - text;
+    if (size == 0) return 0;
+    if ((u32)n >= size) n = size - 1;
+    memcpy(buf, text, n);
+    buf[n] = '\0';
+    return n;
+}
+
+#ifdef ENABLE_BENCHMARK
+#define BENCH_OPS 10000
+
+// 比べる相手: 64bitの剰余 (ARM9には命令が無いのでライブラリの割り算になる)
+static u64 euclidGcd(u64 a, u64 b) {
+    while (b != 0) {
+        u64 t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+void rational_benchmark(void) {
+    // 隣り合うフィボナッチ数はユークリッドの互除法の最悪の場合
+    const u64 fa = 7540113804746346429ULL, fb = 4660046610375530309ULL;
+    u64 sum = 0;
+    u64 ns;
+
+    iprintf("Rational:\n");
+
+    bench_start();
+    for (u32 i = 0; i < BENCH_OPS; i++) sum += rational_gcd(fa, fb + (i & 1));
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" gcd bin: %5lu cyc\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_OPS));
+
+    u64 check = 0;
+    bench_start();
+    for (u32 i = 0; i < BENCH_OPS; i++) check += euclidGcd(fa, fb + (i & 1));
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" gcd mod: %5lu cyc%s\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_OPS), sum == check ? "" : " NG");
+
+    // 1/2 に 1/3, 1/4, ... を足しては引き戻す (値は 1/2 から動かない)
+    Rational q = {1, 2};
+    bool ok = true;
+    bench_start();
+    for (u32 i = 0; i < BENCH_OPS; i++) {
+        Rational step = {1, (s64)(i % 1000) + 3};
+        ok &= rational_add(&q, q, step);
+        ok &= rational_sub(&q, q, step);
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    ok &= q.num == 1 && q.den == 2;
+    iprintf(" add+sub: %5lu cyc%s\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_OPS), ok ? "" : " NG");
+
+    double d = 0.5;
+    bench_start();
+    for (u32 i = 0; i < BENCH_OPS; i++) {
+        double step = 1.0 / (double)((i % 1000) + 3);
+        d += step;
+        d -= step;
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" dbl a/b: %5lu cyc%s\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_OPS), d == 0.5 ? "" : " ~");
+}
+#endif
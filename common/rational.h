@@ -0,0 +1,62 @@
+#ifndef RATIONAL_H
+#define RATIONAL_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 有理数 (64bitの分子と分母の既約分数)
+// 分母は常に正で、0は 0/1。約分の最大公約数は2進GCD (シフトと引き算だけ) で求め、
+// 約分の割り算はARM9の除算器を使うので、ソフトウェアの浮動小数点を通らない。
+// 演算の途中や結果が64bitに収まらなければfalseを返す (呼び出し側は小数に切り替える)。
+// 分子・分母に INT64_MIN は使わない (符号を反転できないので、あふれとして扱う)。
+
+typedef struct {
+    s64 num;
+    s64 den;
+} Rational;
+
+static inline Rational rational_fromInt(s64 n) {
+    Rational r = {n, 1};
+    return r;
+}
+
+static inline bool rational_isInt(Rational r) {
+    return r.den == 1;
+}
+
+// 2進GCD (gcd(0, b) = b)
+u64 rational_gcd(u64 a, u64 b);
+
+// num/den を約分して *r に入れる。den が0、またはINT64_MINを含むときはfalse
+bool rational_make(Rational* r, s64 num, s64 den);
+
+// *r = a op b。あふれたとき (と0で割ったとき) はfalseで、*r は変えない
+bool rational_add(Rational* r, Rational a, Rational b);
+bool rational_sub(Rational* r, Rational a, Rational b);
+bool rational_mul(Rational* r, Rational a, Rational b);
+bool rational_div(Rational* r, Rational a, Rational b);
+
+// 10進の文字列 ("-12.375" など、指数は無し) を誤差無しで分数にする。
+// 数字以外が混じっているか、64bitに収まらなければfalse
+bool rational_parse(Rational* r, const char* text);
+
+double rational_toDouble(Rational r);
+
+// "a/b" (整数なら "a")。mixed なら帯分数 "-1 1/3" にする。書いた文字数を返す
+// (size に収まらなければ切り詰める)
+int rational_format(Rational r, bool mixed, char* buf, u32 size);
+
+#ifdef ENABLE_BENCHMARK
+// 2進GCDとユークリッドの互除法 (64bitの剰余)、分数の足し算と小数の割り算の
+// 1回あたりのサイクル数を表示する
+void rational_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RATIONAL_H
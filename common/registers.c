@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "registers.h"
+#include "storage.h"
+
+// ファイル: "NCRG" + 版数 + レジスタ数 + 予備2バイト、続いて double が
+// REG_COUNT 個 (ARM9のリトルエンディアンのまま)。レジスタ i の位置は固定
+static const char register_magic[4] = {'N', 'C', 'R', 'G'};
+#define REGISTER_FILE_VERSION 1
+#define REGISTER_HEADER_SIZE  8
+
+double register_values[REG_COUNT];
+
+static u32 register_dirty = 0;   // ビット i: レジスタ i を書いていない
+static u32 register_version = 0;
+
+static const char register_names[REG_COUNT][4] = {
+    "A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M",
+    "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z", "Ans"
+};
+
+void registers_set(int index, double value) {
+    if (register_values[index] == value) return;
+    register_values[index] = value;
+    register_dirty |= 1u << index;
+    register_version++;
+}
+
+void registers_clear(void) {
+    for (int i = 0; i < REG_COUNT; i++) registers_set(i, 0.0);
+}
+
+int registers_index(const char* name) {
+    if (name[0] >= 'A' && name[0] <= 'Z' && name[1] == '\0') return name[0] - 'A';
+    if (strcmp(name, "Ans") == 0) return REG_ANS;
+    return -1;
+}
+
+const char* registers_name(int index) {
+    return register_names[index];
+}
+
+u32 registers_version(void) {
+    return register_version;
+}
+
+bool registers_dirty(void) {
+    return register_dirty != 0;
+}
+
+static bool writeHeader(FILE* f) {
+    u8 header[REGISTER_HEADER_SIZE] = {0};
+    memcpy(header, register_magic, sizeof(register_magic));
+    header[4] = REGISTER_FILE_VERSION;
+    header[5] = REG_COUNT;
+    return fwrite(header, 1, sizeof(header), f) == sizeof(header);
+}
+
+static bool checkHeader(FILE* f) {
+    u8 header[REGISTER_HEADER_SIZE];
+    return fread(header, 1, sizeof(header), f) == sizeof(header) &&
+           memcmp(header, register_magic, sizeof(register_magic)) == 0 &&
+           header[4] == REGISTER_FILE_VERSION && header[5] == REG_COUNT;
+}
+
+bool registers_load(const char* path) {
+    memset(register_values, 0, sizeof(register_values));
+    register_dirty = 0;
+    register_version++;
+    if (!storage_mount()) return false;
+
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return false;
+
+    bool ok = checkHeader(f) &&
+              fread(register_values, sizeof(double), REG_COUNT, f) == REG_COUNT;
+    fclose(f);
+
+    if (!ok) memset(register_values, 0, sizeof(register_values));
+    return ok;
+}
+
+// 連続した変更はまとめて1回のシークと書き込みにする
+static bool writeDirty(FILE* f) {
+    int i = 0;
+    while (i < REG_COUNT) {
+        if (!(register_dirty & (1u << i))) {
+            i++;
+            continue;
+        }
+        int first = i;
+        while (i < REG_COUNT && (register_dirty & (1u << i))) i++;
+
+        if (fseek(f, REGISTER_HEADER_SIZE + first * (long)sizeof(double), SEEK_SET) != 0 ||
+            fwrite(&register_values[first], sizeof(double), i - first, f) != (size_t)(i - first)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool registers_sync(const char* path) {
+    if (register_dirty == 0) return true;
+    if (!storage_mount()) return false;
+
+    bool ok;
+    FILE* f = fopen(path, "rb+");
+    if (f != NULL && checkHeader(f)) {
+        ok = writeDirty(f);
+    } else {
+        // 最初の保存: 全体を書く
+        if (f != NULL) fclose(f);
+        f = fopen(path, "wb");
+        if (f == NULL) return false;
+        ok = writeHeader(f) &&
+             fwrite(register_values, sizeof(double), REG_COUNT, f) == REG_COUNT;
+    }
+
+    if (fclose(f) == 0 && ok) {
+        register_dirty = 0;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#ifndef REGISTERS_H
+#define REGISTERS_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 名前付きのレジスタ (変数) A～Z と Ans
+// 値は記号で添字を引く固定の配列に置くので、読み書きは定数時間。
+// 変更したレジスタはビットで覚えておき、registers_sync() でその分だけ
+// ファイルの決まった位置に書き込む。
+
+#define REG_COUNT 27
+#define REG_ANS   26             // 直前の計算結果
+#define REG_M     ('M' - 'A')    // M+ / MR / MC が使うレジスタ
+
+extern double register_values[REG_COUNT];
+
+static inline double registers_get(int index) { return register_values[index]; }
+
+void registers_set(int index, double value);
+
+// 全部0にする
+void registers_clear(void);
+
+// "A"～"Z", "Ans" の番号 (それ以外は-1)
+int registers_index(const char* name);
+
+// 番号の名前 ("A"～"Z", "Ans")
+const char* registers_name(int index);
+
+// 値が変わるたびに増える (キャッシュした計算結果の確認用)
+u32 registers_version(void);
+
+// まだファイルに書いていない変更があるか
+bool registers_dirty(void);
+
+// SD (libfat) またはホストのファイルから読み込む。失敗したら全部0
+bool registers_load(const char* path);
+
+// 変更したレジスタだけを書き込む (ファイルが無いか壊れていれば全体を書く)
+bool registers_sync(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REGISTERS_H
@@ -0,0 +1,549 @@
+#include <math.h> // NAN, INFINITY, isnan (マクロのみ。libmの関数は使わない)
+
+#include "sci_math.h"
+#include "hw_math.h"
+#include "tcm.h"
+
+// 固定小数点はQ30 (1.0 = 1 << 30)
+#define Q_ONE   (1 << 30)
+#define Q_1_2   536870912
+#define Q_1_3   357913941
+#define Q_1_4   268435456
+#define Q_1_5   214748365
+#define Q_1_6   178956971
+#define Q_1_7   153391689
+#define Q_1_24  44739243
+#define Q_1_120 8947849
+#define Q_2_15  143165577
+#define Q_3_40  80530637
+#define Q_5_112 47934903
+#define Q_17_315 57947971
+#define Q_62_2835 23482185
+#define Q_1382_155925 9516827
+#define Q_1_9   119304647
+#define Q_1_11  97612893
+#define Q_35_1152 32622364
+#define Q_63_2816 24021923
+#define Q_1_720 1491308
+#define Q_1_5040 213044
+#define Q_1_40320 26631
+#define Q_1_362880 2959
+
+// |x| < 1/8 は多項式で直接求める (CORDICは絶対誤差なので0付近の相対精度が落ちる)
+#define SMALL_Q30 (1 << 27)
+#define SMALL_ARG 0.125
+
+#define CORDIC_ITERATIONS 30
+#define CORDIC_GAIN_Q30 652032874 // 1/K = Π 1/sqrt(1 + 2^-2i)
+
+// 三角関数の引数の上限 (π/2の倍数をdouble 2つで正確に引ける範囲)
+#define SCI_TRIG_MAX 1.0e6
+#define TWO_OVER_PI 0.63661977236758134308
+#define PI_2_HI 1.5707963267341256      // π/2の上位32bit
+#define PI_2_LO 6.077094383272197e-11
+
+#define LN2_Q52     3121657384082680LL
+#define INV_LN10    0.43429448190325176
+#define EXP_SCALE   46.16624130844683   // 32 / ln2
+#define LN2_32_HI   0.02166084938653512 // ln2 / 32 の上位32bit
+#define LN2_32_LO   5.963170929268458e-12
+
+// 整数乗を掛け算で求める指数の上限
+#define SCI_POW_INT_MAX 1024
+
+#define FRAC_MASK ((1ULL << 52) - 1)
+
+// atan(2^-i) (Q30)
+static const s32 cordic_atan[CORDIC_ITERATIONS] = {
+    843314857, 497837829, 263043837, 133525159, 67021687, 33543516, 16775851, 8388437,
+    4194283, 2097149, 1048576, 524288, 262144, 131072, 65536, 32768,
+    16384, 8192, 4096, 2048, 1024, 512, 256, 128, 64, 32, 16, 8, 4, 2
+};
+
+// ln(1 + k/32), 1 / (1 + k/32) (Q30)
+static const s32 ln_table[32] = {
+    0, 33040817, 65095192, 96220323, 126468572, 155887996, 184522808, 212413774,
+    239598564, 266112055, 291986604, 317252283, 341937090, 366067135, 389666807, 412758919,
+    435364845, 457504636, 479197128, 500460037, 521310048, 541762891, 561833416, 581535654,
+    600882877, 619887653, 638561895, 656916903, 674963409, 692711611, 710171213, 727351448
+};
+static const s32 ln_inv_table[32] = {
+    1073741824, 1041204193, 1010580540, 981706811, 954437177, 928641578, 904203641, 881018933,
+    858993459, 838042399, 818089009, 799063683, 780903145, 763549742, 746950834, 731058263,
+    715827883, 701219150, 687194767, 673720360, 660764199, 648296950, 636291451, 624722516,
+    613566757, 602802428, 592409282, 582368447, 572662306, 563274399, 554189329, 545392673
+};
+
+// 2^(j/32) (Q30)
+static const u32 exp2_table[32] = {
+    1073741824, 1097253708, 1121280436, 1145833280, 1170923762, 1196563654, 1222764986, 1249540052,
+    1276901417, 1304861917, 1333434672, 1362633090, 1392470869, 1422962010, 1454120821, 1485961921,
+    1518500250, 1551751076, 1585730000, 1620452965, 1655936265, 1692196547, 1729250827, 1767116489,
+    1805811301, 1845353420, 1885761398, 1927054196, 1969251188, 2012372174, 2056437387, 2101467502
+};
+
+typedef union {
+    double d;
+    u64 u;
+} DoubleBits;
+
+static inline u64 dblBits(double x) {
+    DoubleBits b;
+    b.d = x;
+    return b.u;
+}
+
+static inline s32 qmul(s32 a, s32 b) {
+    return (s32)(((s64)a * b) >> 30);
+}
+
+// mant * 2^exp2 をdoubleにする (浮動小数点演算を使わずビットを組み立てる)
+static double makeDouble(u64 mant, int exp2, bool negative) {
+    DoubleBits b;
+
+    if (mant == 0) return negative ? -0.0 : 0.0;
+
+    // 最上位bitをbit52に揃える
+    int shift = 11 - __builtin_clzll(mant);
+    if (shift > 0) {
+        mant = (mant + (1ULL << (shift - 1))) >> shift;
+        if (mant >> 53) {
+            mant >>= 1;
+            shift++;
+        }
+    } else {
+        mant <<= -shift;
+    }
+
+    int e = exp2 + shift + 52;
+    if (e > 1023) return negative ? -INFINITY : INFINITY;
+    if (e < -1022) return negative ? -0.0 : 0.0; // 非正規化数は0に丸める
+
+    b.u = ((u64)(e + 1023) << 52) | (mant & FRAC_MASK);
+    if (negative) b.u |= 1ULL << 63;
+    return b.d;
+}
+
+static inline double fromFixed(s64 v, int frac_bits) {
+    return v < 0 ? makeDouble((u64)-v, -frac_bits, true) : makeDouble((u64)v, -frac_bits, false);
+}
+
+// x * 2^frac_bits の整数部 (0方向に切り捨て)。結果が63bitに収まる範囲で使う
+static s64 toFixed(double x, int frac_bits) {
+    u64 bits = dblBits(x);
+    int e = (int)((bits >> 52) & 0x7FF);
+    if (e == 0) return 0; // 0と非正規化数
+
+    u64 mant = (bits & FRAC_MASK) | (1ULL << 52);
+    int shift = e - 1075 + frac_bits;
+    s64 v;
+    if (shift >= 0) v = (s64)(mant << shift);
+    else if (shift > -64) v = (s64)(mant >> -shift);
+    else v = 0;
+    return (bits >> 63) ? -v : v;
+}
+
+// 回転モード: angle (Q30, |angle| <= π/2) の cos, sin をQ30で
+// (CORDICの2つのループはグラフの描画で毎フレーム回るので、make TCM=1 ではITCMに置く)
+static TCM_CODE void cordicRotate(s32 angle, s32* cos_out, s32* sin_out) {
+    s32 x = CORDIC_GAIN_Q30;
+    s32 y = 0;
+    s32 z = angle;
+
+    for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+        s32 dx = x >> i;
+        s32 dy = y >> i;
+        if (z >= 0) {
+            x -= dy;
+            y += dx;
+            z -= cordic_atan[i];
+        } else {
+            x += dy;
+            y -= dx;
+            z += cordic_atan[i];
+        }
+    }
+    *cos_out = x;
+    *sin_out = y;
+}
+
+// ベクトルモード: atan2(y, x) (Q30)。x >= 0、|(x, y)| <= 2^29.5 (途中で1.65倍に伸びるため)
+static TCM_CODE s32 cordicVector(s32 x, s32 y) {
+    s32 z = 0;
+
+    for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+        s32 dx = x >> i;
+        s32 dy = y >> i;
+        if (y > 0) {
+            x += dy;
+            y -= dx;
+            z += cordic_atan[i];
+        } else {
+            x -= dy;
+            y += dx;
+            z -= cordic_atan[i];
+        }
+    }
+    return z;
+}
+
+// x = n * π/2 + r (|r| <= π/4) に分ける
+static bool reduceAngle(double x, double* r, int* quadrant) {
+    if (!(x > -SCI_TRIG_MAX && x < SCI_TRIG_MAX)) return false; // NaNもここで弾く
+
+    double t = x * TWO_OVER_PI;
+    s32 n = (s32)(t + (t >= 0 ? 0.5 : -0.5));
+    *r = (x - n * PI_2_HI) - n * PI_2_LO;
+    *quadrant = n & 3;
+    return true;
+}
+
+// sin r / r = 1 - r^2/6 + r^4/120 - r^6/5040 + r^8/362880 (r2 = r^2)
+static s32 sinSeries(s32 r2) {
+    return Q_ONE - qmul(r2, Q_1_6 - qmul(r2, Q_1_120 - qmul(r2, Q_1_5040 - qmul(r2, Q_1_362880))));
+}
+
+// |r| <= π/4 の sin, cos をQ30で
+static void sinCosQ30(s32 rq, s32* s, s32* c) {
+    if (rq > -SMALL_Q30 && rq < SMALL_Q30) {
+        s32 r2 = qmul(rq, rq);
+        *s = qmul(rq, sinSeries(r2));
+        // cos r = 1 - r^2/2 + r^4/24 - r^6/720 + r^8/40320
+        *c = Q_ONE - qmul(r2, Q_1_2 - qmul(r2, Q_1_24 - qmul(r2, Q_1_720 - qmul(r2, Q_1_40320))));
+    } else {
+        cordicRotate(rq, c, s);
+    }
+}
+
+// 0付近のsin rだけはrとの積で返して相対精度を保つ
+static double sinSmall(double r, s32 rq) {
+    return r * fromFixed(sinSeries(qmul(rq, rq)), 30);
+}
+
+double sci_sin(double x) {
+    double r;
+    int quadrant;
+    s32 s, c;
+
+    if (!reduceAngle(x, &r, &quadrant)) return NAN;
+    s32 rq = (s32)toFixed(r, 30);
+    sinCosQ30(rq, &s, &c);
+
+    switch (quadrant) {
+    case 0:  return (rq > -SMALL_Q30 && rq < SMALL_Q30) ? sinSmall(r, rq) : fromFixed(s, 30);
+    case 1:  return fromFixed(c, 30);
+    case 2:  return (rq > -SMALL_Q30 && rq < SMALL_Q30) ? -sinSmall(r, rq) : fromFixed(-s, 30);
+    default: return fromFixed(-c, 30);
+    }
+}
+
+double sci_cos(double x) {
+    double r;
+    int quadrant;
+    s32 s, c;
+
+    if (!reduceAngle(x, &r, &quadrant)) return NAN;
+    s32 rq = (s32)toFixed(r, 30);
+    sinCosQ30(rq, &s, &c);
+
+    switch (quadrant) {
+    case 0:  return fromFixed(c, 30);
+    case 1:  return (rq > -SMALL_Q30 && rq < SMALL_Q30) ? -sinSmall(r, rq) : fromFixed(-s, 30);
+    case 2:  return fromFixed(-c, 30);
+    default: return (rq > -SMALL_Q30 && rq < SMALL_Q30) ? sinSmall(r, rq) : fromFixed(s, 30);
+    }
+}
+
+double sci_tan(double x) {
+    double r;
+    int quadrant;
+    s32 s, c;
+
+    if (!reduceAngle(x, &r, &quadrant)) return NAN;
+    s32 rq = (s32)toFixed(r, 30);
+
+    if (rq > -SMALL_Q30 && rq < SMALL_Q30) {
+        // tan r = r(1 + r^2/3 + 2r^4/15 + 17r^6/315 + 62r^8/2835 + 1382r^10/155925)
+        s32 r2 = qmul(rq, rq);
+        s32 p = Q_62_2835 + qmul(r2, Q_1382_155925);
+        p = Q_ONE + qmul(r2, Q_1_3 + qmul(r2, Q_2_15 + qmul(r2, Q_17_315 + qmul(r2, p))));
+        double t = r * fromFixed(p, 30);
+        if (quadrant & 1) return t == 0.0 ? NAN : -hwmath_divDouble(1.0, t); // π/2付近のみ (まれ)
+        return t;
+    }
+
+    sinCosQ30(rq, &s, &c);
+    // 商はQ30。分母は sin(1/8) 以上あるのでオーバーフローしない
+    if (quadrant & 1) {
+        hwmath_divStart64((s64)c << 30, s);
+        return fromFixed(-hwmath_divResult(), 30);
+    }
+    hwmath_divStart64((s64)s << 30, c);
+    return fromFixed(hwmath_divResult(), 30);
+}
+
+double sci_atan(double v) {
+    if (isnan(v)) return v;
+    if (isinf(v)) return v > 0 ? SCI_PI / 2 : -SCI_PI / 2;
+
+    double av = v < 0 ? -v : v;
+    if (av < SMALL_ARG) {
+        // atan v = v(1 - v^2/3 + v^4/5 - v^6/7 + v^8/9 - v^10/11)
+        s32 vq = (s32)toFixed(v, 30);
+        s32 v2 = qmul(vq, vq);
+        s32 p = Q_1_7 - qmul(v2, Q_1_9 - qmul(v2, Q_1_11));
+        return v * fromFixed(Q_ONE - qmul(v2, Q_1_3 - qmul(v2, Q_1_5 - qmul(v2, p))), 30);
+    }
+
+    s32 z;
+    if (av <= 1.0) {
+        z = cordicVector(1 << 29, (s32)toFixed(av, 29));
+    } else {
+        // av = m * 2^e (e >= 0): y を [2^28, 2^29) に収め、x = 2^(28-e) とする
+        int e = (int)((dblBits(av) >> 52) & 0x7FF) - 1023;
+        s32 y = (s32)toFixed(av, 28 - e);
+        s32 x = e <= 28 ? 1 << (28 - e) : 0;
+        z = cordicVector(x, y);
+    }
+    return fromFixed(v < 0 ? -z : z, 30);
+}
+
+double sci_asin(double v) {
+    if (isnan(v) || v < -1.0 || v > 1.0) return NAN;
+
+    double av = v < 0 ? -v : v;
+    if (av < SMALL_ARG) {
+        // asin v = v(1 + v^2/6 + 3v^4/40 + 5v^6/112 + 35v^8/1152 + 63v^10/2816)
+        s32 vq = (s32)toFixed(v, 30);
+        s32 v2 = qmul(vq, vq);
+        s32 p = Q_5_112 + qmul(v2, Q_35_1152 + qmul(v2, Q_63_2816));
+        return v * fromFixed(Q_ONE + qmul(v2, Q_1_6 + qmul(v2, Q_3_40 + qmul(v2, p))), 30);
+    }
+
+    // ±1付近は 1 - v^2 が桁落ちするので asin v = π/2 - 2 asin(sqrt((1 - |v|)/2)) にする
+    // (1 - |v| は |v| > 0.5 なら誤差なしで引ける)
+    if (av > 0.5) {
+        double z = SCI_PI / 2 - 2.0 * sci_asin(sci_sqrt((1.0 - av) * 0.5));
+        return v < 0 ? -z : z;
+    }
+
+    // asin v = atan2(v, sqrt(1 - v^2)) (Q29で計算)
+    s32 y = (s32)toFixed(av, 29);
+    s32 x = (s32)hwmath_sqrt64((1ULL << 58) - (u64)((s64)y * y));
+    s32 z = cordicVector(x, y);
+    return fromFixed(v < 0 ? -z : z, 30);
+}
+
+double sci_acos(double v) {
+    if (isnan(v) || v < -1.0 || v > 1.0) return NAN;
+
+    // ±1付近は acos v = 2 asin(sqrt((1 - v)/2)) にして0付近の相対精度を保つ
+    if (v > 0.5) return 2.0 * sci_asin(sci_sqrt((1.0 - v) * 0.5));
+    if (v < -0.5) return SCI_PI - 2.0 * sci_asin(sci_sqrt((1.0 + v) * 0.5));
+    return SCI_PI / 2 - sci_asin(v);
+}
+
+// ln(1+r)/r = 1 - r/2 + r^2/3 - ... + r^6/7 (|r| < 1/32, Q30)
+static s32 lnSeries(s32 r) {
+    s32 p = Q_1_7;
+    p = Q_1_6 - qmul(r, p);
+    p = Q_1_5 - qmul(r, p);
+    p = Q_1_4 - qmul(r, p);
+    p = Q_1_3 - qmul(r, p);
+    p = Q_1_2 - qmul(r, p);
+    return Q_ONE - qmul(r, p);
+}
+
+double sci_ln(double x) {
+    if (isnan(x) || x < 0) return NAN;
+    if (x == 0) return -INFINITY;
+    if (isinf(x)) return x;
+
+    // 1付近は r = x - 1 との積で返して相対精度を保つ
+    if (x > 0.96875 && x < 1.03125) {
+        double r = x - 1.0;
+        return r * fromFixed(lnSeries((s32)toFixed(r, 30)), 30);
+    }
+
+    u64 bits = dblBits(x);
+    int e = (int)(bits >> 52) - 1023;
+    if (e == -1023) {
+        // 非正規化数は2^54倍して正規化する
+        bits = dblBits(x * 18014398509481984.0);
+        e = (int)(bits >> 52) - 1023 - 54;
+    }
+
+    // x = 2^e * m, m = c_k * (1 + r), c_k = 1 + k/32
+    u64 frac = bits & FRAC_MASK;
+    int k = (int)(frac >> 47);
+    s32 d = (s32)((frac >> 22) & ((1 << 25) - 1)); // m - c_k (Q30)
+    s32 r = qmul(d, ln_inv_table[k]);
+    s64 ln_m = ln_table[k] + qmul(r, lnSeries(r));
+
+    // e * ln2 は桁が大きいのでQ52で足す
+    return fromFixed((s64)e * LN2_Q52 + (ln_m << 22), 52);
+}
+
+double sci_log10(double x) {
+    return sci_ln(x) * INV_LN10;
+}
+
+double sci_exp(double x) {
+    if (isnan(x)) return x;
+    if (x > 709.78) return INFINITY;
+    if (x < -745.2) return 0.0;
+
+    // x = (32k + j) * ln2/32 + r, 0 <= r < ln2/32
+    double t = x * EXP_SCALE;
+    s32 n = (s32)t;
+    if (t < n) n--;
+    double r = (x - n * LN2_32_HI) - n * LN2_32_LO;
+    s32 rq = (s32)toFixed(r, 30);
+
+    // e^r = 1 + r(1 + r(1/2 + r(1/6 + r/24)))
+    s32 p = Q_1_24;
+    p = Q_1_6 + qmul(rq, p);
+    p = Q_1_2 + qmul(rq, p);
+    p = Q_ONE + qmul(rq, p);
+    p = Q_ONE + qmul(rq, p);
+
+    u64 m = ((u64)exp2_table[n & 31] * (u32)p) >> 30;
+    return makeDouble(m, (n >> 5) - 30, false);
+}
+
+double sci_pow(double x, double y) {
+    if (isnan(x) || isnan(y)) return NAN;
+    if (y == 0) return 1.0;
+
+    // 整数乗は掛け算で求める (2^10 などが誤差なく出るように)
+    if (y >= -SCI_POW_INT_MAX && y <= SCI_POW_INT_MAX && y == (double)(s32)y) {
+        s32 n = (s32)y;
+        u32 k = n < 0 ? -n : n;
+        double result = 1.0;
+        double base = x;
+        while (k) {
+            if (k & 1) result *= base;
+            base *= base;
+            k >>= 1;
+        }
+        if (n < 0) return result == 0.0 ? INFINITY : hwmath_divDouble(1.0, result);
+        return result;
+    }
+
+    if (x < 0) return NAN; // 負数の非整数乗は実数にならない
+    if (x == 0) return y > 0 ? 0.0 : INFINITY;
+    return sci_exp(y * sci_ln(x));
+}
+
+double sci_sqrt(double x) {
+    if (isnan(x) || x < 0) return NAN;
+    if (x == 0 || isinf(x)) return x;
+
+    u64 bits = dblBits(x);
+    int e = (int)(bits >> 52);
+    u64 mant = bits & FRAC_MASK;
+    if (e == 0) {
+        // 非正規化数
+        e = 1;
+        while (!(mant >> 52)) {
+            mant <<= 1;
+            e--;
+        }
+    } else {
+        mant |= 1ULL << 52;
+    }
+
+    // x = mant * 2^(e-1075)。仮数を63〜64bitに広げて指数を偶数にする
+    int ex = e - 1075 - 10;
+    mant <<= 10;
+    if (ex & 1) {
+        mant <<= 1;
+        ex--;
+    }
+    hwmath_sqrtStart64(mant);
+    ex /= 2; // 平方根ユニットの計算中に済ませる
+    return makeDouble(hwmath_sqrtResult(), ex, false);
+}
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+
+#define SCI_BENCH_SAMPLES 500
+#define SCI_BENCH_EDGES   64  // ±(1 - 2^-k), k = 2～33
+
+typedef struct {
+    const char* name;
+    double (*fn)(double);
+    double (*ref)(double);
+    double lo;
+    double hi;
+    bool edges;  // 誤差は±1のすぐ内側でも測る
+} SciBenchCase;
+
+static double sciPowHalf(double x) { return sci_pow(x, 2.5); }
+static double libmPowHalf(double x) { return pow(x, 2.5); }
+
+static const SciBenchCase sci_bench_cases[] = {
+    { "sin",  sci_sin,    sin,         -10.0,  10.0 },
+    { "cos",  sci_cos,    cos,         -10.0,  10.0 },
+    { "tan",  sci_tan,    tan,          -1.5,   1.5 },
+    { "asin", sci_asin,   asin,         -1.0,   1.0, true },
+    { "acos", sci_acos,   acos,         -1.0,   1.0, true },
+    { "atan", sci_atan,   atan,        -20.0,  20.0 },
+    { "ln",   sci_ln,     log,         0.001, 1000.0 },
+    { "log",  sci_log10,  log10,       0.001, 1000.0 },
+    { "exp",  sci_exp,    exp,         -20.0,  20.0 },
+    { "pow",  sciPowHalf, libmPowHalf,  0.01, 100.0 },
+    { "sqrt", sci_sqrt,   sqrt,          0.0,  1.0e6 },
+};
+
+static double sci_bench_input[SCI_BENCH_SAMPLES];
+
+static u32 sciBenchCycles(double (*fn)(double)) {
+    volatile double sink = 0;
+
+    bench_start();
+    for (int i = 0; i < SCI_BENCH_SAMPLES; i++) {
+        sink += fn(sci_bench_input[i]);
+    }
+    u64 ns = bench_elapsedNsec();
+    bench_stop();
+    (void)sink;
+    return bench_cyclesPerOp(ns, SCI_BENCH_SAMPLES);
+}
+
+void sci_benchmark(void) {
+    iprintf("fn    cycles  libm  max err\n");
+
+    for (u32 c = 0; c < sizeof(sci_bench_cases) / sizeof(sci_bench_cases[0]); c++) {
+        const SciBenchCase* bc = &sci_bench_cases[c];
+        double max_err = 0;
+
+        for (int i = 0; i < SCI_BENCH_SAMPLES + SCI_BENCH_EDGES; i++) {
+            double x;
+            if (i < SCI_BENCH_SAMPLES) {
+                x = bc->lo + (bc->hi - bc->lo) * i / (SCI_BENCH_SAMPLES - 1);
+                sci_bench_input[i] = x;
+            } else if (bc->edges) {
+                int e = i - SCI_BENCH_SAMPLES;
+                x = 1.0 - ldexp(1.0, -(2 + e / 2));
+                if (e & 1) x = -x;
+            } else {
+                break;
+            }
+
+            // 真値が小さいところは絶対誤差、それ以外は相対誤差
+            double want = bc->ref(x);
+            double err = bc->fn(x) - want;
+            if (err < 0) err = -err;
+            if (want > 1e-6 || want < -1e-6) err /= (want < 0 ? -want : want);
+            if (err > max_err) max_err = err;
+        }
+
+        u32 ours = sciBenchCycles(bc->fn);
+        u32 libm = sciBenchCycles(bc->ref);
+        iprintf("%-4s %7lu %6lu %5lu ppb\n", bc->name,
+                (unsigned long)ours, (unsigned long)libm, (unsigned long)(max_err * 1e9 + 0.5));
+    }
+}
+#endif
@@ -0,0 +1,44 @@
+#ifndef SCI_MATH_H
+#define SCI_MATH_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 関数電卓用の初等関数
+// 内部は固定小数点(Q30)で計算する: 三角関数はCORDIC、ln/expは表+多項式、
+// 平方根とtanの割り算はハードウェアユニット(hw_math.h)を使う。
+// 精度は相対誤差でおよそ1e-7 (SCI_MAX_ERROR。表示の%.6gには十分だが、8桁目は信用できない)。
+// 誤差の大半はQ30の絶対誤差で、値が0.1程度まで小さくなると相対誤差が1e-7に近づく。
+// 角度はラジアン。定義域外やオーバーフローではNaNまたは無限大を返す。
+
+double sci_sin(double x);
+double sci_cos(double x);
+double sci_tan(double x);
+double sci_asin(double x);
+double sci_acos(double x);
+double sci_atan(double x);
+double sci_ln(double x);
+double sci_log10(double x);
+double sci_exp(double x);
+double sci_pow(double x, double y);
+double sci_sqrt(double x);
+
+#define SCI_PI 3.14159265358979323846
+#define SCI_E  2.71828182845904523536
+
+// libmとの最大相対誤差 (真値が1e-6未満では絶対誤差)。tests/sci_math_test.c で確かめている
+#define SCI_MAX_ERROR 2e-7
+
+#ifdef ENABLE_BENCHMARK
+// libmとの誤差(最大相対誤差)と1回あたりのサイクル数を表示する
+void sci_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCI_MATH_H
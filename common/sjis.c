@@ -0,0 +1,259 @@
+#include <string.h>
+
+#include "sjis.h"
+
+#define SJIS_S SJIS_F_SINGLE
+#define SJIS_L (SJIS_F_LEAD | SJIS_F_TRAIL)
+#define SJIS_T (SJIS_F_SINGLE | SJIS_F_TRAIL)
+
+// バイト分類テーブル
+// 0x80, 0xA0, 0xFD-0xFFはどの役割にもならない (不正バイト)
+const u8 sjis_byte_class[256] = {
+    [0x00 ... 0x3F] = SJIS_S,
+    [0x40 ... 0x7E] = SJIS_T,        // ASCIIだがtrailにもなる
+    [0x7F]          = SJIS_S,
+    [0x80]          = SJIS_F_TRAIL,
+    [0x81 ... 0x9F] = SJIS_L,
+    [0xA0]          = SJIS_F_TRAIL,
+    [0xA1 ... 0xDF] = SJIS_T,        // 半角カナ
+    [0xE0 ... 0xFC] = SJIS_L,
+    ['\r']          = SJIS_S | SJIS_F_CR,
+};
+
+#undef SJIS_S
+#undef SJIS_L
+#undef SJIS_T
+
+bool sjis_next(SjisIter* it, u16* code) {
+    if (it->pending) {
+        if (it->cur >= it->end) return false;
+        u8 lead = it->pending;
+        it->pending = 0;
+        if (lead == '\r') {
+            if (*it->cur == '\n') it->cur++;
+            *code = '\n';
+        } else if (sjis_byte_class[*it->cur] & SJIS_F_TRAIL) {
+            *code = (u16)((lead << 8) | *it->cur++);
+        } else {
+            *code = SJIS_INVALID; // trailは消費せず次の文字として読み直す
+        }
+        return true;
+    }
+
+    if (it->cur >= it->end) return false;
+
+    u8 c = *it->cur++;
+    u8 cls = sjis_byte_class[c];
+
+    if (cls & SJIS_F_LEAD) {
+        if (it->cur >= it->end) {
+            it->pending = c; // 次のチャンクを待つ
+            return false;
+        }
+        if (sjis_byte_class[*it->cur] & SJIS_F_TRAIL) {
+            *code = (u16)((c << 8) | *it->cur++);
+        } else {
+            *code = SJIS_INVALID;
+        }
+        return true;
+    }
+
+    if (cls & SJIS_F_CR) {
+        if (it->cur >= it->end) {
+            it->pending = '\r';
+            return false;
+        }
+        if (*it->cur == '\n') it->cur++;
+        *code = '\n';
+        return true;
+    }
+
+    *code = (cls & SJIS_F_SINGLE) ? c : SJIS_INVALID;
+    return true;
+}
+
+bool sjis_flush(SjisIter* it, u16* code) {
+    if (!it->pending) return false;
+    *code = (it->pending == '\r') ? '\n' : SJIS_INVALID;
+    it->pending = 0;
+    return true;
+}
+
+u32 sjis_asciiRun(const u8* data, u32 size) {
+    u32 n = 0;
+
+    // 4バイト境界までは1バイトずつ
+    while (n < size && ((uintptr_t)(data + n) & 3)) {
+        if (data[n] & 0x80) return n;
+        n++;
+    }
+    // ワード単位で最上位ビットをまとめて調べる
+    // (u8の配列をu32*で読むと別名規則に反するのでmemcpyにする。境界は揃っているのでldr 1つになる)
+    while (n + 4 <= size) {
+        u32 w;
+        memcpy(&w, data + n, 4);
+        if (w & 0x80808080) break;
+        n += 4;
+    }
+    while (n < size && !(data[n] & 0x80)) n++;
+    return n;
+}
+
+bool sjis_validate(const u8* data, u32 size) {
+    u32 i = 0;
+    while (i < size) {
+        i += sjis_asciiRun(data + i, size - i);
+        if (i >= size) break;
+
+        u8 cls = sjis_byte_class[data[i]];
+        if (cls & SJIS_F_LEAD) {
+            if (i + 1 >= size || !(sjis_byte_class[data[i + 1]] & SJIS_F_TRAIL)) return false;
+            i += 2;
+        } else if (cls & SJIS_F_SINGLE) {
+            i++;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+u32 sjis_countChars(const u8* data, u32 size) {
+    SjisIter it;
+    u16 code;
+    u32 count = 0;
+
+    sjis_iterInit(&it, data, size);
+    while (sjis_next(&it, &code)) count++;
+    if (sjis_flush(&it, &code)) count++;
+    return count;
+}
+
+u16 sjis_toCodepoint(u16 code) {
+    if (code < 0x80) return code;
+    if (code >= 0xA1 && code <= 0xDF) return (u16)(0xFF61 + (code - 0xA1));
+    if (code < 0x100 || code == SJIS_INVALID) return 0xFFFD;
+
+    u8 lead = code >> 8;
+    u8 trail = code & 0xFF;
+    int li, ti;
+
+    if (lead >= 0x81 && lead <= 0x9F) li = lead - 0x81;
+    else if (lead >= 0xE0 && lead <= 0xFC) li = lead - 0xE0 + 31;
+    else return 0xFFFD;
+
+    if (trail >= 0x40 && trail <= 0x7E) ti = trail - 0x40;
+    else if (trail >= 0x80 && trail <= 0xFC) ti = trail - 0x80 + 63;
+    else return 0xFFFD;
+
+    u16 cp = sjis_unicode_table[li * SJIS_TRAIL_COUNT + ti];
+    return cp ? cp : 0xFFFD;
+}
+
+u32 sjis_toCodepoints(const u8* data, u32 size, u16* out, u32 out_max) {
+    SjisIter it;
+    u16 code;
+    u32 n = 0;
+
+    sjis_iterInit(&it, data, size);
+    while (n < out_max && sjis_next(&it, &code)) {
+        out[n++] = sjis_toCodepoint(code);
+    }
+    if (n < out_max && sjis_flush(&it, &code)) {
+        out[n++] = sjis_toCodepoint(code);
+    }
+    return n;
+}
+
+u32 sjis_toUtf8(const u8* data, u32 size, char* out, u32 out_size) {
+    SjisIter it;
+    u16 code;
+    u32 n = 0;
+
+    if (out_size == 0) return 0;
+    out_size--; // '\0'の分
+
+    sjis_iterInit(&it, data, size);
+    for (;;) {
+        // ASCIIの連続はまとめてコピーする (CRは改行処理のため除外)
+        u32 run = sjis_asciiRun(it.cur, (u32)(it.end - it.cur));
+        if (run > 0 && !it.pending) {
+            const u8* cr = memchr(it.cur, '\r', run);
+            if (cr) run = (u32)(cr - it.cur);
+            if (run > out_size - n) run = out_size - n;
+            memcpy(out + n, it.cur, run);
+            it.cur += run;
+            n += run;
+        }
+
+        if (!sjis_next(&it, &code) && !sjis_flush(&it, &code)) break;
+
+        u16 cp = sjis_toCodepoint(code);
+        if (cp < 0x80) {
+            if (n + 1 > out_size) break;
+            out[n++] = (char)cp;
+        } else if (cp < 0x800) {
+            if (n + 2 > out_size) break;
+            out[n++] = (char)(0xC0 | (cp >> 6));
+            out[n++] = (char)(0x80 | (cp & 0x3F));
+        } else {
+            if (n + 3 > out_size) break;
+            out[n++] = (char)(0xE0 | (cp >> 12));
+            out[n++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            out[n++] = (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    out[n] = '\0';
+    return n;
+}
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+
+static char sjis_bench_utf8[32 * 1024];
+
+void sjis_benchmark(const u8* data, u32 size, int iterations) {
+    SjisIter it;
+    u16 code;
+    u32 sum = 0;
+    u64 ns;
+
+    iprintf("SJIS bench: %lu bytes x %d\n", (unsigned long)size, iterations);
+
+    // 1. チェック付きイテレータ
+    bench_start();
+    for (int i = 0; i < iterations; i++) {
+        sjis_iterInit(&it, data, size);
+        while (sjis_next(&it, &code)) sum += code;
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" next     : %lu KB/s\n",
+            (unsigned long)((u64)size * iterations * 1000000ULL / (ns / 1000 + 1) / 1024));
+
+    // 2. 検証済み高速パス
+    bench_start();
+    for (int i = 0; i < iterations; i++) {
+        if (!sjis_validate(data, size)) break;
+        sjis_iterInit(&it, data, size);
+        while (it.cur < it.end) sum += sjis_nextUnchecked(&it);
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" validated: %lu KB/s\n",
+            (unsigned long)((u64)size * iterations * 1000000ULL / (ns / 1000 + 1) / 1024));
+
+    // 3. UTF-8変換 (バッファに収まらない分は切り捨て)
+    bench_start();
+    for (int i = 0; i < iterations; i++) {
+        sum += sjis_toUtf8(data, size, sjis_bench_utf8, sizeof(sjis_bench_utf8));
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" utf8     : %lu KB/s\n",
+            (unsigned long)((u64)size * iterations * 1000000ULL / (ns / 1000 + 1) / 1024));
+
+    iprintf(" (checksum %lu)\n", (unsigned long)sum);
+}
+#endif
@@ -0,0 +1,104 @@
+#ifndef SJIS_H
+#define SJIS_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Shift-JISストリームデコーダ
+//
+// 返すコードはdrawFont()と同じ形式:
+//   0x00-0xFF  : 1バイト文字 (ASCII / 半角カナ 0xA1-0xDF)
+//   0x8140以上 : 2バイト文字 (lead << 8 | trail)
+// 改行はCRLF・CR・LFのいずれも '\n' 1文字に畳み込む。
+// 不正なバイトはSJIS_INVALIDとして1バイトだけ消費し、次のバイトから再同期する。
+
+#define SJIS_INVALID 0xFFFF
+
+// バイト分類テーブルのフラグ
+#define SJIS_F_SINGLE 0x01 // 単独で1文字になるバイト
+#define SJIS_F_LEAD   0x02 // 2バイト文字の1バイト目
+#define SJIS_F_TRAIL  0x04 // 2バイト文字の2バイト目になれるバイト
+#define SJIS_F_CR     0x08 // '\r'
+
+extern const u8 sjis_byte_class[256];
+
+// バイト列の上を進むだけのイテレータ (コピーなし)
+// チャンク境界で2バイト文字やCRLFが分断されてもpendingに持ち越すので、
+// ブロック単位で展開したテキストにもそのまま使える。
+typedef struct {
+    const u8* cur;
+    const u8* end;
+    u8 pending; // 前のチャンク末尾に残ったリードバイトまたは'\r' (0なら無し)
+} SjisIter;
+
+static inline void sjis_iterInit(SjisIter* it, const u8* data, u32 size) {
+    it->cur = data;
+    it->end = data + size;
+    it->pending = 0;
+}
+
+// 次のチャンクを与える (pendingは保持される)
+static inline void sjis_iterFeed(SjisIter* it, const u8* data, u32 size) {
+    it->cur = data;
+    it->end = data + size;
+}
+
+// 次の1文字を*codeに返す。チャンクを使い切った(またはpendingの相方待ち)ならfalse。
+bool sjis_next(SjisIter* it, u16* code);
+
+// ストリーム終端でpendingに残った文字を取り出す。無ければfalse。
+bool sjis_flush(SjisIter* it, u16* code);
+
+// 検証済みバッファ用の高速版 (trailの範囲チェックと末尾チェックを省略)
+// sjis_validate()が真を返したバイト列にのみ使うこと。
+static inline u16 sjis_nextUnchecked(SjisIter* it) {
+    u8 c = *it->cur++;
+    u8 cls = sjis_byte_class[c];
+    if (cls & SJIS_F_LEAD) {
+        return (u16)((c << 8) | *it->cur++);
+    }
+    if (cls & SJIS_F_CR) {
+        if (it->cur < it->end && *it->cur == '\n') it->cur++;
+        return '\n';
+    }
+    return c;
+}
+
+// バイト列全体が正しいSJISか検証する (末尾で2バイト文字が切れていても不正)
+bool sjis_validate(const u8* data, u32 size);
+
+// 先頭から続くASCII(0x00-0x7F)のバイト数を返す。4バイト単位で調べる。
+u32 sjis_asciiRun(const u8* data, u32 size);
+
+// 文字数を数える (改行の畳み込み後)
+u32 sjis_countChars(const u8* data, u32 size);
+
+// Unicodeへの変換 (sjis_table.cの対応表を使う)
+#define SJIS_LEAD_COUNT  60  // 0x81-0x9F, 0xE0-0xFC
+#define SJIS_TRAIL_COUNT 188 // 0x40-0x7E, 0x80-0xFC
+
+extern const u16 sjis_unicode_table[SJIS_LEAD_COUNT * SJIS_TRAIL_COUNT];
+
+// SJISコード1文字をコードポイントに変換する。対応が無ければU+FFFD。
+u16 sjis_toCodepoint(u16 code);
+
+// バイト列をコードポイント列に変換する。書き込んだ文字数を返す。
+u32 sjis_toCodepoints(const u8* data, u32 size, u16* out, u32 out_max);
+
+// バイト列をUTF-8に変換する。終端の'\0'を含めずに書き込んだバイト数を返す。
+// out_sizeに収まらない文字の手前で止まる。outは常に'\0'終端される (out_size > 0のとき)。
+u32 sjis_toUtf8(const u8* data, u32 size, char* out, u32 out_size);
+
+#ifdef ENABLE_BENCHMARK
+// dataを繰り返しデコードしてバイト/秒を表示する
+void sjis_benchmark(const u8* data, u32 size, int iterations);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SJIS_H
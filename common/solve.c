@@ -0,0 +1,631 @@
+#include <math.h>
+#include <string.h>
+
+#include "solve.h"
+#include "hw_math.h"
+#include "sci_math.h"
+
+#ifdef ENABLE_BENCHMARK
+#include <stdio.h>
+#include "bench.h"
+#endif
+
+// 解: xの相対誤差がこれより小さくなったら止める
+#define SOLVE_X_TOL 1e-12
+#define SOLVE_NEWTON_MAX 60
+#define SOLVE_BRACKET_MAX 400
+// 符号の変わる区間を探す範囲 (初期値からの距離)
+#define SOLVE_SCAN_LIMIT 1e30
+
+// 多項式: 値を取る点は -4.5, -3.5, ..., 4.5
+#define SOLVE_POLY_SAMPLES (SOLVE_POLY_MAX_DEGREE + 2)
+#define SOLVE_POLY_DIFF_TOL 1e-10  // 0とみなす差分 (値の大きさに対して)
+#define SOLVE_POLY_CHECK_TOL 1e-7  // 格子の外で合っているとみなす差
+#define SOLVE_POLY_ITER_MAX 500
+#define SOLVE_POLY_TOL 1e-14
+#define SOLVE_POLY_REAL_TOL 1e-7   // 虚部がこれより小さい根は実数の根にする
+
+// 積分: 式の値にはsci_mathの誤差 (相対でSCI_MAX_ERROR程度) が乗るので、各点の |f| に
+// SOLVE_EVAL_ERRORを掛けた分を誤差の見積もりに足す。この分は区間を分けても減らない
+// ので、打ち切り誤差がそれを下回ったら止める
+#define SOLVE_EVAL_ERROR SCI_MAX_ERROR
+#define SOLVE_INTEGRAL_REL SCI_MAX_ERROR
+#define SOLVE_INTEGRAL_ABS 1e-12
+
+// 微分: Riddersの表の大きさと、1段ごとに刻みを縮める比
+#define RIDDERS_TABLE 10
+#define RIDDERS_SHRINK 1.4
+
+enum {
+    PHASE_NEWTON,
+    PHASE_SCAN,
+    PHASE_BRACKET
+};
+
+static double absOf(double x) { return x < 0 ? -x : x; }
+static double maxOf(double a, double b) { return a > b ? a : b; }
+
+static double evalAt(SolveJob* job, double x) {
+    job->evals++;
+    return expr_eval(job->prog, x);
+}
+
+static void startJob(SolveJob* job, const ExprProgram* prog, SolveKind kind) {
+    job->prog = prog;
+    job->kind = kind;
+    job->state = SOLVE_RUNNING;
+    job->error = NULL;
+    job->evals = 0;
+    job->progress = 0;
+    job->phase = 0;
+    job->iter = 0;
+}
+
+static void finish(SolveJob* job) {
+    job->state = SOLVE_DONE;
+    job->progress = 100;
+}
+
+static void fail(SolveJob* job, const char* error) {
+    job->state = SOLVE_FAILED;
+    job->error = error;
+}
+
+// start から target まで縮めるうち、now までの割合 (対数で)
+static u8 progressOf(double start, double now, double target) {
+    if (!(now < start) || !(target < start)) return 0;
+    if (now <= target) return 99;
+    double p = log(start / now) / log(start / target) * 100.0;
+    return p >= 99.0 ? 99 : (u8)p;
+}
+
+// ---- 解 ----
+
+// 中心差分 (刻みは倍精度の誤差の3乗根くらい)
+static double slopeAt(SolveJob* job, double x) {
+    double h = 6e-6 * maxOf(1.0, absOf(x));
+    double d = evalAt(job, x + h) - evalAt(job, x - h);
+    return isfinite(d) ? hwmath_divDouble(d, 2.0 * h) : NAN;
+}
+
+static void startBracket(SolveJob* job, double a, double fa, double b, double fb) {
+    if (fa == 0.0 || fb == 0.0) {
+        job->x = fa == 0.0 ? a : b;
+        job->fx = 0.0;
+        finish(job);
+        return;
+    }
+    if (a > b) {
+        double t = a; a = b; b = t;
+        t = fa; fa = fb; fb = t;
+    }
+    job->lo = a;
+    job->flo = fa;
+    job->hi = b;
+    job->fhi = fb;
+    // |f| の小さい方の端から始める
+    bool from_lo = absOf(fa) < absOf(fb);
+    job->x = from_lo ? a : b;
+    job->fx = from_lo ? fa : fb;
+    job->dx_old = b - a;
+    job->width0 = b - a;
+    job->fmax0 = maxOf(absOf(fa), absOf(fb));
+    job->phase = PHASE_BRACKET;
+    job->iter = 0;
+}
+
+static void startScan(SolveJob* job) {
+    job->phase = PHASE_SCAN;
+    job->iter = 0;
+    job->step = 0.1 * maxOf(1.0, absOf(job->origin));
+    job->left = job->right = job->origin;
+    job->fleft = job->fright = evalAt(job, job->origin);
+}
+
+static void newtonStep(SolveJob* job) {
+    double d = slopeAt(job, job->x);
+    if (!isfinite(d) || d == 0.0 || ++job->iter > SOLVE_NEWTON_MAX) {
+        startScan(job);
+        return;
+    }
+
+    double xn = job->x - hwmath_divDouble(job->fx, d);
+    double fn = evalAt(job, xn);
+    if (!isfinite(fn)) {
+        startScan(job);
+        return;
+    }
+    if ((fn < 0) != (job->fx < 0) || fn == 0.0) {
+        // 根をまたいだので、ここからは区間の中だけで進める
+        startBracket(job, job->x, job->fx, xn, fn);
+        return;
+    }
+
+    bool converged = absOf(xn - job->x) <= SOLVE_X_TOL * maxOf(1.0, absOf(xn));
+    job->x = xn;
+    job->fx = fn;
+    if (converged) finish(job);
+    else job->progress = (u8)(job->iter * 50 / SOLVE_NEWTON_MAX);
+}
+
+// 初期値の両側に、倍々に離れた点で符号が変わるところを探す
+static void scanStep(SolveJob* job) {
+    if (job->step > SOLVE_SCAN_LIMIT) {
+        fail(job, "no sign change");
+        return;
+    }
+
+    double r = job->origin + job->step;
+    double l = job->origin - job->step;
+    double fr = evalAt(job, r);
+    double fl = evalAt(job, l);
+    // 値の無いところをはさんだ符号の変化は使わない
+    if (isfinite(fr) && isfinite(job->fright) && (fr < 0) != (job->fright < 0)) {
+        startBracket(job, job->right, job->fright, r, fr);
+        return;
+    }
+    if (isfinite(fl) && isfinite(job->fleft) && (fl < 0) != (job->fleft < 0)) {
+        startBracket(job, l, fl, job->left, job->fleft);
+        return;
+    }
+
+    job->right = r;
+    job->fright = fr;
+    job->left = l;
+    job->fleft = fl;
+    job->step *= 2.0;
+    job->iter++;
+    job->progress = (u8)(job->iter * 50 / 100); // 100回で SOLVE_SCAN_LIMIT に届く
+    if (job->progress > 50) job->progress = 50;
+}
+
+// 符号の変わる区間 [lo, hi] の中のNewton法。外に出るか、前の歩幅の半分より
+// 縮まないときは二分法にする
+static void bracketStep(SolveJob* job) {
+    double dx = 0.0, xn = 0.0;
+    double d = slopeAt(job, job->x);
+    bool newton = isfinite(d) && d != 0.0;
+    if (newton) {
+        dx = hwmath_divDouble(job->fx, d);
+        xn = job->x - dx;
+        newton = xn > job->lo && xn < job->hi && absOf(2.0 * dx) <= absOf(job->dx_old);
+    }
+    if (!newton) {
+        dx = 0.5 * (job->hi - job->lo);
+        xn = job->lo + dx;
+    }
+
+    double fn = evalAt(job, xn);
+    if (!isfinite(fn) && newton) {
+        dx = 0.5 * (job->hi - job->lo);
+        xn = job->lo + dx;
+        fn = evalAt(job, xn);
+    }
+    if (!isfinite(fn)) {
+        fail(job, "undefined");
+        return;
+    }
+
+    job->dx_old = dx;
+    if ((fn < 0) == (job->flo < 0)) {
+        job->lo = xn;
+        job->flo = fn;
+    } else {
+        job->hi = xn;
+        job->fhi = fn;
+    }
+    job->x = xn;
+    job->fx = fn;
+
+    double tol = SOLVE_X_TOL * maxOf(1.0, absOf(xn));
+    double width = job->hi - job->lo;
+    if (fn == 0.0 || width <= tol || absOf(dx) <= tol || ++job->iter >= SOLVE_BRACKET_MAX) {
+        // 符号が変わっても |f| が大きくなっていくなら根ではなく極 (1/x など)
+        if (absOf(fn) > job->fmax0) fail(job, "pole, no root");
+        else finish(job);
+        return;
+    }
+    double left = absOf(dx) < width ? absOf(dx) : width;
+    job->progress = 50 + progressOf(job->width0, left, tol) / 2;
+}
+
+void solve_startRoot(SolveJob* job, const ExprProgram* prog, double x0) {
+    startJob(job, prog, SOLVE_ROOT);
+    job->origin = x0;
+    job->x = x0;
+    job->fx = evalAt(job, x0);
+    if (job->fx == 0.0) {
+        finish(job);
+    } else if (isfinite(job->fx)) {
+        job->phase = PHASE_NEWTON;
+    } else {
+        startScan(job);
+    }
+}
+
+// ---- 多項式の根 ----
+
+static double nodeOf(int i) {
+    return i - 0.5 * (SOLVE_POLY_SAMPLES - 1);
+}
+
+static double polyEval(const SolveJob* job, double x) {
+    double v = job->coeff[job->degree];
+    for (int k = job->degree - 1; k >= 0; k--) v = v * x + job->coeff[k];
+    return v;
+}
+
+void solve_startPoly(SolveJob* job, const ExprProgram* prog) {
+    startJob(job, prog, SOLVE_POLY);
+
+    double diff[SOLVE_POLY_SAMPLES];
+    double scale = 0.0;
+    for (int i = 0; i < SOLVE_POLY_SAMPLES; i++) {
+        diff[i] = evalAt(job, nodeOf(i));
+        if (!isfinite(diff[i])) {
+            fail(job, "not a polynomial");
+            return;
+        }
+        scale = maxOf(scale, absOf(diff[i]));
+    }
+
+    // 前進差分 diff[k] = Δ^k f(x_0)。丸めの誤差はk階でおよそ2^k倍になる
+    for (int k = 1; k < SOLVE_POLY_SAMPLES; k++) {
+        for (int i = SOLVE_POLY_SAMPLES - 1; i >= k; i--) diff[i] -= diff[i - 1];
+    }
+    int degree = -1;
+    double tol = SOLVE_POLY_DIFF_TOL * scale;
+    for (int k = 0; k < SOLVE_POLY_SAMPLES; k++, tol *= 2.0) {
+        if (absOf(diff[k]) > tol) degree = k;
+    }
+    if (degree > SOLVE_POLY_MAX_DEGREE) {
+        fail(job, "not a polynomial");
+        return;
+    }
+    if (degree < 1) {
+        fail(job, "no roots (constant)");
+        return;
+    }
+
+    // 刻み1のNewton補間 p(x) = Σ Δ^k f / k! (x - x_0)...(x - x_{k-1}) を
+    // 高い次から展開して x^k の係数にする
+    double* p = job->coeff;
+    double factorial = 1.0;
+    for (int k = 1; k <= degree; k++) factorial *= k;
+    memset(p, 0, sizeof(job->coeff));
+    p[0] = diff[degree] / factorial;
+    for (int k = degree - 1; k >= 0; k--) {
+        factorial /= k + 1;
+        double xk = nodeOf(k);
+        for (int j = degree - k; j > 0; j--) p[j] = p[j - 1] - xk * p[j];
+        p[0] = -xk * p[0] + diff[k] / factorial;
+    }
+    job->degree = degree;
+
+    // 格子から外れた点でも合うか (sin(pi x) などは格子点の値だけなら多項式に見える)
+    static const double check_x[] = {0.3, -2.7, 6.1};
+    for (int i = 0; i < (int)(sizeof(check_x) / sizeof(check_x[0])); i++) {
+        double fx = evalAt(job, check_x[i]);
+        if (!isfinite(fx) || absOf(polyEval(job, check_x[i]) - fx) > SOLVE_POLY_CHECK_TOL * maxOf(scale, absOf(fx))) {
+            fail(job, "not a polynomial");
+            return;
+        }
+    }
+
+    if (degree == 1) {
+        job->roots[0] = complex_make(hwmath_divDouble(-p[0], p[1]), 0.0);
+        finish(job);
+        return;
+    }
+
+    // 初期値: 根の大きさの上限 (Cauchy) の円の上に、実軸に対して対称にならないようずらして並べる
+    double bound = 0.0;
+    for (int k = 0; k < degree; k++) bound = maxOf(bound, absOf(hwmath_divDouble(p[k], p[degree])));
+    bound += 1.0;
+    for (int i = 0; i < degree; i++) {
+        job->roots[i] = complex_fromPolar(bound, 2.0 * 3.14159265358979323846 * i / degree + 0.4);
+    }
+    job->change0 = 0.0;
+}
+
+// 実数の根をNewton法で仕上げる (|p| が小さくなるときだけ進める)
+static double polishReal(const SolveJob* job, double x) {
+    for (int i = 0; i < 3; i++) {
+        double v = job->coeff[job->degree], d = 0.0;
+        for (int k = job->degree - 1; k >= 0; k--) {
+            d = d * x + v;
+            v = v * x + job->coeff[k];
+        }
+        if (v == 0.0 || d == 0.0) break;
+        double xn = x - hwmath_divDouble(v, d);
+        if (!(absOf(polyEval(job, xn)) < absOf(v))) break;
+        x = xn;
+    }
+    return x;
+}
+
+// 実数の根が先、それぞれ実部 (同じなら虚部) の小さい順
+static bool rootBefore(Complex a, Complex b) {
+    if ((a.im == 0.0) != (b.im == 0.0)) return a.im == 0.0;
+    if (a.re != b.re) return a.re < b.re;
+    return a.im < b.im;
+}
+
+static void polyFinish(SolveJob* job) {
+    for (int i = 0; i < job->degree; i++) {
+        Complex z = job->roots[i];
+        if (absOf(z.im) <= SOLVE_POLY_REAL_TOL * (1.0 + complex_abs(z))) {
+            job->roots[i] = complex_make(polishReal(job, z.re), 0.0);
+        } else if (absOf(z.re) <= SOLVE_POLY_TOL * complex_abs(z)) {
+            job->roots[i] = complex_make(0.0, z.im); // ±i が 1e-17±i にならないように
+        }
+    }
+    for (int i = 1; i < job->degree; i++) {
+        Complex z = job->roots[i];
+        int j = i;
+        for (; j > 0 && rootBefore(z, job->roots[j - 1]); j--) job->roots[j] = job->roots[j - 1];
+        job->roots[j] = z;
+    }
+    finish(job);
+}
+
+// Durand-Kerner法の1周: z_i -= p(z_i) / Π(z_i - z_j)。更新した根はすぐ次の根に使う
+static void polyStep(SolveJob* job) {
+    int n = job->degree;
+    double monic[SOLVE_POLY_MAX_DEGREE];
+    for (int k = 0; k < n; k++) monic[k] = hwmath_divDouble(job->coeff[k], job->coeff[n]);
+
+    double change = 0.0;
+    for (int i = 0; i < n; i++) {
+        Complex z = job->roots[i];
+        Complex v = complex_make(1.0, 0.0);
+        for (int k = n - 1; k >= 0; k--) v = complex_add(complex_mul(v, z), complex_make(monic[k], 0.0));
+        Complex den = complex_make(1.0, 0.0);
+        for (int j = 0; j < n; j++) {
+            if (j != i) den = complex_mul(den, complex_sub(z, job->roots[j]));
+        }
+
+        Complex w;
+        if (!complex_div(&w, v, den)) w = complex_make(1e-8 * (1.0 + complex_abs(z)), 0.0); // 重なったらずらす
+        job->roots[i] = complex_sub(z, w);
+        change = maxOf(change, complex_abs(w) / (1.0 + complex_abs(z)));
+    }
+    job->evals += n; // 評価の回数の代わりに根の数だけ進める
+
+    if (job->iter++ == 0) job->change0 = change;
+    if (!isfinite(change)) {
+        fail(job, "no convergence");
+    } else if (change <= SOLVE_POLY_TOL || job->iter >= SOLVE_POLY_ITER_MAX) {
+        polyFinish(job);
+    } else {
+        job->progress = progressOf(job->change0, change, SOLVE_POLY_TOL);
+    }
+}
+
+// ---- 積分 ----
+
+// 15点Kronrodの節点 (0を除く正の側、外側から) と重み。奇数番目の節点が7点Gaussの節点
+static const double kronrod_x[7] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245
+};
+static const double kronrod_w[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714 // 中心
+};
+static const double gauss_w[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327 // 中心
+};
+
+// [a, b] の15点Kronrodと7点Gauss。値の無い点があればfalse
+static bool kronrod(SolveJob* job, double a, double b, SolveInterval* out) {
+    double c = 0.5 * (a + b);
+    double h = 0.5 * (b - a);
+    double fc = evalAt(job, c);
+    double k = fc * kronrod_w[7];
+    double g = fc * gauss_w[3];
+    double k_abs = absOf(fc) * kronrod_w[7];
+    for (int j = 0; j < 7; j++) {
+        double dx = h * kronrod_x[j];
+        double f1 = evalAt(job, c - dx);
+        double f2 = evalAt(job, c + dx);
+        k += kronrod_w[j] * (f1 + f2);
+        k_abs += kronrod_w[j] * (absOf(f1) + absOf(f2));
+        if (j & 1) g += gauss_w[j >> 1] * (f1 + f2);
+    }
+    if (!isfinite(k)) return false;
+
+    out->a = a;
+    out->b = b;
+    out->value = k * h;
+    out->error = absOf((k - g) * h);
+    out->noise = SOLVE_EVAL_ERROR * k_abs * absOf(h);
+    return true;
+}
+
+// 値と誤差の見積もり (打ち切り誤差 + 評価の誤差) を足し合わせ、打ち切り誤差の和を返す
+static double sumIntervals(SolveJob* job) {
+    double truncation = 0.0;
+    job->value = 0.0;
+    job->value_error = 0.0;
+    for (int i = 0; i < job->interval_count; i++) {
+        job->value += job->intervals[i].value;
+        job->value_error += job->intervals[i].error + job->intervals[i].noise;
+        truncation += job->intervals[i].error;
+    }
+    return truncation;
+}
+
+// 打ち切り誤差の目標。評価の誤差より細かくしても意味がない
+static double integralTarget(const SolveJob* job, double truncation) {
+    double noise = job->value_error - truncation;
+    return maxOf(maxOf(SOLVE_INTEGRAL_ABS, SOLVE_INTEGRAL_REL * absOf(job->value)), noise);
+}
+
+void solve_startIntegral(SolveJob* job, const ExprProgram* prog, double a, double b) {
+    startJob(job, prog, SOLVE_INTEGRAL);
+    job->interval_count = 0;
+    job->value = 0.0;
+    job->value_error = 0.0;
+    if (a == b) {
+        finish(job);
+        return;
+    }
+
+    if (!kronrod(job, a, b, &job->intervals[0])) {
+        fail(job, "undefined in [a,b]");
+        return;
+    }
+    job->interval_count = 1;
+    double truncation = sumIntervals(job);
+    job->error0 = truncation;
+    if (truncation <= integralTarget(job, truncation)) finish(job);
+}
+
+// 誤差の見積もりが一番大きい区間を二等分する
+static void integralStep(SolveJob* job) {
+    int worst = 0;
+    for (int i = 1; i < job->interval_count; i++) {
+        if (job->intervals[i].error > job->intervals[worst].error) worst = i;
+    }
+    SolveInterval* w = &job->intervals[worst];
+    double mid = 0.5 * (w->a + w->b);
+    if (job->interval_count >= SOLVE_MAX_INTERVALS || mid == w->a || mid == w->b) {
+        finish(job); // これ以上は分けられない (誤差の見積もりはそのまま返す)
+        return;
+    }
+
+    SolveInterval left, right;
+    if (!kronrod(job, w->a, mid, &left) || !kronrod(job, mid, w->b, &right)) {
+        fail(job, "undefined in [a,b]");
+        return;
+    }
+    *w = left;
+    job->intervals[job->interval_count++] = right;
+    double truncation = sumIntervals(job);
+
+    double target = integralTarget(job, truncation);
+    if (truncation <= target) finish(job);
+    else job->progress = progressOf(job->error0, truncation, target);
+}
+
+// ---- 進める ----
+
+bool solve_step(SolveJob* job, u32 max_evals) {
+    u32 limit = job->evals + max_evals;
+    while (job->state == SOLVE_RUNNING && job->evals < limit) {
+        switch (job->kind) {
+        case SOLVE_ROOT:
+            if (job->phase == PHASE_NEWTON) newtonStep(job);
+            else if (job->phase == PHASE_SCAN) scanStep(job);
+            else bracketStep(job);
+            break;
+        case SOLVE_POLY:
+            polyStep(job);
+            break;
+        case SOLVE_INTEGRAL:
+            integralStep(job);
+            break;
+        }
+    }
+    return job->state != SOLVE_RUNNING;
+}
+
+// ---- 微分 ----
+
+double solve_derivative(const ExprProgram* prog, double x, double* error) {
+    double table[RIDDERS_TABLE][RIDDERS_TABLE];
+    double h = 0.1 * maxOf(1.0, absOf(x));
+    double best = NAN;
+    int rows = 0;
+
+    *error = INFINITY;
+    // 最初の刻みで定義域から出る (x = 0.05 での ln(x) など) ときは縮めてやり直す
+    for (int tries = 0; tries < 2 * RIDDERS_TABLE && rows < RIDDERS_TABLE; tries++, h /= RIDDERS_SHRINK) {
+        double d = expr_eval(prog, x + h) - expr_eval(prog, x - h);
+        if (!isfinite(d)) {
+            if (rows > 0) break;
+            continue;
+        }
+
+        int i = rows++;
+        table[0][i] = hwmath_divDouble(d, 2.0 * h);
+        if (i == 0) {
+            best = table[0][0];
+            continue;
+        }
+
+        // 刻みを縮めた列から誤差の h^2, h^4, ... の項を順に消す
+        double fac = RIDDERS_SHRINK * RIDDERS_SHRINK;
+        for (int j = 1; j <= i; j++) {
+            table[j][i] = (table[j - 1][i] * fac - table[j - 1][i - 1]) / (fac - 1.0);
+            fac *= RIDDERS_SHRINK * RIDDERS_SHRINK;
+            double e = maxOf(absOf(table[j][i] - table[j - 1][i]), absOf(table[j][i] - table[j - 1][i - 1]));
+            if (e <= *error) {
+                *error = e;
+                best = table[j][i];
+            }
+        }
+        // 高い次の補外が悪くなってきたら、丸めの誤差の方が大きい
+        if (absOf(table[i][i] - table[i - 1][i - 1]) >= 2.0 * *error) break;
+    }
+    return best;
+}
+
+#ifdef ENABLE_BENCHMARK
+#define BENCH_OPS 10000
+
+void solve_benchmark(void) {
+    static SolveJob bench_job;
+    SolveJob* job = &bench_job;
+    ExprProgram prog;
+    int error_pos;
+    u64 ns;
+
+    iprintf("Solve:\n");
+
+    expr_compile(&prog, "sin(x)*exp(-x/3)+x^2/10", &error_pos);
+    double sum = 0.0;
+    bench_start();
+    for (u32 i = 0; i < BENCH_OPS; i++) sum += expr_eval(&prog, i * 0.001);
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" eval: %5lu cyc %lu/s%s\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_OPS),
+            (unsigned long)(ns > 0 ? (u64)BENCH_OPS * 1000000000ULL / ns : 0), isfinite(sum) ? "" : " NG");
+
+    // 解: x^3 - 2x - 5 = 0 (x = 2.0945514815...)
+    expr_compile(&prog, "x^3-2x-5", &error_pos);
+    bench_start();
+    solve_startRoot(job, &prog, 0.0);
+    while (!solve_step(job, 1000)) { }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" root: %3lu ev %6lu ns%s\n", (unsigned long)job->evals, (unsigned long)ns,
+            job->state == SOLVE_DONE && absOf(job->x - 2.0945514815423265) < 1e-9 ? "" : " NG");
+
+    // 積分: sin(x) の 0..pi (= 2)
+    expr_compile(&prog, "sin(x)", &error_pos);
+    bench_start();
+    solve_startIntegral(job, &prog, 0.0, 3.14159265358979323846);
+    while (!solve_step(job, 1000)) { }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" intg: %3lu ev %6lu ns%s\n", (unsigned long)job->evals, (unsigned long)ns,
+            job->state == SOLVE_DONE && absOf(job->value - 2.0) < 1e-7 ? "" : " NG");
+
+    // 多項式の根: (x-1)(x-2)(x-3)(x^2+1)
+    expr_compile(&prog, "(x-1)(x-2)(x-3)(x^2+1)", &error_pos);
+    bench_start();
+    solve_startPoly(job, &prog);
+    while (!solve_step(job, 1000)) { }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" poly: %3lu it %6lu ns%s\n", (unsigned long)job->iter, (unsigned long)ns,
+            job->state == SOLVE_DONE && job->degree == 5 && absOf(job->roots[2].re - 3.0) < 1e-9 ? "" : " NG");
+}
+#endif
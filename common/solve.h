@@ -0,0 +1,106 @@
+#ifndef SOLVE_H
+#define SOLVE_H
+
+#include "platform.h"
+#include "complex.h"
+#include "expr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// f(x) = 0 の解、多項式のすべての根、定積分、微分係数を数値的に求める
+// f はコンパイル済みの式 (expr.h) で、評価は expr_eval() だけなのでメモリを確保しない。
+//
+// 解と根と積分は途中で止めて続きから再開できる計算 (SolveJob) になっていて、
+// solve_step() に1回あたりの評価の回数を渡して毎フレーム少しずつ進める。
+// 進み具合 (progress) は残りの誤差から見積もった目安。
+//
+// 解: 初期値からのNewton法 (微分は中心差分)。符号が変わる区間が見つかったら
+//   その中だけで進め、外に出る・縮み方が遅いときは二分法にする。Newton法が
+//   行き詰まったら初期値の両側に広げながら符号の変わる区間を探す。
+// 多項式の根: 10点で値を取って差分から8次までの多項式か確かめ、係数に直して
+//   Durand-Kerner法で複素数の根をすべて求める。
+// 積分: 適応型のGauss-Kronrod (7点Gaussと15点Kronrod)。誤差の見積もりが一番大きい
+//   区間を二等分していく。見積もりには式の評価の誤差 (sci_math.h) も含める。
+// 微分: Riddersの方法 (刻みを縮めた中心差分をRichardson補外する)。すぐに終わる。
+
+#define SOLVE_POLY_MAX_DEGREE 8
+#define SOLVE_MAX_INTERVALS   64
+
+typedef enum {
+    SOLVE_ROOT,
+    SOLVE_POLY,
+    SOLVE_INTEGRAL
+} SolveKind;
+
+typedef enum {
+    SOLVE_RUNNING,
+    SOLVE_DONE,
+    SOLVE_FAILED
+} SolveState;
+
+typedef struct {
+    double a, b;
+    double value; // 15点Kronrodの値
+    double error; // |Kronrod - Gauss|
+    double noise; // 評価の誤差による分 (Σ w|f| の一定割合)
+} SolveInterval;
+
+typedef struct {
+    const ExprProgram* prog;
+    SolveKind kind;
+    SolveState state;
+    const char* error;  // SOLVE_FAILED の理由 (画面にそのまま出せる短い英語)
+    u32 evals;          // これまでに評価した回数
+    u8 progress;        // 0～100
+    int phase;
+    int iter;
+
+    // 解: x, fx が今の近似 (終わったら答え)
+    double x, fx;
+    double origin;      // 初期値 (区間を探すときの中心)
+    double lo, hi, flo, fhi;  // 符号の変わる区間
+    double step, dx_old;
+    double left, fleft, right, fright; // 区間を探すときの両側の端
+    double width0;      // 区間の最初の幅 (進み具合用)
+    double fmax0;       // 区間の最初の両端の |f| (極との区別用)
+
+    // 多項式: coeff[k] は x^k の係数
+    int degree;
+    double coeff[SOLVE_POLY_MAX_DEGREE + 1];
+    Complex roots[SOLVE_POLY_MAX_DEGREE];
+    double change0;     // 最初の1周の修正量 (進み具合用)
+
+    // 積分
+    SolveInterval intervals[SOLVE_MAX_INTERVALS];
+    int interval_count;
+    double value, value_error; // value_error は打ち切り誤差と評価の誤差の和
+    double error0;      // 最初の誤差の見積もり (進み具合用)
+} SolveJob;
+
+// f(x) = 0 の解を x0 から探す
+void solve_startRoot(SolveJob* job, const ExprProgram* prog, double x0);
+
+// f が8次までの多項式ならすべての根を求める (実数の根が先、それぞれ小さい順)
+void solve_startPoly(SolveJob* job, const ExprProgram* prog);
+
+// a から b までの f の積分
+void solve_startIntegral(SolveJob* job, const ExprProgram* prog, double a, double b);
+
+// 評価の回数がおよそ max_evals になるまで進める。終わったら (失敗も) true
+bool solve_step(SolveJob* job, u32 max_evals);
+
+// x での f の微分係数。*error に誤差の見積もりを入れる。求まらなければNaN
+double solve_derivative(const ExprProgram* prog, double x, double* error);
+
+#ifdef ENABLE_BENCHMARK
+// 式の評価1回のサイクル数と、解・積分にかかった評価の回数と時間を表示する
+void solve_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SOLVE_H
@@ -0,0 +1,172 @@
+#include <string.h>
+
+#include "stats.h"
+#include "hw_math.h"
+#include "sci_math.h"
+
+#ifdef ENABLE_BENCHMARK
+#include <stdlib.h> // qsort
+#include "bench.h"
+#endif
+
+void stats_reset(StatsAccumulator* s) {
+    memset(s, 0, sizeof(*s));
+}
+
+// 件数・最小/最大・平均・偏差平方和を更新する。*dx は更新前の平均との差
+static void addX(StatsAccumulator* s, double x, double* dx) {
+    s->count++;
+    if (s->count == 1 || x < s->min_x) s->min_x = x;
+    if (s->count == 1 || x > s->max_x) s->max_x = x;
+
+    *dx = x - s->mean_x;
+    s->mean_x += hwmath_divDouble(*dx, (double)s->count); // 整数で割るので除算器が使える
+    s->m2_x += *dx * (x - s->mean_x);
+}
+
+void stats_add(StatsAccumulator* s, double x) {
+    double dx;
+    addX(s, x, &dx);
+}
+
+void stats_addPair(StatsAccumulator* s, double x, double y) {
+    double dx;
+    addX(s, x, &dx);
+
+    s->pair_count++;
+    double dy = y - s->mean_y;
+    s->mean_y += hwmath_divDouble(dy, (double)s->pair_count);
+    s->m2_y += dy * (y - s->mean_y);
+    s->c_xy += dx * (y - s->mean_y);
+}
+
+double stats_variance(const StatsAccumulator* s, bool sample) {
+    u32 n = sample ? s->count - 1 : s->count;
+    if (s->count == 0 || n == 0) return 0.0;
+    return hwmath_divDouble(s->m2_x, (double)n);
+}
+
+double stats_stddev(const StatsAccumulator* s, bool sample) {
+    return sci_sqrt(stats_variance(s, sample));
+}
+
+bool stats_regression(const StatsAccumulator* s, double* slope, double* intercept, double* r) {
+    if (s->count < 2 || s->pair_count != s->count || s->m2_x <= 0.0) return false;
+
+    *slope = s->c_xy / s->m2_x;
+    *intercept = s->mean_y - *slope * s->mean_x;
+    *r = s->m2_y > 0.0 ? s->c_xy / sci_sqrt(s->m2_x * s->m2_y) : 0.0;
+    return true;
+}
+
+static void swap(double* a, double* b) {
+    double t = *a;
+    *a = *b;
+    *b = t;
+}
+
+// クイックセレクト: 中央値の3つの中央値を軸に分割し、k を含む側だけを続ける
+double stats_select(double* data, u32 n, u32 k) {
+    u32 lo = 0;
+    u32 hi = n - 1;
+
+    while (hi > lo) {
+        u32 mid = lo + (hi - lo) / 2;
+        if (data[mid] < data[lo]) swap(&data[mid], &data[lo]);
+        if (data[hi] < data[lo]) swap(&data[hi], &data[lo]);
+        if (data[hi] < data[mid]) swap(&data[hi], &data[mid]);
+        double pivot = data[mid];
+
+        // Hoare分割: [lo, j] <= pivot <= [i, hi]
+        u32 i = lo;
+        u32 j = hi;
+        while (i <= j) {
+            while (data[i] < pivot) i++;
+            while (data[j] > pivot) j--;
+            if (i <= j) {
+                swap(&data[i], &data[j]);
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break; // j < k < i はpivotと等しい
+    }
+    return data[k];
+}
+
+double stats_quantile(double* data, u32 n, double q) {
+    if (n == 0) return 0.0;
+    if (q <= 0.0) q = 0.0;
+    if (q >= 1.0) q = 1.0;
+
+    double h = q * (n - 1);
+    u32 k = (u32)h;
+    double v = stats_select(data, n, k);
+    if (k + 1 >= n || h == k) return v;
+
+    // 選択の後は k より後ろが全部 v 以上なので、その最小が k+1 番目
+    double next = data[k + 1];
+    for (u32 i = k + 2; i < n; i++) {
+        if (data[i] < next) next = data[i];
+    }
+    return v + (h - k) * (next - v);
+}
+
+#ifdef ENABLE_BENCHMARK
+#define BENCH_ADDS 10000
+#define BENCH_DATA 4096
+
+static int compareDouble(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void benchFill(double* data, u32 n) {
+    u32 seed = 12345;
+    for (u32 i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = 1.0e9 + (seed >> 8) / 1024.0; // 大きな値 + 小さな変化
+    }
+}
+
+void stats_benchmark(void) {
+    static double data[BENCH_DATA];
+    static double sorted[BENCH_DATA];
+    StatsAccumulator s;
+    u64 ns;
+
+    iprintf("Stats:\n");
+
+    stats_reset(&s);
+    bench_start();
+    for (u32 i = 0; i < BENCH_ADDS; i++) stats_addPair(&s, i * 0.5, i * 1.5 + 2.0);
+    ns = bench_elapsedNsec();
+    bench_stop();
+    double slope, intercept, r;
+    bool ok = stats_regression(&s, &slope, &intercept, &r);
+    iprintf(" add (x,y): %5lu cyc%s\n", (unsigned long)bench_cyclesPerOp(ns, BENCH_ADDS),
+            ok && slope > 2.999999 && slope < 3.000001 && r > 0.999999 ? "" : " NG");
+
+    benchFill(data, BENCH_DATA);
+    memcpy(sorted, data, sizeof(sorted));
+
+    bench_start();
+    double median = stats_quantile(data, BENCH_DATA, 0.5);
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" median %d select: %6lu us\n", BENCH_DATA, (unsigned long)(ns / 1000));
+
+    bench_start();
+    qsort(sorted, BENCH_DATA, sizeof(sorted[0]), compareDouble);
+    ns = bench_elapsedNsec();
+    bench_stop();
+    double lower = sorted[BENCH_DATA / 2 - 1];
+    double expect = lower + 0.5 * (sorted[BENCH_DATA / 2] - lower);
+    iprintf(" median %d qsort:  %6lu us%s\n", BENCH_DATA, (unsigned long)(ns / 1000),
+            median == expect ? "" : " NG");
+}
+#endif
@@ -0,0 +1,54 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 1パスの統計 (Welford法)
+// 値を1つ足すごとに平均と偏差平方和をO(1)で更新するので、データを保存も
+// 読み直しもせずに平均・分散・標準偏差・最小/最大・回帰直線が求まる。
+// 大きな値が続いても (1e9 + 小さな変化) 桁落ちしない。
+
+typedef struct {
+    u32 count;
+    u32 pair_count;  // (x, y) で足した数。count と等しいときだけ回帰できる
+    double mean_x;
+    double mean_y;
+    double m2_x;     // Σ(x - 平均)^2
+    double m2_y;
+    double c_xy;     // Σ(x - 平均x)(y - 平均y)
+    double min_x;
+    double max_x;
+} StatsAccumulator;
+
+void stats_reset(StatsAccumulator* s);
+void stats_add(StatsAccumulator* s, double x);
+void stats_addPair(StatsAccumulator* s, double x, double y);
+
+// sample なら n-1 で、そうでなければ n で割る (足りないときは0)
+double stats_variance(const StatsAccumulator* s, bool sample);
+double stats_stddev(const StatsAccumulator* s, bool sample);
+
+// y = intercept + slope × x と相関係数。全部 (x, y) で足していて2組以上、
+// xがすべて同じでないときだけtrue
+bool stats_regression(const StatsAccumulator* s, double* slope, double* intercept, double* r);
+
+// data を並べ替えて k 番目 (0から) に小さい値を返す (平均O(n)の選択)
+double stats_select(double* data, u32 n, u32 k);
+
+// q分位数 (0 <= q <= 1、順位の間は線形補間)。data は並べ替わる
+double stats_quantile(double* data, u32 n, double q);
+
+#ifdef ENABLE_BENCHMARK
+// 1件追加のサイクル数と、中央値の選択/整列の時間を表示する
+void stats_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STATS_H
@@ -0,0 +1,19 @@
+#include "storage.h"
+
+#ifdef ARM9
+#include <fat.h>
+#endif
+
+bool storage_mount(void) {
+#ifdef ARM9
+    static bool tried = false;
+    static bool mounted = false;
+    if (!tried) {
+        tried = true;
+        mounted = fatInitDefault();
+    }
+    return mounted;
+#else
+    return true;
+#endif
+}
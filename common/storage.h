@@ -0,0 +1,18 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// SDカード (libfat) を最初に使うときにマウントする。
+// 2回目からは最初の結果を返すだけ。ホストビルドでは常にtrue
+bool storage_mount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STORAGE_H
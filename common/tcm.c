@@ -0,0 +1,163 @@
+#include "tcm.h"
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+#include "hw_math.h"
+
+// ベンチマークでは USE_TCM に関係なく、同じカーネルを両方に置いて比べる
+#ifdef ARM9
+#define BENCH_ITCM ITCM_CODE __attribute__((noinline))
+#define BENCH_DTCM DTCM_BSS
+#else
+#define BENCH_ITCM __attribute__((noinline))
+#define BENCH_DTCM
+#endif
+#define BENCH_RAM __attribute__((noinline))
+
+// カーネルの本体は1つにして、メインRAM版とITCM版の両方に展開する
+#define BENCH_BODY static inline __attribute__((always_inline))
+
+#define BENCH_REPEAT 64
+
+#define FILL_WORDS    1024 // 4KB
+#define COLUMN_HEIGHT 192  // グラフの1列
+#define ROW_LIMBS     64
+#define TABLE_SIZE    96   // ローマ字表と同じくらい
+#define TABLE_KEY     4
+
+typedef struct {
+    char key[TABLE_KEY];
+    u32 value;
+} BenchEntry;
+
+static u32 bench_words[FILL_WORDS];
+static u16 bench_bitmap[256 * COLUMN_HEIGHT];
+
+static u32 row_ram[2][ROW_LIMBS];
+static u32 row_dtcm[2][ROW_LIMBS] BENCH_DTCM;
+static BenchEntry table_ram[TABLE_SIZE];
+static BenchEntry table_dtcm[TABLE_SIZE] BENCH_DTCM;
+
+// 8語ずつ書く (stmiaになる)
+BENCH_BODY void fillWordsBody(u32* dst, u32 value, u32 n) {
+    u32* end = dst + (n & ~7u);
+    while (dst < end) {
+        dst[0] = value; dst[1] = value; dst[2] = value; dst[3] = value;
+        dst[4] = value; dst[5] = value; dst[6] = value; dst[7] = value;
+        dst += 8;
+    }
+    for (n &= 7; n > 0; n--) *dst++ = value;
+}
+
+// 256画素おきの書き込み (グラフの列の再描画と同じ)
+BENCH_BODY void fillColumnBody(u16* p, u16 color, int height) {
+    for (; height > 0; height--, p += 256) *p = color;
+}
+
+// r += a * m (10^9進、bignumの筆算の内側と同じ)
+BENCH_BODY u32 mulRowBody(u32* r, const u32* a, u32 m, s32 n) {
+    u32 carry = 0;
+    for (s32 i = 0; i < n; i++) {
+        hwmath_divStart64_32((s64)((u64)a[i] * m + r[i] + carry), 1000000000);
+        carry = (u32)hwmath_divResult();
+        r[i] = (u32)hwmath_divRemainder32();
+    }
+    return carry;
+}
+
+// 先頭の文字で絞ってからキーを比べる (ローマ字の照合と同じ)
+BENCH_BODY int scanBody(const BenchEntry* table, int count, const char* key) {
+    for (int i = 0; i < count; i++) {
+        if (table[i].key[0] != key[0]) continue;
+        int k = 1;
+        while (k < TABLE_KEY && table[i].key[k] == key[k]) k++;
+        if (k == TABLE_KEY) return i;
+    }
+    return -1;
+}
+
+static BENCH_RAM void fillWordsRam(u32* dst, u32 value, u32 n) { fillWordsBody(dst, value, n); }
+static BENCH_ITCM void fillWordsItcm(u32* dst, u32 value, u32 n) { fillWordsBody(dst, value, n); }
+static BENCH_RAM void fillColumnRam(u16* p, u16 color, int height) { fillColumnBody(p, color, height); }
+static BENCH_ITCM void fillColumnItcm(u16* p, u16 color, int height) { fillColumnBody(p, color, height); }
+static BENCH_RAM u32 mulRowRam(u32* r, const u32* a, u32 m, s32 n) { return mulRowBody(r, a, m, n); }
+static BENCH_ITCM u32 mulRowItcm(u32* r, const u32* a, u32 m, s32 n) { return mulRowBody(r, a, m, n); }
+static BENCH_RAM int scanRam(const BenchEntry* table, int count, const char* key) { return scanBody(table, count, key); }
+static BENCH_ITCM int scanItcm(const BenchEntry* table, int count, const char* key) { return scanBody(table, count, key); }
+
+static volatile u32 bench_sink; // 結果を捨てさせない
+
+static void runFillWords(bool tcm) {
+    (tcm ? fillWordsItcm : fillWordsRam)(bench_words, 0x7FFF7FFF, FILL_WORDS);
+}
+
+static void runFillColumn(bool tcm) {
+    (tcm ? fillColumnItcm : fillColumnRam)(bench_bitmap + 128, 0xFFFF, COLUMN_HEIGHT);
+}
+
+static void runMulRow(bool tcm) {
+    if (tcm) {
+        bench_sink = mulRowItcm(row_dtcm[0], row_dtcm[1], 123456789, ROW_LIMBS);
+    } else {
+        bench_sink = mulRowRam(row_ram[0], row_ram[1], 123456789, ROW_LIMBS);
+    }
+}
+
+static void runScan(bool tcm) {
+    // 表の後ろの方にあるキー (73番目)
+    static const char key[TABLE_KEY] = {'t', 'v', 'd', 0};
+    bench_sink = tcm ? scanItcm(table_dtcm, TABLE_SIZE, key) : scanRam(table_ram, TABLE_SIZE, key);
+}
+
+static void flushCaches(void) {
+#ifdef ARM9
+    IC_InvalidateAll();
+    DC_FlushAll();
+#endif
+}
+
+// 1回あたりのサイクル数。coldなら毎回キャッシュを捨ててから呼ぶ
+static u32 measure(void (*run)(bool), bool tcm, bool cold) {
+    u64 total = 0;
+
+    run(tcm); // 1回目はキャッシュに載せるため
+    bench_start();
+    for (int i = 0; i < BENCH_REPEAT; i++) {
+        if (cold) flushCaches();
+        u64 t0 = bench_elapsedNsec();
+        run(tcm);
+        total += bench_elapsedNsec() - t0;
+    }
+    bench_stop();
+    return bench_cyclesPerOp(total, BENCH_REPEAT);
+}
+
+static void printCase(const char* name, void (*run)(bool)) {
+    for (int cold = 0; cold <= 1; cold++) {
+        u32 ram = measure(run, false, cold);
+        u32 tcm = measure(run, true, cold);
+        long saved = ram > 0 ? (long)(((s64)ram - tcm) * 100 / ram) : 0;
+        iprintf(" %-6s %s %6lu %6lu %3ld%%\n", name, cold ? "cold" : "warm",
+                (unsigned long)ram, (unsigned long)tcm, saved);
+    }
+}
+
+void tcm_benchmark(void) {
+    for (int i = 0; i < ROW_LIMBS; i++) {
+        row_ram[0][i] = row_dtcm[0][i] = (u32)i * 15485863u % 1000000000u;
+        row_ram[1][i] = row_dtcm[1][i] = (u32)i * 32452843u % 1000000000u;
+    }
+    // "a".."z" を先頭にした4文字のキーを順に並べる ('t'で始まるものは後ろの方)
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        BenchEntry e = {{(char)('a' + i * 26 / TABLE_SIZE), (char)('a' + i % 26), (char)('a' + i % 7), 0}, (u32)i};
+        table_ram[i] = table_dtcm[i] = e;
+    }
+
+    iprintf("TCM cyc/call    RAM    TCM save\n");
+    printCase("fill4K", runFillWords);
+    printCase("column", runFillColumn);
+    printCase("mulrow", runMulRow);
+    printCase("scan", runScan);
+    iprintf(" (cold: caches flushed first)\n");
+}
+#endif
@@ -0,0 +1,37 @@
+#ifndef TCM_H
+#define TCM_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ARM9の密結合メモリへの配置 (make TCM=1 で -DUSE_TCM)
+// ITCM (32KB) はコード、DTCM (16KB) はデータ用で、どちらもキャッシュを通らず
+// 待ち無しで読み書きできる。メインRAMはキャッシュが外れると1ラインに数十サイクル
+// 待つので、毎フレーム回る内側のループをITCMに、それが引く参照表をDTCMに置く。
+// DTCMはスタックと共有なので、置くのは数KBまでの表と作業領域だけにすること。
+// ARM7とホストのビルドでは何もしない。
+
+#if defined(ARM9) && defined(USE_TCM)
+#define TCM_CODE ITCM_CODE __attribute__((noinline)) // 呼び出し側に展開されるとITCMに載らない
+#define TCM_BSS  DTCM_BSS
+#else
+#define TCM_CODE
+#define TCM_BSS
+#endif
+
+#ifdef ENABLE_BENCHMARK
+// 同じカーネル (メモリの塗りつぶし、縦1列の塗りつぶし、10^9進の積和、表の線形探索) を
+// メインRAMとITCM/DTCMの両方から動かし、1回あたりのサイクル数と削減率を表示する。
+// キャッシュに載ったままの場合と、毎回キャッシュを捨てた場合 (他の処理の後に
+// 1フレームに1回呼ばれる状況) の両方を測る。make TCM=1 でなくても比べられる
+void tcm_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TCM_H
@@ -0,0 +1,350 @@
+#include <math.h>
+#include <string.h>
+
+#include "text_console.h"
+
+static u16 map_fallback[TEXT_CONSOLE_ROWS * TEXT_CONSOLE_COLS]; // init前に書いても落ちないように
+static u16* console_map = map_fallback;
+static u16 console_space = 0;
+
+// まとめて写す間の裏のマップと、変わった行 (ビットごと)
+static u16 batch_map[TEXT_CONSOLE_ROWS * TEXT_CONSOLE_COLS] __attribute__((aligned(4)));
+static u32 batch_dirty = 0;
+static bool batch_active = false;
+static bool batch_pending = false; // endBatch() の後、まだ写していない
+
+void textConsole_init(u16* map, u16 space_entry) {
+    console_map = map;
+    console_space = space_entry;
+    batch_dirty = 0;
+    batch_active = false;
+    batch_pending = false;
+}
+
+#ifdef ARM9
+void textConsole_attach(PrintConsole* console) {
+    // consolePrintChar() と同じ項目の作り方 (パレットの番号は上位4ビット)
+    u16 space = (u16)(' ' + console->fontCharOffset - console->font.asciiOffset);
+    textConsole_init(console->fontBgMap, console->fontCurPal | space);
+}
+#endif
+
+// フォントにあるのは ' '..'~' だけ
+static inline u16 entryOf(char c) {
+    u8 u = (u8)c;
+    if (u < ' ' || u > '~') u = (u < ' ') ? ' ' : '?';
+    return console_space + (u - ' ');
+}
+
+static inline void writeCell(int row, int col, u16 entry) {
+    int i = row * TEXT_CONSOLE_COLS + col;
+    if (batch_active || batch_pending) {
+        batch_map[i] = entry;
+        batch_dirty |= 1u << row;
+    } else {
+        console_map[i] = entry;
+    }
+}
+
+static inline bool inside(int row, int col) {
+    return row >= 0 && row < TEXT_CONSOLE_ROWS && col >= 0 && col < TEXT_CONSOLE_COLS;
+}
+
+void textConsole_clearRow(int row) {
+    if (row < 0 || row >= TEXT_CONSOLE_ROWS) return;
+    for (int col = 0; col < TEXT_CONSOLE_COLS; col++) writeCell(row, col, console_space);
+}
+
+void textConsole_clear(void) {
+    for (int row = 0; row < TEXT_CONSOLE_ROWS; row++) textConsole_clearRow(row);
+}
+
+int textConsole_putChar(int row, int col, char c) {
+    if (inside(row, col)) writeCell(row, col, entryOf(c));
+    return col + 1;
+}
+
+int textConsole_putText(int row, int col, const char* text) {
+    if (row < 0 || row >= TEXT_CONSOLE_ROWS) return col + strlen(text);
+    for (; *text != '\0'; text++, col++) {
+        if (col >= 0 && col < TEXT_CONSOLE_COLS) writeCell(row, col, entryOf(*text));
+    }
+    return col;
+}
+
+int textConsole_fill(int row, int col, char c, int count) {
+    u16 entry = entryOf(c);
+    for (; count > 0; count--, col++) {
+        if (inside(row, col)) writeCell(row, col, entry);
+    }
+    return col;
+}
+
+// ---- 数値の書式化 ----
+
+// valueを下の桁から作ってbufに詰める。min_digits桁に満たなければ0で埋める
+static int formatU64(char* buf, u64 value, int min_digits) {
+    char tmp[24];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0 || n < min_digits);
+    for (int i = 0; i < n; i++) buf[i] = tmp[n - 1 - i];
+    buf[n] = '\0';
+    return n;
+}
+
+int textConsole_formatUInt(char* buf, u32 value, int base, bool upper) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char tmp[33];
+    int n = 0;
+    do {
+        tmp[n++] = digits[value % base];
+        value /= base;
+    } while (value != 0);
+    for (int i = 0; i < n; i++) buf[i] = tmp[n - 1 - i];
+    buf[n] = '\0';
+    return n;
+}
+
+int textConsole_formatInt(char* buf, s32 value) {
+    if (value >= 0) return textConsole_formatUInt(buf, (u32)value, 10, false);
+    buf[0] = '-';
+    return 1 + textConsole_formatUInt(buf + 1, 0u - (u32)value, 10, false);
+}
+
+static u64 pow10u(int n) {
+    u64 p = 1;
+    while (n-- > 0) p *= 10;
+    return p;
+}
+
+// value * 10^k (負のkは割り算にして、10^22までは誤差無しで済ませる)
+static double scale10(double value, int k) {
+    while (k > 300) { value *= 1e300; k -= 300; }
+    while (k < -300) { value /= 1e300; k += 300; }
+    return k >= 0 ? value * pow(10.0, k) : value / pow(10.0, -k);
+}
+
+// 四捨五入。10^kを掛けた時点でちょうど半分になったものは切り上げる
+// (57.225 のように2進で少し下にずれた10進の値を、入力した人の期待どおりに丸める。
+// 430.5 のように2進でちょうど半分の値はprintfと違って偶数に寄せない)
+static u64 roundHalfUp(double value) {
+    return (u64)(value + 0.5);
+}
+
+// 有効数字digits桁に丸めた仮数 (ちょうどdigits桁) と10の指数
+static u64 roundSignificant(double value, int digits, int* exponent) {
+    u64 limit = pow10u(digits);
+    int e = (int)floor(log10(value));
+    u64 m = roundHalfUp(scale10(value, digits - 1 - e));
+    // log10の誤差や丸めの繰り上がりで桁がずれたら直す
+    if (m >= limit) {
+        e++;
+        m = roundHalfUp(scale10(value, digits - 1 - e));
+        if (m >= limit) m = limit / 10;
+    } else if (m < limit / 10) {
+        e--;
+        m = roundHalfUp(scale10(value, digits - 1 - e));
+        if (m >= limit) { m = limit / 10; e++; }
+    }
+    *exponent = e;
+    return m;
+}
+
+int textConsole_formatNumber(char* buf, double value, int digits, char style) {
+    char* p = buf;
+
+    if (value != value) {
+        strcpy(buf, "nan");
+        return 3;
+    }
+    if (value < 0) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (isinf(value)) {
+        strcpy(p, "inf");
+        return p - buf + 3;
+    }
+
+    if (style == 'f') {
+        if (digits < 0) digits = 6;
+        if (digits > 9) digits = 9;
+        u64 unit = pow10u(digits);
+        if (value < 1e18 / (double)unit) {
+            u64 scaled = roundHalfUp(value * (double)unit);
+            p += formatU64(p, scaled / unit, 1);
+            if (digits > 0) {
+                *p++ = '.';
+                p += formatU64(p, scaled % unit, digits);
+            }
+            return p - buf;
+        }
+        digits = 15; // 大きすぎる値は指数で書く
+    }
+
+    if (digits <= 0) digits = 1;
+    if (digits > 17) digits = 17;
+    if (value == 0.0) {
+        strcpy(p, "0");
+        return p - buf + 1;
+    }
+
+    int e;
+    char d[20];
+    formatU64(d, roundSignificant(value, digits, &e), digits);
+    int n = digits;
+    while (n > 1 && d[n - 1] == '0') n--; // %g は末尾の0を書かない
+
+    if (e < -4 || e >= digits) {
+        *p++ = d[0];
+        if (n > 1) {
+            *p++ = '.';
+            memcpy(p, d + 1, n - 1);
+            p += n - 1;
+        }
+        *p++ = 'e';
+        *p++ = e < 0 ? '-' : '+';
+        p += formatU64(p, (u64)(e < 0 ? -e : e), 2);
+    } else if (e >= 0) {
+        memcpy(p, d, e + 1);
+        p += e + 1;
+        if (n > e + 1) {
+            *p++ = '.';
+            memcpy(p, d + e + 1, n - e - 1);
+            p += n - e - 1;
+        }
+    } else {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = -1; i > e; i--) *p++ = '0';
+        memcpy(p, d, n);
+        p += n;
+    }
+    *p = '\0';
+    return p - buf;
+}
+
+// ---- printfの一部 ----
+
+void textConsole_vprint(int* row, int* col, const char* format, va_list args) {
+    char num[TEXT_CONSOLE_NUMBER_MAX];
+
+    for (const char* f = format; *f != '\0'; f++) {
+        if (*f == '\n') {
+            (*row)++;
+            *col = 0;
+            continue;
+        }
+        if (*f != '%') {
+            *col = textConsole_putChar(*row, *col, *f);
+            continue;
+        }
+
+        bool left = false, zero = false;
+        int width = 0, precision = -1;
+        for (f++; *f == '-' || *f == '0'; f++) {
+            if (*f == '-') left = true;
+            else zero = true;
+        }
+        while (*f >= '0' && *f <= '9') width = width * 10 + (*f++ - '0');
+        if (*f == '.') {
+            precision = 0;
+            for (f++; *f >= '0' && *f <= '9'; f++) precision = precision * 10 + (*f - '0');
+        }
+        int longs = 0;
+        while (*f == 'l') { longs++; f++; }
+
+        const char* text = num;
+        int len;
+        switch (*f) {
+        case 'd': case 'i':
+            len = textConsole_formatInt(num, longs ? (s32)va_arg(args, long) : va_arg(args, int));
+            break;
+        case 'u':
+            len = textConsole_formatUInt(num, longs ? (u32)va_arg(args, unsigned long) : va_arg(args, unsigned), 10, false);
+            break;
+        case 'x': case 'X':
+            len = textConsole_formatUInt(num, longs ? (u32)va_arg(args, unsigned long) : va_arg(args, unsigned), 16, *f == 'X');
+            break;
+        case 'c':
+            num[0] = (char)va_arg(args, int);
+            len = 1;
+            break;
+        case 's':
+            text = va_arg(args, const char*);
+            if (text == NULL) text = "(null)";
+            len = strlen(text);
+            if (precision >= 0 && len > precision) len = precision;
+            break;
+        case 'g': case 'f':
+            len = textConsole_formatNumber(num, va_arg(args, double), precision < 0 ? 6 : precision, *f);
+            break;
+        case '%':
+            num[0] = '%';
+            len = 1;
+            break;
+        default: // 知らない変換は書かない
+            if (*f == '\0') return;
+            continue;
+        }
+
+        int pad = width - len;
+        if (!left) {
+            // 0埋めは符号の後ろに入れる
+            if (zero && *f != 's' && *f != 'c' && len > 0 && text[0] == '-') {
+                *col = textConsole_putChar(*row, *col, '-');
+                text++;
+                len--;
+            }
+            if (pad > 0) *col = textConsole_fill(*row, *col, zero && *f != 's' ? '0' : ' ', pad);
+        }
+        for (int i = 0; i < len; i++) *col = textConsole_putChar(*row, *col, text[i]);
+        if (left && pad > 0) *col = textConsole_fill(*row, *col, ' ', pad);
+    }
+}
+
+int textConsole_printAt(int row, int col, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    textConsole_vprint(&row, &col, format, args);
+    va_end(args);
+    return col;
+}
+
+// ---- まとめて写す ----
+
+void textConsole_beginBatch(void) {
+    // 写していない分が残っていれば、その続きに書く
+    if (!batch_pending) {
+        memcpy(batch_map, console_map, sizeof(batch_map));
+        batch_dirty = 0;
+    }
+    batch_active = true;
+}
+
+void textConsole_endBatch(void) {
+    batch_active = false;
+    batch_pending = true;
+}
+
+void textConsole_commit(void) {
+    if (!batch_pending || batch_active) return;
+
+    // 書いた行でも、表示中のマップと同じなら写さない。毎フレーム全体を消して
+    // 描き直しても、実際に変わった行だけがVRAMに書かれる。
+    // 1行 = 64バイトを32ビットずつ (VRAMには8ビットで書けない)
+    u32 dirty = batch_dirty;
+    for (int row = 0; dirty != 0; row++, dirty >>= 1) {
+        if (!(dirty & 1)) continue;
+        u32* dst = (u32*)(console_map + row * TEXT_CONSOLE_COLS);
+        const u32* src = (const u32*)(batch_map + row * TEXT_CONSOLE_COLS);
+        int i = 0;
+        while (i < TEXT_CONSOLE_COLS / 2 && dst[i] == src[i]) i++;
+        for (; i < TEXT_CONSOLE_COLS / 2; i++) dst[i] = src[i];
+    }
+    batch_dirty = 0;
+    batch_pending = false;
+}
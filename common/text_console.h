@@ -0,0 +1,65 @@
+#ifndef TEXT_CONSOLE_H
+#define TEXT_CONSOLE_H
+
+#include <stdarg.h>
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 下画面の文字の表示 (iprintfの代わり)
+//
+// libndsのコンソールと同じBGのマップに、(行, 桁) を指定して項目を直接書く。
+// エスケープシーケンスの解釈もnewlibの書式化も通らないので、1文字あたり
+// マップの1項目を書くだけで済む。数値は自前で文字にする (%g と %f も扱う。
+// iprintfは浮動小数点を書けない)。
+// 行からはみ出した分は捨てる (折り返さない)。
+//
+// textConsole_beginBatch() から textConsole_endBatch() までに書いたものは
+// 裏のマップにたまり、VBlankの直後に textConsole_commit() を呼ぶと、表示中の
+// マップと比べて変わった行だけ (行の中では最初に違う桁から) VRAMに写る。画面を消して描き直しても途中の状態は表示されない。
+// 写すまでの間にiprintfで同じ行に書いたものは上書きされる。
+
+#define TEXT_CONSOLE_COLS 32
+#define TEXT_CONSOLE_ROWS 24
+
+// map: 32x24のBGマップ。space_entry: 空白のマップの項目 (文字cは space_entry + c - ' ')
+void textConsole_init(u16* map, u16 space_entry);
+
+#ifdef ARM9
+// libndsのコンソール (consoleDemoInit() などの戻り値) と同じマップとフォントを使う
+void textConsole_attach(PrintConsole* console);
+#endif
+
+// 全体 / 1行を空白にする
+void textConsole_clear(void);
+void textConsole_clearRow(int row);
+
+// 書いた次の桁を返す
+int textConsole_putChar(int row, int col, char c);
+int textConsole_putText(int row, int col, const char* text);
+int textConsole_fill(int row, int col, char c, int count);
+
+// printfの一部: %d %i %u %x %X %c %s %g %f %% と、フラグ '-' '0'、幅、精度、長さ 'l'。
+// '\n' で次の行の0桁目に移る。最後に書いた次の桁を返す
+int textConsole_printAt(int row, int col, const char* format, ...);
+void textConsole_vprint(int* row, int* col, const char* format, va_list args);
+
+// 数値を文字にしてbufに書き、長さを返す (bufは TEXT_CONSOLE_NUMBER_MAX バイト)
+#define TEXT_CONSOLE_NUMBER_MAX 32
+int textConsole_formatInt(char* buf, s32 value);
+int textConsole_formatUInt(char* buf, u32 value, int base, bool upper);
+// style 'g': 有効数字digits桁 (%.*g と同じ)、'f': 小数点以下digits桁 (%.*f と同じ)
+int textConsole_formatNumber(char* buf, double value, int digits, char style);
+
+void textConsole_beginBatch(void);
+void textConsole_endBatch(void);
+// たまっている行をVRAMに写す (swiWaitForVBlank() の直後に呼ぶ)
+void textConsole_commit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEXT_CONSOLE_H
@@ -0,0 +1,202 @@
+#include "text_index.h"
+#include "sjis.h"
+
+// ポスティングリストを先頭から順に復号するカーソル
+typedef struct {
+    const u8* p;
+    const u8* end;   // グループの終わり (壊れたデータでも越えて読まない)
+    u32 remaining;
+    s32 pos;
+} PostingCursor;
+
+// end で途切れたら読めたところまでを返す (呼び出し側が p == end で気づく)
+static inline u32 readLeb128(const u8** p, const u8* end) {
+    u32 value = 0;
+    int shift = 0;
+    u8 b;
+    do {
+        if (*p >= end) break;
+        b = *(*p)++;
+        value |= (u32)(b & 0x7F) << shift;
+        shift += 7;
+    } while ((b & 0x80) && shift < 32);
+    return value;
+}
+
+static inline bool postingNext(PostingCursor* c) {
+    if (c->remaining == 0 || c->p >= c->end) return false;
+    c->remaining--;
+    c->pos += (s32)readLeb128(&c->p, c->end);
+    return true;
+}
+
+// キーのグループをディレクトリから二分探索し、グループの中は先頭から読む
+static bool findKey(const TextIndex* idx, u32 key, PostingCursor* cursor) {
+    int lo = 0;
+    int hi = (int)idx->group_count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) >> 1;
+        if (idx->directory[mid * 2] <= key) lo = mid;
+        else hi = mid - 1;
+    }
+    if (hi < 0 || idx->directory[lo * 2] > key) return false;
+
+    const u8* p = idx->area + idx->directory[lo * 2 + 1];
+    const u8* end = idx->area + ((u32)lo + 1 < idx->group_count
+                                 ? idx->directory[lo * 2 + 3] : idx->area_size);
+    u32 k = idx->directory[lo * 2];
+    while (p < end) {
+        u32 head = readLeb128(&p, end);
+        u32 count = (head & 1) ? readLeb128(&p, end) + 2 : 1;
+        if (p >= end) return false; // 位置が1つも無いまま途切れている
+        k += head >> 1;
+        if (k == key) {
+            cursor->p = p;
+            cursor->end = end;
+            cursor->remaining = count;
+            cursor->pos = 0;
+            return true;
+        }
+        if (k > key) return false;
+
+        // 位置は読まずに飛ばす (最後のバイトだけ最上位ビットが0)
+        while (count > 0 && p < end) {
+            if (!(*p++ & 0x80)) count--;
+        }
+        if (count > 0) return false; // グループが途中で切れている
+    }
+    return false;
+}
+
+static inline int codeBytes(u16 code) {
+    return (code < 0x100) ? 1 : 2;
+}
+
+bool textIndex_open(TextIndex* idx, const u8* index, u32 index_size, const TextPack* text) {
+    const u32* header = (const u32*)index;
+
+    if (index_size < 20 || ((uintptr_t)index & 3)) return false;
+    if (header[0] != TEXT_INDEX_MAGIC || header[1] != text->text_size) return false;
+
+    u32 group_count = header[3];
+    u32 area_size = header[4];
+    if (group_count > (index_size - 20) / 8 || area_size > index_size - 20 - group_count * 8) return false;
+
+    // グループの位置は昇順で領域の中 (findKeyはこれを前提に範囲を決める)
+    const u32* directory = header + 5;
+    for (u32 g = 0; g < group_count; g++) {
+        u32 next = g + 1 < group_count ? directory[g * 2 + 3] : area_size;
+        if (directory[g * 2 + 1] > next) return false;
+    }
+
+    idx->text = text;
+    idx->key_count = header[2];
+    idx->group_count = group_count;
+    idx->directory = directory;
+    idx->area = (const u8*)(idx->directory + group_count * 2);
+    idx->area_size = area_size;
+    return true;
+}
+
+// 1文字だけの問い合わせはbigramを引けないので本文を直接走査する
+// ブロック境界が文字境界とは限らないので常に先頭から読む
+// (ブロックをまたぐ2バイト文字はイテレータのpendingで繋がる)
+static int scanSingle(const TextIndex* idx, u16 code, u32 min_pos, u32* hits, int max_hits) {
+    const TextPack* text = idx->text;
+    SjisIter it;
+    u16 c;
+    int n = 0;
+
+    sjis_iterInit(&it, NULL, 0);
+    for (u32 b = 0; b < text->block_count; b++) {
+        u32 len;
+        const u8* data = textPack_block(text, b, &len);
+        if (data == NULL) break;
+
+        u32 base = b * text->block_size;
+        sjis_iterFeed(&it, data, len);
+        for (;;) {
+            u32 pos = base + (u32)(it.cur - data) - (it.pending ? 1 : 0);
+            if (!sjis_next(&it, &c)) break;
+            if (c == code && pos >= min_pos) {
+                hits[n++] = pos;
+                if (n >= max_hits) return n;
+            }
+        }
+    }
+    return n;
+}
+
+// TEXT_INDEX_MAX_QUERYを超えた部分を本文と比較する
+static bool matchTail(const TextIndex* idx, u32 pos, const u16* query, int query_len) {
+    u8 buf[512];
+    SjisIter it;
+    u16 c;
+
+    u32 len = (u32)query_len * 2;
+    if (len > sizeof(buf)) len = sizeof(buf);
+    len = textPack_read(idx->text, pos, buf, len);
+
+    sjis_iterInit(&it, buf, len);
+    for (int i = 0; i < query_len; i++) {
+        if (!sjis_next(&it, &c) || c != query[i]) return false;
+    }
+    return true;
+}
+
+static int searchFrom(const TextIndex* idx, const u16* query, int query_len, u32 min_pos,
+                      u32* hits, int max_hits) {
+    PostingCursor cursors[TEXT_INDEX_MAX_QUERY - 1];
+    s32 offsets[TEXT_INDEX_MAX_QUERY - 1];
+    int bigrams;
+    int n = 0;
+
+    if (query_len <= 0 || max_hits <= 0) return 0;
+    if (query_len == 1) return scanSingle(idx, query[0], min_pos, hits, max_hits);
+
+    bigrams = ((query_len < TEXT_INDEX_MAX_QUERY) ? query_len : TEXT_INDEX_MAX_QUERY) - 1;
+
+    s32 off = 0;
+    for (int i = 0; i < bigrams; i++) {
+        // 本文に無いbigramがあれば一致なし
+        if (!findKey(idx, ((u32)query[i] << 16) | query[i + 1], &cursors[i])) return 0;
+        if (!postingNext(&cursors[i])) return 0;
+
+        offsets[i] = off;
+        off += codeBytes(query[i]);
+    }
+
+    // 各リストの位置から問い合わせ内の相対位置を引いた値が全て揃ったら一致
+    s32 cand = (s32)min_pos;
+    for (;;) {
+        bool agreed = true;
+
+        for (int i = 0; i < bigrams; i++) {
+            PostingCursor* c = &cursors[i];
+            while (c->pos - offsets[i] < cand) {
+                if (!postingNext(c)) return n;
+            }
+            if (c->pos - offsets[i] > cand) {
+                cand = c->pos - offsets[i];
+                agreed = false;
+                break;
+            }
+        }
+        if (!agreed) continue;
+
+        if (query_len <= TEXT_INDEX_MAX_QUERY || matchTail(idx, (u32)cand, query, query_len)) {
+            hits[n++] = (u32)cand;
+            if (n >= max_hits) return n;
+        }
+        cand++;
+    }
+}
+
+int textIndex_search(const TextIndex* idx, const u16* query, int query_len, u32* hits, int max_hits) {
+    return searchFrom(idx, query, query_len, 0, hits, max_hits);
+}
+
+bool textIndex_findNext(const TextIndex* idx, const u16* query, int query_len, u32 from, u32* hit) {
+    if (searchFrom(idx, query, query_len, from + 1, hit, 1) == 1) return true;
+    return searchFrom(idx, query, query_len, 0, hit, 1) == 1;
+}
@@ -0,0 +1,48 @@
+#ifndef TEXT_INDEX_H
+#define TEXT_INDEX_H
+
+#include "platform.h"
+#include "text_pack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 埋め込みテキストのbigram全文検索
+//
+// インデックスはビルド時にgenerate_text_index.pyで作り、本文と並べて
+// data/にbin2oで埋め込む (4バイト境界に置かれていること)。
+// 検索は問い合わせ文字列のbigramごとのポスティングリストを
+// 相対位置をずらしながら突き合わせるだけなので、本文は走査しない。
+// 本文はTextPack経由で必要な部分だけ展開して参照する。
+
+#define TEXT_INDEX_MAGIC 0x32494742 // 'BGI2'
+
+// bigramで突き合わせる問い合わせの最大文字数 (これより長い分は本文と直接比較する)
+#define TEXT_INDEX_MAX_QUERY 32
+
+typedef struct {
+    const TextPack* text; // 本文 (SJIS)
+    u32 key_count;
+    u32 group_count;
+    const u32* directory; // グループごとの (先頭のキー, areaでの位置)。キーは (code1 << 16) | code2
+    const u8* area;       // キーの差分・件数・バイト位置の差分を LEB128 で並べたもの
+    u32 area_size;
+} TextIndex;
+
+// インデックスを開く。形式や本文サイズが合わなければfalse。
+bool textIndex_open(TextIndex* idx, const u8* index, u32 index_size, const TextPack* text);
+
+// queryはsjis_next()と同じ形式の文字コード列 (IMEのconverted_kana_bufferをそのまま渡せる)。
+// 一致した位置(本文先頭からのバイト位置)を昇順でhitsに最大max_hits個書き込み、件数を返す。
+int textIndex_search(const TextIndex* idx, const u16* query, int query_len, u32* hits, int max_hits);
+
+// fromより後ろ(fromを含まない)で最初の一致位置を返す。末尾まで無ければ先頭から探し直す。
+// 見つからなければfalse。
+bool textIndex_findNext(const TextIndex* idx, const u16* query, int query_len, u32 from, u32* hit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEXT_INDEX_H
@@ -0,0 +1,169 @@
+#include <string.h>
+
+#include "text_pack.h"
+#include "lz77.h"
+
+typedef struct {
+    const u8* blocks;   // どのパックのブロックか (NULLなら空き)
+    u32 block;
+    u32 len;
+    u32 last_use;
+    u8 data[TEXT_PACK_MAX_BLOCK] __attribute__((aligned(4)));
+} TextPackSlot;
+
+static TextPackSlot pack_cache[TEXT_PACK_CACHE_SLOTS];
+static u32 pack_clock = 0;
+
+bool textPack_open(TextPack* pack, const u8* data, u32 size) {
+    const u32* header = (const u32*)data;
+
+    if (size < 20 || ((uintptr_t)data & 3)) return false;
+    if (header[0] != TEXT_PACK_MAGIC) return false;
+    if (header[2] == 0 || header[2] > TEXT_PACK_MAX_BLOCK) return false;
+
+    u32 block_count = header[3];
+    u32 table_end = 16 + 4 * (block_count + 1);
+    if (table_end > size || table_end + header[4 + block_count] > size) return false;
+    if ((u64)block_count * header[2] < header[1]) return false;
+
+    pack->text_size = header[1];
+    pack->block_size = header[2];
+    pack->block_count = block_count;
+    pack->offsets = header + 4;
+    pack->blocks = data + table_end;
+    return true;
+}
+
+static void unpackBlock(const u8* src, u8* dst, u32 size) {
+    if (lz77_isCompressed(src)) {
+        lz77_decompress(src, dst);
+    } else {
+        memcpy(dst, src + 4, size); // 無圧縮で格納されたブロック
+    }
+}
+
+const u8* textPack_block(const TextPack* pack, u32 block, u32* len) {
+    TextPackSlot* victim = &pack_cache[0];
+
+    if (block >= pack->block_count) return NULL;
+
+    pack_clock++;
+    for (int i = 0; i < TEXT_PACK_CACHE_SLOTS; i++) {
+        TextPackSlot* slot = &pack_cache[i];
+        if (slot->blocks == pack->blocks && slot->block == block) {
+            slot->last_use = pack_clock;
+            *len = slot->len;
+            return slot->data;
+        }
+        if (slot->last_use < victim->last_use) victim = slot;
+    }
+
+    // 最も長く使われていないスロットに展開する
+    const u8* src = pack->blocks + pack->offsets[block];
+    u32 size = lz77_size(src); // 無圧縮ブロックも同じヘッダ形式
+    if (size > TEXT_PACK_MAX_BLOCK) return NULL;
+
+    unpackBlock(src, victim->data, size);
+    victim->blocks = pack->blocks;
+    victim->block = block;
+    victim->len = size;
+    victim->last_use = pack_clock;
+
+    *len = size;
+    return victim->data;
+}
+
+const u8* textPack_span(const TextPack* pack, u32 offset, u32* len) {
+    u32 block_len;
+
+    if (offset >= pack->text_size) return NULL;
+
+    u32 block = offset / pack->block_size;
+    u32 inner = offset - block * pack->block_size;
+    const u8* data = textPack_block(pack, block, &block_len);
+    if (data == NULL || inner >= block_len) return NULL;
+
+    *len = block_len - inner;
+    return data + inner;
+}
+
+u32 textPack_read(const TextPack* pack, u32 offset, u8* dst, u32 len) {
+    u32 done = 0;
+
+    while (done < len) {
+        u32 avail;
+        const u8* src = textPack_span(pack, offset + done, &avail);
+        if (src == NULL) break;
+        if (avail > len - done) avail = len - done;
+        memcpy(dst + done, src, avail);
+        done += avail;
+    }
+    return done;
+}
+
+u32 textPack_lineStart(const TextPack* pack, u32 offset) {
+    if (offset > pack->text_size) offset = pack->text_size;
+
+    // offsetの手前のブロックから順に戻る
+    while (offset > 0) {
+        u32 block = (offset - 1) / pack->block_size;
+        u32 base = block * pack->block_size;
+        u32 block_len;
+        const u8* data = textPack_block(pack, block, &block_len);
+        if (data == NULL) break;
+
+        u32 inner = offset - base;
+        if (inner > block_len) inner = block_len;
+        while (inner > 0 && data[inner - 1] != '\n') inner--;
+        if (inner > 0) return base + inner;
+        offset = base;
+    }
+    return 0;
+}
+
+void textPack_flushCache(void) {
+    for (int i = 0; i < TEXT_PACK_CACHE_SLOTS; i++) {
+        pack_cache[i].blocks = NULL;
+        pack_cache[i].last_use = 0;
+    }
+}
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+
+static u8 pack_bench_page[1024];
+
+void textPack_benchmark(const TextPack* pack, int iterations) {
+    u32 seed = 12345;
+    u32 sum = 0;
+    u64 ns;
+
+    iprintf("Text pack: %lu bytes, %lu blocks\n",
+            (unsigned long)pack->text_size, (unsigned long)pack->block_count);
+
+    // キャッシュを捨ててからのページジャンプ (毎回ブロック展開)
+    bench_start();
+    for (int i = 0; i < iterations; i++) {
+        seed = seed * 1103515245 + 12345;
+        textPack_flushCache();
+        sum += textPack_read(pack, (seed >> 8) % pack->text_size, pack_bench_page, sizeof(pack_bench_page));
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" cold jump: %lu us\n", (unsigned long)(ns / 1000 / iterations));
+
+    // 近い位置への連続読み出し (ページ送り相当)
+    u32 offset = 0;
+    bench_start();
+    for (int i = 0; i < iterations; i++) {
+        sum += textPack_read(pack, offset, pack_bench_page, sizeof(pack_bench_page));
+        offset += 512;
+        if (offset >= pack->text_size) offset = 0;
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf(" page turn: %lu us\n", (unsigned long)(ns / 1000 / iterations));
+
+    iprintf(" (checksum %lu)\n", (unsigned long)sum);
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef TEXT_PACK_H
+#define TEXT_PACK_H
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ブロック単位で圧縮した埋め込みテキスト
+//
+// pack_text.pyで本文を一定サイズのブロックに分け、それぞれを
+// BIOSのLZ77形式(0x10)で圧縮してdata/に埋め込む。読み出し時は
+// 要求された位置を含むブロックだけを小さなキャッシュに展開する。
+// 展開はlz77.cを使う。
+
+#define TEXT_PACK_MAGIC 0x314B5054 // 'TPK1'
+
+// 展開キャッシュ (全TextPackで共有する固定領域)
+#define TEXT_PACK_MAX_BLOCK   4096
+#define TEXT_PACK_CACHE_SLOTS 2
+
+typedef struct {
+    u32 text_size;
+    u32 block_size;
+    u32 block_count;
+    const u32* offsets;  // block_count + 1 個
+    const u8* blocks;
+} TextPack;
+
+// パックを開く (dataは4バイト境界に置かれていること)。形式が合わなければfalse。
+bool textPack_open(TextPack* pack, const u8* data, u32 size);
+
+// block番目のブロックを展開してキャッシュ上の先頭を返す。*lenにそのブロックの長さ。
+const u8* textPack_block(const TextPack* pack, u32 block, u32* len);
+
+// offsetから連続して読めるバイト列を返す (ブロック終端まで)。*lenに読める長さ。
+// 範囲外ならNULL。返したポインタは次にキャッシュを使うまで有効。
+const u8* textPack_span(const TextPack* pack, u32 offset, u32* len);
+
+// offsetからlenバイトをdstにコピーする。実際にコピーしたバイト数を返す。
+u32 textPack_read(const TextPack* pack, u32 offset, u8* dst, u32 len);
+
+// offsetを含む行の先頭 (直前の'\n'の次、無ければ0) のバイト位置を返す。
+// '\n'(0x0A)は2バイト文字のtrailにならないので後ろ向きに探せる。
+u32 textPack_lineStart(const TextPack* pack, u32 offset);
+
+// キャッシュを空にする (展開済みブロックを捨てる)
+void textPack_flushCache(void);
+
+#ifdef ENABLE_BENCHMARK
+// ランダムな位置へのページ読み出しを繰り返して時間を表示する
+void textPack_benchmark(const TextPack* pack, int iterations);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEXT_PACK_H
@@ -0,0 +1,192 @@
+#include "worker.h"
+
+#ifndef ARM9
+#ifndef ARM7
+#include <pthread.h>
+#endif
+#endif
+
+void worker_run(WorkerJob* job) {
+    switch (job->type) {
+    case WORKER_JOB_BIG_MUL:
+        job->ok = bignum_mul(&job->u.big.r, &job->u.big.a, &job->u.big.b);
+        break;
+    case WORKER_JOB_BIG_DIV:
+        job->ok = bignum_div(&job->u.big.r, &job->u.big.a, &job->u.big.b, job->u.big.digits);
+        break;
+    case WORKER_JOB_BIG_FACTORIAL:
+        job->ok = bignum_factorial(&job->u.big.r, job->u.big.n);
+        break;
+    case WORKER_JOB_TEXT_FIND:
+        job->ok = textIndex_findNext(job->u.find.index, job->u.find.query, job->u.find.query_len,
+                                     job->u.find.from, &job->u.find.hit);
+        if (job->ok) job->u.find.line = textPack_lineStart(job->u.find.index->text, job->u.find.hit);
+        break;
+    default:
+        job->ok = false;
+        break;
+    }
+}
+
+static bool worker_started = false;
+
+#ifdef ARM9
+// ARM7に送って、まだ返ってきていないジョブの数
+static volatile int worker_inflight = 0;
+
+// ARM7から返ってきたジョブ (FIFOの割り込みで呼ばれる)。
+// 送ってからARM9は書いていないので、キャッシュの該当ラインは捨ててよい
+static void jobDone(void* address, void* userdata) {
+    WorkerJob* job = (WorkerJob*)address;
+    (void)userdata;
+
+    DC_InvalidateRange(job, sizeof(WorkerJob));
+    if (job->type != WORKER_JOB_TEXT_FIND) {
+        DC_InvalidateRange(job->u.big.r.limb, job->u.big.r.cap * sizeof(u32));
+    }
+    job->state = WORKER_DONE;
+    worker_inflight--;
+}
+
+void worker_start(void) {
+    fifoSetAddressHandler(WORKER_FIFO_CHANNEL, jobDone, NULL);
+    worker_started = true;
+}
+
+bool worker_submit(WorkerJob* job) {
+    if (job->state == WORKER_BUSY) return false;
+    if (!worker_started) {
+        worker_run(job);
+        job->state = WORKER_DONE;
+        return true;
+    }
+
+    int old_ime = enterCriticalSection();
+    bool room = worker_inflight < WORKER_QUEUE_SIZE;
+    if (room) worker_inflight++;
+    leaveCriticalSection(old_ime);
+    if (!room) return false;
+
+    job->state = WORKER_BUSY;
+    DC_FlushAll(); // ジョブと入力をARM7から見えるようにする
+    if (!fifoSendAddress(WORKER_FIFO_CHANNEL, job)) {
+        // FIFOの送信バッファがいっぱい: ARM7には届いていないのでここで実行する
+        old_ime = enterCriticalSection();
+        worker_inflight--;
+        leaveCriticalSection(old_ime);
+        worker_run(job);
+        job->state = WORKER_DONE;
+    }
+    return true;
+}
+
+bool worker_finished(WorkerJob* job) {
+    if (job->state != WORKER_DONE) return false;
+    job->state = WORKER_IDLE;
+    return true;
+}
+
+#elif defined(ARM7)
+// ARM9から届いたジョブ。ARM9が送るのはWORKER_QUEUE_SIZE個までなのであふれない
+static WorkerJob* volatile worker_queue[WORKER_QUEUE_SIZE];
+static volatile u32 worker_head = 0;
+static volatile u32 worker_tail = 0;
+
+// 実行したが、FIFOがいっぱいでまだARM9に返せていないジョブ
+static WorkerJob* worker_unsent = NULL;
+
+// FIFOの割り込みで呼ばれる。実行はメインループで行う
+static void jobReceived(void* address, void* userdata) {
+    (void)userdata;
+    worker_queue[worker_tail % WORKER_QUEUE_SIZE] = (WorkerJob*)address;
+    worker_tail++;
+}
+
+void worker_start(void) {
+    fifoSetAddressHandler(WORKER_FIFO_CHANNEL, jobReceived, NULL);
+    worker_started = true;
+}
+
+bool worker_runNext(void) {
+    // 返せていないジョブが先。ARM9が受け取るまで次のジョブは始めない
+    if (worker_unsent != NULL) {
+        if (!fifoSendAddress(WORKER_FIFO_CHANNEL, worker_unsent)) return false;
+        worker_unsent = NULL;
+    }
+    if (worker_head == worker_tail) return false;
+
+    WorkerJob* job = worker_queue[worker_head % WORKER_QUEUE_SIZE];
+    worker_head++;
+    worker_run(job);
+    if (!fifoSendAddress(WORKER_FIFO_CHANNEL, job)) worker_unsent = job;
+    return true;
+}
+
+bool worker_submit(WorkerJob* job) {
+    // ARM7からは送らない (その場で実行する)
+    worker_run(job);
+    job->state = WORKER_DONE;
+    return true;
+}
+
+bool worker_finished(WorkerJob* job) {
+    if (job->state != WORKER_DONE) return false;
+    job->state = WORKER_IDLE;
+    return true;
+}
+
+#else
+// ホストビルド: ARM7の代わりにスレッドで順に実行する
+static pthread_t worker_thread;
+static pthread_mutex_t worker_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t worker_wake = PTHREAD_COND_INITIALIZER;
+static WorkerJob* worker_queue[WORKER_QUEUE_SIZE];
+static u32 worker_head = 0;
+static u32 worker_tail = 0;
+
+static void* workerMain(void* arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&worker_lock);
+        while (worker_head == worker_tail) pthread_cond_wait(&worker_wake, &worker_lock);
+        WorkerJob* job = worker_queue[worker_head % WORKER_QUEUE_SIZE];
+        worker_head++;
+        pthread_mutex_unlock(&worker_lock);
+
+        worker_run(job);
+        __atomic_store_n(&job->state, WORKER_DONE, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+void worker_start(void) {
+    if (worker_started) return;
+    worker_started = pthread_create(&worker_thread, NULL, workerMain, NULL) == 0;
+}
+
+bool worker_submit(WorkerJob* job) {
+    if (__atomic_load_n(&job->state, __ATOMIC_ACQUIRE) == WORKER_BUSY) return false;
+    if (!worker_started) {
+        worker_run(job);
+        job->state = WORKER_DONE;
+        return true;
+    }
+
+    pthread_mutex_lock(&worker_lock);
+    bool room = worker_tail - worker_head < WORKER_QUEUE_SIZE;
+    if (room) {
+        job->state = WORKER_BUSY;
+        worker_queue[worker_tail % WORKER_QUEUE_SIZE] = job;
+        worker_tail++;
+        pthread_cond_signal(&worker_wake);
+    }
+    pthread_mutex_unlock(&worker_lock);
+    return room;
+}
+
+bool worker_finished(WorkerJob* job) {
+    if (__atomic_load_n(&job->state, __ATOMIC_ACQUIRE) != WORKER_DONE) return false;
+    job->state = WORKER_IDLE;
+    return true;
+}
+#endif
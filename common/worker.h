@@ -0,0 +1,97 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include "platform.h"
+#include "bignum.h"
+#include "text_index.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 時間のかかる処理をARM7 (ホストビルドではワーカースレッド) で動かすジョブ
+//
+// ARM9はジョブをメインRAMの静的領域に書いてFIFOでアドレスを送り、ARM7は
+// 順に実行して同じアドレスを送り返す。終わったかどうかは worker_finished() で
+// 毎フレーム調べる。ARM9は描画を続けられるが、ジョブを送ってから終わるまでは
+// ジョブとその入出力 (BigNumのlimbなど) に触れないこと。
+// ARM9のデータキャッシュは送信時に全体を書き戻し、完了時に出力の範囲を捨てる。
+//
+// ARM7には除算器が無いので、ARM7で動くbignumはhw_math.hのCの実装を使う。
+
+// ジョブのアドレスを送るFIFOチャンネル
+#define WORKER_FIFO_CHANNEL FIFO_USER_01
+
+// 同時に送れるジョブの数 (ARM7側のキューの長さ)
+#define WORKER_QUEUE_SIZE 8
+
+// 検索文字列の最大文字数 (IMEの入力バッファと同じ)
+#define WORKER_QUERY_MAX 256
+
+typedef enum {
+    WORKER_JOB_BIG_MUL,       // big.r = big.a * big.b
+    WORKER_JOB_BIG_DIV,       // big.r = big.a / big.b (有効数字 big.digits 桁)
+    WORKER_JOB_BIG_FACTORIAL, // big.r = big.n!
+    WORKER_JOB_TEXT_FIND      // textIndex_findNext() と一致位置の行頭
+} WorkerJobType;
+
+typedef enum {
+    WORKER_IDLE,
+    WORKER_BUSY,
+    WORKER_DONE
+} WorkerState;
+
+// キャッシュラインにそろえ、他の変数と同じラインに載らないようにする
+typedef struct {
+    u32 type;
+    volatile u32 state;
+    bool ok;
+    union {
+        struct {
+            BigNum r;     // 結果の書き込み先 (limbはARM9のアリーナ)
+            BigNum a, b;  // 入力 (rとlimbを共有してよい)
+            u32 n;
+            u32 digits;
+        } big;
+        struct {
+            const TextIndex* index;
+            u32 from;
+            u32 hit;       // 一致位置
+            u32 line;      // hitを含む行の先頭
+            int query_len;
+            u16 query[WORKER_QUERY_MAX];
+        } find;
+    } u;
+} __attribute__((aligned(32))) WorkerJob;
+
+// ワーカーを起動する。ARM9ではFIFOのハンドラを登録し、ARM7ではジョブの受付を
+// 始め、ホストではスレッドを作る。起動していなければジョブはその場で実行する
+void worker_start(void);
+
+// ジョブを送る (job->stateがWORKER_BUSYになる)。
+// jobは静的領域に置くこと (ARM9のスタックはDTCMにあり、ARM7から見えない)。
+// 実行中のジョブか、キューがいっぱいならfalse。FIFOで送れなかったときは
+// ARM9でその場で実行して終わらせる
+bool worker_submit(WorkerJob* job);
+
+// ジョブが終わっていればtrueを返してWORKER_IDLEに戻す。結果はその後で読む
+bool worker_finished(WorkerJob* job);
+
+static inline bool worker_busy(const WorkerJob* job) {
+    return job->state == WORKER_BUSY;
+}
+
+// ジョブをその場で実行する (ARM7とワーカースレッドが呼ぶ)
+void worker_run(WorkerJob* job);
+
+#ifdef ARM7
+// キューから1つ取り出して実行し、ARM9に返す。空ならfalse (ARM7のメインループ用)。
+// FIFOがいっぱいで返せなかったジョブは次の呼び出しで送り直し、送れるまで次を始めない
+bool worker_runNext(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WORKER_H
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Builds the predictive-input dictionary for the kana IME from an SJIS text in texts/.
+#
+#   python3 generate_predict_index.py texts/chumonno_oi_ryoriten.txt data/chumonno_oi_ryoriten_dict.bin
+#
+# Words are the runs of hiragana and of katakana (with the long vowel mark) in
+# the text, counted by frequency. Their readings (katakana folded to hiragana)
+# are stored in a double-array trie, and every trie node carries the ids of the
+# TOP_K most frequent words below it, so the runtime (common/predict.c) steps
+# one array slot per typed kana and reads the candidates without searching.
+# Layout (little endian, every section 4-byte aligned):
+#
+#   u32 magic       'PRD1'
+#   u32 node_count  size of the base/check arrays
+#   u32 word_count
+#   u32 top_k       candidates stored per node
+#   u32 word_starts[word_count + 1]  offset of each word in words[] (u16 units)
+#   u16 base[node_count]
+#   u16 check[node_count]            parent of each slot, 0xFFFF if unused
+#   u16 top[node_count][top_k]       word ids by descending frequency, 0xFFFF = none
+#   u16 words[]                      surface forms as SJIS codes
+#
+# Node 0 is the root. The child of node s for label l is t = base[s] + l if
+# check[t] == s. Labels are 1..83 for ぁ..ん and 84 for ー. A node's list does
+# not contain the word that is spelled exactly like its own reading in
+# hiragana, since that is what has already been typed.
+
+import struct
+import sys
+
+from generate_text_index import decode
+
+MAGIC = 0x31445250  # 'PRD1'
+TOP_K = 4
+NONE = 0xFFFF
+
+MIN_LEN = 2
+MAX_LEN = 10
+
+HIRA_FIRST = 0x829F  # ぁ
+HIRA_LAST = 0x82F1   # ん
+KATA_FIRST = 0x8340  # ァ
+KATA_LAST = 0x8393   # ン (0x837F is unused)
+LONG_MARK = 0x815B   # ー
+LABEL_LONG = HIRA_LAST - HIRA_FIRST + 2
+
+def is_hiragana(c):
+    return HIRA_FIRST <= c <= HIRA_LAST
+
+def is_katakana(c):
+    return KATA_FIRST <= c <= KATA_LAST and c != 0x837F
+
+def label(c):
+    """Trie label of a kana code (the same as predictLabel() in common/predict.c)."""
+    if is_hiragana(c):
+        return c - HIRA_FIRST + 1
+    if is_katakana(c):
+        return c - KATA_FIRST + 1 - (1 if c > 0x837F else 0)
+    if c == LONG_MARK:
+        return LABEL_LONG
+    return 0
+
+def words_in(chars):
+    """Yields the hiragana runs and katakana runs of the decoded text."""
+    run = []
+    kind = None
+    for _, c in chars + [(0, 0)]:
+        k = 'h' if is_hiragana(c) else 'k' if is_katakana(c) or (c == LONG_MARK and kind == 'k') else None
+        if k != kind and run:
+            if MIN_LEN <= len(run) <= MAX_LEN:
+                yield tuple(run)
+            run = []
+        kind = k
+        if k:
+            run.append(c)
+
+def build_double_array(children):
+    """children: node -> {label: child}. Returns (slot of each node, base, check)."""
+    slot = {0: 0}
+    base = [0]
+    check = [NONE]
+    check[0] = 0  # the root has no parent; no child slot can be 0
+    queue = [0]
+    next_free = 1
+    while queue:
+        node = queue.pop(0)
+        kids = children.get(node)
+        if not kids:
+            continue
+        labels = sorted(kids)
+        while next_free < len(check) and check[next_free] != NONE:
+            next_free += 1
+        b = max(1, next_free - labels[0])
+        while True:
+            need = b + labels[-1] + 1
+            if need > len(check):
+                check += [NONE] * (need - len(check))
+                base += [0] * (need - len(base))
+            if all(check[b + l] == NONE for l in labels):
+                break
+            b += 1
+        s = slot[node]
+        base[s] = b
+        for l in labels:
+            check[b + l] = s
+            slot[kids[l]] = b + l
+            queue.append(kids[l])
+    if len(check) >= NONE:
+        raise SystemExit("dictionary too large for u16 slots")
+    return slot, base, check
+
+def main():
+    if len(sys.argv) != 3:
+        print(f"usage: {sys.argv[0]} <text> <dict.bin>", file=sys.stderr)
+        sys.exit(1)
+
+    text = open(sys.argv[1], 'rb').read()
+    freq = {}
+    for w in words_in(list(decode(text))):
+        freq[w] = freq.get(w, 0) + 1
+
+    # word ids in order of frequency (then shorter first, then by code)
+    words = sorted(freq, key=lambda w: (-freq[w], len(w), w))
+
+    children = {}
+    top = {0: []}
+    next_node = 1
+    for wid, w in enumerate(words):
+        node = 0
+        key = [label(c) for c in w]
+        for depth, l in enumerate(key):
+            kids = children.setdefault(node, {})
+            if l not in kids:
+                kids[l] = next_node
+                top[next_node] = []
+                next_node += 1
+            node = kids[l]
+            # a hiragana word is not a candidate at the node of its own reading
+            exact = depth == len(key) - 1 and all(is_hiragana(c) for c in w)
+            if not exact and len(top[node]) < TOP_K:
+                top[node].append(wid)
+
+    slot, base, check = build_double_array(children)
+    node_count = len(check)
+
+    top_array = [NONE] * (node_count * TOP_K)
+    for node, ids in top.items():
+        s = slot[node]
+        for i, wid in enumerate(ids):
+            top_array[s * TOP_K + i] = wid
+
+    starts = []
+    area = []
+    for w in words:
+        starts.append(len(area))
+        area += w
+    starts.append(len(area))
+
+    body = struct.pack(f'<{node_count}H', *base) + struct.pack(f'<{node_count}H', *check)
+    body += struct.pack(f'<{len(top_array)}H', *top_array)
+    body += struct.pack(f'<{len(area)}H', *area)
+    while len(body) % 4:
+        body += b'\0'
+
+    with open(sys.argv[2], 'wb') as f:
+        f.write(struct.pack('<4I', MAGIC, node_count, len(words), TOP_K))
+        f.write(struct.pack(f'<{len(starts)}I', *starts))
+        f.write(body)
+
+    print(f"{sys.argv[1]}: {len(words)} words, {len(top)} trie nodes in {node_count} slots, "
+          f"dictionary {16 + 4 * len(starts) + len(body)} bytes", file=sys.stderr)
+
+if __name__ == '__main__':
+    main()
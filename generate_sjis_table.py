@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Generates common/sjis_table.c, the Shift-JIS (CP932) double-byte to Unicode
+# lookup table used by sjis_toCodepoint().
+#
+#   python3 generate_sjis_table.py > common/sjis_table.c
+#
+# The table is indexed by (lead index * 188 + trail index), where the lead
+# index covers 0x81-0x9F and 0xE0-0xFC and the trail index covers 0x40-0x7E
+# and 0x80-0xFC. Unmapped codes are stored as 0.
+
+LEAD_BYTES = list(range(0x81, 0xA0)) + list(range(0xE0, 0xFD))
+TRAIL_BYTES = list(range(0x40, 0x7F)) + list(range(0x80, 0xFD))
+
+def main():
+    values = []
+    for lead in LEAD_BYTES:
+        for trail in TRAIL_BYTES:
+            try:
+                ch = bytes([lead, trail]).decode('cp932')
+            except UnicodeDecodeError:
+                ch = ''
+            values.append(ord(ch) if len(ch) == 1 and ord(ch) <= 0xFFFF else 0)
+
+    print("/* This file is automatically generated by generate_sjis_table.py */")
+    print("#include \"platform.h\"")
+    print("#include \"sjis.h\"")
+    print("")
+    print("const u16 sjis_unicode_table[SJIS_LEAD_COUNT * SJIS_TRAIL_COUNT] = {")
+    for lead_index, lead in enumerate(LEAD_BYTES):
+        row = values[lead_index * len(TRAIL_BYTES):(lead_index + 1) * len(TRAIL_BYTES)]
+        print(f"    /* 0x{lead:02X} */")
+        for i in range(0, len(row), 12):
+            print("    " + ", ".join(f"0x{v:04X}" for v in row[i:i + 12]) + ",")
+    print("};")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Builds the bigram full-text index for an SJIS text in texts/.
+#
+#   python3 generate_text_index.py texts/chumonno_oi_ryoriten.txt data/chumonno_oi_ryoriten_idx.bin
+#
+# The index is embedded by the DATA (bin2o) rule next to the packed book (see
+# pack_text.py) and read by common/text_index.c. Layout (little endian, every
+# section 4-byte aligned):
+#
+#   u32 magic        'BGI2'
+#   u32 text_size    size of the indexed text in bytes
+#   u32 key_count    number of distinct bigrams
+#   u32 group_count  number of directory entries
+#   u32 area_size    size of the entry area in bytes
+#   u32 directory[group_count][2]  first key of each group, offset of the group in the area
+#   u8  area[area_size]            entries, sorted by key
+#
+# A bigram's key is (code1 << 16) | code2. Each entry is LEB128 coded:
+#
+#   (key - previous key) << 1 | more   the delta is 0 for the first key of a group
+#   count - 2                          only when more is set (count >= 2)
+#   position deltas                    byte offsets of the bigram, ascending
+#
+# Groups hold up to GROUP_KEYS entries, so a lookup is a binary search over the
+# directory and a short scan. Most bigrams occur once or twice, so interleaving
+# keys with their postings costs about 3 bytes per key instead of the 8 of a
+# key table with a u32 offset each.
+#
+# Character codes are the same u16 codes the runtime decoder (common/sjis.c)
+# produces: single bytes as-is, double bytes as (lead << 8) | trail, CRLF and
+# CR folded to '\n'. Bigrams containing a newline or an invalid byte are not
+# indexed.
+
+import struct
+import sys
+
+MAGIC = 0x32494742  # 'BGI2'
+GROUP_KEYS = 16
+INVALID = 0xFFFF
+
+def is_lead(b):
+    return 0x81 <= b <= 0x9F or 0xE0 <= b <= 0xFC
+
+def is_trail(b):
+    return 0x40 <= b <= 0x7E or 0x80 <= b <= 0xFC
+
+def is_single(b):
+    return b <= 0x7F or 0xA1 <= b <= 0xDF
+
+def decode(text):
+    """Yields (byte offset, code) like sjis_next()."""
+    i = 0
+    n = len(text)
+    while i < n:
+        c = text[i]
+        if is_lead(c):
+            if i + 1 < n and is_trail(text[i + 1]):
+                yield i, (c << 8) | text[i + 1]
+                i += 2
+            else:
+                yield i, INVALID
+                i += 1
+        elif c == 0x0D:
+            yield i, 0x0A
+            i += 2 if i + 1 < n and text[i + 1] == 0x0A else 1
+        else:
+            yield i, c if is_single(c) else INVALID
+            i += 1
+
+def leb128(value):
+    out = bytearray()
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return out
+
+def main():
+    if len(sys.argv) != 3:
+        print(f"usage: {sys.argv[0]} <text> <index.bin>", file=sys.stderr)
+        sys.exit(1)
+
+    text = open(sys.argv[1], 'rb').read()
+    chars = list(decode(text))
+
+    postings = {}
+    for (pos, c1), (_, c2) in zip(chars, chars[1:]):
+        if c1 in (0x0A, INVALID) or c2 in (0x0A, INVALID):
+            continue
+        postings.setdefault((c1 << 16) | c2, []).append(pos)
+
+    keys = sorted(postings)
+    directory = []
+    area = bytearray()
+    prev = 0
+    for key in keys:
+        # The shifted delta has to fit 32 bits, so a long jump starts a group
+        if len(directory) == 0 or directory[-1][2] == GROUP_KEYS or key - prev >= 1 << 31:
+            directory.append([key, len(area), 0])
+            prev = key
+        directory[-1][2] += 1
+
+        positions = postings[key]
+        more = 1 if len(positions) > 1 else 0
+        area += leb128(((key - prev) << 1) | more)
+        if more:
+            area += leb128(len(positions) - 2)
+        prev_pos = 0
+        for pos in positions:
+            area += leb128(pos - prev_pos)
+            prev_pos = pos
+        prev = key
+    while len(area) % 4:
+        area.append(0)
+
+    with open(sys.argv[2], 'wb') as f:
+        f.write(struct.pack('<5I', MAGIC, len(text), len(keys), len(directory), len(area)))
+        for key, offset, _ in directory:
+            f.write(struct.pack('<2I', key, offset))
+        f.write(area)
+
+    total = sum(len(p) for p in postings.values())
+    print(f"{sys.argv[1]}: {len(text)} bytes, {len(keys)} bigrams, {total} postings, "
+          f"index {20 + 8 * len(directory) + len(area)} bytes", file=sys.stderr)
+
+if __name__ == '__main__':
+    main()
@@ -1,9 +1,13 @@
 #include <nds.h>
 #include "mplus_font_10x10.h"
 #include "mplus_font_10x10alpha.h"
+#include "draw_font.h"
+#include "glyph_cache.h"
+#include "sjis.h"
+#include "tcm.h"
 
 //FrameBuffer
-void drawFont(int x, int y, u16* buffer, u16 code, u16 color) {
+TCM_CODE void drawFont(int x, int y, u16* buffer, u16 code, u16 color) {
 	int i, j;
 	u16 bit;
 	u16 block;
@@ -29,10 +33,12 @@ void drawFont(int x, int y, u16* buffer, u16 code, u16 color) {
 		}
 	} else {
 	// 2oCg
+		const u16* glyph = glyphCache_get(code);
+
 		for ( i = 0; i < 11; i++ ) {
 			uint16* line = buffer + (SCREEN_WIDTH * i);
 			bit = 0x8000;
-			block = FONT_MPLUS_10x10[code][i];
+			block = glyph[i];
 		
 			for ( j = 0; j < 11; j++ ) {
 				if ( (block & bit) > 0 ) {
@@ -44,3 +50,36 @@ void drawFont(int x, int y, u16* buffer, u16 code, u16 color) {
 	}
 }
 
+// SJISoCg`悷Bʉ[ɒB炻Ŏ~߁AoCgԂB
+// (߂l̕`̊Jnʒuɂ΃y[WɂȂ)
+u32 drawTextSjis(int x, int y, u16* buffer, const u8* text, u32 size, u16 color) {
+	SjisIter it;
+	const u8* start;
+	u16 code;
+	int cx = x;
+
+	sjis_iterInit(&it, text, size);
+	for (;;) {
+		start = it.cur;
+		if ( !sjis_next(&it, &code) && !sjis_flush(&it, &code) ) break;
+
+		if ( code == '\n' ) {
+			cx = x;
+			y += FONT_LINE_HEIGHT;
+			if ( y + FONT_LINE_HEIGHT > SCREEN_HEIGHT ) return (u32)(it.cur - text);
+			continue;
+		}
+
+		int w = ( code < 0x100 ) ? FONT_HALF_WIDTH : FONT_FULL_WIDTH;
+		if ( cx + w > SCREEN_WIDTH ) {
+			cx = x;
+			y += FONT_LINE_HEIGHT;
+			if ( y + FONT_LINE_HEIGHT > SCREEN_HEIGHT ) return (u32)(start - text);
+		}
+		if ( code != SJIS_INVALID ) {
+			drawFont(cx, y, buffer, code, color);
+		}
+		cx += w;
+	}
+	return size;
+}
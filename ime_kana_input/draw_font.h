@@ -1,3 +1,6 @@
-void drawFont(int x, int y, u16* buffer, u16 code, u16 color);
-
+#define FONT_FULL_WIDTH   10 // 2バイト文字の送り幅
+#define FONT_HALF_WIDTH   8  // 1バイト文字の送り幅
+#define FONT_LINE_HEIGHT  13 // 行送り (1バイトフォントの高さ)
 
+void drawFont(int x, int y, u16* buffer, u16 code, u16 color);
+u32 drawTextSjis(int x, int y, u16* buffer, const u8* text, u32 size, u16 color);
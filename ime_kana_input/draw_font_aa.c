@@ -0,0 +1,139 @@
+#include <nds.h>
+
+#include "draw_font.h"
+#include "draw_font_aa.h"
+#include "ipaex_font_data.h"
+
+// シートの配置 (320x96ドット = 8x8タイル 40x12枚、10x10セル 32x9個)
+#define SHEET_TILES_PER_ROW 40
+#define SHEET_CELLS_PER_ROW 32
+#define SHEET_GLYPHS        263
+
+// シート上の並び: ASCII 95文字, ひらがな 84文字, カタカナ 84文字
+#define SHEET_HIRAGANA_FIRST 95
+#define SHEET_KATAKANA_FIRST 179
+
+// 文字ごとに10x10のアルファ段階(0-15)を並べ直したもの
+static u8 aa_glyphs[SHEET_GLYPHS][FONT_AA_SIZE * FONT_AA_SIZE];
+
+// 文字色ごとの合成テーブル: aa_blend_x[アルファ][背景の成分] = 合成後の成分
+static u8 aa_blend_r[FONT_AA_LEVELS][32];
+static u8 aa_blend_g[FONT_AA_LEVELS][32];
+static u8 aa_blend_b[FONT_AA_LEVELS][32];
+static u16 aa_blend_color = 0xFFFF; // テーブルを作った文字色 (0xFFFFは未作成)
+
+static int glyphIndex(u16 code) {
+    if (code >= 0x20 && code <= 0x7E) return code - 0x20;
+    if (code >= 0x82A0 && code <= 0x82F3) return SHEET_HIRAGANA_FIRST + (code - 0x82A0);
+    if (code >= 0x8340 && code <= 0x8393) return SHEET_KATAKANA_FIRST + (code - 0x8340);
+    return -1;
+}
+
+void drawFontAA_init(void) {
+    const u8* tiles = (const u8*)ipaex_font_dataTiles;
+    u8 level[256];
+
+    // パレットは灰色なので赤成分(0-31)をそのまま明るさとして使う
+    for (int i = 0; i < 256; i++) {
+        int grey = ipaex_font_dataPal[i] & 31;
+        level[i] = (u8)((grey * (FONT_AA_LEVELS - 1) + 15) / 31);
+    }
+
+    for (int g = 0; g < SHEET_GLYPHS; g++) {
+        int x0 = (g % SHEET_CELLS_PER_ROW) * FONT_AA_SIZE;
+        int y0 = (g / SHEET_CELLS_PER_ROW) * FONT_AA_SIZE;
+        u8* dst = aa_glyphs[g];
+
+        for (int y = y0; y < y0 + FONT_AA_SIZE; y++) {
+            for (int x = x0; x < x0 + FONT_AA_SIZE; x++) {
+                int tile = (y >> 3) * SHEET_TILES_PER_ROW + (x >> 3);
+                *dst++ = level[tiles[tile * 64 + (y & 7) * 8 + (x & 7)]];
+            }
+        }
+    }
+}
+
+bool drawFontAA_has(u16 code) {
+    return glyphIndex(code) >= 0;
+}
+
+// 文字色が変わったときだけ合成テーブルを作り直す
+static void buildBlendTables(u16 color) {
+    int fr = color & 31;
+    int fg = (color >> 5) & 31;
+    int fb = (color >> 10) & 31;
+    const int max = FONT_AA_LEVELS - 1;
+
+    for (int a = 0; a < FONT_AA_LEVELS; a++) {
+        for (int bg = 0; bg < 32; bg++) {
+            aa_blend_r[a][bg] = (u8)(bg + ((fr - bg) * a + (fr >= bg ? max / 2 : -max / 2)) / max);
+            aa_blend_g[a][bg] = (u8)(bg + ((fg - bg) * a + (fg >= bg ? max / 2 : -max / 2)) / max);
+            aa_blend_b[a][bg] = (u8)(bg + ((fb - bg) * a + (fb >= bg ? max / 2 : -max / 2)) / max);
+        }
+    }
+    aa_blend_color = color;
+}
+
+void drawFontAA(int x, int y, u16* buffer, u16 code, u16 color) {
+    int g = glyphIndex(code);
+    if (g < 0) {
+        drawFont(x, y, buffer, code, color);
+        return;
+    }
+
+    color &= 0x7FFF;
+    if (color != aa_blend_color) buildBlendTables(color);
+
+    const u8* alpha = aa_glyphs[g];
+    buffer += y * SCREEN_WIDTH + x;
+
+    for (int i = 0; i < FONT_AA_SIZE; i++) {
+        u16* line = buffer + SCREEN_WIDTH * i;
+        for (int j = 0; j < FONT_AA_SIZE; j++) {
+            int a = *alpha++;
+            if (a == 0) continue;
+            if (a == FONT_AA_LEVELS - 1) {
+                line[j] = color | 0x8000;
+                continue;
+            }
+            u16 bg = line[j];
+            line[j] = aa_blend_r[a][bg & 31]
+                    | (aa_blend_g[a][(bg >> 5) & 31] << 5)
+                    | (aa_blend_b[a][(bg >> 10) & 31] << 10)
+                    | 0x8000;
+        }
+    }
+}
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+
+// 1フレーム (約1/60秒) のナノ秒
+#define FRAME_NSEC (1000000000ULL / 60)
+
+void drawFontAA_benchmark(u16* buffer) {
+    const int n = 2000;
+    u64 ns;
+
+    // 背景は模様にしておく (合成の読み戻しが起きるように)
+    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+        buffer[i] = RGB15(i & 31, (i >> 5) & 31, 8) | 0x8000;
+    }
+
+    bench_start();
+    for (int i = 0; i < n; i++) {
+        drawFont((i % 24) * 10, ((i / 24) % 16) * 11, buffer, 0x82A0 + (i % 84), RGB15(31,31,31));
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf("1bpp font: %lu glyphs/frame\n", (unsigned long)((u64)n * FRAME_NSEC / (ns + 1)));
+
+    bench_start();
+    for (int i = 0; i < n; i++) {
+        drawFontAA((i % 24) * 10, ((i / 24) % 16) * 11, buffer, 0x82A0 + (i % 84), RGB15(31,31,31));
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf("AA font  : %lu glyphs/frame\n", (unsigned long)((u64)n * FRAME_NSEC / (ns + 1)));
+}
+#endif
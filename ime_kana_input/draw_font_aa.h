@@ -0,0 +1,35 @@
+#ifndef DRAW_FONT_AA_H
+#define DRAW_FONT_AA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ipaexフォントシート(8bpp, 階調付き)によるアンチエイリアス描画
+//
+// シートにはASCII(0x20-0x7E)、ひらがな(0x82A0-0x82F3)、カタカナ(0x8340-0x8393)が
+// 10x10のセルで並んでいる。パレットの灰色をアルファ16段階に直してから、
+// 文字色ごとに作る合成テーブルで背景と混ぜる (画素ごとの乗算なし)。
+
+#define FONT_AA_SIZE   10 // セルの幅と高さ
+#define FONT_AA_LEVELS 16 // アルファの段階数 (0: 透明, 15: 文字色そのもの)
+
+// フォントシートを展開する (最初に一度だけ呼ぶ)
+void drawFontAA_init(void);
+
+// codeの字形がシートにあるか
+bool drawFontAA_has(u16 code);
+
+// codeを背景とアルファ合成して描く。シートに無い文字はdrawFont()で描く。
+void drawFontAA(int x, int y, u16* buffer, u16 code, u16 color);
+
+#ifdef ENABLE_BENCHMARK
+// 1ビット描画とアンチエイリアス描画の1フレームあたりの文字数を表示する
+void drawFontAA_benchmark(u16* buffer);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DRAW_FONT_AA_H
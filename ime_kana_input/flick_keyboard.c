@@ -0,0 +1,253 @@
+#include <nds.h>
+#include <stdlib.h>
+
+#include "flick_keyboard.h"
+#include "glyph_cache.h"
+#include "tcm.h"
+
+// キーの並び (4x4、右の列が機能キー) と大きさ。キーの境目は8ドットの格子に合わせる
+#define FLICK_COLS    4
+#define FLICK_ROWS    4
+#define FLICK_KEYS    (FLICK_COLS * FLICK_ROWS)
+#define KEY_W         56
+#define KEY_H         32
+#define FLICK_LEFT_X  16
+#define FLICK_WIDTH   (KEY_W * FLICK_COLS)
+
+// 方向 (flick_codes の並び。あいうえお の順)
+#define DIR_TAP   0
+#define DIR_LEFT  1
+#define DIR_UP    2
+#define DIR_RIGHT 3
+#define DIR_DOWN  4
+#define DIR_COUNT 5
+
+// 指を離した位置がこれより近ければタップ
+#define FLICK_THRESHOLD 12
+// 方向の表は縦横 ±FLICK_SPAN ドットを FLICK_STEP ドットごとに引く (その外は端に寄せる)
+#define FLICK_SPAN 64
+#define FLICK_STEP 4
+#define DIR_TABLE_SIZE (FLICK_SPAN * 2 / FLICK_STEP + 1)
+
+#define NO_KEY 0xFF
+
+// 下画面のVRAM (VRAM_C) の割り当て。コンソールはマップ22、タイル3 (48KB〜) を使う
+#define FLICK_BG        1
+#define FLICK_TILE_BASE 0  // 1 + 2面 x 448タイル = 約28KB
+#define FLICK_MAP_HIRA  16 // 32KB
+#define FLICK_MAP_KATA  17 // 34KB
+
+#define TILE_COLS     (FLICK_WIDTH / 8)
+#define TILES_PER_SET (TILE_COLS * FLICK_HEIGHT / 8)
+
+// パレットはBGの16色の組の1番と2番 (押しているキー)。コンソールは各組の15番だけを使う
+#define PAL_NORMAL  1
+#define PAL_PRESSED 2
+#define COLOR_FACE  1
+#define COLOR_LABEL 2
+#define COLOR_HINT  3
+
+#define CODE_KANA_TOGGLE 0x02 // ひらがなとカタカナの面の切り替え (外には返さない)
+
+// キーごとの タップ、左、上、右、下 の文字。0はその方向に何も無い
+static const u16 flick_codes[FLICK_KEYS][DIR_COUNT] = {
+    {0x82A0, 0x82A2, 0x82A4, 0x82A6, 0x82A8}, // あいうえお
+    {0x82A9, 0x82AB, 0x82AD, 0x82AF, 0x82B1}, // かきくけこ
+    {0x82B3, 0x82B5, 0x82B7, 0x82B9, 0x82BB}, // さしすせそ
+    {'\b', '\b', '\b', '\b', '\b'},
+    {0x82BD, 0x82BF, 0x82C2, 0x82C4, 0x82C6}, // たちつてと
+    {0x82C8, 0x82C9, 0x82CA, 0x82CB, 0x82CC}, // なにぬねの
+    {0x82CD, 0x82D0, 0x82D3, 0x82D6, 0x82D9}, // はひふへほ
+    {0x8140, 0x8140, 0x8140, 0x8140, 0x8140}, // 空白
+    {0x82DC, 0x82DD, 0x82DE, 0x82DF, 0x82E0}, // まみむめも
+    {0x82E2, 0x8169, 0x82E4, 0x816A, 0x82E6}, // や（ゆ）よ
+    {0x82E7, 0x82E8, 0x82E9, 0x82EA, 0x82EB}, // らりるれろ
+    {CODE_KANA_TOGGLE, CODE_KANA_TOGGLE, CODE_KANA_TOGGLE, CODE_KANA_TOGGLE, CODE_KANA_TOGGLE},
+    {FLICK_CODE_VARIANT, FLICK_CODE_VARIANT, FLICK_CODE_VARIANT, FLICK_CODE_VARIANT, FLICK_CODE_VARIANT},
+    {0x82ED, 0x82F0, 0x82F1, 0x815B, 0},      // わをんー
+    {0x8141, 0x8142, 0x8148, 0x8149, 0},      // 、。？！
+    {'\n', '\n', '\n', '\n', '\n'},
+};
+
+// 文字の代わりに2文字の名前を描くキー (0のキーは flick_codes の文字を並べる)
+static const u16 key_labels[FLICK_KEYS][2] = {
+    [3]  = {0x8DED, 0x8F9C}, // 削除
+    [7]  = {0x8BF3, 0x9492}, // 空白
+    [11] = {0x82A9, 0x82C8}, // かな (カタカナの面では カナ)
+    [12] = {0x814A, 0x814B}, // ゛゜
+    [15] = {0x8C9F, 0x8DF5}, // 検索
+};
+
+// キーの中の各方向の文字の位置 (11ドットのグリフの左上)
+static const u8 hint_x[DIR_COUNT] = {22, 4, 22, 40, 22};
+static const u8 hint_y[DIR_COUNT] = {11, 11, 1, 11, 21};
+
+// 8ドットのセルごとのキーの番号と、指の移動量ごとの方向。タッチのたびに引く
+static u8 key_at[FLICK_HEIGHT / 8][SCREEN_WIDTH / 8] TCM_BSS;
+static u8 dir_table[DIR_TABLE_SIZE][DIR_TABLE_SIZE] TCM_BSS;
+
+static int bg_id;
+static bool katakana = false;
+static int touch_key = -1;
+static int touch_x0, touch_y0;
+
+static u16 toKatakana(u16 code) {
+    if (code < 0x829F || code > 0x82F1) return code;
+    u16 i = code - 0x829F;
+    return 0x8340 + i + (i >= 0x3F ? 1 : 0);
+}
+
+// キーボードの左上を原点にした1画素を面のタイルに書く (VRAMなので16ビットで読み書きする)
+static void putPixel(u16* tiles, int x, int y, int color) {
+    u16* p = tiles + ((y >> 3) * TILE_COLS + (x >> 3)) * 16 + (y & 7) * 2 + ((x & 7) >> 2);
+    int shift = (x & 3) * 4;
+    *p = (*p & ~(0xF << shift)) | (color << shift);
+}
+
+static void drawGlyph(u16* tiles, int x, int y, u16 code, int color) {
+    const u16* glyph = glyphCache_get(code);
+    for (int i = 0; i < 11; i++) {
+        u16 bits = glyph[i];
+        for (int j = 0; j < 11; j++) {
+            if (bits & (0x8000 >> j)) putPixel(tiles, x + j, y + i, color);
+        }
+    }
+}
+
+static void drawKey(u16* tiles, int key, bool kata) {
+    int x0 = (key % FLICK_COLS) * KEY_W;
+    int y0 = (key / FLICK_COLS) * KEY_H;
+
+    // 周り1ドットは透明にしてキーの間の隙間にする
+    for (int y = 1; y < KEY_H - 1; y++) {
+        for (int x = 1; x < KEY_W - 1; x++) putPixel(tiles, x0 + x, y0 + y, COLOR_FACE);
+    }
+
+    const u16* label = key_labels[key];
+    if (label[0] != 0) {
+        int x = x0 + (KEY_W - 22) / 2;
+        for (int i = 0; i < 2; i++) {
+            u16 code = kata ? toKatakana(label[i]) : label[i];
+            drawGlyph(tiles, x + i * 11, y0 + hint_y[DIR_TAP], code, COLOR_LABEL);
+        }
+        return;
+    }
+    for (int d = 0; d < DIR_COUNT; d++) {
+        u16 code = flick_codes[key][d];
+        if (code == 0) continue;
+        if (kata) code = toKatakana(code);
+        drawGlyph(tiles, x0 + hint_x[d], y0 + hint_y[d], code, d == DIR_TAP ? COLOR_LABEL : COLOR_HINT);
+    }
+}
+
+// 面のタイルを順に並べたマップを作る
+static void fillMap(u16* map, int first_tile) {
+    for (int r = 0; r < FLICK_HEIGHT / 8; r++) {
+        u16* line = map + (FLICK_TOP_Y / 8 + r) * 32 + FLICK_LEFT_X / 8;
+        for (int c = 0; c < TILE_COLS; c++) {
+            line[c] = (u16)(first_tile + r * TILE_COLS + c) | (PAL_NORMAL << 12);
+        }
+    }
+}
+
+// 表示中の面でキーの色を変える (マップの28個の項目のパレットの番号だけ書き換える)
+static void setKeyPalette(int key, int palette) {
+    u16* map = (u16*)BG_MAP_RAM_SUB(katakana ? FLICK_MAP_KATA : FLICK_MAP_HIRA);
+    int col = FLICK_LEFT_X / 8 + (key % FLICK_COLS) * (KEY_W / 8);
+    int row = FLICK_TOP_Y / 8 + (key / FLICK_COLS) * (KEY_H / 8);
+    for (int r = 0; r < KEY_H / 8; r++) {
+        u16* line = map + (row + r) * 32 + col;
+        for (int c = 0; c < KEY_W / 8; c++) line[c] = (line[c] & 0x0FFF) | (palette << 12);
+    }
+}
+
+static void buildTables(void) {
+    for (int r = 0; r < FLICK_HEIGHT / 8; r++) {
+        for (int c = 0; c < SCREEN_WIDTH / 8; c++) {
+            int x = c * 8 - FLICK_LEFT_X;
+            key_at[r][c] = (x < 0 || x >= FLICK_WIDTH) ? NO_KEY
+                         : (u8)((r * 8 / KEY_H) * FLICK_COLS + x / KEY_W);
+        }
+    }
+    for (int i = 0; i < DIR_TABLE_SIZE; i++) {
+        for (int j = 0; j < DIR_TABLE_SIZE; j++) {
+            int dx = j * FLICK_STEP - FLICK_SPAN;
+            int dy = i * FLICK_STEP - FLICK_SPAN;
+            u8 dir;
+            if (dx * dx + dy * dy < FLICK_THRESHOLD * FLICK_THRESHOLD) dir = DIR_TAP;
+            else if (abs(dx) >= abs(dy)) dir = dx < 0 ? DIR_LEFT : DIR_RIGHT;
+            else dir = dy < 0 ? DIR_UP : DIR_DOWN;
+            dir_table[i][j] = dir;
+        }
+    }
+}
+
+static TCM_CODE int flickDirection(int dx, int dy) {
+    if (dx < -FLICK_SPAN) dx = -FLICK_SPAN;
+    else if (dx > FLICK_SPAN) dx = FLICK_SPAN;
+    if (dy < -FLICK_SPAN) dy = -FLICK_SPAN;
+    else if (dy > FLICK_SPAN) dy = FLICK_SPAN;
+    return dir_table[(dy + FLICK_SPAN) / FLICK_STEP][(dx + FLICK_SPAN) / FLICK_STEP];
+}
+
+void flickKeyboard_init(void) {
+    buildTables();
+
+    bg_id = bgInitSub(FLICK_BG, BgType_Text4bpp, BgSize_T_256x256, FLICK_MAP_HIRA, FLICK_TILE_BASE);
+    bgSetPriority(bg_id, 1); // コンソールの文字を上に出す
+
+    u16* tiles = (u16*)bgGetGfxPtr(bg_id);
+    dmaFillWords(0, tiles, (1 + 2 * TILES_PER_SET) * 32); // タイル0は透明のまま使う
+    dmaFillWords(0, BG_MAP_RAM_SUB(FLICK_MAP_HIRA), 2 * 2048);
+
+    BG_PALETTE_SUB[PAL_NORMAL * 16 + COLOR_FACE]   = RGB15(5, 5, 8);
+    BG_PALETTE_SUB[PAL_NORMAL * 16 + COLOR_LABEL]  = RGB15(31, 31, 31);
+    BG_PALETTE_SUB[PAL_NORMAL * 16 + COLOR_HINT]   = RGB15(15, 15, 19);
+    BG_PALETTE_SUB[PAL_PRESSED * 16 + COLOR_FACE]  = RGB15(8, 14, 24);
+    BG_PALETTE_SUB[PAL_PRESSED * 16 + COLOR_LABEL] = RGB15(31, 31, 31);
+    BG_PALETTE_SUB[PAL_PRESSED * 16 + COLOR_HINT]  = RGB15(24, 26, 31);
+
+    for (int set = 0; set < 2; set++) {
+        u16* set_tiles = tiles + (1 + set * TILES_PER_SET) * 16;
+        for (int key = 0; key < FLICK_KEYS; key++) drawKey(set_tiles, key, set == 1);
+        fillMap((u16*)BG_MAP_RAM_SUB(set ? FLICK_MAP_KATA : FLICK_MAP_HIRA), 1 + set * TILES_PER_SET);
+    }
+    katakana = false;
+    touch_key = -1;
+}
+
+void flickKeyboard_show(void) { bgShow(bg_id); }
+
+void flickKeyboard_hide(void) {
+    if (touch_key >= 0) setKeyPalette(touch_key, PAL_NORMAL);
+    touch_key = -1;
+    bgHide(bg_id);
+}
+
+u16 flickKeyboard_touch(const InputEvent* event) {
+    if (event->type == INPUT_TOUCH_DOWN) {
+        int y = event->y - FLICK_TOP_Y;
+        if (y < 0 || y >= FLICK_HEIGHT || event->x >= SCREEN_WIDTH) return 0;
+        u8 key = key_at[y >> 3][event->x >> 3];
+        if (key == NO_KEY) return 0;
+
+        touch_key = key;
+        touch_x0 = event->x;
+        touch_y0 = event->y;
+        setKeyPalette(key, PAL_PRESSED);
+        return 0;
+    }
+    if (event->type != INPUT_TOUCH_UP || touch_key < 0) return 0;
+
+    int key = touch_key;
+    touch_key = -1;
+    setKeyPalette(key, PAL_NORMAL);
+
+    u16 code = flick_codes[key][flickDirection(event->x - touch_x0, event->y - touch_y0)];
+    if (code == CODE_KANA_TOGGLE) {
+        katakana = !katakana;
+        bgSetMapBase(bg_id, katakana ? FLICK_MAP_KATA : FLICK_MAP_HIRA);
+        return 0;
+    }
+    return katakana ? toKatakana(code) : code;
+}
@@ -0,0 +1,41 @@
+#ifndef FLICK_KEYBOARD_H
+#define FLICK_KEYBOARD_H
+
+#include <nds.h>
+#include "input.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 下画面の12キーのフリック入力キーボード
+//
+// かな3x4と機能キー4つを、起動時に一度だけ下画面のBG1 (4bpp) のタイルに描く。
+// ひらがなとカタカナの2面を描いておき、切り替えはマップの差し替えだけ。
+// コンソール (BG0) はその上に重なる。
+// タッチした位置から8ドット単位の表でキーを引き、離した位置との差から
+// 同じく表で方向 (タップ、左、上、右、下) を引くので、判定に計算はほとんど要らない。
+// 入力はSJISのかなをそのまま返す (ローマ字を通さない)。
+
+// 画面上のキーボードの位置と大きさ (ドット)
+#define FLICK_TOP_Y    64
+#define FLICK_HEIGHT   128
+
+// flickKeyboard_touch() が返す文字以外の値
+#define FLICK_CODE_VARIANT 0x01 // 最後の文字の濁点・半濁点・小書きの切り替え
+
+// BG1と表を用意してキーボードを描く (consoleDemoInit() の後で一度だけ呼ぶ)
+void flickKeyboard_init(void);
+
+void flickKeyboard_show(void);
+void flickKeyboard_hide(void);
+
+// タッチのイベントを渡す。指を離したときに入力された文字を返し、それ以外は0。
+// 返すのはSJISの文字、'\b' (1文字消す)、'\n' (検索)、FLICK_CODE_VARIANT のどれか
+u16 flickKeyboard_touch(const InputEvent* event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLICK_KEYBOARD_H
@@ -0,0 +1,53 @@
+#include "frame_buffer.h"
+
+// 消去に使うDMAチャンネル (dmaCopy/dmaFill はチャンネル3を使う)
+#define FRAME_BUFFER_DMA 2
+
+#define FRAME_BUFFER_WORDS (FRAME_BUFFER_WIDTH * FRAME_BUFFER_HEIGHT * 2 / 4)
+
+static u16* const frame_banks[2] = {VRAM_A, VRAM_B};
+static volatile int frame_front = 0;        // 表示中のバンク
+static volatile bool frame_pending = false;  // 次のVBlankで切り替える
+
+// 裏バッファを0で埋め始める (完了を待たない)
+static void startClear(void) {
+    DMA_FILL(FRAME_BUFFER_DMA) = 0;
+    DMA_SRC(FRAME_BUFFER_DMA) = (u32)&DMA_FILL(FRAME_BUFFER_DMA);
+    DMA_DEST(FRAME_BUFFER_DMA) = (u32)frame_banks[frame_front ^ 1];
+    DMA_CR(FRAME_BUFFER_DMA) = DMA_ENABLE | DMA_START_NOW | DMA_32_BIT |
+                               DMA_SRC_FIX | DMA_DST_INC | FRAME_BUFFER_WORDS;
+}
+
+static void vblankIrq(void) {
+    if (!frame_pending) return;
+    frame_front ^= 1;
+    videoSetMode(frame_front == 0 ? MODE_FB0 : MODE_FB1);
+    frame_pending = false;
+    startClear();
+}
+
+void frameBuffer_init(void) {
+    vramSetBankA(VRAM_A_LCD);
+    vramSetBankB(VRAM_B_LCD);
+    frame_front = 0;
+    frame_pending = false;
+    videoSetMode(MODE_FB0);
+
+    dmaFillWords(0, frame_banks[0], FRAME_BUFFER_WIDTH * FRAME_BUFFER_HEIGHT * 2);
+    startClear();
+
+    irqSet(IRQ_VBLANK, vblankIrq);
+    irqEnable(IRQ_VBLANK);
+}
+
+bool frameBuffer_ready(void) {
+    return !frame_pending && !(DMA_CR(FRAME_BUFFER_DMA) & DMA_BUSY);
+}
+
+u16* frameBuffer_back(void) {
+    return frame_banks[frame_front ^ 1];
+}
+
+void frameBuffer_present(void) {
+    frame_pending = true;
+}
@@ -0,0 +1,37 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <nds.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// メイン画面のダブルバッファ (VRAM_A と VRAM_B の直接表示モード)
+//
+// 表示していない方のバンクに描いて frameBuffer_present() を呼ぶと、次の
+// VBlank割り込みで MODE_FB0 / MODE_FB1 を切り替える。切り替えた直後に
+// 新しい裏バッファの消去をDMAで始めるので、CPUが入力を処理している間に
+// 消去が終わる。描いている途中の画面は表示されない (ティアリングしない)。
+
+#define FRAME_BUFFER_WIDTH  256
+#define FRAME_BUFFER_HEIGHT 192
+
+// 両方のバンクをLCDに割り当てて消去し、VBlank割り込みを登録する
+void frameBuffer_init(void);
+
+// 裏バッファに描けるか (前の切り替えが済み、消去も終わっている)。
+// falseなら待たずに次のフレームで描き直す
+bool frameBuffer_ready(void);
+
+// 描画先 (裏バッファ)。frameBuffer_ready() がtrueのときだけ描く
+u16* frameBuffer_back(void);
+
+// 描き終わった裏バッファを次のVBlankで表示する
+void frameBuffer_present(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_BUFFER_H
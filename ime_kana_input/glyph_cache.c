@@ -0,0 +1,119 @@
+#include <nds.h>
+
+#include "glyph_cache.h"
+#include "mplus_font_10x10.h"
+#include "lz77.h"
+
+static u16 glyph_slots[GLYPH_CACHE_SLOTS][GLYPH_CELLS * GLYPH_WORDS] __attribute__((aligned(4)));
+static s8 slot_row[GLYPH_CACHE_SLOTS] = { [0 ... GLYPH_CACHE_SLOTS - 1] = -1 };
+static u32 slot_use[GLYPH_CACHE_SLOTS];
+static s8 row_slot[GLYPH_ROWS] = { [0 ... GLYPH_ROWS - 1] = -1 };
+static u32 glyph_clock = 0;
+static u32 glyph_hits = 0;
+static u32 glyph_misses = 0;
+
+static const u16 glyph_blank[GLYPH_WORDS] = {0};
+
+// SJISコードから区(0始まり)と区内の位置を求める。JIS X 0208の範囲外なら-1。
+static inline int glyphRow(u16 code, int* cell) {
+    u8 lead = code >> 8;
+    u8 trail = code & 0xFF;
+    int row;
+
+    if (lead >= 0x81 && lead <= 0x9F) row = (lead - 0x81) * 2;
+    else if (lead >= 0xE0 && lead <= 0xEF) row = (lead - 0xC1) * 2;
+    else return -1;
+
+    if (trail >= 0x40 && trail <= 0x7E) {
+        *cell = trail - 0x40;
+    } else if (trail >= 0x80 && trail <= 0x9E) {
+        *cell = trail - 0x41;
+    } else if (trail >= 0x9F && trail <= 0xFC) {
+        *cell = trail - 0x9F;
+        row++;
+    } else {
+        return -1;
+    }
+    return row;
+}
+
+const u16* glyphCache_get(u16 code) {
+    int cell;
+    int row = glyphRow(code, &cell);
+    if (row < 0) return glyph_blank;
+
+    glyph_clock++;
+
+    int slot = row_slot[row];
+    if (slot >= 0) {
+        glyph_hits++;
+        slot_use[slot] = glyph_clock;
+        return &glyph_slots[slot][cell * GLYPH_WORDS];
+    }
+
+    u32 start = FONT_MPLUS_10x10_GROUP_OFFSETS[row];
+    if (start == FONT_MPLUS_10x10_GROUP_OFFSETS[row + 1]) return glyph_blank; // 字形の無い区
+
+    // 最も長く使われていないスロットを追い出して展開する
+    glyph_misses++;
+    slot = 0;
+    for (int i = 1; i < GLYPH_CACHE_SLOTS; i++) {
+        if (slot_use[i] < slot_use[slot]) slot = i;
+    }
+    if (slot_row[slot] >= 0) row_slot[(int)slot_row[slot]] = -1;
+
+    lz77_decompress(FONT_MPLUS_10x10_PACKED + start, (u8*)glyph_slots[slot]);
+    slot_row[slot] = row;
+    row_slot[row] = slot;
+    slot_use[slot] = glyph_clock;
+
+    return &glyph_slots[slot][cell * GLYPH_WORDS];
+}
+
+void glyphCache_clear(void) {
+    for (int i = 0; i < GLYPH_CACHE_SLOTS; i++) {
+        slot_row[i] = -1;
+        slot_use[i] = 0;
+    }
+    for (int i = 0; i < GLYPH_ROWS; i++) {
+        row_slot[i] = -1;
+    }
+}
+
+void glyphCache_stats(u32* hits, u32* misses) {
+    *hits = glyph_hits;
+    *misses = glyph_misses;
+}
+
+#ifdef ENABLE_BENCHMARK
+#include "bench.h"
+
+void glyphCache_benchmark(void) {
+    const int n = 1000;
+    u32 sum = 0;
+    u64 ns;
+
+    // 毎回展開 (区をまたいで引き続けてキャッシュを溢れさせる)
+    glyphCache_clear();
+    bench_start();
+    for (int i = 0; i < n; i++) {
+        // 第1バイト0x88～0x9Fの24通り (亜の区から1つおきの24区、どれも漢字で埋まっている)
+        u16 code = ((0x88 + (i * 7) % 24) << 8) | 0x9F;
+        sum += glyphCache_get(code)[5];
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf("Glyph miss: %lu cycles\n", (unsigned long)bench_cyclesPerOp(ns, n));
+
+    // 展開済みの区 (ひらがな) を引くだけ
+    glyphCache_get(0x82A0);
+    bench_start();
+    for (int i = 0; i < n; i++) {
+        sum += glyphCache_get(0x829F + (i % 83))[5];
+    }
+    ns = bench_elapsedNsec();
+    bench_stop();
+    iprintf("Glyph hit : %lu cycles\n", (unsigned long)bench_cyclesPerOp(ns, n));
+    iprintf(" (checksum %lu)\n", (unsigned long)sum);
+}
+#endif
@@ -0,0 +1,38 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 10x10漢字フォントのオンデマンド展開キャッシュ
+//
+// フォントはpack_font.pyでJISの区(94文字)ごとにLZ77圧縮して埋め込んである。
+// 文字を引くとその区を丸ごと展開してスロットに置き、以後は展開済みを返す。
+// スロットが埋まったら最も長く使われていない区を捨てる。
+// メモリ使用量は GLYPH_CACHE_SLOTS x 2068バイトで固定。
+
+#define GLYPH_CACHE_SLOTS 16
+#define GLYPH_ROWS        94   // JIS X 0208の区
+#define GLYPH_CELLS       94   // 1区あたりの文字数
+#define GLYPH_WORDS       11   // 1文字あたりのu16 (drawFont()の11行)
+
+// SJISの2バイトコードに対応するグリフ(11ワード)を返す。
+// 範囲外や字形の無い区は空白のグリフを返すのでNULLにはならない。
+const u16* glyphCache_get(u16 code);
+
+// 展開済みの区を全て捨てる
+void glyphCache_clear(void);
+
+// ヒット/ミスの回数 (ベンチマーク・デバッグ用)
+void glyphCache_stats(u32* hits, u32* misses);
+
+#ifdef ENABLE_BENCHMARK
+void glyphCache_benchmark(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GLYPH_CACHE_H
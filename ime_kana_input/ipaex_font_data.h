@@ -0,0 +1,24 @@
+
+//{{BLOCK(ipaex_font_data)
+
+//======================================================================
+//
+//	ipaex_font_data, 320x96@8, 
+//	+ palette 256 entries, not compressed
+//	+ 480 tiles not compressed
+//	Total size: 512 + 30720 = 31232
+//
+//======================================================================
+
+#ifndef GRIT_IPAEX_FONT_DATA_H
+#define GRIT_IPAEX_FONT_DATA_H
+
+#define ipaex_font_dataTilesLen 30720
+extern const unsigned int ipaex_font_dataTiles[7680];
+
+#define ipaex_font_dataPalLen 512
+extern const unsigned short ipaex_font_dataPal[256];
+
+#endif // GRIT_IPAEX_FONT_DATA_H
+
+//}}BLOCK(ipaex_font_data)
@@ -2,151 +2,416 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdlib.h>
 
 #include "kana_ime.h"
 #include "draw_font.h"
-#include "romakana_map.h"
+#include "draw_font_aa.h"
+#include "frame_buffer.h"
+#include "glyph_cache.h"
+#include "flick_keyboard.h"
+#include "text_pack.h"
+#include "text_index.h"
+#include "text_reader.h"
+#include "predict.h"
+#include "handwriting.h"
+#include "text_console.h"
+#include "worker.h"
+#include "tcm.h"
+#include "chumonno_oi_ryoriten_pack_bin.h"
+#include "chumonno_oi_ryoriten_idx_bin.h"
+#include "chumonno_oi_ryoriten_dict_bin.h"
 
 #define ENABLE_DEBUG_LOG
 
+// ログは候補欄の下から書き、clearConsole() で先頭に戻る
+#define DEBUG_TOP_ROW 2
+static int debug_row = DEBUG_TOP_ROW;
+static int debug_col = 0;
+
 #ifdef ENABLE_DEBUG_LOG
 void debug_log(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    viprintf(format, args);
+    textConsole_vprint(&debug_row, &debug_col, format, args);
     va_end(args);
 }
 #else
 void debug_log(const char* format, ...) { (void)format; }
 #endif
 
-static u16* mainScreenBuffer = NULL;
-static char input_romaji_buffer[32] = {0};
-static int input_romaji_len = 0;
 static u16 converted_kana_buffer[256] = {0};
 static int converted_kana_len = 0;
 
-void kanaIME_init(void) {
-    videoSetMode(MODE_FB0);
-    vramSetBankA(VRAM_A_LCD);
-    mainScreenBuffer = (u16*)VRAM_A;
+// 予測候補の行と本文の表示開始位置 (入力行の下)
+#define CANDIDATE_Y 22
+#define READER_TOP_Y 36
+
+// 下画面のコンソールの上2行が候補を選ぶ欄 (1つ8文字 = 64ドット)
+#define CANDIDATE_SLOT_WIDTH 64
+#define CANDIDATE_STRIP_HEIGHT 16
+
+// 予測変換。predict_nodes[i] は converted_kana_buffer の先頭i文字のうち、
+// 最後の語 (かな以外の文字の後) の読みのノード。1文字足すごとに1つ進めるだけなので、
+// 候補は打鍵ごとに一定の手間で出る
+static PredictDict predict_dict;
+static bool predict_ok = false;
+static u16 predict_nodes[256 + 1] = {PREDICT_ROOT};
+static int predict_len = 0; // predict_nodes の有効な長さ - 1
+static u16 candidate_ids[PREDICT_TOP_K];
+static int candidate_count = 0;
+
+// 手書き入力 (SELECTでキーボードと切り替える)。候補欄より下に書き、
+// ペンを上げて0.5秒たったら1文字として認識して入力行に足す。
+// 軌跡はコンソールの文字のセルに '*' で描く
+#define PAD_COMMIT_FRAMES 30
+#define PAD_CELL_PX 8
+#define PAD_SET_COUNT 3
+
+static HwInk pad_ink;
+static bool pad_active = false;
+static int pad_idle_frames = 0;
+static int pad_set = 0; // Xで切り替える
+static const u32 pad_sets[PAD_SET_COUNT] = {HW_SET_HIRAGANA, HW_SET_KATAKANA, HW_SET_DIGITS | HW_SET_OPERATORS};
+static const char* const pad_set_names[PAD_SET_COUNT] = {"HIRA", "KATA", "NUM "};
+
+static TextPack book_pack;
+static TextIndex book_index;
+static bool book_index_ok = false;
+static u32 last_hit = 0;
+static bool has_hit = false;
 
-    consoleDemoInit();
-    keyboardDemoInit();
-    keyboardShow();
+// 検索はARM7で行う (ビグラムの突き合わせと一致位置の行頭探し)。
+// 結果が返るまでの間も描画とキー入力は止めない
+static WorkerJob search_job;
 
+// 入力中のかなで本文を検索し、次の一致位置へリーダーを移動する
+static void searchBook(void) {
+    if (!book_index_ok || converted_kana_len == 0 || worker_busy(&search_job)) return;
+
+    search_job.type = WORKER_JOB_TEXT_FIND;
+    search_job.u.find.index = &book_index;
+    search_job.u.find.from = has_hit ? last_hit : textReader_offset();
+    search_job.u.find.query_len = converted_kana_len;
+    memcpy(search_job.u.find.query, converted_kana_buffer, sizeof(u16) * converted_kana_len);
+    worker_submit(&search_job);
+}
+
+// 検索の結果が返っていればリーダーを移動する。移動したらtrue
+static bool searchFinished(void) {
+    if (!worker_finished(&search_job)) return false;
+
+    if (!search_job.ok) {
+        #ifdef ENABLE_DEBUG_LOG
+        debug_log("Not found\n");
+        #endif
+        return false;
+    }
+    textReader_jumpToLine(search_job.u.find.line);
+    last_hit = search_job.u.find.hit;
+    has_hit = true;
     #ifdef ENABLE_DEBUG_LOG
-    iprintf("\x1b[2J");
-    debug_log("Kana IME Initialized.\n");
+    debug_log("Hit: %lu\n", (unsigned long)last_hit);
     #endif
+    return true;
 }
 
-void kanaIME_update(void) {
-    int key = keyboardUpdate();
+// converted_kana_buffer の変更 (末尾への追加と削除) に合わせてノードを進め、候補を引く
+static void predictSync(void) {
+    if (!predict_ok) return;
 
-    if (key <= 0) {
-        return;
+    if (predict_len > converted_kana_len) predict_len = converted_kana_len;
+    while (predict_len < converted_kana_len) {
+        predict_nodes[predict_len + 1] = predict_step(&predict_dict, predict_nodes[predict_len],
+                                                      converted_kana_buffer[predict_len]);
+        predict_len++;
     }
+    candidate_count = predict_candidates(&predict_dict, predict_nodes[predict_len], candidate_ids);
+}
 
-    #ifdef ENABLE_DEBUG_LOG
-    iprintf("\x1b[2J");
-    debug_log("Key: %c (0x%X)\n", (key > 31 && key < 127) ? key : '?', key);
-    debug_log("Before: Romaji='%s' (%d)\n", input_romaji_buffer, input_romaji_len);
-    #endif
+// 入力中の語をk番目の候補で置き換える
+static void commitCandidate(int k) {
+    if (k >= candidate_count) return;
 
-    if (key == '\b') { 
-        if (input_romaji_len > 0) {
-            input_romaji_len--;
-            input_romaji_buffer[input_romaji_len] = '\0';
-        } else if (converted_kana_len > 0) {
-            converted_kana_len--;
-            converted_kana_buffer[converted_kana_len] = 0;
-        }
-    } else if (key == '\n') { 
-        if (input_romaji_len == 1 && input_romaji_buffer[0] == 'n') {
-            if(converted_kana_len < 255) {
-                converted_kana_buffer[converted_kana_len++] = 0x82f1; // ん
-            }
-            input_romaji_len = 0;
-            input_romaji_buffer[0] = '\0';
-        }
-    } else if (key == ' ') {
-        if (input_romaji_len == 1 && input_romaji_buffer[0] == 'n') {
-            if(converted_kana_len < 255) {
-                converted_kana_buffer[converted_kana_len++] = 0x82f1; // ん
-            }
-        }
-        input_romaji_len = 0;
-        input_romaji_buffer[0] = '\0';
+    int start = converted_kana_len;
+    while (start > 0 && predict_nodes[start] != PREDICT_ROOT) start--;
 
-        if(converted_kana_len < 255) {
-            converted_kana_buffer[converted_kana_len++] = 0x8140;
-        }
-    } else { 
-        if (input_romaji_len < 30) {
-            input_romaji_buffer[input_romaji_len++] = (char)key;
-            input_romaji_buffer[input_romaji_len] = '\0';
+    int len;
+    const u16* word = predict_word(&predict_dict, candidate_ids[k], &len);
+    if (start + len > 255) return;
+
+    memcpy(converted_kana_buffer + start, word, sizeof(u16) * len);
+    converted_kana_len = start + len;
+    has_hit = false;
+
+    predict_len = start;
+    predictSync();
+}
+
+// 下画面の候補欄。かなはコンソールに出せないので番号だけ並べ、
+// 上画面の候補の番号と対応させる
+static void drawCandidateStrip(void) {
+    for (int row = 0; row < 2; row++) {
+        for (int i = 0; i < PREDICT_TOP_K; i++) {
+            int col = i * (CANDIDATE_SLOT_WIDTH / 8);
+            if (i >= candidate_count) textConsole_fill(row, col, ' ', CANDIDATE_SLOT_WIDTH / 8);
+            else if (row == 0) textConsole_printAt(row, col, "[%d     ]", i + 1);
+            else textConsole_putText(row, col, "[      ]");
         }
     }
+}
 
-    bool converted_in_pass;
-    do {
-        converted_in_pass = false;
-
-        if (input_romaji_len >= 2 && input_romaji_buffer[0] == input_romaji_buffer[1] && input_romaji_buffer[0] != 'n') {
-            char c = input_romaji_buffer[0];
-            if (strchr("kstnhmyrwgzdbpv", c) != NULL) {
-                 if(converted_kana_len < 255) {
-                    converted_kana_buffer[converted_kana_len++] = 0x82c1; // っ
-                }
-                memmove(input_romaji_buffer, input_romaji_buffer + 1, input_romaji_len);
-                input_romaji_len--;
-                converted_in_pass = true;
-                continue;
-            }
-        }
+// 下画面の文字を全部消して、ログを候補欄の下から書き直す
+static void clearConsole(void) {
+    textConsole_clear();
+    debug_row = DEBUG_TOP_ROW;
+    debug_col = 0;
+}
 
-        for (int i = 0; romakana_map[i].romaji != NULL; i++) {
-            const char* romaji = romakana_map[i].romaji;
-            int len = strlen(romaji);
-
-            if (strncmp(input_romaji_buffer, romaji, len) == 0) {
-                if (len == 1 && *romaji == 'n') {
-                    char next_char = input_romaji_buffer[1];
-                    if (next_char != '\0' && strchr("aiueoy',", next_char) == NULL) {
-                    } else {
-                        continue;
-                    }
-                }
-
-                if(converted_kana_len < 255) {
-                    converted_kana_buffer[converted_kana_len++] = romakana_map[i].sjis_code;
-                }
-                
-                memmove(input_romaji_buffer, input_romaji_buffer + len, input_romaji_len - len + 1);
-                input_romaji_len -= len;
-                converted_in_pass = true;
-                break;
-            }
-        }
-    } while (converted_in_pass);
+// 最後の文字を 清音 -> 濁音 -> 半濁音 / 小書き の順に切り替えた文字 (カタカナも同じ)
+static u16 kanaVariant(u16 code) {
+    bool katakana = code >= 0x8340 && code <= 0x8393 && code != 0x837F;
+    u16 h = code;
+    if (katakana) h = 0x829F + (code - 0x8340) - (code > 0x837F ? 1 : 0);
+
+    if (h >= 0x829F && h <= 0x82A8) h += (h & 1) ? 1 : -1;         // ぁ-お
+    else if (h >= 0x82A9 && h <= 0x82C0) h += (h & 1) ? 1 : -1;    // か-ぢ
+    else if (h == 0x82C1) h = 0x82C2;                               // っ -> つ
+    else if (h == 0x82C2) h = 0x82C3;                               // つ -> づ
+    else if (h == 0x82C3) h = 0x82C1;                               // づ -> っ
+    else if (h >= 0x82C4 && h <= 0x82C7) h += (h & 1) ? -1 : 1;    // て-ど
+    else if (h >= 0x82CD && h <= 0x82DB) h += ((h - 0x82CD) % 3 == 2) ? -2 : 1; // は-ぽ
+    else if (h >= 0x82E1 && h <= 0x82E6) h += (h & 1) ? 1 : -1;    // ゃ-よ
+    else if (h == 0x82EC || h == 0x82ED) h ^= 0x01;                 // ゎ わ
+    else return code;
+
+    if (katakana) {
+        u16 i = h - 0x829F;
+        return 0x8340 + i + (i >= 0x3F ? 1 : 0);
+    }
+    return h;
+}
+
+// 上画面を描き直す必要がある (kanaIME_update() の最後に1回だけ描く)
+static bool redraw_requested = false;
+
+static void requestRedraw(void) {
+    redraw_requested = true;
+}
+
+// キーボード (とボタン) からの1文字を入力行に反映する。かなはそのまま足す
+static void inputCode(u16 code) {
+    if (code != '\n') {
+        has_hit = false; // 問い合わせが変わったら先頭側から探し直す
+    }
 
     #ifdef ENABLE_DEBUG_LOG
-    debug_log("After: Romaji='%s' (%d)\n", input_romaji_buffer, input_romaji_len);
+    clearConsole();
+    debug_log("Key: 0x%X\n", code);
     #endif
 
-    dmaFillWords(0, mainScreenBuffer, 256 * 192 * 2);
+    if (code == '\n') {
+        searchBook(); // 確定済みのかなで検索 (続けて押すと次の一致へ)
+        return;
+    }
+    if (code == '\b') {
+        if (converted_kana_len > 0) converted_kana_len--;
+    } else if (code == FLICK_CODE_VARIANT) {
+        if (converted_kana_len == 0) return;
+        converted_kana_buffer[converted_kana_len - 1] = kanaVariant(converted_kana_buffer[converted_kana_len - 1]);
+        if (predict_len >= converted_kana_len) predict_len = converted_kana_len - 1;
+    } else if (converted_kana_len < 255) {
+        converted_kana_buffer[converted_kana_len++] = code;
+    }
+
+    predictSync();
+    requestRedraw();
+}
+
+static void padDrawHint(void) {
+    textConsole_printAt(23, 0, "%s X:set L:voice B:del A:find", pad_set_names[pad_set]);
+}
+
+static void padPlot(int x, int y) {
+    int col = x / PAD_CELL_PX;
+    int row = y / PAD_CELL_PX;
+    if (col < 0 || col > 31 || row < 0 || row > 22) return;
+    textConsole_putChar(row, col, '*');
+}
+
+// 前の点から次の点までセルを埋める
+static void padLine(int x0, int y0, int x1, int y1) {
+    int dx = (x1 - x0) / PAD_CELL_PX, dy = (y1 - y0) / PAD_CELL_PX;
+    int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+    for (int k = 1; k <= steps; k++) padPlot(x0 + (x1 - x0) * k / steps, y0 + (y1 - y0) * k / steps);
+    padPlot(x1, y1);
+}
+
+static void padToggle(void) {
+    pad_active = !pad_active;
+    handwriting_clear(&pad_ink);
+    if (pad_active) flickKeyboard_hide();
+    else flickKeyboard_show();
+    clearConsole();
+    requestRedraw();
+}
+
+// ペンを上げてからしばらくたったら認識する (毎フレーム)
+static void padUpdate(void) {
+    if (handwriting_empty(&pad_ink) || pad_ink.pen_down) return;
+    if (++pad_idle_frames < PAD_COMMIT_FRAMES) return;
+
+    u16 code = handwriting_recognize(&pad_ink, pad_sets[pad_set]);
+    handwriting_clear(&pad_ink);
+    clearConsole(); // 軌跡を消す
+    if (code != 0 && converted_kana_len < 255) {
+        converted_kana_buffer[converted_kana_len++] = code;
+        has_hit = false;
+        #ifdef ENABLE_DEBUG_LOG
+        debug_log("Written: 0x%X\n", code);
+        #endif
+    }
+    predictSync();
+    requestRedraw();
+}
+
+// 裏バッファに全体を描いて次のVBlankで表示する (裏バッファは消去済み)
+static void redraw(void) {
+    u16* mainScreenBuffer = frameBuffer_back();
     int x = 10;
+    // 入力行はかなと英字だけなのでアンチエイリアスのシートで描ける
     for (int i = 0; i < converted_kana_len; i++) {
-        drawFont(x, 10, mainScreenBuffer, converted_kana_buffer[i], RGB15(31,31,31));
+        drawFontAA(x, 10, mainScreenBuffer, converted_kana_buffer[i], RGB15(31,31,31));
         x += 10;
     }
-    for (int i = 0; i < input_romaji_len; i++) {
-        drawFont(x, 10, mainScreenBuffer, (u16)input_romaji_buffer[i], RGB15(31,31,31));
+
+    // 予測候補 (番号と表記)。画面の右端で打ち切る
+    x = 10;
+    for (int i = 0; i < candidate_count && x + 10 <= SCREEN_WIDTH; i++) {
+        int len;
+        const u16* word = predict_word(&predict_dict, candidate_ids[i], &len);
+        drawFontAA(x, CANDIDATE_Y, mainScreenBuffer, (u16)('1' + i), RGB15(16,28,31));
+        x += 10;
+        for (int j = 0; j < len && x + 10 <= SCREEN_WIDTH; j++) {
+            drawFontAA(x, CANDIDATE_Y, mainScreenBuffer, word[j], RGB15(16,28,31));
+            x += 10;
+        }
         x += 10;
     }
+    textReader_draw(mainScreenBuffer, READER_TOP_Y);
+    frameBuffer_present();
+}
+
+// このフレームの入力で変わったものを1回だけ描く。下画面の文字はバッチに書くだけ
+// なのですぐに描き、上画面は前の切り替えが済んでいなければ次のフレームに回す
+static void flushRedraw(void) {
+    if (!redraw_requested) return;
+
+    drawCandidateStrip();
+    if (pad_active) padDrawHint();
+
+    if (!frameBuffer_ready()) return;
+    redraw_requested = false;
+    redraw();
+}
+
+void kanaIME_init(void) {
+    frameBuffer_init();
+    worker_start();
+    handwriting_init();
+
+    drawFontAA_init();
+
+    textConsole_attach(consoleDemoInit());
+    flickKeyboard_init();
+
+    if (textPack_open(&book_pack, chumonno_oi_ryoriten_pack_bin, chumonno_oi_ryoriten_pack_bin_size)) {
+        textReader_init(&book_pack);
+        book_index_ok = textIndex_open(&book_index, chumonno_oi_ryoriten_idx_bin,
+                                       chumonno_oi_ryoriten_idx_bin_size, &book_pack);
+    }
+    predict_ok = predict_open(&predict_dict, chumonno_oi_ryoriten_dict_bin, chumonno_oi_ryoriten_dict_bin_size);
+    requestRedraw();
+
+    #ifdef ENABLE_DEBUG_LOG
+    clearConsole();
+    debug_log("Kana IME Initialized.\n");
+    #endif
+}
+
+void kanaIME_update(int pressed) {
+    if (searchFinished()) requestRedraw();
+
+    // 十字キー上下でページ送り
+    if (pressed & (KEY_DOWN | KEY_UP)) {
+        if (pressed & KEY_DOWN) textReader_nextPage();
+        else textReader_prevPage();
+        has_hit = false;
+        requestRedraw();
+    }
+
+    // Rで1番目の予測候補を確定
+    if ((pressed & KEY_R) && candidate_count > 0) {
+        commitCandidate(0);
+        requestRedraw();
+    }
+
+    if (pressed & KEY_SELECT) padToggle();
+    if (pad_active) {
+        if (pressed & KEY_X) {
+            pad_set = (pad_set + 1) % PAD_SET_COUNT;
+            padDrawHint();
+        }
+        padUpdate();
+    }
+
+    // Lで最後の文字の濁点などを切り替え、Bで1文字消し、Aで検索する (キーボードの ゛゜、削除、検索 と同じ)
+    if (pressed & KEY_L) inputCode(FLICK_CODE_VARIANT);
+    if (pressed & KEY_B) inputCode('\b');
+    else if (pressed & KEY_A) inputCode('\n');
+
+    // kanaIME_touch() とこのフレームの変更をまとめて描く
+    flushRedraw();
+}
+
+void kanaIME_touch(const InputEvent* event) {
+    if (event->type == INPUT_TOUCH_DOWN && event->y < CANDIDATE_STRIP_HEIGHT) {
+        int k = event->x / CANDIDATE_SLOT_WIDTH;
+        if (k < candidate_count) {
+            commitCandidate(k);
+            requestRedraw();
+        }
+        return;
+    }
+    if (!pad_active) {
+        u16 code = flickKeyboard_touch(event);
+        if (code != 0) inputCode(code);
+        return;
+    }
+
+    if (event->type == INPUT_TOUCH_DOWN) {
+        handwriting_penDown(&pad_ink, event->x, event->y);
+        padPlot(event->x, event->y);
+    } else if (event->type == INPUT_TOUCH_MOVE && pad_ink.pen_down) {
+        int last = pad_ink.point_count - 1;
+        padLine(pad_ink.x[last], pad_ink.y[last], event->x, event->y);
+        handwriting_penMove(&pad_ink, event->x, event->y);
+    } else if (event->type == INPUT_TOUCH_UP) {
+        handwriting_penUp(&pad_ink);
+    }
+    pad_idle_frames = 0;
 }
 
-void kanaIME_showKeyboard(void) { keyboardShow(); }
-void kanaIME_hideKeyboard(void) { keyboardHide(); }
+#ifdef ENABLE_BENCHMARK
+void kanaIME_benchmark(void) {
+    glyphCache_benchmark();
+    while (!frameBuffer_ready()) swiWaitForVBlank();
+    drawFontAA_benchmark(frameBuffer_back());
+    frameBuffer_present(); // 描いた裏バッファは表示して、次の裏バッファに描き直す
+    requestRedraw();
+}
+#endif
+
+void kanaIME_showKeyboard(void) { flickKeyboard_show(); }
+void kanaIME_hideKeyboard(void) { flickKeyboard_hide(); }
 char kanaIME_getChar(void) { return 0; }
\ No newline at end of file
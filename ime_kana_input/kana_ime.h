@@ -1,6 +1,8 @@
 #ifndef KANA_IME_H
 #define KANA_IME_H
 
+#include "input.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -9,7 +11,12 @@ extern "C" {
 void kanaIME_init(void);
 
 // IMEの更新関数（キーボード表示、入力処理など）
-void kanaIME_update(void);
+// pressed: 前のフレームから押されたキー (入力キューから取り出したもの)
+void kanaIME_update(int pressed);
+
+// 下画面のタッチ (入力キューのタッチのイベント)。上端の候補欄なら予測候補を確定し、
+// それより下はフリック入力のキーボードに、手書き入力のときは軌跡として渡す
+void kanaIME_touch(const InputEvent* event);
 
 // キーボードを表示する関数
 void kanaIME_showKeyboard(void);
@@ -20,6 +27,11 @@ void kanaIME_hideKeyboard(void);
 // 入力された文字を取得する関数（仮）
 char kanaIME_getChar(void);
 
+#ifdef ENABLE_BENCHMARK
+// フォント関係のベンチマークを実行する (結果は下画面に表示)
+void kanaIME_benchmark(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
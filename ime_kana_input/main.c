@@ -1,6 +1,13 @@
 #include <nds.h>
 #include <stdio.h>
 #include "kana_ime.h" // 新しく追加
+#include "input.h"
+#include "text_console.h"
+
+// キーは割り込みでキューに入れ、毎フレームまとめて取り出す
+#define INPUT_TIMER 2 // タイマー0/1はベンチマークが使う
+
+static InputQueue input_queue;
 
 int main(void) {
     // メインスクリーンの初期化はkanaIME_initで行うので、ここでは不要
@@ -11,17 +18,34 @@ int main(void) {
 
     kanaIME_init(); // IMEの初期化を呼び出す (メインスクリーンを設定する)
 
+#ifdef ENABLE_BENCHMARK
+    kanaIME_benchmark(); // make BENCHMARK=1 のとき
+#endif
+
     // キーボードをすぐに表示してみる（テスト用）
     kanaIME_showKeyboard();
 
+    input_reset(&input_queue);
+    input_start(&input_queue, INPUT_TIMER);
+
     while(1) {
-        scanKeys();
-        int pressed = keysDown();
+        // 下画面の文字はまとめて次のVBlankで写す
+        textConsole_beginBatch();
+
+        // 前のフレームから押されたキー (フレームの途中で離したものも含む)
+        int pressed = 0;
+        InputEvent event;
+        while (input_pop(&input_queue, &event)) {
+            if (event.type == INPUT_KEY_DOWN) pressed |= event.keys;
+            else if (event.type != INPUT_KEY_UP) kanaIME_touch(&event);
+        }
 
         if(pressed & KEY_START) break;
 
-        kanaIME_update(); // IMEの更新処理を呼び出す
+        kanaIME_update(pressed); // IMEの更新処理を呼び出す
+        textConsole_endBatch();
         swiWaitForVBlank();
+        textConsole_commit();
     }
 
     return 0;
@@ -1 +1,2 @@
-extern const u16 FONT_MPLUS_10x10[0xFFFF][11];
+extern const u32 FONT_MPLUS_10x10_GROUP_OFFSETS[95];
+extern const u8 FONT_MPLUS_10x10_PACKED[];
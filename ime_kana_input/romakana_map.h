@@ -1,104 +0,0 @@
-/* This file is automatically generated by generate_map.py */
-#ifndef ROMAKANA_MAP_H_
-#define ROMAKANA_MAP_H_
-
-#include <nds.h>
-
-typedef struct {
-    const char* romaji;
-    u16 sjis_code;
-} RomajiKanaMap;
-
-const RomajiKanaMap romakana_map[] = {
-    {"shi", 0x82b5},
-    {"chi", 0x82bf},
-    {"tsu", 0x82c2},
-    {"xya", 0x82e1},
-    {"xyu", 0x82e3},
-    {"xyo", 0x82e5},
-    {"xtu", 0x82c1},
-    {"ka", 0x82a9},
-    {"ki", 0x82ab},
-    {"ku", 0x82ad},
-    {"ke", 0x82af},
-    {"ko", 0x82b1},
-    {"sa", 0x82b3},
-    {"si", 0x82b5},
-    {"su", 0x82b7},
-    {"se", 0x82b9},
-    {"so", 0x82bb},
-    {"ta", 0x82bd},
-    {"ti", 0x82bf},
-    {"tu", 0x82c2},
-    {"te", 0x82c4},
-    {"to", 0x82c6},
-    {"na", 0x82c8},
-    {"ni", 0x82c9},
-    {"nu", 0x82ca},
-    {"ne", 0x82cb},
-    {"no", 0x82cc},
-    {"ha", 0x82cd},
-    {"hi", 0x82d0},
-    {"fu", 0x82d3},
-    {"hu", 0x82d3},
-    {"he", 0x82d6},
-    {"ho", 0x82d9},
-    {"ma", 0x82dc},
-    {"mi", 0x82dd},
-    {"mu", 0x82de},
-    {"me", 0x82df},
-    {"mo", 0x82e0},
-    {"ya", 0x82e2},
-    {"yu", 0x82e4},
-    {"yo", 0x82e6},
-    {"ra", 0x82e7},
-    {"ri", 0x82e8},
-    {"ru", 0x82e9},
-    {"re", 0x82ea},
-    {"ro", 0x82eb},
-    {"wa", 0x82ed},
-    {"wo", 0x82f0},
-    {"ga", 0x82aa},
-    {"gi", 0x82ac},
-    {"gu", 0x82ae},
-    {"ge", 0x82b0},
-    {"go", 0x82b2},
-    {"za", 0x82b4},
-    {"ji", 0x82b6},
-    {"zi", 0x82b6},
-    {"zu", 0x82b8},
-    {"ze", 0x82ba},
-    {"zo", 0x82bc},
-    {"da", 0x82be},
-    {"di", 0x82c0},
-    {"du", 0x82c3},
-    {"de", 0x82c5},
-    {"do", 0x82c7},
-    {"ba", 0x82ce},
-    {"bi", 0x82d1},
-    {"bu", 0x82d4},
-    {"be", 0x82d7},
-    {"bo", 0x82da},
-    {"pa", 0x82cf},
-    {"pi", 0x82d2},
-    {"pu", 0x82d5},
-    {"pe", 0x82d8},
-    {"po", 0x82db},
-    {"nn", 0x82f1},
-    {"n'", 0x82f1},
-    {"xa", 0x829f},
-    {"xi", 0x82a1},
-    {"xu", 0x82a3},
-    {"xe", 0x82a5},
-    {"xo", 0x82a7},
-    {"a", 0x82a0},
-    {"i", 0x82a2},
-    {"u", 0x82a4},
-    {"e", 0x82a6},
-    {"o", 0x82a8},
-    {"n", 0x82f1},
-    {"-", 0x815b},
-    {NULL, 0}
-};
-
-#endif  // ROMAKANA_MAP_H_
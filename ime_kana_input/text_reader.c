@@ -0,0 +1,66 @@
+#include <nds.h>
+#include <string.h>
+
+#include "text_reader.h"
+#include "draw_font.h"
+
+// 前ページに戻るための履歴 (古いものから捨てる)
+#define READER_HISTORY 64
+
+// 1ページ分の作業バッファ (12行 x 全角25文字 + 改行 に余裕を持たせる)
+#define READER_PAGE_BYTES 1024
+
+static const TextPack* reader_text = NULL;
+static u32 reader_size = 0;
+static u8 reader_page[READER_PAGE_BYTES];
+static u32 reader_offset = 0;
+static u32 reader_page_end = 0;   // 最後に描画したページの終端
+static u32 reader_history[READER_HISTORY];
+static int reader_history_len = 0;
+
+void textReader_init(const TextPack* text) {
+    reader_text = text;
+    reader_size = text->text_size;
+    reader_offset = 0;
+    reader_page_end = 0;
+    reader_history_len = 0;
+}
+
+void textReader_draw(u16* buffer, int y) {
+    if (reader_text == NULL) return;
+
+    u32 len = textPack_read(reader_text, reader_offset, reader_page, READER_PAGE_BYTES);
+    reader_page_end = reader_offset + drawTextSjis(0, y, buffer, reader_page, len, RGB15(31,31,31));
+}
+
+void textReader_nextPage(void) {
+    if (reader_page_end <= reader_offset || reader_page_end >= reader_size) return;
+
+    if (reader_history_len == READER_HISTORY) {
+        memmove(reader_history, reader_history + 1, sizeof(u32) * (READER_HISTORY - 1));
+        reader_history_len--;
+    }
+    reader_history[reader_history_len++] = reader_offset;
+    reader_offset = reader_page_end;
+}
+
+void textReader_prevPage(void) {
+    if (reader_history_len > 0) {
+        reader_offset = reader_history[--reader_history_len];
+    }
+}
+
+void textReader_jumpTo(u32 offset) {
+    if (reader_text == NULL || offset >= reader_size) return;
+    textReader_jumpToLine(textPack_lineStart(reader_text, offset));
+}
+
+void textReader_jumpToLine(u32 line_start) {
+    if (reader_text == NULL || line_start >= reader_size) return;
+    reader_offset = line_start;
+    reader_history_len = 0;
+}
+
+u32 textReader_offset(void) {
+    return reader_offset;
+}
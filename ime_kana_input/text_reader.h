@@ -0,0 +1,35 @@
+#ifndef TEXT_READER_H
+#define TEXT_READER_H
+
+#include "text_pack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 埋め込みテキストのページ表示
+// 表示位置は本文先頭からのバイト位置で持ち、1ページ分をTextPackから
+// 作業バッファに読み出してdrawTextSjis()で描く。
+
+void textReader_init(const TextPack* text);
+
+// 現在のページをbufferのy行目から画面下端まで描画する
+void textReader_draw(u16* buffer, int y);
+
+void textReader_nextPage(void);
+void textReader_prevPage(void);
+
+// offsetを含む行が先頭に来るように移動する (検索結果へのジャンプ用)
+void textReader_jumpTo(u32 offset);
+
+// 行頭 (textPack_lineStart()の結果) に移動する。行頭をワーカーで求めたとき用
+void textReader_jumpToLine(u32 line_start);
+
+// 現在のページ先頭のバイト位置
+u32 textReader_offset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEXT_READER_H
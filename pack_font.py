@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Packs the 10x10 kanji font (FONT_MPLUS_10x10, indexed by SJIS code) into
+# LZ77 compressed groups, one group per JIS row (ku), for the on-demand glyph
+# cache in ime_kana_input/glyph_cache.c.
+#
+#   python3 pack_font.py mplus_font_10x10.c mplus_font_10x10_packed.c
+#
+# The IME Makefile runs this at build time, so the 1.4 MB raw table is never
+# linked. Only JIS X 0208 rows (SJIS lead bytes 0x81-0x9F, 0xE0-0xEF) are kept.
+# Rows without any glyph are stored as empty groups.
+
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from pack_text import lz77_compress
+
+GLYPH_WORDS = 11
+ROWS = 94
+CELLS = 94
+
+ROW_RE = re.compile(r'\{((?:\s*0x[0-9A-Fa-f]+\s*,?){%d})\s*\}' % GLYPH_WORDS)
+
+def load_font(path):
+    src = open(path, encoding='utf-8', errors='replace').read()
+    body = src[src.index('=') + 1:]
+    glyphs = []
+    for m in ROW_RE.finditer(body):
+        glyphs.append([int(v, 16) for v in re.findall(r'0x[0-9A-Fa-f]+', m.group(1))])
+    if len(glyphs) < 0xF000:
+        raise SystemExit(f"{path}: expected a table indexed by SJIS code, found {len(glyphs)} rows")
+    return glyphs
+
+def sjis_code(ku, ten):
+    """ku, ten are 1-based JIS row / cell."""
+    lead = (ku + 1) // 2 + (0x80 if ku <= 62 else 0xC0)
+    if ku % 2:
+        trail = ten + 0x3F + (1 if ten >= 64 else 0)
+    else:
+        trail = ten + 0x9E
+    return (lead << 8) | trail
+
+def main():
+    if len(sys.argv) != 3:
+        print(f"usage: {sys.argv[0]} <mplus_font_10x10.c> <packed.c>", file=sys.stderr)
+        sys.exit(1)
+
+    glyphs = load_font(sys.argv[1])
+
+    groups = []
+    for ku in range(1, ROWS + 1):
+        raw = bytearray()
+        for ten in range(1, CELLS + 1):
+            raw += struct.pack(f'<{GLYPH_WORDS}H', *glyphs[sjis_code(ku, ten)])
+        groups.append(lz77_compress(bytes(raw)) if any(raw) else b'')
+
+    offsets = [0]
+    for g in groups:
+        offsets.append(offsets[-1] + len(g))
+    data = b''.join(groups)
+
+    with open(sys.argv[2], 'w') as f:
+        f.write("/* This file is automatically generated by pack_font.py */\n")
+        f.write("#include <nds/ndstypes.h>\n\n")
+        f.write(f"const u32 FONT_MPLUS_10x10_GROUP_OFFSETS[{ROWS + 1}] = {{\n")
+        for i in range(0, len(offsets), 8):
+            f.write("\t" + ", ".join(f"0x{v:05X}" for v in offsets[i:i + 8]) + ",\n")
+        f.write("};\n\n")
+        f.write(f"const u8 FONT_MPLUS_10x10_PACKED[{max(len(data), 4)}] __attribute__((aligned(4))) = {{\n")
+        for i in range(0, len(data), 16):
+            f.write("\t" + ", ".join(f"0x{b:02X}" for b in data[i:i + 16]) + ",\n")
+        f.write("};\n")
+
+    raw_size = ROWS * CELLS * GLYPH_WORDS * 2
+    print(f"{sys.argv[1]}: {raw_size} -> {len(data) + 4 * len(offsets)} bytes "
+          f"({sum(1 for g in groups if g)} non-empty rows)", file=sys.stderr)
+
+if __name__ == '__main__':
+    main()
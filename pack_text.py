@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Packs an SJIS text from texts/ into independently decodable compressed
+# blocks for embedding with the DATA (bin2o) rule.
+#
+#   python3 pack_text.py texts/chumonno_oi_ryoriten.txt data/chumonno_oi_ryoriten_pack.bin
+#
+# Each block is a BIOS LZ77 stream (type 0x10), so the ARM9 can expand it with
+# swiDecompressLZSSWram(). Blocks that do not shrink are stored raw (type 0x00).
+# Layout (little endian, every block 4-byte aligned):
+#
+#   u32 magic        'TPK1'
+#   u32 text_size
+#   u32 block_size   bytes of text per block (the last block may be shorter)
+#   u32 block_count
+#   u32 offsets[block_count + 1]  block start relative to the end of this table
+#   blocks...
+#
+# Read by common/text_pack.c.
+
+import struct
+import sys
+
+MAGIC = 0x314B5054  # 'TPK1'
+BLOCK_SIZE = 4096   # must not exceed TEXT_PACK_MAX_BLOCK in text_pack.h
+
+MIN_MATCH = 3
+MAX_MATCH = 18
+WINDOW = 4096
+MAX_CHAIN = 64
+
+def lz77_compress(data):
+    """Greedy LZ77 in the GBA/DS BIOS format (header 0x10)."""
+    out = bytearray(struct.pack('<I', 0x10 | (len(data) << 8)))
+    chains = {}
+    i = 0
+    n = len(data)
+
+    while i < n:
+        flag_pos = len(out)
+        out.append(0)
+        flags = 0
+        for bit in range(8):
+            if i >= n:
+                break
+            best_len = 0
+            best_dist = 0
+            if i + MIN_MATCH <= n:
+                key = bytes(data[i:i + MIN_MATCH])
+                for j in reversed(chains.get(key, [])[-MAX_CHAIN:]):
+                    dist = i - j
+                    if dist > WINDOW:
+                        break
+                    length = 0
+                    limit = min(MAX_MATCH, n - i)
+                    while length < limit and data[j + length] == data[i + length]:
+                        length += 1
+                    if length > best_len:
+                        best_len = length
+                        best_dist = dist
+                        if length == MAX_MATCH:
+                            break
+
+            step = best_len if best_len >= MIN_MATCH else 1
+            if best_len >= MIN_MATCH:
+                flags |= 0x80 >> bit
+                d = best_dist - 1
+                out.append(((best_len - MIN_MATCH) << 4) | (d >> 8))
+                out.append(d & 0xFF)
+            else:
+                out.append(data[i])
+
+            for k in range(i, i + step):
+                if k + MIN_MATCH <= n:
+                    chains.setdefault(bytes(data[k:k + MIN_MATCH]), []).append(k)
+            i += step
+        out[flag_pos] = flags
+
+    while len(out) % 4:
+        out.append(0)
+    return bytes(out)
+
+def stored(data):
+    out = struct.pack('<I', 0x00 | (len(data) << 8)) + data
+    return out + b'\0' * (-len(out) % 4)
+
+def main():
+    if len(sys.argv) != 3:
+        print(f"usage: {sys.argv[0]} <text> <pack.bin>", file=sys.stderr)
+        sys.exit(1)
+
+    text = open(sys.argv[1], 'rb').read()
+    blocks = []
+    for start in range(0, len(text), BLOCK_SIZE):
+        raw = text[start:start + BLOCK_SIZE]
+        packed = lz77_compress(raw)
+        blocks.append(packed if len(packed) < len(raw) + 4 else stored(raw))
+
+    offsets = [0]
+    for b in blocks:
+        offsets.append(offsets[-1] + len(b))
+
+    with open(sys.argv[2], 'wb') as f:
+        f.write(struct.pack('<4I', MAGIC, len(text), BLOCK_SIZE, len(blocks)))
+        f.write(struct.pack(f'<{len(offsets)}I', *offsets))
+        for b in blocks:
+            f.write(b)
+
+    total = 16 + 4 * len(offsets) + offsets[-1]
+    print(f"{sys.argv[1]}: {len(text)} -> {total} bytes ({len(blocks)} blocks)", file=sys.stderr)
+
+if __name__ == '__main__':
+    main()
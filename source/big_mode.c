@@ -0,0 +1,239 @@
+#include <nds.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "big_mode.h"
+#include "bignum.h"
+#include "result_view.h"
+#include "text_console.h"
+#include "worker.h"
+
+// Limbs per number (9 digits each): enough for 1000! and 3000-digit results
+#define BIG_LIMBS 340
+
+// Result text (plain notation up to this size, scientific beyond)
+#define BIG_TEXT_SIZE 3200
+
+const char* big_button_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "/", "*", "-"},
+    {"7", "8", "9", "+"},
+    {"4", "5", "6", "="},
+    {"1", "2", "3", "n!"},
+    {"0", ".", "x^2", "DIG"}
+};
+
+// Significant digits kept by division (DIG cycles through these)
+static const u32 big_digit_options[] = {20, 50, 100, 500, 1000};
+static int big_digit_index = 1;
+
+static BigNum big_acc;     // Left operand / running total
+static BigNum big_x;       // Right operand
+static BigNum big_result;  // Value shown in the display
+static bool big_ready = false;
+
+static char big_pending = ' ';
+static char big_text[BIG_TEXT_SIZE];
+static ResultView big_view = {big_text, sizeof(big_text), 0, 0, false}; // Shows big_result
+
+// Multiplication, division and n! run on the ARM7 (common/worker.h). Keys are
+// ignored until the job comes back; bigMode_update() then finishes the key.
+static WorkerJob big_job;
+static BigNum* big_job_target = NULL; // Receives the job's result (NULL: idle)
+static char big_job_label[4];         // Key to finish when the job returns
+static u32 big_job_frames = 0;
+
+void bigMode_init(void) {
+    big_ready = bignum_alloc(&big_acc, BIG_LIMBS) &&
+                bignum_alloc(&big_x, BIG_LIMBS) &&
+                bignum_alloc(&big_result, BIG_LIMBS);
+}
+
+static void bigError(void) {
+    showError();
+    big_pending = ' ';
+    resultView_hide(&big_view);
+}
+
+// Show a value in the display; the next digit starts a new number
+static void showBig(const BigNum* n) {
+    if (n != &big_result) bignum_copy(&big_result, n);
+    resultView_show(&big_view, bignum_toString(&big_result, big_text, sizeof(big_text)));
+    new_number_flag = true;
+}
+
+// The value being entered, or the last result if nothing was typed since
+static bool bigInput(BigNum* x) {
+    if (big_view.shown) return bignum_copy(x, &big_result);
+    return bignum_fromString(x, display_buffer);
+}
+
+// Expression log: "<value> <op>", the value shortened to fit the line
+static void logExpression(const BigNum* n, const char* suffix) {
+    char value[20];
+    bignum_toString(n, value, sizeof(value));
+    snprintf(expression_buffer, sizeof(expression_buffer), "%s%s", value, suffix);
+}
+
+// Second half of a key: shows the value computed for it
+static void bigShow(const char* label) {
+    if (strcmp(label, "=") == 0) {
+        big_pending = ' ';
+        strcpy(expression_buffer, "=");
+        showBig(&big_acc);
+    }
+    else if (strcmp(label, "n!") == 0) {
+        if (big_pending == ' ') logExpression(&big_x, "!");
+        showBig(&big_result);
+    }
+    else if (strcmp(label, "x^2") == 0) {
+        if (big_pending == ' ') logExpression(&big_x, "^2");
+        showBig(&big_result);
+    }
+    else {
+        big_pending = label[0];
+        char op[3] = {' ', label[0], '\0'};
+        logExpression(&big_acc, op);
+        showBig(&big_acc);
+    }
+}
+
+static void bigFinish(const char* label, bool ok) {
+    if (ok) {
+        bigShow(label);
+    } else {
+        bigError();
+    }
+}
+
+// Hands r = a * b, a / b or n! to the worker; the key finishes in bigMode_update()
+static void bigSubmit(WorkerJobType type, BigNum* r, const BigNum* a, const BigNum* b, u32 n,
+                      const char* label) {
+    big_job.type = type;
+    big_job.u.big.r = *r;
+    if (a != NULL) big_job.u.big.a = *a;
+    if (b != NULL) big_job.u.big.b = *b;
+    big_job.u.big.n = n;
+    big_job.u.big.digits = big_digit_options[big_digit_index];
+
+    if (!worker_submit(&big_job)) {
+        bigFinish(label, false);
+        return;
+    }
+    big_job_target = r;
+    big_job_frames = 0;
+    strcpy(big_job_label, label);
+}
+
+// big_acc = big_acc <op> big_x, then finishes the key
+static void bigApply(char op, const char* label) {
+    bool ok;
+    switch (op) {
+    case '*':
+        bigSubmit(WORKER_JOB_BIG_MUL, &big_acc, &big_acc, &big_x, 0, label);
+        return;
+    case '/':
+        bigSubmit(WORKER_JOB_BIG_DIV, &big_acc, &big_acc, &big_x, 0, label);
+        return;
+    case '+': ok = bignum_add(&big_acc, &big_acc, &big_x); break;
+    case '-': ok = bignum_sub(&big_acc, &big_acc, &big_x); break;
+    default:  ok = bignum_copy(&big_acc, &big_x); break;
+    }
+    bigFinish(label, ok);
+}
+
+bool bigMode_busy(void) {
+    return big_job_target != NULL;
+}
+
+void bigMode_update(void) {
+    if (big_job_target == NULL) return;
+    if (!worker_finished(&big_job)) {
+        big_job_frames++;
+        return;
+    }
+
+    // The worker wrote the limbs in place; length, exponent and sign come back in the job
+    *big_job_target = big_job.u.big.r;
+    big_job_target = NULL;
+    bigFinish(big_job_label, big_job.ok);
+}
+
+void bigMode_wait(void) {
+    while (big_job_target != NULL) bigMode_update();
+}
+
+bool bigMode_handleButton(const char* label) {
+    if (!big_ready) return false;
+    if (big_job_target != NULL) return true; // Busy: the job's operands must stay as they are
+
+    if (resultView_typing(&big_view, label)) return false;
+
+    if (strcmp(label, "C") == 0) {
+        strcpy(display_buffer, "0");
+        strcpy(expression_buffer, "");
+        big_pending = ' ';
+        resultView_hide(&big_view);
+        new_number_flag = true;
+    }
+    else if (strchr("+-*/", label[0]) && label[1] == '\0') {
+        if (!bigInput(&big_x)) {
+            bigError();
+            return true;
+        }
+        bigApply(big_pending, label);
+    }
+    else if (strcmp(label, "=") == 0) {
+        if (big_pending == ' ') return true;
+        if (!bigInput(&big_x)) {
+            bigError();
+            return true;
+        }
+        bigApply(big_pending, label);
+    }
+    else if (strcmp(label, "n!") == 0) {
+        u32 n;
+        if (!bigInput(&big_x) || !bignum_toU32(&big_x, &n)) {
+            bigError();
+            return true;
+        }
+        bigSubmit(WORKER_JOB_BIG_FACTORIAL, &big_result, NULL, NULL, n, label);
+    }
+    else if (strcmp(label, "x^2") == 0) {
+        if (!bigInput(&big_x)) {
+            bigError();
+            return true;
+        }
+        bigSubmit(WORKER_JOB_BIG_MUL, &big_result, &big_x, &big_x, 0, label);
+    }
+    else if (strcmp(label, "DIG") == 0) {
+        big_digit_index = (big_digit_index + 1) % (int)(sizeof(big_digit_options) / sizeof(big_digit_options[0]));
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void bigMode_handleKeys(u32 keys) {
+    resultView_handleKeys(&big_view, keys);
+}
+
+void bigMode_drawDisplay(void) {
+    u32 digits = big_digit_options[big_digit_index];
+
+    if (!big_view.shown) {
+        textConsole_putText(2, 1, display_buffer);
+    } else {
+        resultView_draw(&big_view, 2);
+    }
+
+    if (big_job_target != NULL) {
+        textConsole_printAt(3, 1, "working on ARM7... %lus", (unsigned long)(big_job_frames / 60));
+    } else if (resultView_scrollable(&big_view)) {
+        // Scroll position and arrows when the result is longer than the line
+        int col = resultView_drawPosition(&big_view, 3, 1);
+        textConsole_printAt(3, col + 1, "div:%lu", (unsigned long)digits);
+    } else {
+        textConsole_printAt(3, 1, "div digits:%lu", (unsigned long)digits);
+    }
+}
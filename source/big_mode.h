@@ -0,0 +1,35 @@
+#ifndef BIG_MODE_H
+#define BIG_MODE_H
+
+#include "calc.h"
+
+// Arbitrary-precision mode (common/bignum.c). Digits and "." use the basic
+// entry in main.c; operators, "=", n!, x^2 and the precision key are handled here.
+// Multiplication, division and n! run on the ARM7 worker while the display
+// keeps updating.
+
+extern const char* big_button_labels[BUTTON_ROWS][BUTTON_COLS];
+
+// Allocates the mode's numbers from the bignum arena
+void bigMode_init(void);
+
+// Returns false for keys left to the basic handler (digits, ".").
+// Keys are ignored while a job is running.
+bool bigMode_handleButton(const char* label);
+
+// Finishes the pending key once the worker has returned its result (every frame)
+void bigMode_update(void);
+
+// True while a multiplication, division or n! is running on the worker
+bool bigMode_busy(void);
+
+// Blocks until the running job has finished (macro playback does not wait for frames)
+void bigMode_wait(void);
+
+// D-pad left/right scroll a long result, L/R jump by a screen width
+void bigMode_handleKeys(u32 keys);
+
+// Draws the display area (lines 2-3)
+void bigMode_drawDisplay(void);
+
+#endif // BIG_MODE_H
@@ -0,0 +1,24 @@
+#ifndef CALC_H
+#define CALC_H
+
+#include <nds.h>
+
+// Calculator state shared by main.c and the mode modules (defined in main.c)
+
+// Button grid size shared by every mode
+#define BUTTON_ROWS 5
+#define BUTTON_COLS 4
+
+// One row of a keypad layout (a mode's labels are BUTTON_ROWS of these)
+typedef const char* ButtonLabelRow[BUTTON_COLS];
+
+extern char display_buffer[17];     // Current input/result
+extern char expression_buffer[32];  // Expression log
+extern double current_value;
+extern char pending_operation;
+extern bool new_number_flag;
+
+// Reset the calculator and show an error message
+void showError(void);
+
+#endif // CALC_H
@@ -0,0 +1,247 @@
+#include <nds.h>
+#include <math.h>   // For isfinite
+#include <stdio.h>
+#include <stdlib.h> // For strtod
+#include <string.h>
+
+#include "complex_mode.h"
+#include "complex.h"
+#include "result_view.h"
+#include "sci_math.h"
+#include "text_console.h"
+
+// Significant digits of the result line (scrolled when it is longer than the
+// window, see result_view.h; sci_math's trigonometry is good to about 1e-7,
+// so polar entry and conversion keep 7) and of the expression log (reduced
+// until it fits the line)
+#define COMPLEX_DIGITS 7
+#define COMPLEX_LOG_DIGITS 6
+#define COMPLEX_TEXT_SIZE 64
+
+static const char* complex_button_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "/", "*", "-"},
+    {"7", "8", "9", "+"},
+    {"4", "5", "6", "="},
+    {"1", "2", "3", "i"},
+    {"0", ".", "ang", "FN"}
+};
+
+static const char* complex_fn_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "conj", "|z|", "arg"},
+    {"+/-", "re", "im", "1/z"},
+    {"POL", "DRG", "", ""},
+    {"", "", "", ""},
+    {"", "", "", "123"}
+};
+
+static bool complex_fn_page = false;
+
+// Which part display_buffer is being typed into
+enum {
+    PART_RE,
+    PART_IM,
+    PART_ANGLE
+};
+static int complex_part = PART_RE;
+static double complex_first = 0.0; // Real part or modulus typed before "i"/"ang"
+
+static Complex complex_acc;      // Left operand
+static Complex complex_result;   // Value shown in the display
+static char complex_pending = ' ';
+
+static bool complex_polar = false;  // Show results as r<theta
+static bool complex_degrees = true; // Angle unit of "ang" entry and polar display
+
+static char complex_text[COMPLEX_TEXT_SIZE];
+static ResultView complex_view = {complex_text, sizeof(complex_text), 0, 0, false};
+
+#define COMPLEX_DEG_TO_RAD (SCI_PI / 180.0)
+#define COMPLEX_RAD_TO_DEG (180.0 / SCI_PI)
+
+ButtonLabelRow* complexMode_labels(void) {
+    return complex_fn_page ? complex_fn_labels : complex_button_labels;
+}
+
+static int formatValue(Complex z, int digits, char* buf, u32 size) {
+    if (!complex_polar) return complex_formatRect(z, digits, buf, size);
+
+    double theta = complex_arg(z);
+    if (complex_degrees) theta *= COMPLEX_RAD_TO_DEG;
+    return complex_formatPolar(complex_abs(z), theta, digits, buf, size);
+}
+
+static void resetEntry(void) {
+    complex_part = PART_RE;
+    strcpy(display_buffer, "0");
+    new_number_flag = true;
+}
+
+static void complexError(void) {
+    showError();
+    complex_part = PART_RE;
+    complex_pending = ' ';
+    resultView_hide(&complex_view);
+}
+
+static void showComplex(Complex z) {
+    if (!isfinite(z.re) || !isfinite(z.im)) {
+        complexError();
+        return;
+    }
+    complex_result = z;
+    resultView_show(&complex_view, formatValue(z, COMPLEX_DIGITS, complex_text, sizeof(complex_text)));
+    complex_part = PART_RE;
+    new_number_flag = true;
+}
+
+// The number being typed, or the shown result if nothing was typed since
+static Complex complexInput(void) {
+    if (complex_view.shown) return complex_result;
+
+    double typed = strtod(display_buffer, NULL);
+    switch (complex_part) {
+    case PART_IM:
+        return complex_make(complex_first, new_number_flag ? 1.0 : typed);
+    case PART_ANGLE:
+        return complex_fromPolar(complex_first, complex_degrees ? typed * COMPLEX_DEG_TO_RAD : typed);
+    }
+    return complex_make(typed, 0.0);
+}
+
+// complex_acc = complex_acc <op> x
+static bool complexApply(char op, Complex x) {
+    switch (op) {
+    case '+': complex_acc = complex_add(complex_acc, x); return true;
+    case '-': complex_acc = complex_sub(complex_acc, x); return true;
+    case '*': complex_acc = complex_mul(complex_acc, x); return true;
+    case '/': return complex_div(&complex_acc, complex_acc, x);
+    }
+    complex_acc = x;
+    return true;
+}
+
+// Expression log "<value> <op>", with fewer digits until it fits the line
+static void logExpression(Complex z, char op) {
+    for (int digits = COMPLEX_LOG_DIGITS; digits >= 3; digits--) {
+        char value[COMPLEX_TEXT_SIZE];
+        int n = formatValue(z, digits, value, sizeof(value));
+        if (n + 2 < (int)sizeof(expression_buffer) || digits == 3) {
+            snprintf(expression_buffer, sizeof(expression_buffer), "%s %c", value, op);
+            return;
+        }
+    }
+}
+
+// Starts typing the next part of the number ("i" or "ang")
+static void startPart(int part) {
+    if (complex_part != PART_RE) return;
+    complex_first = complex_view.shown ? complex_result.re : strtod(display_buffer, NULL);
+    if (complex_view.shown && part == PART_ANGLE) complex_first = complex_abs(complex_result);
+    resultView_hide(&complex_view);
+    complex_part = part;
+    strcpy(display_buffer, "0");
+    new_number_flag = true;
+}
+
+static void applyUnary(const char* label) {
+    Complex z = complexInput();
+    Complex r = z;
+
+    if (strcmp(label, "conj") == 0) {
+        r = complex_conj(z);
+    } else if (strcmp(label, "|z|") == 0) {
+        r = complex_make(complex_abs(z), 0.0);
+    } else if (strcmp(label, "arg") == 0) {
+        double theta = complex_arg(z);
+        r = complex_make(complex_degrees ? theta * COMPLEX_RAD_TO_DEG : theta, 0.0);
+    } else if (strcmp(label, "re") == 0) {
+        r = complex_make(z.re, 0.0);
+    } else if (strcmp(label, "im") == 0) {
+        r = complex_make(z.im, 0.0);
+    } else if (!complex_div(&r, complex_make(1.0, 0.0), z)) { // 1/z
+        complexError();
+        return;
+    }
+    showComplex(r);
+}
+
+bool complexMode_handleButton(const char* label) {
+    if (strcmp(label, "FN") == 0 || strcmp(label, "123") == 0) {
+        complex_fn_page = !complex_fn_page;
+        return true;
+    }
+    if (resultView_typing(&complex_view, label)) return false;
+
+    if (strcmp(label, "C") == 0) {
+        resetEntry();
+        strcpy(expression_buffer, "");
+        complex_pending = ' ';
+        resultView_hide(&complex_view);
+    }
+    else if (strcmp(label, "+/-") == 0) {
+        if (!complex_view.shown) return false;
+        showComplex(complex_make(-complex_result.re, -complex_result.im));
+    }
+    else if (strcmp(label, "i") == 0) {
+        startPart(PART_IM);
+    }
+    else if (strcmp(label, "ang") == 0) {
+        startPart(PART_ANGLE);
+    }
+    else if (strchr("+-*/", label[0]) && label[1] == '\0') {
+        if (!complexApply(complex_pending, complexInput())) {
+            complexError();
+            return true;
+        }
+        complex_pending = label[0];
+        logExpression(complex_acc, complex_pending);
+        showComplex(complex_acc);
+    }
+    else if (strcmp(label, "=") == 0) {
+        if (complex_pending == ' ') {
+            showComplex(complexInput()); // Shows a typed number in the display format
+            return true;
+        }
+        if (!complexApply(complex_pending, complexInput())) {
+            complexError();
+            return true;
+        }
+        complex_pending = ' ';
+        strcpy(expression_buffer, "=");
+        showComplex(complex_acc);
+    }
+    else if (strcmp(label, "POL") == 0 || strcmp(label, "DRG") == 0) {
+        if (label[0] == 'P') complex_polar = !complex_polar;
+        else complex_degrees = !complex_degrees;
+        if (complex_view.shown) showComplex(complex_result); // Reformat
+    }
+    else if (strcmp(label, "conj") == 0 || strcmp(label, "|z|") == 0 || strcmp(label, "arg") == 0 ||
+             strcmp(label, "re") == 0 || strcmp(label, "im") == 0 || strcmp(label, "1/z") == 0) {
+        applyUnary(label);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void complexMode_handleKeys(u32 keys) {
+    resultView_handleKeys(&complex_view, keys);
+}
+
+void complexMode_drawDisplay(void) {
+    textConsole_putText(1, 1, expression_buffer);
+
+    if (complex_view.shown) {
+        resultView_draw(&complex_view, 2);
+    } else if (complex_part == PART_IM) {
+        textConsole_printAt(2, 1, "%.10g + %si", complex_first, new_number_flag ? "" : display_buffer);
+    } else if (complex_part == PART_ANGLE) {
+        textConsole_printAt(2, 1, "%.10g < %s", complex_first, display_buffer);
+    } else {
+        textConsole_putText(2, 1, display_buffer);
+    }
+
+    textConsole_printAt(3, 1, "%s %s", complex_polar ? "POL" : "RECT", complex_degrees ? "DEG" : "RAD");
+    resultView_drawPosition(&complex_view, 3, 10);
+}
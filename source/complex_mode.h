@@ -0,0 +1,23 @@
+#ifndef COMPLEX_MODE_H
+#define COMPLEX_MODE_H
+
+#include "calc.h"
+
+// Complex-number mode (common/complex.c). Numbers are typed with the basic
+// digit entry in main.c: "i" moves on to the imaginary part ("3 i 4" is
+// 3+4i, "i" alone is i) and "ang" to the angle of a polar entry ("2 ang 30").
+// The FN page holds conj, |z|, arg, re, im, 1/z and the display settings.
+
+// Current keypad page (digits/operators or functions)
+ButtonLabelRow* complexMode_labels(void);
+
+// Returns false for keys left to the basic handler (digits, ".", "+/-")
+bool complexMode_handleButton(const char* label);
+
+// D-pad left/right scroll a result longer than the line, L/R jump by a line
+void complexMode_handleKeys(u32 keys);
+
+// Draws the display area (lines 1-3)
+void complexMode_drawDisplay(void);
+
+#endif // COMPLEX_MODE_H
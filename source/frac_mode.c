@@ -0,0 +1,288 @@
+#include <nds.h>
+#include <math.h>   // For isfinite
+#include <stdio.h>
+#include <stdlib.h> // For strtod
+#include <string.h>
+
+#include "frac_mode.h"
+#include "hw_math.h"
+#include "rational.h"
+#include "result_view.h"
+#include "text_console.h"
+
+// Significant digits of a decimal result (and of the log of an inexact one)
+#define FRAC_DIGITS 15
+#define FRAC_LOG_DIGITS 6
+#define FRAC_TEXT_SIZE 64
+
+const char* frac_button_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "/", "*", "-"},
+    {"7", "8", "9", "+"},
+    {"4", "5", "6", "="},
+    {"1", "2", "3", "a/b"},
+    {"0", ".", "+/-", "F<>D"}
+};
+
+// A value is exact until an operation overflows 64 bits, then a double
+typedef struct {
+    bool exact;
+    Rational q;
+    double d;
+} FracValue;
+
+// How results are shown (F<>D cycles)
+enum {
+    SHOW_FRACTION,
+    SHOW_MIXED,
+    SHOW_DECIMAL,
+    SHOW_COUNT
+};
+static int frac_show = SHOW_FRACTION;
+static const char* frac_show_names[SHOW_COUNT] = {"a/b", "MIXED", "DEC"};
+
+// Which part display_buffer is being typed into
+enum {
+    PART_NUM,
+    PART_DEN
+};
+static int frac_part = PART_NUM;
+static FracValue frac_first;  // Numerator typed before "a/b"
+static FracValue frac_whole;  // Whole part of a mixed entry
+static bool frac_has_whole = false;
+
+static FracValue frac_acc;     // Left operand
+static FracValue frac_result;  // Value shown in the display
+static char frac_pending = ' ';
+
+static char frac_text[FRAC_TEXT_SIZE];
+static ResultView frac_view = {frac_text, sizeof(frac_text), 0, 0, false};
+
+static FracValue exactValue(Rational q) {
+    FracValue v = {true, q, 0.0};
+    return v;
+}
+
+static FracValue decimalValue(double d) {
+    FracValue v = {false, {0, 1}, d};
+    return v;
+}
+
+static double toDouble(FracValue v) {
+    return v.exact ? rational_toDouble(v.q) : v.d;
+}
+
+static int formatValue(FracValue v, int style, int digits, char* buf, u32 size) {
+    if (v.exact && style != SHOW_DECIMAL) return rational_format(v.q, style == SHOW_MIXED, buf, size);
+    return snprintf(buf, size, "%.*g", digits, toDouble(v));
+}
+
+static void resetEntry(void) {
+    frac_part = PART_NUM;
+    frac_has_whole = false;
+    strcpy(display_buffer, "0");
+    new_number_flag = true;
+}
+
+static void fracError(void) {
+    showError();
+    frac_part = PART_NUM;
+    frac_has_whole = false;
+    frac_pending = ' ';
+    resultView_hide(&frac_view);
+}
+
+static void showValue(FracValue v) {
+    if (!v.exact && !isfinite(v.d)) {
+        fracError();
+        return;
+    }
+    frac_result = v;
+    resultView_show(&frac_view, formatValue(v, frac_show, FRAC_DIGITS, frac_text, sizeof(frac_text)));
+    frac_part = PART_NUM;
+    frac_has_whole = false;
+    new_number_flag = true;
+}
+
+// The typed number, exactly if it fits 64 bits
+static FracValue typedValue(void) {
+    Rational q;
+    if (strcmp(display_buffer, "Error") == 0) return exactValue(rational_fromInt(0));
+    if (rational_parse(&q, display_buffer)) return exactValue(q);
+    return decimalValue(strtod(display_buffer, NULL));
+}
+
+// a op b, exactly while the result fits and as doubles after that.
+// False only for division by zero (or a result that is not finite)
+static bool applyOp(FracValue* r, char op, FracValue a, FracValue b) {
+    if (op == '/' && (b.exact ? b.q.num == 0 : b.d == 0.0)) return false;
+
+    if (a.exact && b.exact) {
+        Rational q;
+        bool ok = false;
+        switch (op) {
+        case '+': ok = rational_add(&q, a.q, b.q); break;
+        case '-': ok = rational_sub(&q, a.q, b.q); break;
+        case '*': ok = rational_mul(&q, a.q, b.q); break;
+        case '/': ok = rational_div(&q, a.q, b.q); break;
+        }
+        if (ok) {
+            *r = exactValue(q);
+            return true;
+        }
+    }
+
+    double x = toDouble(a), y = toDouble(b), d = 0.0;
+    switch (op) {
+    case '+': d = x + y; break;
+    case '-': d = x - y; break;
+    case '*': d = x * y; break;
+    case '/': d = hwmath_divDouble(x, y); break;
+    }
+    *r = decimalValue(d);
+    return isfinite(d);
+}
+
+// The number being typed (with its numerator and whole part), or the shown
+// result if nothing was typed since
+static bool fracInput(FracValue* v) {
+    if (frac_view.shown) {
+        *v = frac_result;
+        return true;
+    }
+    if (frac_part == PART_NUM) {
+        *v = typedValue();
+        return true;
+    }
+
+    // "1 a/b" without a denominator is just 1
+    FracValue part = frac_first;
+    if (!new_number_flag && !applyOp(&part, '/', frac_first, typedValue())) return false;
+    if (!frac_has_whole) {
+        *v = part;
+        return true;
+    }
+    // -2 1/3 is -(2 + 1/3)
+    bool negative = frac_whole.exact ? frac_whole.q.num < 0 : frac_whole.d < 0.0;
+    return applyOp(v, negative ? '-' : '+', frac_whole, part);
+}
+
+// frac_acc = frac_acc <op> x
+static bool fracApply(char op, FracValue x) {
+    if (op == ' ') {
+        frac_acc = x;
+        return true;
+    }
+    return applyOp(&frac_acc, op, frac_acc, x);
+}
+
+// Expression log "<value> <op>", as a decimal if the fraction does not fit
+static void logExpression(FracValue v, char op) {
+    char value[FRAC_TEXT_SIZE];
+    int n = formatValue(v, frac_show, FRAC_LOG_DIGITS, value, sizeof(value));
+    if (n + 2 >= (int)sizeof(expression_buffer)) formatValue(v, SHOW_DECIMAL, FRAC_LOG_DIGITS, value, sizeof(value));
+    snprintf(expression_buffer, sizeof(expression_buffer), "%s %c", value, op);
+}
+
+// "a/b": the typed number becomes the numerator (or, pressed a second time,
+// the first number becomes the whole part and the second the numerator)
+static void startDenominator(void) {
+    if (frac_part == PART_DEN) {
+        if (frac_has_whole || new_number_flag) return;
+        frac_whole = frac_first;
+        frac_first = typedValue();
+        frac_has_whole = true;
+    } else if (!fracInput(&frac_first)) {
+        return;
+    }
+    resultView_hide(&frac_view);
+    frac_part = PART_DEN;
+    strcpy(display_buffer, "0");
+    new_number_flag = true;
+}
+
+bool fracMode_handleButton(const char* label) {
+    if (resultView_typing(&frac_view, label)) return false;
+
+    if (strcmp(label, "C") == 0) {
+        resetEntry();
+        strcpy(expression_buffer, "");
+        frac_pending = ' ';
+        resultView_hide(&frac_view);
+    }
+    else if (strcmp(label, "+/-") == 0) {
+        if (!frac_view.shown) return false;
+        FracValue v = frac_result;
+        if (v.exact) v.q.num = -v.q.num;
+        else v.d = -v.d;
+        showValue(v);
+    }
+    else if (strcmp(label, "a/b") == 0) {
+        startDenominator();
+    }
+    else if (strcmp(label, "F<>D") == 0) {
+        // Converts the shown result, or the number being typed
+        FracValue x;
+        frac_show = (frac_show + 1) % SHOW_COUNT;
+        if (fracInput(&x)) showValue(x);
+        else fracError();
+    }
+    else if (strchr("+-*/", label[0]) && label[1] == '\0') {
+        FracValue x;
+        if (!fracInput(&x) || !fracApply(frac_pending, x)) {
+            fracError();
+            return true;
+        }
+        frac_pending = label[0];
+        logExpression(frac_acc, frac_pending);
+        showValue(frac_acc);
+    }
+    else if (strcmp(label, "=") == 0) {
+        FracValue x;
+        if (!fracInput(&x)) {
+            fracError();
+            return true;
+        }
+        if (frac_pending == ' ') {
+            showValue(x); // Shows a typed number reduced
+            return true;
+        }
+        if (!fracApply(frac_pending, x)) {
+            fracError();
+            return true;
+        }
+        frac_pending = ' ';
+        strcpy(expression_buffer, "=");
+        showValue(frac_acc);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void fracMode_handleKeys(u32 keys) {
+    resultView_handleKeys(&frac_view, keys);
+}
+
+void fracMode_drawDisplay(void) {
+    textConsole_putText(1, 1, expression_buffer);
+
+    if (frac_view.shown) {
+        resultView_draw(&frac_view, 2);
+    } else if (frac_part == PART_DEN) {
+        // The parts typed so far, as entered: "2 1/3"
+        char whole[FRAC_TEXT_SIZE] = "";
+        char first[FRAC_TEXT_SIZE];
+        if (frac_has_whole) formatValue(frac_whole, SHOW_FRACTION, FRAC_LOG_DIGITS, whole, sizeof(whole));
+        formatValue(frac_first, SHOW_FRACTION, FRAC_LOG_DIGITS, first, sizeof(first));
+        int col = 1;
+        if (frac_has_whole) col = textConsole_putChar(2, textConsole_putText(2, col, whole), ' ');
+        textConsole_printAt(2, col, "%s/%s", first, new_number_flag ? "" : display_buffer);
+    } else {
+        textConsole_putText(2, 1, display_buffer);
+    }
+
+    int col = textConsole_putText(3, 1, frac_show_names[frac_show]);
+    if (frac_view.shown && !frac_result.exact) textConsole_putText(3, col + 1, "~"); // Overflowed to a double
+    resultView_drawPosition(&frac_view, 3, 10);
+}
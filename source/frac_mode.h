@@ -0,0 +1,24 @@
+#ifndef FRAC_MODE_H
+#define FRAC_MODE_H
+
+#include "calc.h"
+
+// Fraction mode (common/rational.c). Results stay exact reduced fractions of
+// 64-bit integers: "a/b" moves on to the denominator ("1 a/b 3" is 1/3), and
+// pressed again turns the first number into the whole part of a mixed number
+// ("2 a/b 1 a/b 3" is 2 1/3). A typed decimal is converted exactly (0.75 is
+// 3/4). When a result no longer fits 64 bits it continues as a double and is
+// shown as a decimal. F<>D cycles the display through a/b, mixed and decimal.
+
+extern const char* frac_button_labels[BUTTON_ROWS][BUTTON_COLS];
+
+// Returns false for keys left to the basic handler (digits, ".", "+/-")
+bool fracMode_handleButton(const char* label);
+
+// D-pad left/right scroll a result longer than the line, L/R jump by a line
+void fracMode_handleKeys(u32 keys);
+
+// Draws the display area (lines 1-3)
+void fracMode_drawDisplay(void);
+
+#endif // FRAC_MODE_H
@@ -0,0 +1,397 @@
+#include <nds.h>
+#include <math.h>   // For isfinite
+#include <stdio.h>
+#include <string.h>
+
+#include "graph_mode.h"
+#include "expr.h"
+#include "hw_math.h"
+#include "registers.h"
+#include "tcm.h"
+#include "text_console.h"
+#include "var_keys.h"
+
+#define GRAPH_WIDTH  256
+#define GRAPH_HEIGHT 192
+
+// Columns evaluated per frame (a full plot takes GRAPH_WIDTH / this frames)
+#define GRAPH_COLUMNS_PER_FRAME 32
+
+// Pixels moved per D-pad press
+#define GRAPH_PAN_STEP 16
+
+// Default view: x in [-8, 8], same units per pixel on both axes
+#define GRAPH_DEFAULT_SCALE (16.0 / GRAPH_WIDTH)
+#define GRAPH_MIN_SCALE (GRAPH_DEFAULT_SCALE / 65536.0)
+#define GRAPH_MAX_SCALE (GRAPH_DEFAULT_SCALE * 65536.0)
+
+#define GRAPH_EXPR_SIZE 64
+#define GRAPH_MAX_TOKENS 32
+
+// Characters of the expression shown after "y="
+#define GRAPH_WINDOW_CHARS 28
+
+// Bit 15 makes a direct-color bitmap pixel opaque
+#define GRAPH_COLOR_BACK  (RGB15(31, 31, 31) | BIT(15))
+#define GRAPH_COLOR_AXIS  (RGB15(18, 18, 18) | BIT(15))
+#define GRAPH_COLOR_CURVE (RGB15(0, 0, 28) | BIT(15))
+
+// DMA channel used to scroll the bitmap
+#define GRAPH_DMA_CHANNEL 3
+
+static const char* graph_button_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "DEL", "^", "/"},
+    {"7", "8", "9", "*"},
+    {"4", "5", "6", "-"},
+    {"1", "2", "3", "+"},
+    {"0", ".", "x", "FN"}
+};
+
+static const char* graph_fn_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"VAR", "DEL", "(", ")"},
+    {"sin", "cos", "tan", "sqrt"},
+    {"asin", "acos", "atan", "abs"},
+    {"ln", "log", "exp", "pi"},
+    {"x", "e", "RST", "123"}
+};
+
+static bool graph_fn_page = false;
+
+// Expression text and the length of each inserted token (DEL removes one token)
+static char graph_expr[GRAPH_EXPR_SIZE];
+static u8 graph_token_len[GRAPH_MAX_TOKENS];
+static int graph_token_count = 0;
+static int graph_error_pos = -1; // Position of a syntax error, -1 if it compiled
+
+static ExprProgram graph_program;
+static ExprProgram graph_compiled; // Scratch so a failed compile keeps the last plot
+static bool graph_has_program = false;
+static u32 graph_register_version; // Registers the cached columns were computed with
+
+// Per-column cache of f(x)
+enum {
+    COLUMN_PENDING,
+    COLUMN_VALUE,
+    COLUMN_UNDEFINED
+};
+static double column_value[GRAPH_WIDTH];
+static u8 column_state[GRAPH_WIDTH];
+
+// View: x of column 0, y of row 0 and units per pixel
+static double view_x0;
+static double view_y0;
+static double view_scale;
+static double view_inv_scale;
+static double view_row0; // view_y0 in pixels; whole as long as pans are whole pixels
+static int axis_col; // Column of x=0 (-1 if off screen)
+static int axis_row; // Row of y=0 (-1 if off screen)
+
+static u16* graph_vram = NULL;
+static bool graph_shown = false; // The bitmap still holds whatever main() drew
+
+// Pixel row of a value, clamped to -1 (above) and GRAPH_HEIGHT (below).
+// value * view_inv_scale does not depend on the pan position, so a pixel
+// rounds the same way before and after the bitmap is scrolled.
+static int rowOf(double value) {
+    double r = view_row0 - value * view_inv_scale;
+    if (r < -0.5) return -1;
+    if (r >= GRAPH_HEIGHT - 0.5) return GRAPH_HEIGHT;
+    return (int)(r + 0.5);
+}
+
+static void updateAxes(void) {
+    view_inv_scale = hwmath_divDouble(1.0, view_scale);
+    view_row0 = view_y0 * view_inv_scale;
+
+    double c = -view_x0 * view_inv_scale;
+    axis_col = (c > -0.5 && c < GRAPH_WIDTH - 0.5) ? (int)(c + 0.5) : -1;
+    int r = rowOf(0.0);
+    axis_row = r < GRAPH_HEIGHT ? r : -1;
+}
+
+// Redraw rows [top, bottom) of a column: background, axes and the curve
+// segment joining the previous column's value to this one.
+// Panning redraws every column, so with make TCM=1 this runs from ITCM.
+static TCM_CODE void drawColumn(int col, int top, int bottom) {
+    u16* p = graph_vram + top * GRAPH_WIDTH + col;
+    u16 back = col == axis_col ? GRAPH_COLOR_AXIS : GRAPH_COLOR_BACK;
+    for (int y = top; y < bottom; y++, p += GRAPH_WIDTH) *p = back;
+    if (axis_row >= top && axis_row < bottom) {
+        graph_vram[axis_row * GRAPH_WIDTH + col] = GRAPH_COLOR_AXIS;
+    }
+
+    if (column_state[col] != COLUMN_VALUE) return;
+
+    double v1 = column_value[col];
+    int y1 = rowOf(v1);
+    int y0 = y1;
+    if (col > 0 && column_state[col - 1] == COLUMN_VALUE) {
+        double v0 = column_value[col - 1];
+        // A sign change bigger than the screen is a pole (tan, 1/x), not a line.
+        // Decided from the values alone so vertical panning draws the same thing.
+        double jump = (v1 > v0 ? v1 - v0 : v0 - v1) * view_inv_scale;
+        if ((v0 < 0) == (v1 < 0) || jump <= GRAPH_HEIGHT) y0 = rowOf(v0);
+    }
+
+    int lo = y0 < y1 ? y0 : y1;
+    int hi = (y0 < y1 ? y1 : y0) + 1;
+    if (lo < top) lo = top;
+    if (hi > bottom) hi = bottom;
+    p = graph_vram + lo * GRAPH_WIDTH + col;
+    for (int y = lo; y < hi; y++, p += GRAPH_WIDTH) *p = GRAPH_COLOR_CURVE;
+}
+
+static void redrawAll(void) {
+    for (int col = 0; col < GRAPH_WIDTH; col++) drawColumn(col, 0, GRAPH_HEIGHT);
+}
+
+// Forget every cached column and clear the plot
+static void replot(void) {
+    memset(column_state, COLUMN_PENDING, sizeof(column_state));
+    if (graph_shown) redrawAll();
+}
+
+// Move count pixels of the bitmap from src to dst in one DMA transfer.
+// Overlapping moves run downwards when dst is above src, so nothing is read
+// after it has been overwritten.
+static void vramMove(u16* dst, const u16* src, u32 count) {
+    if (dst < src) {
+        DMA_SRC(GRAPH_DMA_CHANNEL) = (u32)src;
+        DMA_DEST(GRAPH_DMA_CHANNEL) = (u32)dst;
+        DMA_CR(GRAPH_DMA_CHANNEL) = DMA_ENABLE | DMA_START_NOW | DMA_16_BIT |
+                                    DMA_SRC_INC | DMA_DST_INC | count;
+    } else {
+        DMA_SRC(GRAPH_DMA_CHANNEL) = (u32)(src + count - 1);
+        DMA_DEST(GRAPH_DMA_CHANNEL) = (u32)(dst + count - 1);
+        DMA_CR(GRAPH_DMA_CHANNEL) = DMA_ENABLE | DMA_START_NOW | DMA_16_BIT |
+                                    DMA_SRC_DEC | DMA_DST_DEC | count;
+    }
+    while (DMA_CR(GRAPH_DMA_CHANNEL) & DMA_BUSY);
+}
+
+// Scroll the view by dx columns. The bitmap moves as one block, so the
+// columns that wrap into the next row are exactly the new ones, which are
+// then cleared and left pending.
+static void panX(int dx) {
+    int n = dx < 0 ? -dx : dx;
+    view_x0 += dx * view_scale;
+    updateAxes();
+    if (n >= GRAPH_WIDTH || !graph_shown) {
+        replot();
+        return;
+    }
+
+    int keep = GRAPH_WIDTH - n;
+    int first_new = dx > 0 ? keep : 0;
+    if (dx > 0) {
+        vramMove(graph_vram, graph_vram + n, GRAPH_WIDTH * GRAPH_HEIGHT - n);
+        memmove(column_value, column_value + n, keep * sizeof(column_value[0]));
+        memmove(column_state, column_state + n, keep);
+        drawColumn(0, 0, GRAPH_HEIGHT); // Its segment joined a column now off screen
+    } else {
+        vramMove(graph_vram + n, graph_vram, GRAPH_WIDTH * GRAPH_HEIGHT - n);
+        memmove(column_value + n, column_value, keep * sizeof(column_value[0]));
+        memmove(column_state + n, column_state, keep);
+    }
+    for (int col = first_new; col < first_new + n; col++) {
+        column_state[col] = COLUMN_PENDING;
+        drawColumn(col, 0, GRAPH_HEIGHT);
+    }
+}
+
+// Scroll the view up by dy rows (down if negative). Cached values are still
+// valid; only the rows scrolled into view are drawn.
+static void panY(int dy) {
+    int n = dy < 0 ? -dy : dy;
+    view_y0 += dy * view_scale;
+    updateAxes();
+    if (n >= GRAPH_HEIGHT || !graph_shown) {
+        if (graph_shown) redrawAll();
+        return;
+    }
+
+    int top;
+    if (dy > 0) {
+        vramMove(graph_vram + n * GRAPH_WIDTH, graph_vram, (GRAPH_HEIGHT - n) * GRAPH_WIDTH);
+        top = 0;
+    } else {
+        vramMove(graph_vram, graph_vram + n * GRAPH_WIDTH, (GRAPH_HEIGHT - n) * GRAPH_WIDTH);
+        top = GRAPH_HEIGHT - n;
+    }
+    for (int col = 0; col < GRAPH_WIDTH; col++) drawColumn(col, top, top + n);
+}
+
+// Zoom by 2 about the centre. Every other column (zoom in) or the middle
+// half (zoom out) lands on an x that is already cached.
+static void zoom(bool zoom_in) {
+    static double old_value[GRAPH_WIDTH];
+    static u8 old_state[GRAPH_WIDTH];
+
+    double new_scale = zoom_in ? view_scale * 0.5 : view_scale * 2.0;
+    if (new_scale < GRAPH_MIN_SCALE || new_scale > GRAPH_MAX_SCALE) return;
+
+    double cx = view_x0 + (GRAPH_WIDTH / 2) * view_scale;
+    double cy = view_y0 - (GRAPH_HEIGHT / 2) * view_scale;
+    memcpy(old_value, column_value, sizeof(old_value));
+    memcpy(old_state, column_state, sizeof(old_state));
+
+    for (int col = 0; col < GRAPH_WIDTH; col++) {
+        int d = col - GRAPH_WIDTH / 2;
+        int old = -1;
+        if (zoom_in) {
+            if (d % 2 == 0) old = GRAPH_WIDTH / 2 + d / 2;
+        } else {
+            old = GRAPH_WIDTH / 2 + d * 2;
+            if (old < 0 || old >= GRAPH_WIDTH) old = -1;
+        }
+        if (old >= 0) {
+            column_value[col] = old_value[old];
+            column_state[col] = old_state[old];
+        } else {
+            column_state[col] = COLUMN_PENDING;
+        }
+    }
+
+    view_scale = new_scale;
+    view_x0 = cx - (GRAPH_WIDTH / 2) * view_scale;
+    view_y0 = cy + (GRAPH_HEIGHT / 2) * view_scale;
+    updateAxes();
+    if (graph_shown) redrawAll();
+}
+
+static void resetView(void) {
+    view_scale = GRAPH_DEFAULT_SCALE;
+    view_x0 = -(GRAPH_WIDTH / 2) * view_scale;
+    view_y0 = (GRAPH_HEIGHT / 2) * view_scale;
+    updateAxes();
+    replot();
+}
+
+void graphMode_init(u16* framebuffer) {
+    graph_vram = framebuffer;
+    graph_expr[0] = '\0';
+    resetView();
+}
+
+ButtonLabelRow* graphMode_labels(void) {
+    return graph_fn_page ? graph_fn_labels : graph_button_labels;
+}
+
+// Compile the edited expression; a valid one restarts the plot
+static void expressionChanged(void) {
+    if (graph_expr[0] == '\0') {
+        graph_has_program = false;
+        graph_error_pos = -1;
+        replot();
+        return;
+    }
+    if (!expr_compile(&graph_compiled, graph_expr, &graph_error_pos)) return;
+
+    graph_program = graph_compiled;
+    graph_register_version = registers_version();
+    graph_has_program = true;
+    graph_error_pos = -1;
+    replot();
+}
+
+static void insertToken(const char* text) {
+    size_t len = strlen(graph_expr);
+    size_t n = strlen(text);
+    if (graph_token_count >= GRAPH_MAX_TOKENS || len + n >= sizeof(graph_expr)) return;
+
+    memcpy(graph_expr + len, text, n + 1);
+    graph_token_len[graph_token_count++] = (u8)n;
+    expressionChanged();
+}
+
+void graphMode_handleButton(const char* label) {
+    if (strcmp(label, "FN") == 0 || strcmp(label, "123") == 0) {
+        graph_fn_page = !graph_fn_page;
+    }
+    else if (strcmp(label, "C") == 0) {
+        graph_expr[0] = '\0';
+        graph_token_count = 0;
+        expressionChanged();
+    }
+    else if (strcmp(label, "DEL") == 0) {
+        if (graph_token_count == 0) return;
+        graph_expr[strlen(graph_expr) - graph_token_len[--graph_token_count]] = '\0';
+        expressionChanged();
+    }
+    else if (strcmp(label, "RST") == 0) {
+        resetView();
+    }
+    else if (strcmp(label, "VAR") == 0) {
+        varKeys_open(insertToken); // RCL types the register's name
+    }
+    else if (label[0] >= 'a' && label[0] <= 'z' && label[1] != '\0' && strcmp(label, "pi") != 0) {
+        // Function keys open the argument's parenthesis
+        char text[8];
+        snprintf(text, sizeof(text), "%s(", label);
+        insertToken(text);
+    }
+    else {
+        insertToken(label);
+    }
+}
+
+void graphMode_handleKeys(u32 keys) {
+    if (keys & KEY_LEFT)  panX(-GRAPH_PAN_STEP);
+    if (keys & KEY_RIGHT) panX(GRAPH_PAN_STEP);
+    if (keys & KEY_UP)    panY(GRAPH_PAN_STEP);
+    if (keys & KEY_DOWN)  panY(-GRAPH_PAN_STEP);
+    if (keys & KEY_L)     zoom(false);
+    if (keys & KEY_R)     zoom(true);
+}
+
+void graphMode_update(void) {
+    if (!graph_shown) {
+        graph_shown = true; // Take over the top screen
+        redrawAll();
+    }
+    if (!graph_has_program) return;
+
+    // A register used by the expression may have been stored meanwhile
+    if (graph_program.uses_registers && graph_register_version != registers_version()) {
+        graph_register_version = registers_version();
+        replot();
+    }
+
+    int budget = GRAPH_COLUMNS_PER_FRAME;
+    for (int col = 0; col < GRAPH_WIDTH && budget > 0; col++) {
+        if (column_state[col] != COLUMN_PENDING) continue;
+
+        double value = expr_eval(&graph_program, view_x0 + col * view_scale);
+        if (isfinite(value)) {
+            column_value[col] = value;
+            column_state[col] = COLUMN_VALUE;
+        } else {
+            column_state[col] = COLUMN_UNDEFINED;
+        }
+        drawColumn(col, 0, GRAPH_HEIGHT);
+        // The next column's segment starts at this one
+        if (col + 1 < GRAPH_WIDTH && column_state[col + 1] == COLUMN_VALUE) {
+            drawColumn(col + 1, 0, GRAPH_HEIGHT);
+        }
+        budget--;
+    }
+}
+
+void graphMode_drawDisplay(void) {
+    textConsole_putText(1, 1, "D-pad:pan L/R:zoom");
+
+    // Tail of the expression when it is longer than the line
+    size_t len = strlen(graph_expr);
+    size_t start = len > GRAPH_WINDOW_CHARS ? len - GRAPH_WINDOW_CHARS : 0;
+    textConsole_printAt(2, 1, "y=%s", graph_expr + start);
+
+    if (graph_error_pos >= 0) {
+        int col = graph_error_pos - (int)start;
+        if (col < 0) col = 0;
+        textConsole_putChar(3, 3 + col, '^');
+    } else {
+        textConsole_printAt(3, 1, "x:%.3g~%.3g y:%.3g~%.3g",
+                            view_x0, view_x0 + GRAPH_WIDTH * view_scale,
+                            view_y0 - GRAPH_HEIGHT * view_scale, view_y0);
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef GRAPH_MODE_H
+#define GRAPH_MODE_H
+
+#include "calc.h"
+
+// Graphing mode: y=f(x) typed on the keypad (common/expr.c) is plotted into
+// the top screen's BG3 bitmap. Columns are evaluated a batch per frame and
+// cached, so panning only evaluates the columns scrolled into view.
+
+// Uses the 256x192 16-bit bitmap at framebuffer (row stride 256)
+void graphMode_init(u16* framebuffer);
+
+// Current keypad page (digits/operators or functions)
+ButtonLabelRow* graphMode_labels(void);
+
+void graphMode_handleButton(const char* label);
+
+// D-pad pans, L/R zoom out/in
+void graphMode_handleKeys(u32 keys);
+
+// Draws the display area (lines 1-3)
+void graphMode_drawDisplay(void);
+
+// Evaluates and draws the next batch of pending columns (call once per frame)
+void graphMode_update(void);
+
+#endif // GRAPH_MODE_H
@@ -0,0 +1,80 @@
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h> // For abs
+
+#include "hw_pad.h"
+#include "handwriting.h"
+#include "text_console.h"
+
+#define PAD_COMMIT_FRAMES 30 // Pen up this long ends the character
+#define PAD_CELL_PX 8        // Console cell size (the ink is drawn with '*')
+
+static HwInk pad_ink;
+static bool pad_active = false;
+static int pad_idle_frames = 0;
+static char pad_label[2];
+static char pad_last = 0; // Last recognised character, shown on the hint line
+
+void hwPad_init(void) {
+    handwriting_init();
+    handwriting_clear(&pad_ink);
+}
+
+void hwPad_toggle(void) {
+    pad_active = !pad_active;
+    handwriting_clear(&pad_ink);
+    pad_last = 0;
+}
+
+bool hwPad_active(void) {
+    return pad_active;
+}
+
+void hwPad_touch(const InputEvent* event) {
+    if (event->type == INPUT_TOUCH_DOWN) handwriting_penDown(&pad_ink, event->x, event->y);
+    else if (event->type == INPUT_TOUCH_MOVE) handwriting_penMove(&pad_ink, event->x, event->y);
+    else if (event->type == INPUT_TOUCH_UP) handwriting_penUp(&pad_ink);
+    pad_idle_frames = 0;
+}
+
+const char* hwPad_update(void) {
+    if (!pad_active || handwriting_empty(&pad_ink) || pad_ink.pen_down) return NULL;
+    if (++pad_idle_frames < PAD_COMMIT_FRAMES) return NULL;
+
+    u16 code = handwriting_recognize(&pad_ink, HW_SET_DIGITS | HW_SET_OPERATORS);
+    handwriting_clear(&pad_ink);
+    if (code == 0) return NULL;
+
+    pad_label[0] = (char)code;
+    pad_label[1] = '\0';
+    pad_last = (char)code;
+    return pad_label;
+}
+
+static void plotCell(int col, int row) {
+    if (col < 0 || col > 31 || row < 0 || row > 23) return;
+    textConsole_putChar(row, col, '*');
+}
+
+void hwPad_draw(int top_row) {
+    int col = textConsole_putText(top_row, 1, "Write 0-9 + - * / = . C");
+    if (pad_last != 0) textConsole_printAt(top_row, col, "  [%c]", pad_last);
+    textConsole_putText(23, 1, "Tap the display for the keypad");
+
+    // Connect the samples of each stroke cell by cell
+    int start = 0;
+    for (int s = 0; s < pad_ink.stroke_count; s++) {
+        int end = pad_ink.stroke_end[s];
+        for (int i = start; i < end; i++) {
+            int c1 = pad_ink.x[i] / PAD_CELL_PX, r1 = pad_ink.y[i] / PAD_CELL_PX;
+            int c0 = i > start ? pad_ink.x[i - 1] / PAD_CELL_PX : c1;
+            int r0 = i > start ? pad_ink.y[i - 1] / PAD_CELL_PX : r1;
+            int steps = abs(c1 - c0) > abs(r1 - r0) ? abs(c1 - c0) : abs(r1 - r0);
+            for (int k = 1; k <= steps; k++) {
+                plotCell(c0 + (c1 - c0) * k / steps, r0 + (r1 - r0) * k / steps);
+            }
+            if (steps == 0) plotCell(c1, r1);
+        }
+        start = end;
+    }
+}
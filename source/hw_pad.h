@@ -0,0 +1,27 @@
+#ifndef HW_PAD_H
+#define HW_PAD_H
+
+#include "calc.h"
+#include "input.h"
+
+// Handwriting pad (common/handwriting.c) shown instead of the keypad.
+// Tapping the display switches between the keypad and the pad. A digit or
+// operator written on the pad is pressed like the button with that label
+// once the pen has been up for half a second.
+
+void hwPad_init(void);
+
+void hwPad_toggle(void);
+
+bool hwPad_active(void);
+
+// Touch down/move/up on the pad
+void hwPad_touch(const InputEvent* event);
+
+// Once per frame: the label of a finished character, or NULL
+const char* hwPad_update(void);
+
+// Draws the ink and a hint from console row top_row down
+void hwPad_draw(int top_row);
+
+#endif // HW_PAD_H
@@ -8,6 +8,41 @@
 #include <string.h>
 #include <stdlib.h> // For strtod
 #include <ctype.h>  // For isdigit
+#include <math.h>   // For isfinite
+
+#include "calc.h"
+#include "big_mode.h"
+#include "complex_mode.h"
+#include "frac_mode.h"
+#include "graph_mode.h"
+#include "hw_pad.h"
+#include "matrix_mode.h"
+#include "prog_mode.h"
+#include "solve_mode.h"
+#include "stats_mode.h"
+#include "var_keys.h"
+#include "hw_math.h"
+#include "input.h"
+#include "macro.h"
+#include "registers.h"
+#include "sci_math.h"
+#include "text_console.h"
+#include "worker.h"
+
+#ifdef ENABLE_BENCHMARK
+#include "chumonno_oi_ryoriten_pack_bin.h"
+#include "bignum.h"
+#include "complex.h"
+#include "handwriting.h"
+#include "intcalc.h"
+#include "matrix.h"
+#include "rational.h"
+#include "stats.h"
+#include "sjis.h"
+#include "solve.h"
+#include "tcm.h"
+#include "text_pack.h"
+#endif
 
 // Character dimensions of the console (approximate)
 #define CONSOLE_WIDTH_CHARS 32
@@ -30,15 +65,89 @@ double current_value = 0.0;
 char pending_operation = ' ';
 bool new_number_flag = true;
 
+// Calculator modes (SELECT cycles through them)
+typedef enum {
+    MODE_BASIC,
+    MODE_SCIENTIFIC,
+    MODE_BIG,
+    MODE_GRAPH,
+    MODE_MATRIX,
+    MODE_STATS,
+    MODE_COMPLEX,
+    MODE_PROG,
+    MODE_FRAC,
+    MODE_SOLVE,
+    MODE_COUNT
+} CalcMode;
+
+CalcMode calc_mode = MODE_BASIC;
+bool angle_degrees = true; // Scientific mode angle unit (DRG toggles)
+
+#define DEG_TO_RAD (SCI_PI / 180.0)
+#define RAD_TO_DEG (180.0 / SCI_PI)
+
+// Degree arguments up to this size are checked for exact multiples of 90
+#define SCI_TRIG_EXACT_MAX 1.0e8
+
 // Button layout (row, col, label) - using character coordinates for drawing
-const char* button_labels[5][4] = {
+const char* button_labels[BUTTON_ROWS][BUTTON_COLS] = {
     {"C", "/", "*", "-"},
     {"7", "8", "9", "+"},
     {"4", "5", "6", "="},
-    {"1", "2", "3", ""}, // = spans two rows, so last one is empty
-    {"0", ".", "", ""} // 0 spans two columns, so last two are empty
+    {"1", "2", "3", "M+"},
+    {"0", ".", "MR", "VAR"} // VAR opens the register keypad (STO/RCL A-Z, Ans)
+};
+
+// Scientific mode: functions act on the displayed value, x^y is a binary operator.
+// 123 and FN switch between the function page and a digit page
+const char* sci_button_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "sin", "cos", "tan"},
+    {"DRG", "asin", "acos", "atan"},
+    {"ln", "log", "e^x", "10^x"},
+    {"sqrt", "x^2", "x^y", "1/x"},
+    {"pi", "e", "+/-", "123"}
+};
+
+const char* sci_digit_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "/", "*", "-"},
+    {"7", "8", "9", "+"},
+    {"4", "5", "6", "="},
+    {"1", "2", "3", "+/-"},
+    {"0", ".", "x^y", "FN"}
+};
+
+bool sci_digit_page = false;
+
+typedef struct {
+    const char* name;
+    const char* (*labels)[BUTTON_COLS];
+} CalcModeInfo;
+
+const CalcModeInfo calc_modes[MODE_COUNT] = {
+    { "BASIC", button_labels },
+    { "SCI", NULL }, // Function and digit pages
+    { "BIG", big_button_labels },
+    { "GRAPH", NULL }, // Two keypad pages, see currentLabels()
+    { "MATRIX", NULL },
+    { "STATS", stats_button_labels },
+    { "CPLX", NULL },
+    { "PROG", NULL },
+    { "FRAC", frac_button_labels },
+    { "SOLVE", NULL },
 };
 
+// Keypad layout of the current mode
+ButtonLabelRow* currentLabels(void) {
+    if (varKeys_active()) return varKeys_labels();
+    if (calc_mode == MODE_SCIENTIFIC) return sci_digit_page ? sci_digit_labels : sci_button_labels;
+    if (calc_mode == MODE_GRAPH) return graphMode_labels();
+    if (calc_mode == MODE_MATRIX) return matrixMode_labels();
+    if (calc_mode == MODE_COMPLEX) return complexMode_labels();
+    if (calc_mode == MODE_PROG) return progMode_labels();
+    if (calc_mode == MODE_SOLVE) return solveMode_labels();
+    return calc_modes[calc_mode].labels;
+}
+
 // New button drawing dimensions (character units)
 #define BUTTON_DRAW_WIDTH_CHAR 7  // e.g., "+-----+"
 #define BUTTON_DRAW_HEIGHT_CHAR 3 // e.g., top border, label, bottom border
@@ -64,21 +173,30 @@ void drawButton(int row_char, int col_char, const char* label) {
     int padding_right = BUTTON_DRAW_WIDTH_CHAR - 2 - label_len - padding_left;
 
     // Top border
-    iprintf("\x1b[%d;%dH+", row_char, col_char);
-    for (int i = 0; i < BUTTON_DRAW_WIDTH_CHAR - 2; ++i) iprintf("-");
-    iprintf("+");
+    int col = textConsole_putChar(row_char, col_char, '+');
+    col = textConsole_fill(row_char, col, '-', BUTTON_DRAW_WIDTH_CHAR - 2);
+    textConsole_putChar(row_char, col, '+');
 
     // Label row
-    iprintf("\x1b[%d;%dH|", row_char + 1, col_char);
-    for (int i = 0; i < padding_left; ++i) iprintf(" ");
-    iprintf("%s", label);
-    for (int i = 0; i < padding_right; ++i) iprintf(" ");
-    iprintf("|");
+    col = textConsole_putChar(row_char + 1, col_char, '|');
+    col = textConsole_fill(row_char + 1, col, ' ', padding_left);
+    col = textConsole_putText(row_char + 1, col, label);
+    col = textConsole_fill(row_char + 1, col, ' ', padding_right);
+    textConsole_putChar(row_char + 1, col, '|');
 
     // Bottom border
-    iprintf("\x1b[%d;%dH+", row_char + 2, col_char);
-    for (int i = 0; i < BUTTON_DRAW_WIDTH_CHAR - 2; ++i) iprintf("-");
-    iprintf("+");
+    col = textConsole_putChar(row_char + 2, col_char, '+');
+    col = textConsole_fill(row_char + 2, col, '-', BUTTON_DRAW_WIDTH_CHAR - 2);
+    textConsole_putChar(row_char + 2, col, '+');
+}
+
+// Reset the calculator and show an error message
+void showError(void) {
+    strcpy(display_buffer, "Error");
+    current_value = 0.0;
+    strcpy(expression_buffer, "");
+    pending_operation = ' ';
+    new_number_flag = true;
 }
 
 // Function to perform pending operation
@@ -92,15 +210,17 @@ void performOperation() {
         current_value *= second_operand;
     } else if (pending_operation == '/') {
         if (second_operand != 0.0) {
-            current_value /= second_operand;
+            current_value = hwmath_divDouble(current_value, second_operand);
         } else {
-            strcpy(display_buffer, "Error"); // Handle division by zero
-            current_value = 0.0;
-            strcpy(expression_buffer, "");
-            pending_operation = ' ';
-            new_number_flag = true;
+            showError(); // Handle division by zero
             return;
         }
+    } else if (pending_operation == '^') {
+        current_value = sci_pow(current_value, second_operand);
+    }
+    if (!isfinite(current_value)) {
+        showError(); // Overflow or domain error (e.g. negative ^ fraction)
+        return;
     }
     // Format current_value back to display_buffer
     snprintf(display_buffer, sizeof(display_buffer), "%.6g", current_value); // Use %g for general formatting
@@ -110,15 +230,372 @@ void performOperation() {
     new_number_flag = true;
 }
 
+// Show a function result in the display, keeping any pending operation
+void showResult(double result) {
+    if (!isfinite(result)) {
+        showError();
+        return;
+    }
+    snprintf(display_buffer, sizeof(display_buffer), "%.6g", result);
+    registers_set(REG_ANS, result);
+    new_number_flag = true;
+}
+
+// sin/cos/tan of a multiple of 90 degrees, exactly (avoids results like 1.22465e-16)
+bool exactTrigDegrees(const char* name, double x, double* result) {
+    if (!angle_degrees || x < -SCI_TRIG_EXACT_MAX || x > SCI_TRIG_EXACT_MAX) return false;
+    int k = (int)x / 90;
+    if ((double)k * 90 != x) return false;
+
+    static const double sin_q[4] = {0.0, 1.0, 0.0, -1.0};
+    k &= 3;
+    if (strcmp(name, "sin") == 0) *result = sin_q[k];
+    else if (strcmp(name, "cos") == 0) *result = sin_q[(k + 1) & 3];
+    else *result = (k & 1) ? NAN : 0.0; // tan 90 is undefined
+    return true;
+}
+
+// Apply a one-argument function to the displayed value
+void applyFunction(const char* name, double (*fn)(double), bool angle_arg, bool angle_result) {
+    double x = strtod(display_buffer, NULL);
+    double result;
+
+    if (pending_operation == ' ') {
+        snprintf(expression_buffer, sizeof(expression_buffer), "%s(%s)", name, display_buffer);
+    }
+    if (angle_arg && exactTrigDegrees(name, x, &result)) {
+        showResult(result);
+        return;
+    }
+    if (angle_arg && angle_degrees) x *= DEG_TO_RAD;
+    result = fn(x);
+    if (angle_result && angle_degrees) result *= RAD_TO_DEG;
+    showResult(result);
+}
+
+double squareOf(double x) { return x * x; }
+double reciprocalOf(double x) { return x != 0.0 ? hwmath_divDouble(1.0, x) : NAN; }
+double tenToThe(double x) { return sci_pow(10.0, x); }
+
+// Scientific mode keys. Returns false for keys shared with the basic mode.
+bool handleScientific(const char* label) {
+    if (strcmp(label, "sin") == 0) applyFunction(label, sci_sin, true, false);
+    else if (strcmp(label, "cos") == 0) applyFunction(label, sci_cos, true, false);
+    else if (strcmp(label, "tan") == 0) applyFunction(label, sci_tan, true, false);
+    else if (strcmp(label, "asin") == 0) applyFunction(label, sci_asin, false, true);
+    else if (strcmp(label, "acos") == 0) applyFunction(label, sci_acos, false, true);
+    else if (strcmp(label, "atan") == 0) applyFunction(label, sci_atan, false, true);
+    else if (strcmp(label, "ln") == 0) applyFunction(label, sci_ln, false, false);
+    else if (strcmp(label, "log") == 0) applyFunction(label, sci_log10, false, false);
+    else if (strcmp(label, "e^x") == 0) applyFunction("exp", sci_exp, false, false);
+    else if (strcmp(label, "10^x") == 0) applyFunction("10^", tenToThe, false, false);
+    else if (strcmp(label, "sqrt") == 0) applyFunction(label, sci_sqrt, false, false);
+    else if (strcmp(label, "x^2") == 0) applyFunction("sqr", squareOf, false, false);
+    else if (strcmp(label, "1/x") == 0) applyFunction("1/", reciprocalOf, false, false);
+    else if (strcmp(label, "x^y") == 0) {
+        // Binary operator: enter the exponent on the digit page, then "="
+        if (pending_operation != ' ') {
+            performOperation();
+        } else {
+            current_value = strtod(display_buffer, NULL);
+        }
+        pending_operation = '^';
+        snprintf(expression_buffer, sizeof(expression_buffer), "%.6g ^", current_value);
+        new_number_flag = true;
+        sci_digit_page = true;
+    }
+    else if (strcmp(label, "pi") == 0 || strcmp(label, "e") == 0) {
+        snprintf(display_buffer, sizeof(display_buffer), "%.15g", label[0] == 'p' ? SCI_PI : SCI_E);
+        new_number_flag = true;
+    }
+    else if (strcmp(label, "DRG") == 0) {
+        angle_degrees = !angle_degrees;
+    }
+    else if (strcmp(label, "FN") == 0 || strcmp(label, "123") == 0) {
+        sci_digit_page = !sci_digit_page;
+    }
+    else return false;
+    return true;
+}
+
+// Handle a touched button of the current mode
+void handleButton(const char* pressed_label) {
+    if (varKeys_active()) {
+        varKeys_handleButton(pressed_label);
+        return;
+    }
+    if (calc_mode == MODE_GRAPH) {
+        graphMode_handleButton(pressed_label);
+        return;
+    }
+    if (calc_mode == MODE_MATRIX) {
+        matrixMode_handleButton(pressed_label);
+        return;
+    }
+    if (calc_mode == MODE_PROG) {
+        progMode_handleButton(pressed_label);
+        return;
+    }
+    if (calc_mode == MODE_SCIENTIFIC && handleScientific(pressed_label)) {
+        return;
+    }
+    if (calc_mode == MODE_BIG && bigMode_handleButton(pressed_label)) {
+        return;
+    }
+    if (calc_mode == MODE_STATS && statsMode_handleButton(pressed_label)) {
+        return;
+    }
+    if (calc_mode == MODE_COMPLEX && complexMode_handleButton(pressed_label)) {
+        return;
+    }
+    if (calc_mode == MODE_FRAC && fracMode_handleButton(pressed_label)) {
+        return;
+    }
+    if (calc_mode == MODE_SOLVE && solveMode_handleButton(pressed_label)) {
+        return;
+    }
+
+    // Handle digits
+    if (isdigit((unsigned char)pressed_label[0])) { // Fixed warning here
+        if (new_number_flag || strcmp(display_buffer, "0") == 0 || strcmp(display_buffer, "Error") == 0) {
+            strcpy(display_buffer, pressed_label);
+            // strcpy(expression_buffer, ""); // Clear expression when starting new number - removed for log display
+            new_number_flag = false;
+        } else if (strlen(display_buffer) < 16) { // Max 16 digits
+            strcat(display_buffer, pressed_label);
+        }
+    }
+    // Handle decimal point
+    else if (strcmp(pressed_label, ".") == 0) {
+        if (new_number_flag || strcmp(display_buffer, "Error") == 0) {
+            strcpy(display_buffer, "0.");
+            // strcpy(expression_buffer, ""); // removed
+            new_number_flag = false;
+        } else if (!strchr(display_buffer, '.')) { // Only add if not already present
+            strcat(display_buffer, pressed_label);
+        }
+    }
+    // Handle sign change (scientific, statistics, complex, fraction and solver keypads)
+    else if (strcmp(pressed_label, "+/-") == 0) {
+        if (display_buffer[0] == '-') {
+            memmove(display_buffer, display_buffer + 1, strlen(display_buffer));
+        } else if (strcmp(display_buffer, "0") != 0 && strcmp(display_buffer, "Error") != 0 &&
+                   strlen(display_buffer) < sizeof(display_buffer) - 1) {
+            memmove(display_buffer + 1, display_buffer, strlen(display_buffer) + 1);
+            display_buffer[0] = '-';
+        }
+    }
+    // Handle operators
+    else if (strchr("+-*/", pressed_label[0])) {
+        if (pending_operation != ' ') { // If there's a pending operation, perform it first
+            performOperation();
+        } else { // First operand is the current display value
+            current_value = strtod(display_buffer, NULL);
+        }
+        pending_operation = pressed_label[0];
+        // Update expression buffer with current value and operator
+        snprintf(expression_buffer, sizeof(expression_buffer), "%.6g %c", current_value, pending_operation);
+        new_number_flag = true;
+    }
+    // Handle equals
+    else if (strcmp(pressed_label, "=") == 0) {
+        if (pending_operation != ' ') {
+            // Before performing, capture the full expression for display
+            double second_operand_for_display = strtod(display_buffer, NULL);
+            snprintf(expression_buffer, sizeof(expression_buffer), "%.6g %c %.6g =", current_value, pending_operation, second_operand_for_display);
+            performOperation();
+            if (strcmp(display_buffer, "Error") != 0) registers_set(REG_ANS, current_value);
+        }
+        // performOperation already clears pending_operation and sets new_number_flag
+    }
+    // Memory keys (the M register) and the register keypad
+    else if (strcmp(pressed_label, "M+") == 0) {
+        if (strcmp(display_buffer, "Error") != 0) {
+            registers_set(REG_M, registers_get(REG_M) + strtod(display_buffer, NULL));
+        }
+        new_number_flag = true;
+    }
+    else if (strcmp(pressed_label, "MR") == 0) {
+        snprintf(display_buffer, sizeof(display_buffer), "%.6g", registers_get(REG_M));
+        new_number_flag = true;
+    }
+    else if (strcmp(pressed_label, "VAR") == 0) {
+        varKeys_open(NULL);
+    }
+    // Handle clear
+    else if (strcmp(pressed_label, "C") == 0) {
+        strcpy(display_buffer, "0");
+        strcpy(expression_buffer, "");
+        current_value = 0.0;
+        pending_operation = ' ';
+        new_number_flag = true;
+    }
+}
+
+// Find the button of the current mode under a touch point (NULL if none)
+const char* findButton(int px, int py) {
+    ButtonLabelRow* labels = currentLabels();
+
+    for (int r = 0; r < BUTTON_ROWS; ++r) {
+        for (int c = 0; c < BUTTON_COLS; ++c) {
+            if (labels[r][c][0] != '\0') {
+                // Calculate button's pixel boundaries
+                int btn_px_start_x = BUTTON_START_COL_PX + c * BUTTON_CELL_WIDTH_PX;
+                int btn_px_end_x = btn_px_start_x + BUTTON_CELL_WIDTH_PX;
+                int btn_px_start_y = BUTTON_START_ROW_PX + r * BUTTON_CELL_HEIGHT_PX;
+                int btn_px_end_y = btn_px_start_y + BUTTON_CELL_HEIGHT_PX;
+
+                // Check if touch pixel is within this button's pixel area
+                if (px >= btn_px_start_x && px < btn_px_end_x &&
+                    py >= btn_px_start_y && py < btn_px_end_y) {
+                    return labels[r][c];
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+// Key and touch events are queued by a timer interrupt, so a tap or a short
+// press between two frames (or during a slow frame) still counts
+#define INPUT_TIMER 2 // Timers 0/1 are used by the benchmarks
+
+InputQueue input_queue;
+
+// Keystroke macros: X starts/stops recording, A plays, Y saves to the
+// current SD slot, B moves to the next slot and loads it
+#define MACRO_SLOTS 4
+#define MACRO_STEPS_PER_FRAME 256 // Steps replayed per frame (the screen is not redrawn meanwhile)
+
+MacroProgram macro_program;
+MacroPlayer macro_player;
+bool macro_recording = false;
+bool macro_playing = false;
+int macro_slot = 1;
+const char* macro_status = NULL; // Result of the last save/load
+
+// Registers are loaded at startup; changed ones are written back in place
+#define REGISTER_FILE "/calc_registers.dat"
+#define REGISTER_SYNC_FRAMES 120 // At most one SD write every 2 seconds
+
+// Mode switch replayed from a macro
+void setModeFromMacro(u8 mode) {
+    if (mode < MODE_COUNT) calc_mode = (CalcMode)mode;
+    varKeys_close();
+}
+
+// Key replayed from a macro: a big-number job must finish before the next key
+void playMacroKey(const char* label) {
+    bigMode_wait();
+    handleButton(label);
+}
+
+void macroPath(char* path, size_t size) {
+    snprintf(path, size, "/calc_macro%d.mac", macro_slot);
+}
+
+void handleMacroKeys(u32 keys) {
+    char path[32];
+
+    if (keys & KEY_X) {
+        macro_status = NULL;
+        if (macro_recording) {
+            macro_recording = false;
+        } else {
+            // Start in the mode the macro was recorded in
+            macro_clear(&macro_program);
+            macro_recording = macro_recordMode(&macro_program, calc_mode);
+        }
+    }
+    if (macro_recording) return;
+
+    if ((keys & KEY_A) && macro_program.length > 0) {
+        macro_startPlayback(&macro_player, &macro_program);
+        macro_playing = true;
+        macro_status = NULL;
+    }
+    if (keys & KEY_Y) {
+        macroPath(path, sizeof(path));
+        macro_status = macro_save(&macro_program, path) ? "saved" : "fail";
+    }
+    if (keys & KEY_B) {
+        macro_slot = macro_slot % MACRO_SLOTS + 1;
+        macroPath(path, sizeof(path));
+        macro_status = macro_load(&macro_program, path) ? "load" : "empty";
+    }
+}
+
+// Press a button by label (tapped or handwritten), recording it into a macro
+void pressButton(const char* label) {
+    handleButton(label);
+    if (macro_recording && !macro_recordKey(&macro_program, label)) {
+        macro_recording = false; // Program full
+    }
+}
+
+// Handle a tap on the keypad
+void handleTouch(int px, int py) {
+    const char* pressed_label = findButton(px, py);
+    if (pressed_label != NULL) {
+        pressButton(pressed_label);
+    }
+}
+
+#ifdef ENABLE_BENCHMARK
+// 本文を展開しておく作業領域 (デコーダのベンチマーク用)
+static u8 bench_text[16 * 1024];
+
+// make BENCHMARK=1 のとき起動直後に各モジュールのベンチマークを実行する
+void runBenchmarks(void) {
+    TextPack pack;
+    if (textPack_open(&pack, chumonno_oi_ryoriten_pack_bin, chumonno_oi_ryoriten_pack_bin_size)) {
+        u32 size = textPack_read(&pack, 0, bench_text, sizeof(bench_text));
+        sjis_benchmark(bench_text, size, 1000);
+        textPack_benchmark(&pack, 1000);
+    }
+    hwmath_benchmark();
+    sci_benchmark();
+    bignum_benchmark();
+    matrix_benchmark();
+    stats_benchmark();
+    complex_benchmark();
+    rational_benchmark();
+    solve_benchmark();
+    intcalc_benchmark();
+    tcm_benchmark();
+    handwriting_benchmark();
+
+    // 1000キーのマクロ (1+1+...+1=) を画面を描かずに再生
+    macro_clear(&macro_program);
+    macro_recordMode(&macro_program, MODE_BASIC);
+    for (int i = 0; i < 499; i++) {
+        macro_recordKey(&macro_program, "1");
+        macro_recordKey(&macro_program, "+");
+    }
+    macro_recordKey(&macro_program, "=");
+    macro_benchmark(&macro_program, handleButton, setModeFromMacro);
+    iprintf(" result %s\n", display_buffer);
+    macro_clear(&macro_program);
+
+    iprintf("Press START to continue\n");
+    while (1) {
+        swiWaitForVBlank();
+        scanKeys();
+        if (keysDown() & KEY_START) break;
+    }
+}
+#endif
+
 //---------------------------------------------------------------------------------
 int main(void) {
 //---------------------------------------------------------------------------------
     // 上画面をグラフィックモードに設定し、赤い四角形を描画
     videoSetMode(MODE_5_2D); // 2Dモード、BG3をビットマップとして使用
-    vramSetBankA(VRAM_A_MAIN_BG); // VRAM_Aをメイン画面のBGとして割り当て
-    bgInit(3, BgType_Bmp16, BgSize_B16_256x256, 0, 0); // BG3を使用
+    vramSetBankA(VRAM_A_MAIN_BG_0x06000000); // VRAM_A: BG0のテキスト (プログラマモードの表示)
+    vramSetBankB(VRAM_B_MAIN_BG_0x06020000); // VRAM_B: BG3のビットマップ
+    int bitmap_bg = bgInit(3, BgType_Bmp16, BgSize_B16_256x256, 8, 0); // 8 × 16KB = VRAM_Bの先頭
 
-    u16* main_vram = (u16*)BG_BMP_RAM(3); // BG3のVRAMアドレスを取得 (BG_BMP_RAM(3) for BG3)
+    u16* main_vram = bgGetGfxPtr(bitmap_bg); // BG3のVRAMアドレスを取得
     u16 rect_color = RGB15(31, 0, 0); // 赤色 (Red)
 
     // 画面中央に四角形を描画
@@ -135,130 +612,186 @@ int main(void) {
         }
     }
 
-    // 下画面のコンソールを初期化 (consoleDemoInit() は下画面をデフォルトにする)
-    consoleDemoInit();
+    // 下画面のコンソールを初期化 (consoleDemoInit() は下画面をデフォルトにする)。
+    // 毎フレームの表示はtextConsoleで同じマップに直接書く
+    textConsole_attach(consoleDemoInit());
+
+#ifdef ENABLE_BENCHMARK
+    runBenchmarks();
+#endif
+
+    worker_start(); // Big-number jobs go to the ARM7 (arm7/)
+    bigMode_init();
+    graphMode_init(main_vram);
+    matrixMode_init();
+    progMode_init(bitmap_bg);
+    hwPad_init();
+    registers_load(REGISTER_FILE);
+    keysSetRepeat(20, 4); // Held D-pad scrolls long results
+    input_reset(&input_queue);
+    input_start(&input_queue, INPUT_TIMER);
 
     // 初期状態を設定
     strcpy(display_buffer, "0");
     strcpy(expression_buffer, "");
 
+    int register_sync_timer = 0;
+
     // メインループ
     while(1) {
         swiWaitForVBlank();
-        scanKeys();
-        touchPosition touch;
-        touchRead(&touch);
-
-        // 下画面の描画
-        iprintf("\x1b[2J"); // Clear sub screen
-
-        // Draw Expression Area (on sub screen, Line 1)
-        iprintf("\x1b[1;1H%s", expression_buffer); 
-        // Draw Display Area (on sub screen, Line 2)
-        iprintf("\x1b[2;1H%s", display_buffer); 
-
-        // Draw Buttons
-        for (int r = 0; r < 5; ++r) {
-            for (int c = 0; c < 4; ++c) {
-                if (button_labels[r][c][0] != '\0') { // If label exists
-                    drawButton(BUTTON_START_ROW_CHAR + r * BUTTON_ROW_SPACING_CHAR,
-                               BUTTON_START_COL_CHAR + c * BUTTON_COL_SPACING_CHAR,
-                               button_labels[r][c]);
-                }
+        textConsole_commit(); // The previous frame's text, while the screen is in VBlank
+        scanKeys(); // keysDownRepeat() for the D-pad scrolling
+
+        if (macro_playing) {
+            // Replay without redrawing until the macro has finished. The input
+            // queue is still emptied every frame so that it cannot overflow; a
+            // tap or a key stops the replay and nothing is pressed afterwards
+            bool stop = false;
+            InputEvent event;
+            while (input_pop(&input_queue, &event)) {
+                if (event.type == INPUT_KEY_DOWN || event.type == INPUT_TOUCH_DOWN) stop = true;
+            }
+            if (stop) {
+                macro_playing = false;
+                macro_status = "stop";
+            } else {
+                macro_playing = macro_step(&macro_player, MACRO_STEPS_PER_FRAME, playMacroKey, setModeFromMacro);
+                if (macro_playing) continue;
             }
         }
 
-        // Touch handling (on sub screen)
-        if (keysDown() & KEY_TOUCH) { // Changed from keysHeld() to keysDown() for debouncing
-            // Use raw pixel coordinates for more accurate hit detection
-            int px = touch.px;
-            int py = touch.py;
-
-            bool button_found = false;
-            for (int r = 0; r < 5; ++r) {
-                for (int c = 0; c < 4; ++c) {
-                    if (button_labels[r][c][0] != '\0') {
-                        // Calculate button's pixel boundaries
-                        int btn_px_start_x = BUTTON_START_COL_PX + c * BUTTON_CELL_WIDTH_PX;
-                        int btn_px_end_x = btn_px_start_x + BUTTON_CELL_WIDTH_PX;
-                        int btn_px_start_y = BUTTON_START_ROW_PX + r * BUTTON_CELL_HEIGHT_PX;
-                        int btn_px_end_y = btn_px_start_y + BUTTON_CELL_HEIGHT_PX;
-
-                        // Check if touch pixel is within this button's pixel area
-                        if (px >= btn_px_start_x && px < btn_px_end_x &&
-                            py >= btn_px_start_y && py < btn_px_end_y) {
-                            
-                            const char* pressed_label = button_labels[r][c];
-
-                            // Handle digits
-                            if (isdigit((unsigned char)pressed_label[0])) { // Fixed warning here
-                                if (new_number_flag || strcmp(display_buffer, "0") == 0 || strcmp(display_buffer, "Error") == 0) {
-                                    strcpy(display_buffer, pressed_label);
-                                    // strcpy(expression_buffer, ""); // Clear expression when starting new number - removed for log display
-                                    new_number_flag = false;
-                                } else if (strlen(display_buffer) < 16) { // Max 16 digits
-                                    strcat(display_buffer, pressed_label);
-                                }
-                            }
-                            // Handle decimal point
-                            else if (strcmp(pressed_label, ".") == 0) {
-                                if (new_number_flag || strcmp(display_buffer, "Error") == 0) {
-                                    strcpy(display_buffer, "0.");
-                                    // strcpy(expression_buffer, ""); // removed
-                                    new_number_flag = false;
-                                } else if (!strchr(display_buffer, '.')) { // Only add if not already present
-                                    strcat(display_buffer, pressed_label);
-                                }
-                            }
-                            // Handle operators
-                            else if (strchr("+-*/", pressed_label[0])) {
-                                if (pending_operation != ' ') { // If there's a pending operation, perform it first
-                                    performOperation();
-                                } else { // First operand is the current display value
-                                    current_value = strtod(display_buffer, NULL);
-                                }
-                                pending_operation = pressed_label[0];
-                                // Update expression buffer with current value and operator
-                                snprintf(expression_buffer, sizeof(expression_buffer), "%.6g %c", current_value, pending_operation);
-                                new_number_flag = true;
-                            }
-                            // Handle equals
-                            else if (strcmp(pressed_label, "=") == 0) {
-                                if (pending_operation != ' ') {
-                                    // Before performing, capture the full expression for display
-                                    double second_operand_for_display = strtod(display_buffer, NULL);
-                                    snprintf(expression_buffer, sizeof(expression_buffer), "%.6g %c %.6g =", current_value, pending_operation, second_operand_for_display);
-                                    performOperation();
-                                }
-                                // performOperation already clears pending_operation and sets new_number_flag
-                            }
-                            // Handle clear
-                            else if (strcmp(pressed_label, "C") == 0) {
-                                strcpy(display_buffer, "0");
-                                strcpy(expression_buffer, "");
-                                current_value = 0.0;
-                                pending_operation = ' ';
-                                new_number_flag = true;
-                            }
-
-                            // For now, just print the pressed button's label to a debug area on the sub screen
-                            // This debug line will be overwritten by the main display, so it's fine.
-                            // iprintf("\x1b[23;1HPressed: %s", pressed_label);
-                            button_found = true;
-                            goto end_touch_check; // Exit loops once button found
-                        }
+        // 下画面の描画 (まとめて次のVBlankで写すので、消してから描き直してもちらつかない)
+        textConsole_beginBatch();
+        textConsole_clear();
+
+        // Mode line (Line 0)
+        textConsole_printAt(0, 1, "%s%s", calc_modes[calc_mode].name,
+                            calc_mode == MODE_SCIENTIFIC ? (angle_degrees ? " DEG" : " RAD") : "");
+        if (macro_recording) {
+            textConsole_printAt(0, 11, "REC %lu", (unsigned long)macro_stepCount(&macro_program));
+        } else if (macro_status != NULL) {
+            textConsole_printAt(0, 11, "M%d %s", macro_slot, macro_status);
+        } else if (macro_program.length > 0) {
+            textConsole_printAt(0, 11, "M%d %lu", macro_slot, (unsigned long)macro_stepCount(&macro_program));
+        }
+        textConsole_putText(0, 20, "SELECT:mode");
+
+        if (calc_mode == MODE_GRAPH) {
+            graphMode_drawDisplay(); // Expression being plotted (Lines 1-3)
+        } else if (calc_mode == MODE_MATRIX) {
+            matrixMode_drawDisplay(); // Sizes, element under the cursor, result (Lines 1-3)
+        } else if (calc_mode == MODE_STATS) {
+            statsMode_drawDisplay(); // Count, entry and the selected result (Lines 1-3)
+        } else if (calc_mode == MODE_COMPLEX) {
+            complexMode_drawDisplay(); // Log, entry or scrollable result, display format (Lines 1-3)
+        } else if (calc_mode == MODE_FRAC) {
+            fracMode_drawDisplay(); // Log, entry or scrollable result, display format (Lines 1-3)
+        } else if (calc_mode == MODE_SOLVE) {
+            solveMode_drawDisplay(); // f(x), number entry, progress or result (Lines 1-3)
+        } else if (calc_mode == MODE_PROG) {
+            progMode_drawDisplay(); // Pending operand, value in the entry base, word size (Lines 1-3)
+        } else {
+            // Draw Expression Area (on sub screen, Line 1)
+            textConsole_putText(1, 1, expression_buffer);
+            // Draw Display Area (on sub screen, Line 2)
+            if (calc_mode == MODE_BIG) {
+                bigMode_drawDisplay(); // Scrollable long result (Lines 2-3)
+            } else {
+                textConsole_putText(2, 1, display_buffer);
+            }
+        }
+        if (varKeys_active()) {
+            varKeys_drawStatus(); // STO/RCL waiting for a register (Line 3)
+        }
+
+        progMode_drawTop(calc_mode == MODE_PROG); // All four bases on the top screen
+
+        // Draw Buttons (or the handwriting pad in their place)
+        if (hwPad_active()) {
+            hwPad_draw(BUTTON_START_ROW_CHAR);
+        } else {
+            ButtonLabelRow* labels = currentLabels();
+            for (int r = 0; r < BUTTON_ROWS; ++r) {
+                for (int c = 0; c < BUTTON_COLS; ++c) {
+                    if (labels[r][c][0] != '\0') { // If label exists
+                        drawButton(BUTTON_START_ROW_CHAR + r * BUTTON_ROW_SPACING_CHAR,
+                                   BUTTON_START_COL_CHAR + c * BUTTON_COL_SPACING_CHAR,
+                                   labels[r][c]);
                     }
                 }
             }
-            end_touch_check:;
-            // Clear debug area if no button found or not touching
-            // iprintf("\x1b[23;1H                                  ");
-        } else {
-            // iprintf("\x1b[23;1H                                  ");
+        }
+        textConsole_endBatch();
+
+        // Input since the last frame: taps in order, keys pressed collected
+        u32 pressed = 0;
+        InputEvent event;
+        while (input_pop(&input_queue, &event)) {
+            if (event.type == INPUT_KEY_DOWN) {
+                pressed |= event.keys;
+            } else if (event.type == INPUT_KEY_UP) {
+                continue;
+            } else if (event.type == INPUT_TOUCH_DOWN && event.y < BUTTON_START_ROW_PX) {
+                hwPad_toggle(); // Tapping the display switches between keypad and handwriting
+            } else if (hwPad_active()) {
+                hwPad_touch(&event); // Stroke on the pad
+            } else if (event.type == INPUT_TOUCH_DOWN) {
+                handleTouch(event.x, event.y); // Pixel coordinates on the sub screen
+            }
         }
 
-        if(keysDown() & KEY_START) break;
+        // A handwritten character counts as a button press
+        const char* written = hwPad_update();
+        if (written != NULL) {
+            pressButton(written);
+        }
+
+        if (calc_mode == MODE_BIG) {
+            bigMode_update(); // Finish a key whose job came back from the ARM7
+            bigMode_handleKeys(keysDownRepeat());
+        }
+        if (calc_mode == MODE_GRAPH) {
+            graphMode_handleKeys(keysDownRepeat());
+            graphMode_update(); // Plot a batch of columns
+        }
+        if (calc_mode == MODE_MATRIX) {
+            matrixMode_handleKeys(keysDownRepeat());
+        }
+        if (calc_mode == MODE_STATS) {
+            statsMode_handleKeys(pressed);
+        }
+        if (calc_mode == MODE_COMPLEX) {
+            complexMode_handleKeys(keysDownRepeat());
+        }
+        if (calc_mode == MODE_FRAC) {
+            fracMode_handleKeys(keysDownRepeat());
+        }
+        if (calc_mode == MODE_SOLVE) {
+            solveMode_handleKeys(keysDownRepeat());
+            solveMode_update(); // Run a batch of a solve in progress
+        }
+
+        // Switch calculator mode
+        if (pressed & KEY_SELECT) {
+            calc_mode = (CalcMode)((calc_mode + 1) % MODE_COUNT);
+            varKeys_close();
+            if (macro_recording && !macro_recordMode(&macro_program, calc_mode)) {
+                macro_recording = false;
+            }
+        }
+
+        handleMacroKeys(pressed);
+
+        if (++register_sync_timer >= REGISTER_SYNC_FRAMES) {
+            register_sync_timer = 0;
+            if (registers_dirty()) registers_sync(REGISTER_FILE);
+        }
+
+        if(pressed & KEY_START) break;
     }
 
+    registers_sync(REGISTER_FILE);
+
     return 0;
 }
\ No newline at end of file
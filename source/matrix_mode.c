@@ -0,0 +1,271 @@
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h> // For strtod
+#include <string.h>
+
+#include "matrix_mode.h"
+#include "matrix.h"
+#include "text_console.h"
+
+// Largest magnitude an element can hold in Q16.16
+#define MATRIX_ENTRY_MAX 32767.0
+
+static const char* matrix_button_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "+/-", "A/B", "SIZE"},
+    {"7", "8", "9", "DEL"},
+    {"4", "5", "6", "R>A"},
+    {"1", "2", "3", "FN"},
+    {"0", ".", "ENT", ""}
+};
+
+static const char* matrix_op_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"A+B", "A-B", "A*B", "123"},
+    {"A^T", "det", "inv", "Ax=b"},
+    {"A/B", "R>A", "SIZE", "C"},
+    {"", "", "", ""},
+    {"", "", "", ""}
+};
+
+static bool matrix_op_page = false;
+
+static Matrix mat_a;
+static Matrix mat_b;
+static Matrix mat_r;
+static Matrix* mat_edit = &mat_a;
+static s32 cursor_row = 0;
+static s32 cursor_col = 0;
+
+// Number being typed for the element under the cursor
+static char mat_entry[12];
+static bool mat_typing = false;
+
+enum {
+    RESULT_NONE,
+    RESULT_MATRIX, // mat_r
+    RESULT_SCALAR, // mat_scalar (determinant)
+    RESULT_ERROR
+};
+static int mat_result = RESULT_NONE;
+static const char* mat_result_name = ""; // Operation, or the error message
+static double mat_scalar = 0.0;
+
+ButtonLabelRow* matrixMode_labels(void) {
+    return matrix_op_page ? matrix_op_labels : matrix_button_labels;
+}
+
+void matrixMode_init(void) {
+    matrix_setZero(&mat_a, 2, 2);
+    matrix_setZero(&mat_b, 2, 2);
+    matrix_setZero(&mat_r, 1, 1);
+}
+
+static char editName(void) {
+    return mat_edit == &mat_a ? 'A' : 'B';
+}
+
+static void setError(const char* message) {
+    mat_result = RESULT_ERROR;
+    mat_result_name = message;
+}
+
+// Store the typed number in the element under the cursor
+static void commitEntry(void) {
+    if (!mat_typing) return;
+    mat_typing = false;
+
+    double v = strtod(mat_entry, NULL);
+    if (v > MATRIX_ENTRY_MAX || v < -MATRIX_ENTRY_MAX) {
+        setError("too large");
+        return;
+    }
+    mat_edit->data[cursor_row * mat_edit->cols + cursor_col] = matrix_fromDouble(v);
+}
+
+static void moveCursor(s32 row, s32 col) {
+    commitEntry();
+    if (row < 0 || col < 0 || row >= MATRIX_MAX || col >= MATRIX_MAX) return;
+
+    // Moving past the edge grows the matrix
+    if (row >= mat_edit->rows || col >= mat_edit->cols) {
+        matrix_resize(mat_edit,
+                      row >= mat_edit->rows ? row + 1 : mat_edit->rows,
+                      col >= mat_edit->cols ? col + 1 : mat_edit->cols);
+    }
+    cursor_row = row;
+    cursor_col = col;
+}
+
+// ENT: next element in row-major order, back to the top left after the last one
+static void advanceCursor(void) {
+    commitEntry();
+    if (cursor_col + 1 < mat_edit->cols) {
+        cursor_col++;
+    } else {
+        cursor_col = 0;
+        cursor_row = cursor_row + 1 < mat_edit->rows ? cursor_row + 1 : 0;
+    }
+}
+
+static void typeKey(const char* label) {
+    if (!mat_typing) {
+        strcpy(mat_entry, "0");
+        mat_typing = true;
+    }
+
+    size_t len = strlen(mat_entry);
+    if (strcmp(label, "+/-") == 0) {
+        if (mat_entry[0] == '-') {
+            memmove(mat_entry, mat_entry + 1, len);
+        } else if (len + 1 < sizeof(mat_entry)) {
+            memmove(mat_entry + 1, mat_entry, len + 1);
+            mat_entry[0] = '-';
+        }
+    } else if (strcmp(label, ".") == 0) {
+        if (!strchr(mat_entry, '.') && len + 1 < sizeof(mat_entry)) strcat(mat_entry, ".");
+    } else if (strcmp(mat_entry, "0") == 0) {
+        strcpy(mat_entry, label);
+    } else if (strcmp(mat_entry, "-0") == 0) {
+        strcpy(mat_entry + 1, label);
+    } else if (len + 1 < sizeof(mat_entry)) {
+        strcat(mat_entry, label);
+    }
+}
+
+static void matrixResult(bool ok, const char* name, const char* error) {
+    if (ok) {
+        mat_result = RESULT_MATRIX;
+        mat_result_name = name;
+    } else {
+        setError(error);
+    }
+}
+
+static void runOperation(const char* label) {
+    const Matrix* a = &mat_a;
+    const Matrix* b = &mat_b;
+    bool square = a->rows == a->cols;
+
+    if (strcmp(label, "A+B") == 0 || strcmp(label, "A-B") == 0) {
+        if (a->rows != b->rows || a->cols != b->cols) {
+            setError("size mismatch");
+        } else if (label[1] == '+') {
+            matrixResult(matrix_add(&mat_r, a, b), label, "overflow");
+        } else {
+            matrixResult(matrix_sub(&mat_r, a, b), label, "overflow");
+        }
+    }
+    else if (strcmp(label, "A*B") == 0) {
+        if (a->cols != b->rows) setError("size mismatch");
+        else matrixResult(matrix_mul(&mat_r, a, b), label, "overflow");
+    }
+    else if (strcmp(label, "A^T") == 0) {
+        matrixResult(matrix_transpose(&mat_r, a), label, "");
+    }
+    else if (strcmp(label, "det") == 0) {
+        if (!square) {
+            setError("not square");
+        } else if (matrix_det(a, &mat_scalar)) {
+            mat_result = RESULT_SCALAR;
+            mat_result_name = "det(A)";
+        } else {
+            setError("overflow");
+        }
+    }
+    else if (strcmp(label, "inv") == 0) {
+        if (!square) setError("not square");
+        else matrixResult(matrix_inverse(&mat_r, a), "A^-1", "singular");
+    }
+    else if (strcmp(label, "Ax=b") == 0) {
+        // B holds the right-hand side(s), one column per system
+        if (!square || b->rows != a->rows) setError("size mismatch");
+        else matrixResult(matrix_solve(&mat_r, a, b), "x", "singular");
+    }
+}
+
+void matrixMode_handleButton(const char* label) {
+    if (strcmp(label, "FN") == 0 || strcmp(label, "123") == 0) {
+        matrix_op_page = !matrix_op_page;
+    }
+    else if ((label[0] >= '0' && label[0] <= '9') || strcmp(label, ".") == 0 ||
+             strcmp(label, "+/-") == 0) {
+        typeKey(label);
+    }
+    else if (strcmp(label, "DEL") == 0) {
+        size_t len = strlen(mat_entry);
+        if (mat_typing && len > 0) mat_entry[len - 1] = '\0';
+    }
+    else if (strcmp(label, "ENT") == 0) {
+        advanceCursor();
+    }
+    else if (strcmp(label, "C") == 0) {
+        mat_typing = false;
+        matrix_setZero(mat_edit, mat_edit->rows, mat_edit->cols);
+    }
+    else if (strcmp(label, "A/B") == 0) {
+        commitEntry();
+        mat_edit = mat_edit == &mat_a ? &mat_b : &mat_a;
+        if (cursor_row >= mat_edit->rows) cursor_row = mat_edit->rows - 1;
+        if (cursor_col >= mat_edit->cols) cursor_col = mat_edit->cols - 1;
+    }
+    else if (strcmp(label, "SIZE") == 0) {
+        commitEntry();
+        matrix_resize(mat_edit, cursor_row + 1, cursor_col + 1);
+    }
+    else if (strcmp(label, "R>A") == 0) {
+        commitEntry();
+        if (mat_result == RESULT_MATRIX) {
+            mat_a = mat_r;
+            mat_edit = &mat_a;
+            cursor_row = 0;
+            cursor_col = 0;
+        }
+    }
+    else {
+        commitEntry();
+        runOperation(label);
+    }
+}
+
+void matrixMode_handleKeys(u32 keys) {
+    if (keys & KEY_RIGHT) moveCursor(cursor_row, cursor_col + 1);
+    if (keys & KEY_LEFT)  moveCursor(cursor_row, cursor_col - 1);
+    if (keys & KEY_DOWN)  moveCursor(cursor_row + 1, cursor_col);
+    if (keys & KEY_UP)    moveCursor(cursor_row - 1, cursor_col);
+}
+
+void matrixMode_drawDisplay(void) {
+    const Matrix* other = mat_edit == &mat_a ? &mat_b : &mat_a;
+    char name = editName();
+
+    textConsole_printAt(1, 1, "Edit %c %ldx%ld  %c %ldx%ld", name,
+                        (long)mat_edit->rows, (long)mat_edit->cols,
+                        name == 'A' ? 'B' : 'A', (long)other->rows, (long)other->cols);
+
+    // Element under the cursor (1-based like the usual notation)
+    if (mat_typing) {
+        textConsole_printAt(2, 1, "%c(%ld,%ld)=%s_", name, (long)cursor_row + 1, (long)cursor_col + 1, mat_entry);
+    } else {
+        s32 v = mat_edit->data[cursor_row * mat_edit->cols + cursor_col];
+        textConsole_printAt(2, 1, "%c(%ld,%ld)=%.6g", name, (long)cursor_row + 1, (long)cursor_col + 1,
+                            matrix_toDouble(v));
+    }
+
+    switch (mat_result) {
+    case RESULT_MATRIX:
+        // Same element of the result when the cursor is inside it
+        if (cursor_row < mat_r.rows && cursor_col < mat_r.cols) {
+            textConsole_printAt(3, 1, "%s (%ld,%ld)=%.6g", mat_result_name,
+                                (long)cursor_row + 1, (long)cursor_col + 1,
+                                matrix_toDouble(mat_r.data[cursor_row * mat_r.cols + cursor_col]));
+        } else {
+            textConsole_printAt(3, 1, "%s %ldx%ld", mat_result_name, (long)mat_r.rows, (long)mat_r.cols);
+        }
+        break;
+    case RESULT_SCALAR:
+        textConsole_printAt(3, 1, "%s=%.8g", mat_result_name, mat_scalar);
+        break;
+    case RESULT_ERROR:
+        textConsole_printAt(3, 1, "Error: %s", mat_result_name);
+        break;
+    }
+}
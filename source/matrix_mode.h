@@ -0,0 +1,23 @@
+#ifndef MATRIX_MODE_H
+#define MATRIX_MODE_H
+
+#include "calc.h"
+
+// Matrix mode (common/matrix.c): two operands A and B are entered element by
+// element, results go to R. The D-pad moves the cursor; moving past the last
+// row or column grows the matrix being edited, SIZE crops it at the cursor.
+
+// Current keypad page (entry or operations)
+ButtonLabelRow* matrixMode_labels(void);
+
+void matrixMode_init(void);
+
+void matrixMode_handleButton(const char* label);
+
+// D-pad moves the cursor
+void matrixMode_handleKeys(u32 keys);
+
+// Draws the display area (lines 1-3)
+void matrixMode_drawDisplay(void);
+
+#endif // MATRIX_MODE_H
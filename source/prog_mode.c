@@ -0,0 +1,286 @@
+#include <nds.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "prog_mode.h"
+#include "intcalc.h"
+#include "text_console.h"
+
+// Top-screen console: 4bpp font tiles at 0, map at 62 KB (the bitmap lives
+// in bank B, above both)
+#define PROG_TOP_LAYER 0
+#define PROG_TOP_MAP_BASE 31
+#define PROG_TOP_TILE_BASE 0
+
+// Characters of the value shown on line 2 (binary is cut to its low bits)
+#define PROG_WINDOW_CHARS 30
+
+// Usable width of the top-screen console (from column 1)
+#define PROG_TOP_COLS 31
+
+static const char* prog_digit_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"CLR", "DEL", "=", "OPS"},
+    {"C", "D", "E", "F"},
+    {"8", "9", "A", "B"},
+    {"4", "5", "6", "7"},
+    {"0", "1", "2", "3"}
+};
+
+// Operators go back to the digit page so the next operand can be typed
+static const char* prog_op_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"CLR", "DEL", "=", "123"},
+    {"+", "-", "*", "/"},
+    {"AND", "OR", "XOR", "NOT"},
+    {"<<", ">>", "MOD", "+/-"},
+    {"BASE", "BITS", "SGN", ""}
+};
+
+// Binary operator of each label (the engine's operator character)
+typedef struct {
+    const char* label;
+    char op;
+} ProgOperator;
+
+static const ProgOperator prog_operators[] = {
+    { "+", '+' }, { "-", '-' }, { "*", '*' }, { "/", '/' }, { "MOD", '%' },
+    { "AND", '&' }, { "OR", '|' }, { "XOR", '^' },
+    { "<<", INTCALC_SHL }, { ">>", INTCALC_SHR },
+};
+#define PROG_OPERATOR_COUNT (int)(sizeof(prog_operators) / sizeof(prog_operators[0]))
+
+static const u32 prog_bases[] = {16, 10, 8, 2};
+static const char* prog_base_names[] = {"HEX", "DEC", "OCT", "BIN"};
+static int prog_base_index = 0;
+
+static bool prog_op_page = false;
+static u8 prog_bits = 32;
+static bool prog_signed = true;
+
+static u64 prog_acc = 0;        // Left operand
+static u64 prog_value = 0;      // Value being typed or the last result
+static bool prog_typing = false; // A digit was typed since the last operator
+static char prog_pending = ' ';
+static const char* prog_pending_label = "";
+static bool prog_error = false;
+
+static PrintConsole prog_top;
+static PrintConsole* prog_bottom = NULL;
+static int prog_bitmap_bg;
+static bool prog_top_shown = false;
+static bool prog_top_dirty = true;
+
+void progMode_init(int bitmap_bg) {
+    prog_bitmap_bg = bitmap_bg;
+
+    // consoleInit() selects the new console; keep printing to the sub screen
+    prog_bottom = consoleSelect(&prog_top);
+    consoleInit(&prog_top, PROG_TOP_LAYER, BgType_Text4bpp, BgSize_T_256x256,
+                PROG_TOP_MAP_BASE, PROG_TOP_TILE_BASE, true, true);
+    consoleSelect(prog_bottom);
+    bgHide(prog_top.bgId);
+}
+
+ButtonLabelRow* progMode_labels(void) {
+    return prog_op_page ? prog_op_labels : prog_digit_labels;
+}
+
+static u32 currentBase(void) {
+    return prog_bases[prog_base_index];
+}
+
+static void setValue(u64 value) {
+    prog_value = value & intcalc_mask(prog_bits);
+    prog_top_dirty = true;
+}
+
+// Value of a digit key in base 16 (-1 for other keys)
+static int digitOf(const char* label) {
+    if (label[1] != '\0') return -1;
+    if (label[0] >= '0' && label[0] <= '9') return label[0] - '0';
+    if (label[0] >= 'A' && label[0] <= 'F') return label[0] - 'A' + 10;
+    return -1;
+}
+
+static void typeDigit(int digit) {
+    u64 v = prog_typing ? prog_value : 0;
+    if (!intcalc_appendDigit(&v, (u32)digit, currentBase(), prog_bits)) return;
+    prog_typing = true;
+    prog_error = false;
+    setValue(v);
+}
+
+// prog_acc = prog_acc <pending> prog_value
+static bool applyPending(void) {
+    if (prog_pending == ' ') {
+        prog_acc = prog_value;
+        return true;
+    }
+    if (!intcalc_apply(&prog_acc, prog_pending, prog_acc, prog_value, prog_bits, prog_signed)) {
+        prog_error = true; // Division by zero
+        prog_pending = ' ';
+        prog_typing = false;
+        return false;
+    }
+    return true;
+}
+
+static void binaryOperator(const ProgOperator* op) {
+    if (!applyPending()) return;
+    prog_pending = op->op;
+    prog_pending_label = op->label;
+    prog_typing = false;
+    prog_op_page = false;
+    setValue(prog_acc);
+}
+
+void progMode_handleButton(const char* label) {
+    int digit = digitOf(label);
+    if (digit >= 0) {
+        typeDigit(digit);
+        return;
+    }
+
+    for (int i = 0; i < PROG_OPERATOR_COUNT; i++) {
+        if (strcmp(label, prog_operators[i].label) == 0) {
+            binaryOperator(&prog_operators[i]);
+            return;
+        }
+    }
+
+    if (strcmp(label, "OPS") == 0 || strcmp(label, "123") == 0) {
+        prog_op_page = !prog_op_page;
+    }
+    else if (strcmp(label, "=") == 0) {
+        if (prog_pending == ' ' || !applyPending()) return;
+        prog_pending = ' ';
+        prog_typing = false;
+        setValue(prog_acc);
+    }
+    else if (strcmp(label, "CLR") == 0) {
+        prog_acc = 0;
+        prog_pending = ' ';
+        prog_typing = false;
+        prog_error = false;
+        setValue(0);
+    }
+    else if (strcmp(label, "DEL") == 0) {
+        if (prog_typing) setValue(intcalc_removeDigit(prog_value, currentBase()));
+    }
+    else if (strcmp(label, "NOT") == 0) {
+        setValue(intcalc_not(prog_value, prog_bits));
+    }
+    else if (strcmp(label, "+/-") == 0) {
+        setValue(intcalc_neg(prog_value, prog_bits));
+    }
+    else if (strcmp(label, "BASE") == 0) {
+        prog_base_index = (prog_base_index + 1) % 4;
+        prog_typing = false; // Digits of the new base start a new number
+    }
+    else if (strcmp(label, "BITS") == 0) {
+        // Narrowing keeps the low bits
+        prog_bits = prog_bits == 32 ? 64 : 32;
+        prog_acc &= intcalc_mask(prog_bits);
+        setValue(prog_value);
+    }
+    else if (strcmp(label, "SGN") == 0) {
+        prog_signed = !prog_signed;
+        prog_top_dirty = true;
+    }
+}
+
+void progMode_drawDisplay(void) {
+    char text[INTCALC_MAX_DIGITS + 2];
+
+    if (prog_pending != ' ') {
+        intcalc_format(text, prog_acc, currentBase(), prog_bits, prog_signed, false);
+        int n = (int)strlen(text);
+        int start = n > PROG_WINDOW_CHARS - 4 ? n - (PROG_WINDOW_CHARS - 4) : 0;
+        textConsole_printAt(1, 1, "%s %s", text + start, prog_pending_label);
+    }
+
+    if (prog_error) {
+        textConsole_putText(2, 1, "Error");
+    } else {
+        int n = intcalc_format(text, prog_value, currentBase(), prog_bits, prog_signed, false);
+        int start = n > PROG_WINDOW_CHARS ? n - PROG_WINDOW_CHARS : 0;
+        textConsole_putText(2, 1, text + start);
+    }
+
+    textConsole_printAt(3, 1, "%s %dbit %s", prog_base_names[prog_base_index], prog_bits,
+                        prog_signed ? "signed" : "unsigned");
+}
+
+// Hex and binary in groups of four digits. Returns the length written to out
+static int groupDigits(char* out, const char* digits, int count) {
+    int len = 0;
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && i % 4 == 0) out[len++] = ' ';
+        out[len++] = digits[i];
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// One iprintf per row, padded to the line so a shorter value overwrites a
+// longer one without clearing the screen first
+static void putTopRow(int row, const char* text) {
+    iprintf("\x1b[%d;1H%-*s", row, PROG_TOP_COLS, text);
+}
+
+static void printTop(void) {
+    char text[INTCALC_MAX_DIGITS + 2];
+    char line[PROG_TOP_COLS + 1];
+    int n;
+
+    snprintf(line, sizeof(line), "%dbit %s", prog_bits, prog_signed ? "signed" : "unsigned");
+    putTopRow(1, line);
+
+    n = intcalc_format(text, prog_value, 16, prog_bits, false, true);
+    strcpy(line, "HEX ");
+    groupDigits(line + 4, text, n);
+    putTopRow(3, line);
+
+    intcalc_format(text, prog_value, 10, prog_bits, prog_signed, false);
+    snprintf(line, sizeof(line), "DEC %s", text);
+    putTopRow(5, line);
+
+    intcalc_format(text, prog_value, 8, prog_bits, false, false);
+    snprintf(line, sizeof(line), "OCT %s", text);
+    putTopRow(7, line);
+
+    // Sixteen bits per line, highest first, each line labeled with its top bit.
+    // All four lines are written so a 32-bit value clears the 64-bit rows
+    n = intcalc_format(text, prog_value, 2, prog_bits, false, true);
+    for (int row = 0; row < 64 / 16; row++) {
+        if (row < n / 16) {
+            int len = snprintf(line, sizeof(line), "%s %2d ", row == 0 ? "BIN" : "   ",
+                               prog_bits - 1 - row * 16);
+            groupDigits(line + len, text + row * 16, 16);
+        } else {
+            line[0] = '\0';
+        }
+        putTopRow(9 + row, line);
+    }
+}
+
+void progMode_drawTop(bool shown) {
+    if (prog_bottom == NULL) return;
+
+    if (shown != prog_top_shown) {
+        prog_top_shown = shown;
+        if (shown) {
+            bgHide(prog_bitmap_bg);
+            bgShow(prog_top.bgId);
+            prog_top_dirty = true;
+        } else {
+            bgHide(prog_top.bgId);
+            bgShow(prog_bitmap_bg);
+        }
+    }
+    if (!shown || !prog_top_dirty) return;
+    prog_top_dirty = false;
+
+    consoleSelect(&prog_top);
+    printTop();
+    consoleSelect(prog_bottom);
+}
@@ -0,0 +1,27 @@
+#ifndef PROG_MODE_H
+#define PROG_MODE_H
+
+#include "calc.h"
+
+// Programmer mode (common/intcalc.c): 32/64-bit integers with bitwise
+// operators. The value is shown in hex, decimal, octal and binary on a text
+// console laid over the top screen, reprinted only when it changes.
+// Digits (0-9, A-F) are entered in the base chosen with BASE.
+
+// Sets up the top-screen console on BG0 (tiles and map in the first 64 KB
+// of main BG VRAM). bitmap_bg is hidden while the mode is shown.
+void progMode_init(int bitmap_bg);
+
+// Current keypad page (digits or operators)
+ButtonLabelRow* progMode_labels(void);
+
+void progMode_handleButton(const char* label);
+
+// Draws the display area (lines 1-3)
+void progMode_drawDisplay(void);
+
+// Shows the four bases on the top screen (or gives the screen back to the
+// bitmap). Call once per frame; prints only after a change.
+void progMode_drawTop(bool shown);
+
+#endif // PROG_MODE_H
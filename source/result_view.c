@@ -0,0 +1,64 @@
+#include <nds.h>
+#include <string.h>
+
+#include "result_view.h"
+#include "text_console.h"
+
+void resultView_show(ResultView* view, int len) {
+    if (len < 0) len = 0;
+    if ((u32)len >= view->size) len = view->size - 1;
+    view->len = len;
+    view->scroll = 0;
+    view->shown = true;
+}
+
+void resultView_hide(ResultView* view) {
+    view->shown = false;
+}
+
+bool resultView_typing(ResultView* view, const char* label) {
+    if ((label[0] < '0' || label[0] > '9') && strcmp(label, ".") != 0) return false;
+    view->shown = false;
+    return true;
+}
+
+bool resultView_scrollable(const ResultView* view) {
+    return view->shown && view->len > RESULT_WINDOW_CHARS;
+}
+
+void resultView_handleKeys(ResultView* view, u32 keys) {
+    if (!resultView_scrollable(view)) return;
+
+    u32 max_scroll = view->len - RESULT_WINDOW_CHARS;
+    u32 step = 0;
+    bool back = false;
+    if (keys & KEY_RIGHT) step = 1;
+    if (keys & KEY_R) step = RESULT_WINDOW_CHARS;
+    if (keys & KEY_LEFT) { step = 1; back = true; }
+    if (keys & KEY_L) { step = RESULT_WINDOW_CHARS; back = true; }
+
+    if (back) {
+        view->scroll = view->scroll > step ? view->scroll - step : 0;
+    } else {
+        view->scroll = view->scroll + step < max_scroll ? view->scroll + step : max_scroll;
+    }
+}
+
+void resultView_draw(const ResultView* view, int row) {
+    char window[RESULT_WINDOW_CHARS + 1];
+    u32 n = view->len - view->scroll;
+    if (n > RESULT_WINDOW_CHARS) n = RESULT_WINDOW_CHARS;
+    memcpy(window, view->text + view->scroll, n);
+    window[n] = '\0';
+    textConsole_putText(row, 1, window);
+}
+
+int resultView_drawPosition(const ResultView* view, int row, int col) {
+    if (!resultView_scrollable(view)) return col;
+
+    u32 end = view->scroll + RESULT_WINDOW_CHARS;
+    return textConsole_printAt(row, col, "%c %lu-%lu/%lu %c",
+                               view->scroll > 0 ? '<' : ' ',
+                               (unsigned long)view->scroll + 1, (unsigned long)end,
+                               (unsigned long)view->len, end < view->len ? '>' : ' ');
+}
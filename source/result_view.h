@@ -0,0 +1,46 @@
+#ifndef RESULT_VIEW_H
+#define RESULT_VIEW_H
+
+#include "calc.h"
+
+// Result line shared by the modes whose results can be longer than the
+// display (big, complex, fraction). The mode formats the result into the
+// view's text and calls resultView_show(); the line then shows a window of
+// RESULT_WINDOW_CHARS that D-pad left/right scroll and L/R move by a whole
+// window. Typing a digit hides the result again.
+
+// Characters of the result shown at once
+#define RESULT_WINDOW_CHARS 30
+
+typedef struct {
+    char* text;   // Formatted result (owned by the mode)
+    u32 size;     // Size of text
+    u32 len;
+    u32 scroll;   // First character in the window
+    bool shown;   // Display shows text instead of display_buffer
+} ResultView;
+
+// Shows the len characters written to view->text (snprintf's return value:
+// a truncated text is clamped to the buffer) from the start
+void resultView_show(ResultView* view, int len);
+
+void resultView_hide(ResultView* view);
+
+// True for digits and "." (left to the basic handler); these hide the result
+// so that typing replaces it
+bool resultView_typing(ResultView* view, const char* label);
+
+// True when the result is shown and longer than the window
+bool resultView_scrollable(const ResultView* view);
+
+// D-pad left/right scroll by a character, L/R by a window
+void resultView_handleKeys(ResultView* view, u32 keys);
+
+// Draws the window of the result at column 1 of a display line
+void resultView_draw(const ResultView* view, int row);
+
+// Draws the scroll position "< 31-60/120 >" when the result is scrollable.
+// Returns the column after it (col if nothing was drawn)
+int resultView_drawPosition(const ResultView* view, int row, int col);
+
+#endif // RESULT_VIEW_H
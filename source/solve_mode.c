@@ -0,0 +1,366 @@
+#include <nds.h>
+#include <math.h>   // For isfinite
+#include <stdio.h>
+#include <stdlib.h> // For strtod
+#include <string.h>
+
+#include "solve_mode.h"
+#include "complex.h"
+#include "expr.h"
+#include "registers.h"
+#include "solve.h"
+#include "text_console.h"
+#include "var_keys.h"
+
+// Evaluations per frame (a Kronrod panel is 15, a Newton step 3): a few
+// thousand a second without slowing the frame down
+#define SOLVE_EVALS_PER_FRAME 96
+
+#define SOLVE_EXPR_SIZE 64
+#define SOLVE_MAX_TOKENS 32
+
+// Characters of the expression shown after "f(x)="
+#define SOLVE_WINDOW_CHARS 26
+
+// Significant digits of a complex root (both parts fit the line)
+#define SOLVE_ROOT_DIGITS 10
+
+// Width of the progress bar in characters
+#define SOLVE_BAR_CHARS 16
+
+static const char* solve_button_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"C", "DEL", "^", "/"},
+    {"7", "8", "9", "*"},
+    {"4", "5", "6", "-"},
+    {"1", "2", "3", "+"},
+    {"0", ".", "x", "FN"}
+};
+
+static const char* solve_fn_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"VAR", "DEL", "(", ")"},
+    {"sin", "cos", "tan", "sqrt"},
+    {"asin", "acos", "atan", "abs"},
+    {"ln", "log", "exp", "pi"},
+    {"e", "CALC", "", "123"}
+};
+
+static const char* solve_calc_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"SOLV", "POLY", "INTG", "d/dx"},
+    {"", "", "", ""},
+    {"", "", "", ""},
+    {"", "", "", ""},
+    {"", "", "", "EDIT"}
+};
+
+// Number entry (digits, "." and "+/-" go to the basic handler)
+static const char* solve_arg_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"ESC", "", "", "Ans"},
+    {"7", "8", "9", ""},
+    {"4", "5", "6", ""},
+    {"1", "2", "3", ""},
+    {"0", ".", "+/-", "OK"}
+};
+
+static const char* solve_run_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"", "", "", ""},
+    {"", "", "", ""},
+    {"", "", "", ""},
+    {"", "", "", ""},
+    {"", "", "", "STOP"}
+};
+
+enum {
+    PAGE_EXPR,
+    PAGE_FN,
+    PAGE_CALC
+};
+static int solve_page = PAGE_EXPR;
+
+// Expression text and the length of each inserted token (DEL removes one token)
+static char solve_expr[SOLVE_EXPR_SIZE];
+static u8 solve_token_len[SOLVE_MAX_TOKENS];
+static int solve_token_count = 0;
+static int solve_error_pos = -1; // Position of a syntax error, -1 if it compiled
+
+static ExprProgram solve_program;
+static bool solve_has_program = false;
+
+enum {
+    ACTION_NONE,
+    ACTION_ROOT,
+    ACTION_POLY,
+    ACTION_INTEGRAL,
+    ACTION_DERIVATIVE
+};
+static int solve_action = ACTION_NONE;
+
+// Numbers asked for before the action runs
+static const char* solve_arg_names[2];
+static double solve_args[2];
+static int solve_arg_count = 0;
+static int solve_arg_index = 0;
+static bool solve_entering = false;
+
+enum {
+    SHOW_NONE,
+    SHOW_RUNNING,
+    SHOW_RESULT,
+    SHOW_ERROR
+};
+static int solve_show = SHOW_NONE;
+static const char* solve_message = ""; // SHOW_ERROR
+
+static SolveJob solve_job;
+static double solve_derivative_value;
+static double solve_derivative_error;
+static int solve_root_index = 0; // Polynomial root shown
+
+ButtonLabelRow* solveMode_labels(void) {
+    if (solve_show == SHOW_RUNNING) return solve_run_labels;
+    if (solve_entering) return solve_arg_labels;
+    if (solve_page == PAGE_FN) return solve_fn_labels;
+    if (solve_page == PAGE_CALC) return solve_calc_labels;
+    return solve_button_labels;
+}
+
+static void showMessage(const char* message) {
+    solve_show = SHOW_ERROR;
+    solve_message = message;
+}
+
+// Compile the edited expression; any result shown was for the old one
+static void expressionChanged(void) {
+    solve_show = SHOW_NONE;
+    solve_has_program = false;
+    solve_error_pos = -1;
+    if (solve_expr[0] == '\0') return;
+    solve_has_program = expr_compile(&solve_program, solve_expr, &solve_error_pos);
+}
+
+static void insertToken(const char* text) {
+    size_t len = strlen(solve_expr);
+    size_t n = strlen(text);
+    if (solve_token_count >= SOLVE_MAX_TOKENS || len + n >= sizeof(solve_expr)) return;
+
+    memcpy(solve_expr + len, text, n + 1);
+    solve_token_len[solve_token_count++] = (u8)n;
+    expressionChanged();
+}
+
+// Starts the chosen action once its numbers have been typed
+static void runAction(void) {
+    solve_entering = false;
+    solve_root_index = 0;
+    switch (solve_action) {
+    case ACTION_ROOT:
+        solve_startRoot(&solve_job, &solve_program, solve_args[0]);
+        break;
+    case ACTION_POLY:
+        solve_startPoly(&solve_job, &solve_program);
+        break;
+    case ACTION_INTEGRAL:
+        solve_startIntegral(&solve_job, &solve_program, solve_args[0], solve_args[1]);
+        break;
+    case ACTION_DERIVATIVE:
+        solve_derivative_value = solve_derivative(&solve_program, solve_args[0], &solve_derivative_error);
+        if (isfinite(solve_derivative_value)) {
+            registers_set(REG_ANS, solve_derivative_value);
+            solve_show = SHOW_RESULT;
+        } else {
+            showMessage("undefined");
+        }
+        return;
+    }
+    solve_show = SHOW_RUNNING;
+    solveMode_update(); // The first batch (a short solve is done at once)
+}
+
+static void startArgument(void) {
+    strcpy(display_buffer, "0");
+    new_number_flag = true;
+}
+
+// Picks an action and asks for its numbers (if any)
+static void chooseAction(int action) {
+    if (!solve_has_program) {
+        showMessage(solve_expr[0] == '\0' ? "enter f(x) first" : "syntax error");
+        return;
+    }
+
+    solve_action = action;
+    solve_arg_index = 0;
+    solve_arg_count = 0;
+    if (action == ACTION_ROOT) {
+        solve_arg_names[solve_arg_count++] = "x0";
+    } else if (action == ACTION_INTEGRAL) {
+        solve_arg_names[solve_arg_count++] = "a";
+        solve_arg_names[solve_arg_count++] = "b";
+    } else if (action == ACTION_DERIVATIVE) {
+        solve_arg_names[solve_arg_count++] = "x";
+    }
+
+    if (solve_arg_count == 0) {
+        runAction();
+        return;
+    }
+    solve_show = SHOW_NONE;
+    solve_entering = true;
+    startArgument();
+}
+
+static void handleArgument(const char* label) {
+    if (strcmp(label, "ESC") == 0) {
+        solve_entering = false;
+    }
+    else if (strcmp(label, "Ans") == 0) {
+        snprintf(display_buffer, sizeof(display_buffer), "%.9g", registers_get(REG_ANS));
+        new_number_flag = true;
+    }
+    else if (strcmp(label, "OK") == 0) {
+        solve_args[solve_arg_index++] = strtod(display_buffer, NULL);
+        if (solve_arg_index < solve_arg_count) startArgument();
+        else runAction();
+    }
+}
+
+bool solveMode_handleButton(const char* label) {
+    if (solve_show == SHOW_RUNNING) {
+        if (strcmp(label, "STOP") == 0) solve_show = SHOW_NONE;
+        return true;
+    }
+    if (solve_entering) {
+        if ((label[0] >= '0' && label[0] <= '9') || strcmp(label, ".") == 0 || strcmp(label, "+/-") == 0) {
+            return false;
+        }
+        handleArgument(label);
+        return true;
+    }
+
+    if (strcmp(label, "FN") == 0 || strcmp(label, "123") == 0 || strcmp(label, "EDIT") == 0) {
+        solve_page = solve_page == PAGE_EXPR ? PAGE_FN : PAGE_EXPR;
+    }
+    else if (strcmp(label, "CALC") == 0) {
+        solve_page = PAGE_CALC;
+    }
+    else if (strcmp(label, "SOLV") == 0) {
+        chooseAction(ACTION_ROOT);
+    }
+    else if (strcmp(label, "POLY") == 0) {
+        chooseAction(ACTION_POLY);
+    }
+    else if (strcmp(label, "INTG") == 0) {
+        chooseAction(ACTION_INTEGRAL);
+    }
+    else if (strcmp(label, "d/dx") == 0) {
+        chooseAction(ACTION_DERIVATIVE);
+    }
+    else if (strcmp(label, "C") == 0) {
+        solve_expr[0] = '\0';
+        solve_token_count = 0;
+        expressionChanged();
+    }
+    else if (strcmp(label, "DEL") == 0) {
+        if (solve_token_count == 0) return true;
+        solve_expr[strlen(solve_expr) - solve_token_len[--solve_token_count]] = '\0';
+        expressionChanged();
+    }
+    else if (strcmp(label, "VAR") == 0) {
+        varKeys_open(insertToken); // RCL types the register's name
+    }
+    else if (label[0] >= 'a' && label[0] <= 'z' && label[1] != '\0' && strcmp(label, "pi") != 0) {
+        // Function keys open the argument's parenthesis
+        char text[8];
+        snprintf(text, sizeof(text), "%s(", label);
+        insertToken(text);
+    }
+    else {
+        insertToken(label);
+    }
+    return true;
+}
+
+void solveMode_handleKeys(u32 keys) {
+    if (solve_show != SHOW_RESULT || solve_action != ACTION_POLY) return;
+
+    if (keys & KEY_RIGHT) solve_root_index++;
+    if (keys & KEY_LEFT) solve_root_index--;
+    if (solve_root_index < 0) solve_root_index = 0;
+    if (solve_root_index >= solve_job.degree) solve_root_index = solve_job.degree - 1;
+}
+
+void solveMode_update(void) {
+    if (solve_show != SHOW_RUNNING) return;
+    if (!solve_step(&solve_job, SOLVE_EVALS_PER_FRAME)) return;
+
+    if (solve_job.state == SOLVE_FAILED) {
+        showMessage(solve_job.error);
+        return;
+    }
+    solve_show = SHOW_RESULT;
+    if (solve_action == ACTION_ROOT) {
+        registers_set(REG_ANS, solve_job.x);
+    } else if (solve_action == ACTION_INTEGRAL) {
+        registers_set(REG_ANS, solve_job.value);
+    } else if (solve_job.roots[0].im == 0.0) {
+        registers_set(REG_ANS, solve_job.roots[0].re); // Smallest real root
+    }
+}
+
+static void drawProgress(void) {
+    static const char* names[] = {"", "SOLV", "POLY", "INTG", "d/dx"};
+    int filled = solve_job.progress * SOLVE_BAR_CHARS / 100;
+
+    int col = textConsole_printAt(2, 1, "%s [", names[solve_action]);
+    col = textConsole_fill(2, col, '#', filled);
+    col = textConsole_fill(2, col, '-', SOLVE_BAR_CHARS - filled);
+    textConsole_printAt(2, col, "] %d%%", solve_job.progress);
+    textConsole_printAt(3, 1, "n=%lu", (unsigned long)solve_job.evals);
+}
+
+static void drawResult(void) {
+    switch (solve_action) {
+    case ACTION_ROOT:
+        textConsole_printAt(2, 1, "x=%.12g", solve_job.x);
+        textConsole_printAt(3, 1, "f(x)=%.3g n=%lu", solve_job.fx, (unsigned long)solve_job.evals);
+        break;
+    case ACTION_POLY: {
+        char root[48];
+        complex_formatRect(solve_job.roots[solve_root_index], SOLVE_ROOT_DIGITS, root, sizeof(root));
+        textConsole_printAt(2, 1, "x%d=%s", solve_root_index + 1, root);
+        textConsole_printAt(3, 1, "%c %d/%d %c  degree %d", solve_root_index > 0 ? '<' : ' ',
+                            solve_root_index + 1, solve_job.degree,
+                            solve_root_index < solve_job.degree - 1 ? '>' : ' ', solve_job.degree);
+        break;
+    }
+    case ACTION_INTEGRAL:
+        textConsole_printAt(2, 1, "=%.12g", solve_job.value);
+        textConsole_printAt(3, 1, "err %.2g n=%lu", solve_job.value_error, (unsigned long)solve_job.evals);
+        break;
+    case ACTION_DERIVATIVE:
+        textConsole_printAt(2, 1, "f'=%.12g", solve_derivative_value);
+        textConsole_printAt(3, 1, "err %.2g", solve_derivative_error);
+        break;
+    }
+}
+
+void solveMode_drawDisplay(void) {
+    // Tail of the expression when it is longer than the line
+    size_t len = strlen(solve_expr);
+    size_t start = len > SOLVE_WINDOW_CHARS ? len - SOLVE_WINDOW_CHARS : 0;
+    textConsole_printAt(1, 1, "f(x)=%s", solve_expr + start);
+
+    if (solve_entering) {
+        textConsole_printAt(2, 1, "%s=%s", solve_arg_names[solve_arg_index], display_buffer);
+        if (solve_arg_count > 1) textConsole_printAt(3, 1, "%d/%d OK:next", solve_arg_index + 1, solve_arg_count);
+    } else if (solve_show == SHOW_RUNNING) {
+        drawProgress();
+    } else if (solve_show == SHOW_RESULT) {
+        drawResult();
+    } else if (solve_show == SHOW_ERROR) {
+        textConsole_putText(2, 1, solve_message);
+    } else if (solve_error_pos >= 0) {
+        int col = solve_error_pos - (int)start;
+        if (col < 0) col = 0;
+        textConsole_putChar(2, 6 + col, '^');
+    }
+}
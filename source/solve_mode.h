@@ -0,0 +1,29 @@
+#ifndef SOLVE_MODE_H
+#define SOLVE_MODE_H
+
+#include "calc.h"
+
+// Solver mode (common/solve.c): f(x) typed on the keypad as in the graphing
+// mode, then CALC on the function page for SOLV (f(x)=0 from a starting x),
+// POLY (every root of a polynomial up to degree 8), INTG (integral from a to
+// b) or d/dx (derivative at x). The numbers are typed on a digit page and OK
+// moves on. Solves run a batch of evaluations per frame with a progress bar;
+// STOP abandons one. The result is stored in Ans.
+
+// Current keypad page (expression, functions, CALC or number entry)
+ButtonLabelRow* solveMode_labels(void);
+
+// Returns false for keys left to the basic handler (digits, "." and "+/-"
+// while a number is typed)
+bool solveMode_handleButton(const char* label);
+
+// D-pad left/right step through the roots of a polynomial
+void solveMode_handleKeys(u32 keys);
+
+// Draws the display area (lines 1-3)
+void solveMode_drawDisplay(void);
+
+// Runs the next batch of a solve in progress (call once per frame)
+void solveMode_update(void);
+
+#endif // SOLVE_MODE_H
@@ -0,0 +1,203 @@
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h> // For strtod
+#include <string.h>
+
+#include "stats_mode.h"
+#include "stats.h"
+#include "text_console.h"
+
+// x values kept for the median/quartiles while STO is on
+#define STATS_MAX_STORED 4096
+
+const char* stats_button_labels[BUTTON_ROWS][BUTTON_COLS] = {
+    {"CLR", "+/-", "x,y", "RES"},
+    {"7", "8", "9", "UNDO"},
+    {"4", "5", "6", "STO"},
+    {"1", "2", "3", "ADD"},
+    {"0", ".", "C", ""}
+};
+
+// Results shown on line 3 (RES and the D-pad cycle through them)
+enum {
+    PAGE_MEAN,
+    PAGE_STDDEV,
+    PAGE_RANGE,
+    PAGE_REGRESSION,
+    PAGE_MEDIAN,
+    PAGE_QUARTILES,
+    PAGE_COUNT
+};
+static int stats_page = PAGE_MEAN;
+
+static StatsAccumulator stats_acc;
+static StatsAccumulator stats_prev; // Before the last ADD (one level of UNDO)
+static bool stats_can_undo = false;
+
+static bool stats_have_x = false; // x,y pressed: the next ADD completes a pair
+static double stats_pending_x = 0.0;
+
+// The stored list is complete only while stats_stored == stats_acc.count
+static double stats_data[STATS_MAX_STORED];
+static u32 stats_stored = 0;
+static bool stats_store_on = true;
+static bool stats_last_stored = false;
+static bool stats_last_pair = false; // UNDO goes back to "x entered, y pending"
+static double stats_last_x = 0.0;
+
+// Median and quartiles, recomputed only after the data changed
+static bool stats_quantiles_dirty = true;
+static double stats_q1, stats_median, stats_q3;
+
+static void clearAll(void) {
+    stats_reset(&stats_acc);
+    stats_can_undo = false;
+    stats_have_x = false;
+    stats_stored = 0;
+    stats_quantiles_dirty = true;
+}
+
+static void addValue(double value) {
+    stats_prev = stats_acc;
+    stats_can_undo = true;
+
+    double x = value;
+    stats_last_pair = stats_have_x;
+    if (stats_have_x) {
+        x = stats_pending_x;
+        stats_addPair(&stats_acc, x, value);
+        stats_have_x = false;
+    } else {
+        stats_add(&stats_acc, x);
+    }
+
+    stats_last_x = x;
+    stats_last_stored = stats_store_on && stats_stored < STATS_MAX_STORED;
+    if (stats_last_stored) stats_data[stats_stored++] = x;
+    stats_quantiles_dirty = true;
+}
+
+static void undoLast(void) {
+    if (!stats_can_undo) return;
+    stats_acc = stats_prev;
+    stats_can_undo = false;
+
+    // Undoing a pair keeps its x, so only y has to be entered again
+    if (stats_last_pair) {
+        stats_pending_x = stats_last_x;
+        stats_have_x = true;
+    }
+
+    // The list is reordered by the selection, so look the value up
+    if (stats_last_stored) {
+        for (u32 i = stats_stored; i-- > 0;) {
+            if (stats_data[i] == stats_last_x) {
+                stats_data[i] = stats_data[--stats_stored];
+                break;
+            }
+        }
+    }
+    stats_quantiles_dirty = true;
+}
+
+bool statsMode_handleButton(const char* label) {
+    if (strcmp(label, "ADD") == 0 || strcmp(label, "x,y") == 0) {
+        if (strcmp(display_buffer, "Error") == 0) return true;
+        double value = strtod(display_buffer, NULL);
+        if (label[0] == 'x') {
+            stats_pending_x = value;
+            stats_have_x = true;
+        } else {
+            addValue(value);
+        }
+        new_number_flag = true;
+    }
+    else if (strcmp(label, "UNDO") == 0) {
+        undoLast();
+    }
+    else if (strcmp(label, "STO") == 0) {
+        stats_store_on = !stats_store_on;
+    }
+    else if (strcmp(label, "RES") == 0) {
+        stats_page = (stats_page + 1) % PAGE_COUNT;
+    }
+    else if (strcmp(label, "CLR") == 0) {
+        clearAll();
+    }
+    else if (strcmp(label, "C") == 0) {
+        stats_have_x = false;
+        strcpy(display_buffer, "0");
+        new_number_flag = true;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void statsMode_handleKeys(u32 keys) {
+    if (keys & KEY_RIGHT) stats_page = (stats_page + 1) % PAGE_COUNT;
+    if (keys & KEY_LEFT) stats_page = (stats_page + PAGE_COUNT - 1) % PAGE_COUNT;
+}
+
+static bool storedComplete(void) {
+    return stats_acc.count > 0 && stats_stored == stats_acc.count;
+}
+
+static void updateQuantiles(void) {
+    if (!stats_quantiles_dirty) return;
+    stats_quantiles_dirty = false;
+    stats_q1 = stats_quantile(stats_data, stats_stored, 0.25);
+    stats_median = stats_quantile(stats_data, stats_stored, 0.5);
+    stats_q3 = stats_quantile(stats_data, stats_stored, 0.75);
+}
+
+void statsMode_drawDisplay(void) {
+    textConsole_printAt(1, 1, "n=%lu STO:%s %lu/%d", (unsigned long)stats_acc.count,
+                        stats_store_on ? "on" : "off", (unsigned long)stats_stored, STATS_MAX_STORED);
+
+    if (stats_have_x) {
+        textConsole_printAt(2, 1, "x=%.6g y=%s", stats_pending_x, display_buffer);
+    } else {
+        textConsole_putText(2, 1, display_buffer);
+    }
+
+    if (stats_acc.count == 0) {
+        textConsole_putText(3, 1, "(no data)");
+        return;
+    }
+
+    double slope, intercept, r;
+    switch (stats_page) {
+    case PAGE_MEAN:
+        textConsole_printAt(3, 1, "mean=%.10g", stats_acc.mean_x);
+        break;
+    case PAGE_STDDEV:
+        textConsole_printAt(3, 1, "sd s=%.6g p=%.6g", stats_stddev(&stats_acc, true),
+                            stats_stddev(&stats_acc, false));
+        break;
+    case PAGE_RANGE:
+        textConsole_printAt(3, 1, "min=%.6g max=%.6g", stats_acc.min_x, stats_acc.max_x);
+        break;
+    case PAGE_REGRESSION:
+        if (stats_regression(&stats_acc, &slope, &intercept, &r)) {
+            textConsole_printAt(3, 1, "a=%.5g b=%.5g r=%.4f", intercept, slope, r);
+        } else {
+            textConsole_putText(3, 1, "y=a+bx: needs x,y pairs");
+        }
+        break;
+    case PAGE_MEDIAN:
+    case PAGE_QUARTILES:
+        if (!storedComplete()) {
+            textConsole_putText(3, 1, "median: list not stored");
+        } else {
+            updateQuantiles();
+            if (stats_page == PAGE_MEDIAN) {
+                textConsole_printAt(3, 1, "median=%.10g", stats_median);
+            } else {
+                textConsole_printAt(3, 1, "Q1=%.6g Q3=%.6g", stats_q1, stats_q3);
+            }
+        }
+        break;
+    }
+}
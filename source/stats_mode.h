@@ -0,0 +1,22 @@
+#ifndef STATS_MODE_H
+#define STATS_MODE_H
+
+#include "calc.h"
+
+// Statistics mode (common/stats.c). Values are typed with the basic digit
+// entry in main.c; ADD feeds the displayed value (or an x,y pair) to the
+// one-pass accumulators. STO keeps a copy of the x values for the median and
+// quartiles.
+
+extern const char* stats_button_labels[BUTTON_ROWS][BUTTON_COLS];
+
+// Returns false for keys left to the basic handler (digits, ".", "+/-")
+bool statsMode_handleButton(const char* label);
+
+// D-pad left/right switch the result shown on line 3
+void statsMode_handleKeys(u32 keys);
+
+// Draws the display area (lines 1-3)
+void statsMode_drawDisplay(void);
+
+#endif // STATS_MODE_H
@@ -0,0 +1,105 @@
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h> // For strtod
+#include <string.h>
+
+#include "var_keys.h"
+#include "registers.h"
+#include "text_console.h"
+
+// Two pages of names; the action keys stay on the top row of both
+static const char* var_button_labels[2][BUTTON_ROWS][BUTTON_COLS] = {
+    {
+        {"STO", "RCL", "MC", "ESC"},
+        {"A", "B", "C", "D"},
+        {"E", "F", "G", "H"},
+        {"I", "J", "K", "L"},
+        {"M", "N", "O", ">>"}
+    },
+    {
+        {"STO", "RCL", "MC", "ESC"},
+        {"P", "Q", "R", "S"},
+        {"T", "U", "V", "W"},
+        {"X", "Y", "Z", "Ans"},
+        {"<<", "", "", ""}
+    }
+};
+
+// The keypad shown: var_button_labels, without STO while RCL types names
+// (the modes that do that have no displayed value to store)
+static const char* var_shown_labels[2][BUTTON_ROWS][BUTTON_COLS];
+
+static bool var_active = false;
+static int var_page = 0;
+static bool var_store = false; // STO picked (otherwise RCL)
+static VarInsertFunc var_insert = NULL;
+
+void varKeys_open(VarInsertFunc insert) {
+    var_active = true;
+    var_page = 0;
+    var_store = false;
+    var_insert = insert;
+
+    memcpy(var_shown_labels, var_button_labels, sizeof(var_shown_labels));
+    if (insert != NULL) {
+        var_shown_labels[0][0][0] = "";
+        var_shown_labels[1][0][0] = "";
+    }
+}
+
+void varKeys_close(void) {
+    var_active = false;
+}
+
+bool varKeys_active(void) {
+    return var_active;
+}
+
+ButtonLabelRow* varKeys_labels(void) {
+    return var_shown_labels[var_page];
+}
+
+static void applyTo(int reg) {
+    if (var_store) {
+        if (strcmp(display_buffer, "Error") == 0) return;
+        registers_set(reg, strtod(display_buffer, NULL));
+        new_number_flag = true;
+    } else if (var_insert != NULL) {
+        var_insert(registers_name(reg));
+    } else {
+        snprintf(display_buffer, sizeof(display_buffer), "%.6g", registers_get(reg));
+        new_number_flag = true;
+    }
+    var_active = false;
+}
+
+void varKeys_handleButton(const char* label) {
+    int reg = registers_index(label);
+    if (reg >= 0) {
+        applyTo(reg);
+    }
+    else if (strcmp(label, "STO") == 0 || strcmp(label, "RCL") == 0) {
+        var_store = label[0] == 'S' && var_insert == NULL;
+    }
+    else if (strcmp(label, "MC") == 0) {
+        registers_set(REG_M, 0.0);
+        var_active = false;
+    }
+    else if (strcmp(label, "ESC") == 0) {
+        var_active = false;
+    }
+    else if (strcmp(label, ">>") == 0 || strcmp(label, "<<") == 0) {
+        var_page = !var_page;
+    }
+}
+
+void varKeys_drawStatus(void) {
+    // Padded so it covers whatever the mode drew on line 3
+    char status[32];
+    if (var_store) {
+        snprintf(status, sizeof(status), "STO %s -> ?", display_buffer);
+    } else {
+        snprintf(status, sizeof(status), "RCL ?  (M=%.6g)", registers_get(REG_M));
+    }
+    textConsole_printAt(3, 1, "%-30s", status);
+}
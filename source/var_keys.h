@@ -0,0 +1,30 @@
+#ifndef VAR_KEYS_H
+#define VAR_KEYS_H
+
+#include "calc.h"
+
+// Register keypad (common/registers.c) shown over the current mode's keypad.
+// STO or RCL picks the action (RCL by default), then touching a register
+// applies it and closes the keypad. MC clears M, ESC closes.
+
+// Called by RCL instead of recalling the value (e.g. to type the name into
+// an expression)
+typedef void (*VarInsertFunc)(const char* name);
+
+// Opens the register keypad. With insert NULL, RCL puts the value in the display;
+// otherwise there is no STO (the display does not hold the mode's value)
+void varKeys_open(VarInsertFunc insert);
+
+void varKeys_close(void);
+
+bool varKeys_active(void);
+
+// Current page of register names
+ButtonLabelRow* varKeys_labels(void);
+
+void varKeys_handleButton(const char* label);
+
+// Draws the pending action on line 3
+void varKeys_drawStatus(void);
+
+#endif // VAR_KEYS_H
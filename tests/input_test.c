@@ -0,0 +1,115 @@
+// Host test for common/input.c: ring buffer order, wrap-around and overflow,
+// events derived from consecutive samples, and one producer thread feeding
+// one consumer thread through the queue without a lock.
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "input.h"
+#include "check.h"
+
+#define TOUCH_BIT (1u << 12)
+#define KEY_BIT_A 1u
+#define KEY_BIT_B 2u
+
+static InputQueue queue;
+
+static void testRing(void) {
+    InputEvent e = {0};
+    InputEvent out;
+
+    input_reset(&queue);
+    CHECK(!input_pop(&queue, &out));
+
+    // Several times around the ring, keeping the order
+    for (u32 i = 0; i < INPUT_QUEUE_SIZE * 3; i++) {
+        e.time = i;
+        CHECK(input_push(&queue, &e));
+        CHECK(input_pop(&queue, &out));
+        CHECK(out.time == i);
+    }
+
+    // A full queue drops new events and counts them
+    for (u32 i = 0; i < INPUT_QUEUE_SIZE; i++) {
+        e.time = i;
+        CHECK(input_push(&queue, &e));
+    }
+    CHECK(!input_push(&queue, &e));
+    CHECK(queue.dropped == 1);
+    for (u32 i = 0; i < INPUT_QUEUE_SIZE; i++) {
+        CHECK(input_pop(&queue, &out));
+        CHECK(out.time == i);
+    }
+    CHECK(!input_pop(&queue, &out));
+}
+
+static void testSample(void) {
+    InputEvent e;
+
+    input_reset(&queue);
+
+    // A pressed and released between two frames is still two events
+    input_sample(&queue, KEY_BIT_A, TOUCH_BIT, 0, 0, 1);
+    input_sample(&queue, 0, TOUCH_BIT, 0, 0, 2);
+    CHECK(input_pop(&queue, &e) && e.type == INPUT_KEY_DOWN && e.keys == KEY_BIT_A && e.time == 1);
+    CHECK(input_pop(&queue, &e) && e.type == INPUT_KEY_UP && e.keys == KEY_BIT_A && e.time == 2);
+
+    // Holding a key gives no further events; another key changing is reported alone
+    input_sample(&queue, KEY_BIT_A, TOUCH_BIT, 0, 0, 3);
+    input_sample(&queue, KEY_BIT_A, TOUCH_BIT, 0, 0, 4);
+    input_sample(&queue, KEY_BIT_A | KEY_BIT_B, TOUCH_BIT, 0, 0, 5);
+    CHECK(input_pop(&queue, &e) && e.type == INPUT_KEY_DOWN && e.keys == KEY_BIT_A);
+    CHECK(input_pop(&queue, &e) && e.type == INPUT_KEY_DOWN && e.keys == KEY_BIT_B && e.time == 5);
+    CHECK(!input_pop(&queue, &e));
+
+    // Touch: down, a move only when the position changes, up at the last position
+    input_reset(&queue);
+    input_sample(&queue, TOUCH_BIT, TOUCH_BIT, 10, 20, 1);
+    input_sample(&queue, TOUCH_BIT, TOUCH_BIT, 10, 20, 2);
+    input_sample(&queue, TOUCH_BIT, TOUCH_BIT, 12, 21, 3);
+    input_sample(&queue, 0, TOUCH_BIT, 0, 0, 4);
+    CHECK(input_pop(&queue, &e) && e.type == INPUT_TOUCH_DOWN && e.x == 10 && e.y == 20);
+    CHECK(input_pop(&queue, &e) && e.type == INPUT_TOUCH_MOVE && e.x == 12 && e.y == 21);
+    CHECK(input_pop(&queue, &e) && e.type == INPUT_TOUCH_UP && e.x == 12 && e.y == 21 && e.time == 4);
+    CHECK(!input_pop(&queue, &e));
+}
+
+#define THREAD_EVENTS 200000
+
+static void* producer(void* arg) {
+    (void)arg;
+    InputEvent e = {0};
+    for (u32 i = 0; i < THREAD_EVENTS; i++) {
+        e.time = i;
+        while (!input_push(&queue, &e)) sched_yield();
+    }
+    return NULL;
+}
+
+static void testThreads(void) {
+    pthread_t thread;
+    InputEvent e;
+    u32 next = 0;
+    bool in_order = true;
+
+    input_reset(&queue);
+    pthread_create(&thread, NULL, producer, NULL);
+    while (next < THREAD_EVENTS) {
+        if (!input_pop(&queue, &e)) {
+            sched_yield();
+            continue;
+        }
+        if (e.time != next) in_order = false;
+        next++;
+    }
+    pthread_join(thread, NULL);
+    CHECK(in_order);
+    CHECK(!input_pop(&queue, &e));
+}
+
+int main(void) {
+    testRing();
+    testSample();
+    testThreads();
+    return check_result("input_test");
+}
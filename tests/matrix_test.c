@@ -0,0 +1,102 @@
+// Host test for common/matrix.c: multiply against a double reference and
+// solve/invert systems with a known answer, at the sizes the matrix mode offers.
+
+#include <math.h>
+
+#include "matrix.h"
+#include "check.h"
+
+static Matrix a, b, r, x;
+
+// Values in [-1, 1) plus n on the diagonal, so the matrix is well conditioned
+static void fill(Matrix* m, s32 rows, s32 cols, u32 seed) {
+    matrix_setZero(m, rows, cols);
+    for (s32 i = 0; i < rows * cols; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        m->data[i] = (s32)(seed >> 15) - MATRIX_ONE;
+    }
+    if (rows == cols) {
+        for (s32 i = 0; i < rows; i++) m->data[i * cols + i] += rows * MATRIX_ONE;
+    }
+}
+
+static double at(const Matrix* m, s32 i, s32 j) {
+    return matrix_toDouble(m->data[i * m->cols + j]);
+}
+
+static void testMultiply(s32 n, s32 len, s32 m) {
+    fill(&a, n, len, 1 + n);
+    fill(&b, len, m, 7 + m);
+    CHECK(matrix_mul(&r, &a, &b));
+    CHECK(r.rows == n && r.cols == m);
+
+    // The products are exact in 64 bits, so only the final rounding to Q16.16 differs
+    double worst = 0;
+    for (s32 i = 0; i < n; i++) {
+        for (s32 j = 0; j < m; j++) {
+            double want = 0;
+            for (s32 k = 0; k < len; k++) want += at(&a, i, k) * at(&b, k, j);
+            double err = fabs(at(&r, i, j) - want);
+            if (err > worst) worst = err;
+        }
+    }
+    CHECK(worst <= 0.5 / MATRIX_ONE + 1e-12);
+}
+
+static void testSolve(s32 n) {
+    // b = A x for a known x, then solve and compare with x
+    fill(&a, n, n, 3 * n);
+    matrix_setZero(&x, n, 1);
+    for (s32 i = 0; i < n; i++) x.data[i] = matrix_fromDouble((i % 7) - 3 + 0.25 * (i % 3));
+    CHECK(matrix_mul(&b, &a, &x));
+
+    CHECK(matrix_solve(&r, &a, &b));
+    CHECK(r.rows == n && r.cols == 1);
+    for (s32 i = 0; i < n; i++) CHECK(fabs(at(&r, i, 0) - at(&x, i, 0)) < 1e-3);
+
+    // A × A^-1 = I
+    CHECK(matrix_inverse(&r, &a));
+    CHECK(matrix_mul(&b, &a, &r));
+    for (s32 i = 0; i < n; i++) {
+        for (s32 j = 0; j < n; j++) CHECK(fabs(at(&b, i, j) - (i == j)) < 1e-3);
+    }
+}
+
+static void testDeterminant(void) {
+    // Upper triangular: the determinant is the product of the diagonal
+    matrix_setZero(&a, 4, 4);
+    for (s32 i = 0; i < 4; i++) {
+        for (s32 j = i; j < 4; j++) a.data[i * 4 + j] = matrix_fromDouble(i == j ? i + 1.5 : 0.5);
+    }
+    double det;
+    CHECK(matrix_det(&a, &det));
+    CHECK(fabs(det - 1.5 * 2.5 * 3.5 * 4.5) < 1e-3);
+
+    // Singular (two equal rows)
+    matrix_setZero(&a, 3, 3);
+    for (s32 j = 0; j < 3; j++) {
+        a.data[j] = a.data[3 + j] = matrix_fromDouble(j + 1);
+        a.data[6 + j] = matrix_fromDouble(2 * j - 1);
+    }
+    CHECK(!matrix_inverse(&r, &a));
+    CHECK(!matrix_solve(&r, &a, &a));
+}
+
+int main(void) {
+    testMultiply(8, 8, 8);
+    testMultiply(32, 32, 32);
+    testMultiply(5, 17, 3);
+    testSolve(8);
+    testSolve(32);
+    testDeterminant();
+
+    // Size mismatch and overflow are errors, not wrapped results
+    fill(&a, 3, 4, 1);
+    fill(&b, 3, 4, 2);
+    CHECK(!matrix_mul(&r, &a, &b));
+    matrix_setZero(&a, 2, 2);
+    a.data[0] = a.data[3] = 0x7FFF0000;
+    CHECK(!matrix_mul(&r, &a, &a));
+
+    return check_result("matrix_test");
+}
@@ -0,0 +1,90 @@
+// Host test for common/sci_math.c: every function stays within SCI_MAX_ERROR
+// of libm on a dense grid over the ranges the scientific mode uses, and asin
+// and acos also at ±(1 - 2^-k), where 1 - v^2 cancels.
+
+#include <math.h>
+
+#include "sci_math.h"
+#include "check.h"
+
+#define GRID_POINTS 2000000
+
+typedef struct {
+    const char* name;
+    double (*fn)(double);
+    double (*ref)(double);
+    double lo;
+    double hi;
+} Case;
+
+static double sciPow(double x) { return sci_pow(x, 2.5); }
+static double libmPow(double x) { return pow(x, 2.5); }
+
+static const Case cases[] = {
+    { "sin",  sci_sin,   sin,    -10.0,  10.0 },
+    { "cos",  sci_cos,   cos,    -10.0,  10.0 },
+    { "tan",  sci_tan,   tan,    -10.0,  10.0 },
+    { "asin", sci_asin,  asin,    -1.0,   1.0 },
+    { "acos", sci_acos,  acos,    -1.0,   1.0 },
+    { "atan", sci_atan,  atan,   -20.0,  20.0 },
+    { "ln",   sci_ln,    log,    0.001, 1000.0 },
+    { "log",  sci_log10, log10,  0.001, 1000.0 },
+    { "exp",  sci_exp,   exp,    -20.0,  20.0 },
+    { "pow",  sciPow,    libmPow, 0.01, 100.0 },
+    { "sqrt", sci_sqrt,  sqrt,     0.0,  1.0e6 },
+};
+
+// Relative error, or absolute where the true value is below 1e-6
+static double error(const Case* c, double x) {
+    double want = c->ref(x);
+    double err = fabs(c->fn(x) - want);
+    return fabs(want) > 1e-6 ? err / fabs(want) : err;
+}
+
+static void report(const Case* c, double max_err, double at) {
+    if (max_err < SCI_MAX_ERROR) return;
+    printf("%s: error %.3g at %.17g\n", c->name, max_err, at);
+    CHECK(max_err < SCI_MAX_ERROR);
+}
+
+static void testGrid(const Case* c) {
+    double max_err = 0, at = 0;
+    for (int i = 0; i < GRID_POINTS; i++) {
+        double x = c->lo + (c->hi - c->lo) * i / (GRID_POINTS - 1);
+        double err = error(c, x);
+        if (!(err <= max_err)) { // NaN counts as a failure
+            max_err = isnan(err) ? INFINITY : err;
+            at = x;
+        }
+    }
+    report(c, max_err, at);
+}
+
+static void testEdges(const Case* c) {
+    double max_err = 0, at = 0;
+    for (int k = 2; k <= 52; k++) {
+        for (int sign = -1; sign <= 1; sign += 2) {
+            double x = sign * (1.0 - ldexp(1.0, -k));
+            double err = error(c, x);
+            if (!(err <= max_err)) {
+                max_err = isnan(err) ? INFINITY : err;
+                at = x;
+            }
+        }
+    }
+    report(c, max_err, at);
+}
+
+int main(void) {
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        testGrid(&cases[i]);
+        if (cases[i].fn == sci_asin || cases[i].fn == sci_acos) testEdges(&cases[i]);
+    }
+
+    // Exact cases
+    CHECK(sci_sqrt(4.0) == 2.0);
+    CHECK(sci_pow(2.0, 10.0) == 1024.0);
+    CHECK(sci_asin(1.0) == SCI_PI / 2);
+    CHECK(isnan(sci_asin(1.5)) && isnan(sci_ln(-1.0)));
+    return check_result("sci_math_test");
+}
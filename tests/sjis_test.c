@@ -0,0 +1,106 @@
+// Host test for common/sjis.c: the word-at-a-time ASCII scan and the
+// validator agree with byte-by-byte references at every alignment, and the
+// story decodes to the same characters through the checked and the
+// validated paths.
+//
+// Built with -DSJIS_BENCH_ITERATIONS=n (make -C tests bench), it then times
+// the story's decoding with sjis_benchmark(), as make BENCHMARK=1 does on
+// the DS.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sjis.h"
+#include "text_pack.h"
+#include "check.h"
+
+#define DATA_DIR "../data/"
+
+static u8* load(const char* path, u32* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return NULL;
+    fseek(f, 0, SEEK_END);
+    *size = (u32)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    u8* data = aligned_alloc(4, (*size + 3) & ~3u);
+    if (data != NULL && fread(data, 1, *size, f) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+static u32 asciiRunRef(const u8* data, u32 size) {
+    u32 n = 0;
+    while (n < size && !(data[n] & 0x80)) n++;
+    return n;
+}
+
+// Every start offset and length of a buffer with one high byte per position
+static void testAsciiRun(void) {
+    static u8 buf[40];
+    for (u32 high = 0; high <= sizeof(buf); high++) {
+        memset(buf, 'a', sizeof(buf));
+        if (high < sizeof(buf)) buf[high] = 0x82;
+        for (u32 start = 0; start < 8; start++) {
+            for (u32 len = 0; start + len <= sizeof(buf); len++) {
+                CHECK(sjis_asciiRun(buf + start, len) == asciiRunRef(buf + start, len));
+            }
+        }
+    }
+}
+
+static void testStory(const u8* text, u32 size) {
+    SjisIter it;
+    u16 code;
+
+    CHECK(sjis_validate(text, size));
+    for (u32 start = 0; start < 4; start++) {
+        CHECK(sjis_asciiRun(text + start, size - start) == asciiRunRef(text + start, size - start));
+    }
+
+    // Checked and validated paths give the same characters
+    u32 count = 0, sum = 0;
+    sjis_iterInit(&it, text, size);
+    while (sjis_next(&it, &code)) {
+        CHECK(code != SJIS_INVALID);
+        sum = sum * 31 + code;
+        count++;
+    }
+    u32 count_fast = 0, sum_fast = 0;
+    sjis_iterInit(&it, text, size);
+    while (it.cur < it.end) {
+        sum_fast = sum_fast * 31 + sjis_nextUnchecked(&it);
+        count_fast++;
+    }
+    CHECK(count == count_fast && sum == sum_fast);
+    CHECK(count == sjis_countChars(text, size));
+
+    // A lead byte cut off at the end is invalid
+    static const u8 cut[] = {'a', 'b', 'c', 'd', 'e', 0x82};
+    CHECK(!sjis_validate(cut, sizeof(cut)));
+    CHECK(sjis_validate(cut, sizeof(cut) - 1));
+}
+
+int main(void) {
+    testAsciiRun();
+
+    TextPack pack;
+    u32 pack_size;
+    u8* pack_data = load(DATA_DIR "chumonno_oi_ryoriten_pack.bin", &pack_size);
+    CHECK(pack_data != NULL && textPack_open(&pack, pack_data, pack_size));
+    if (pack_data == NULL) return check_result("sjis_test");
+
+    u8* text = malloc(pack.text_size);
+    u32 size = textPack_read(&pack, 0, text, pack.text_size);
+    CHECK(size == pack.text_size);
+    testStory(text, size);
+
+#ifdef SJIS_BENCH_ITERATIONS
+    sjis_benchmark(text, size, SJIS_BENCH_ITERATIONS);
+#endif
+    free(text);
+    free(pack_data);
+    return check_result("sjis_test");
+}
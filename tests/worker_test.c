@@ -0,0 +1,153 @@
+// Host test for common/worker.c: jobs run on the worker thread give the same
+// results as running them in place, a busy job is not sent twice, and result
+// limbs are allocated on whole cache lines so the ARM9 can discard them safely.
+//
+// The host worker shares the bignum arena with this thread (the ARM7 has its
+// own copy), so every operand is allocated before the jobs are sent.
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "worker.h"
+#include "check.h"
+
+#define DATA_DIR "../data/"
+
+static WorkerJob job_mul, job_div, job_fact, job_find, job_ref;
+static TextPack book_pack;
+static TextIndex book_index;
+
+static u8* load(const char* path, u32* size) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return NULL;
+    fseek(f, 0, SEEK_END);
+    *size = (u32)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    u8* data = aligned_alloc(4, (*size + 3) & ~3u);
+    if (data != NULL && fread(data, 1, *size, f) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+static bool sameNumber(const BigNum* a, const BigNum* b) {
+    static char sa[4096], sb[4096];
+    bignum_toString(a, sa, sizeof(sa));
+    bignum_toString(b, sb, sizeof(sb));
+    return strcmp(sa, sb) == 0;
+}
+
+static void fillDigits(char* s, int digits, unsigned seed) {
+    s[0] = '1' + seed % 9;
+    for (int i = 1; i < digits; i++) {
+        seed = seed * 1103515245u + 12345u;
+        s[i] = '0' + (seed >> 16) % 10;
+    }
+    s[digits] = '\0';
+}
+
+static bool aligned(const BigNum* n) {
+    return ((uintptr_t)n->limb & 31) == 0;
+}
+
+static void setupBig(WorkerJob* job, WorkerJobType type, const BigNum* a, const BigNum* b, u32 n) {
+    job->type = type;
+    bignum_alloc(&job->u.big.r, 400);
+    if (a != NULL) job->u.big.a = *a;
+    if (b != NULL) job->u.big.b = *b;
+    job->u.big.n = n;
+    job->u.big.digits = 200;
+}
+
+// The same job run in place, into a fresh result
+static bool runReference(const WorkerJob* job) {
+    job_ref = *job;
+    bignum_alloc(&job_ref.u.big.r, 400);
+    worker_run(&job_ref);
+    return job_ref.ok;
+}
+
+int main(void) {
+    static char digits_a[1001], digits_b[1001];
+    BigNum a, b, small;
+
+    // Odd sizes still start on a 32-byte line
+    CHECK(bignum_alloc(&small, 3));
+    CHECK(bignum_alloc(&a, 120) && bignum_alloc(&b, 120));
+    CHECK(aligned(&small) && aligned(&a) && aligned(&b));
+    CHECK(a.limb - small.limb == 8);
+
+    // Long enough for the Karatsuba path
+    fillDigits(digits_a, 1000, 7);
+    fillDigits(digits_b, 900, 11);
+    CHECK(bignum_fromString(&a, digits_a));
+    CHECK(bignum_fromString(&b, digits_b));
+
+    // Without worker_start() a job runs in place
+    setupBig(&job_mul, WORKER_JOB_BIG_MUL, &a, &b, 0);
+    CHECK(worker_submit(&job_mul));
+    CHECK(worker_finished(&job_mul) && job_mul.ok);
+    CHECK(runReference(&job_mul) && sameNumber(&job_mul.u.big.r, &job_ref.u.big.r));
+
+    setupBig(&job_mul, WORKER_JOB_BIG_MUL, &a, &b, 0);
+    setupBig(&job_div, WORKER_JOB_BIG_DIV, &a, &b, 0);
+    setupBig(&job_fact, WORKER_JOB_BIG_FACTORIAL, NULL, NULL, 300);
+    CHECK(aligned(&job_mul.u.big.r) && aligned(&job_div.u.big.r) && aligned(&job_fact.u.big.r));
+
+    u32 pack_size = 0, index_size = 0;
+    u8* pack = load(DATA_DIR "chumonno_oi_ryoriten_pack.bin", &pack_size);
+    u8* index = load(DATA_DIR "chumonno_oi_ryoriten_idx.bin", &index_size);
+    CHECK(pack != NULL && index != NULL);
+    bool have_text = pack != NULL && index != NULL &&
+                     textPack_open(&book_pack, pack, pack_size) &&
+                     textIndex_open(&book_index, index, index_size, &book_pack);
+    CHECK(have_text);
+    job_find.type = WORKER_JOB_TEXT_FIND;
+    job_find.u.find.index = &book_index;
+    job_find.u.find.from = 0;
+    job_find.u.find.query_len = 2;
+    job_find.u.find.query[0] = 0x82B1; // こ
+    job_find.u.find.query[1] = 0x82CC; // の
+
+    worker_start();
+    CHECK(worker_submit(&job_mul));
+    CHECK(worker_submit(&job_div));
+    CHECK(worker_submit(&job_fact));
+    if (have_text) CHECK(worker_submit(&job_find));
+
+    // A job that has not come back yet cannot be sent again
+    if (worker_busy(&job_fact)) CHECK(!worker_submit(&job_fact));
+
+    int remaining = have_text ? 4 : 3;
+    bool done_mul = false, done_div = false, done_fact = false, done_find = !have_text;
+    for (long spins = 0; remaining > 0 && spins < 100000000L; spins++) {
+        if (!done_mul && worker_finished(&job_mul)) { done_mul = true; remaining--; }
+        if (!done_div && worker_finished(&job_div)) { done_div = true; remaining--; }
+        if (!done_fact && worker_finished(&job_fact)) { done_fact = true; remaining--; }
+        if (!done_find && worker_finished(&job_find)) { done_find = true; remaining--; }
+        sched_yield();
+    }
+    CHECK(remaining == 0);
+    if (remaining > 0) return check_result("worker_test");
+
+    // worker_finished() reports a job once and puts it back to idle
+    CHECK(!worker_finished(&job_mul));
+
+    CHECK(job_mul.ok && runReference(&job_mul) && sameNumber(&job_mul.u.big.r, &job_ref.u.big.r));
+    CHECK(job_div.ok && runReference(&job_div) && sameNumber(&job_div.u.big.r, &job_ref.u.big.r));
+    CHECK(job_fact.ok && runReference(&job_fact) && sameNumber(&job_fact.u.big.r, &job_ref.u.big.r));
+
+    if (have_text) {
+        u32 hit;
+        CHECK(job_find.ok);
+        CHECK(textIndex_findNext(&book_index, job_find.u.find.query, 2, 0, &hit));
+        CHECK(job_find.u.find.hit == hit);
+        CHECK(job_find.u.find.line == textPack_lineStart(&book_pack, hit));
+    }
+
+    return check_result("worker_test");
+}